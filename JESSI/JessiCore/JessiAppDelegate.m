@@ -1,5 +1,6 @@
 #import "JessiAppDelegate.h"
 #import "JESSI-Swift.h"
+#import "JessiRuntimePrewarm.h"
 
 @implementation JessiAppDelegate
 
@@ -8,6 +9,9 @@
     self.window.rootViewController = [JessiSwiftUIEntry makeRootTabViewController];
     [self.window makeKeyAndVisible];
 
+    // Low QoS, after first frame; the launch view narrows this to the selected server.
+    [[JessiRuntimePrewarm shared] prewarmServerNamed:nil afterDelay:3.0];
+
     return YES;
 }
 
@@ -0,0 +1,33 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Server jars, mods and pack files shared by every server (Application Support/ArtifactStore).
+// objects/ holds one read-only copy per SHA-256; index.json maps the SHA-1 and SHA-512 that
+// Modrinth and Mojang publish onto it and lists which server files reference each object.
+// Server files are APFS clones of the object (hard link, then copy, as fallbacks), so ten servers
+// on the same jar share its blocks while each can still replace its own copy.
+@interface JessiArtifactStore : NSObject
+
++ (instancetype)shared;
+
+// algorithm is "sha1", "sha256" or "sha512". YES when the artifact was stored and is now at path,
+// in which case the download can be skipped.
+- (BOOL)materializeHash:(NSString *)hex algorithm:(NSString *)algorithm toPath:(NSString *)path;
+
+// Hashes a file that was just written into a server folder and shares it: a new object is added,
+// or the file is swapped for a clone of the existing one. hashes are the digests the source
+// published ({"sha1": ...}); NO if the file doesn't match them.
+- (BOOL)ingestFileAtPath:(NSString *)path knownHashes:(nullable NSDictionary<NSString *, NSString *> *)hashes;
+
+// Call after renaming a file or folder in Documents (e.g. a server) so the references under it
+// follow; a rename keeps the inodes, so they stay valid.
+- (void)moveReferencesFromPath:(NSString *)oldPath toPath:(NSString *)newPath;
+
+// Drops references whose file is gone or was replaced, then deletes objects nothing references.
+// Runs in the background; call after deleting servers or mods.
+- (void)collectGarbage;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,375 @@
+#import "JessiArtifactStore.h"
+#import "JessiPaths.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#include <copyfile.h>
+#include <sys/clonefile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const int JessiArtifactIndexFormat = 1;
+// Read size when hashing; heap-allocated because hashing runs on background queues.
+static const NSUInteger JessiArtifactHashChunk = 256 * 1024;
+
+static NSString *jessi_artifact_hex(const unsigned char *digest, size_t len) {
+    NSMutableString *hex = [NSMutableString stringWithCapacity:len * 2];
+    for (size_t i = 0; i < len; i++) [hex appendFormat:@"%02x", digest[i]];
+    return hex;
+}
+
+// One pass over the file for all three digests; nil if it can't be read.
+static NSDictionary<NSString *, NSString *> *jessi_artifact_hash_file(NSString *path, unsigned long long *size) {
+    NSInputStream *in = [NSInputStream inputStreamWithFileAtPath:path];
+    if (!in) return nil;
+    uint8_t *buf = malloc(JessiArtifactHashChunk);
+    if (!buf) return nil;
+    [in open];
+    CC_SHA1_CTX c1;
+    CC_SHA256_CTX c256;
+    CC_SHA512_CTX c512;
+    CC_SHA1_Init(&c1);
+    CC_SHA256_Init(&c256);
+    CC_SHA512_Init(&c512);
+    unsigned long long total = 0;
+    NSInteger n;
+    while ((n = [in read:buf maxLength:JessiArtifactHashChunk]) > 0) {
+        CC_SHA1_Update(&c1, buf, (CC_LONG)n);
+        CC_SHA256_Update(&c256, buf, (CC_LONG)n);
+        CC_SHA512_Update(&c512, buf, (CC_LONG)n);
+        total += (unsigned long long)n;
+    }
+    [in close];
+    free(buf);
+    if (n < 0) return nil;
+    unsigned char d1[CC_SHA1_DIGEST_LENGTH], d256[CC_SHA256_DIGEST_LENGTH], d512[CC_SHA512_DIGEST_LENGTH];
+    CC_SHA1_Final(d1, &c1);
+    CC_SHA256_Final(d256, &c256);
+    CC_SHA512_Final(d512, &c512);
+    if (size) *size = total;
+    return @{
+        @"sha1": jessi_artifact_hex(d1, sizeof(d1)),
+        @"sha256": jessi_artifact_hex(d256, sizeof(d256)),
+        @"sha512": jessi_artifact_hex(d512, sizeof(d512)),
+    };
+}
+
+static BOOL jessi_artifact_is_hex(id s, NSUInteger length) {
+    if (![s isKindOfClass:[NSString class]] || [s length] != length) return NO;
+    NSCharacterSet *bad = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    return [s rangeOfCharacterFromSet:bad].location == NSNotFound;
+}
+
+@implementation JessiArtifactStore {
+    NSString *_root;
+    NSString *_documents;
+    // sha256 -> {size, sha1, sha512, ino, mtime, refs: [{path (relative to Documents), ino}]}
+    // ino and mtime are the object file's when its content was last hashed.
+    NSMutableDictionary<NSString *, NSMutableDictionary *> *_objects;
+    NSMutableDictionary<NSString *, NSString *> *_bySHA1;
+    NSMutableDictionary<NSString *, NSString *> *_bySHA512;
+}
+
++ (instancetype)shared {
+    static JessiArtifactStore *shared;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        shared = [[JessiArtifactStore alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        NSURL *appSupport = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
+                                                                    inDomains:NSUserDomainMask] firstObject];
+        _root = [[appSupport URLByAppendingPathComponent:@"ArtifactStore" isDirectory:YES] path];
+        _documents = [[JessiPaths documentsDirectory] stringByResolvingSymlinksInPath];
+    }
+    return self;
+}
+
+#pragma mark - Index
+
+- (NSString *)indexPath {
+    return [_root stringByAppendingPathComponent:@"index.json"];
+}
+
+- (NSString *)objectPathForHash:(NSString *)sha {
+    return [[[_root stringByAppendingPathComponent:@"objects"] stringByAppendingPathComponent:[sha substringToIndex:2]]
+            stringByAppendingPathComponent:sha];
+}
+
+- (void)loadIndexIfNeeded {
+    if (_objects) return;
+    _objects = [NSMutableDictionary dictionary];
+    _bySHA1 = [NSMutableDictionary dictionary];
+    _bySHA512 = [NSMutableDictionary dictionary];
+
+    NSData *data = [NSData dataWithContentsOfFile:[self indexPath]];
+    NSDictionary *index = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![index isKindOfClass:[NSDictionary class]] || [index[@"format"] intValue] != JessiArtifactIndexFormat) return;
+    NSDictionary *objects = index[@"objects"];
+    if (![objects isKindOfClass:[NSDictionary class]]) return;
+
+    for (NSString *sha in objects) {
+        NSDictionary *entry = objects[sha];
+        if (!jessi_artifact_is_hex(sha, CC_SHA256_DIGEST_LENGTH * 2) || ![entry isKindOfClass:[NSDictionary class]]) continue;
+        NSMutableDictionary *obj = [entry mutableCopy];
+        NSMutableArray *refs = [NSMutableArray array];
+        for (NSDictionary *ref in ([entry[@"refs"] isKindOfClass:[NSArray class]] ? entry[@"refs"] : @[])) {
+            if ([ref isKindOfClass:[NSDictionary class]] && [ref[@"path"] isKindOfClass:[NSString class]]) [refs addObject:ref];
+        }
+        obj[@"refs"] = refs;
+        _objects[sha] = obj;
+        if (jessi_artifact_is_hex(obj[@"sha1"], CC_SHA1_DIGEST_LENGTH * 2)) _bySHA1[obj[@"sha1"]] = sha;
+        if (jessi_artifact_is_hex(obj[@"sha512"], CC_SHA512_DIGEST_LENGTH * 2)) _bySHA512[obj[@"sha512"]] = sha;
+    }
+}
+
+- (void)saveIndex {
+    [[NSFileManager defaultManager] createDirectoryAtPath:_root withIntermediateDirectories:YES attributes:nil error:nil];
+    NSDictionary *index = @{@"format": @(JessiArtifactIndexFormat), @"objects": _objects};
+    NSData *out = [NSJSONSerialization dataWithJSONObject:index options:0 error:nil];
+    if (!out || ![out writeToFile:[self indexPath] atomically:YES]) {
+        NSLog(@"[JESSI] Failed to write artifact index");
+    }
+}
+
+- (NSString *)sha256ForHash:(NSString *)hex algorithm:(NSString *)algorithm {
+    NSString *h = hex.lowercaseString;
+    if ([algorithm isEqualToString:@"sha256"]) return _objects[h] ? h : nil;
+    if ([algorithm isEqualToString:@"sha1"]) return _bySHA1[h];
+    if ([algorithm isEqualToString:@"sha512"]) return _bySHA512[h];
+    return nil;
+}
+
+// References are kept relative to Documents, which moves when the app container does.
+- (NSString *)documentsRelativePath:(NSString *)path {
+    NSString *dir = [[path stringByDeletingLastPathComponent] stringByResolvingSymlinksInPath];
+    NSString *full = [dir stringByAppendingPathComponent:path.lastPathComponent];
+    NSString *prefix = [_documents stringByAppendingString:@"/"];
+    return [full hasPrefix:prefix] ? [full substringFromIndex:prefix.length] : nil;
+}
+
+- (void)addReferenceToObject:(NSMutableDictionary *)obj path:(NSString *)path {
+    NSString *rel = [self documentsRelativePath:path];
+    struct stat st;
+    if (!rel || lstat(path.fileSystemRepresentation, &st) != 0) return;
+    NSMutableArray *refs = obj[@"refs"];
+    [refs filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSDictionary *ref, NSDictionary *bindings) {
+        return ![ref[@"path"] isEqualToString:rel];
+    }]];
+    [refs addObject:@{@"path": rel, @"ino": @((unsigned long long)st.st_ino)}];
+}
+
+#pragma mark - Objects
+
+static long long jessi_artifact_mtime_ns(const struct stat *st) {
+    return (long long)st->st_mtimespec.tv_sec * 1000000000LL + st->st_mtimespec.tv_nsec;
+}
+
+- (void)recordStat:(const struct stat *)st forObject:(NSMutableDictionary *)obj {
+    obj[@"ino"] = @((unsigned long long)st->st_ino);
+    obj[@"mtime"] = @(jessi_artifact_mtime_ns(st));
+}
+
+// Same size, but a different inode or mtime means the file was replaced or written since it was
+// hashed (a backup restore, a manual copy), so its content has to be checked again.
+- (BOOL)object:(NSDictionary *)obj isUnchangedSince:(const struct stat *)st {
+    return obj[@"ino"] && obj[@"mtime"] &&
+           [obj[@"ino"] unsignedLongLongValue] == (unsigned long long)st->st_ino &&
+           [obj[@"mtime"] longLongValue] == jessi_artifact_mtime_ns(st);
+}
+
+// Clones keep the server's copy writable and independent; a hard link shares the read-only inode.
+- (BOOL)placeObject:(NSString *)object at:(NSString *)dest {
+    [[NSFileManager defaultManager] createDirectoryAtPath:[dest stringByDeletingLastPathComponent]
+                              withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *tmp = [dest stringByAppendingFormat:@".%@.tmp", [NSUUID UUID].UUIDString];
+    const char *o = object.fileSystemRepresentation;
+    const char *t = tmp.fileSystemRepresentation;
+    BOOL ok = NO;
+    if (clonefile(o, t, 0) == 0) {
+        chmod(t, 0644);
+        ok = YES;
+    } else if (link(o, t) == 0) {
+        ok = YES;
+    } else if (copyfile(o, t, NULL, COPYFILE_DATA) == 0) {
+        chmod(t, 0644);
+        ok = YES;
+    }
+    if (!ok || rename(t, dest.fileSystemRepresentation) != 0) {
+        unlink(t);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)addObjectFromPath:(NSString *)src sha256:(NSString *)sha {
+    NSString *dest = [self objectPathForHash:sha];
+    if (access(dest.fileSystemRepresentation, F_OK) == 0) return YES;
+    [[NSFileManager defaultManager] createDirectoryAtPath:[dest stringByDeletingLastPathComponent]
+                              withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *tmp = [dest stringByAppendingFormat:@".%@.tmp", [NSUUID UUID].UUIDString];
+    if (clonefile(src.fileSystemRepresentation, tmp.fileSystemRepresentation, 0) != 0 &&
+        copyfile(src.fileSystemRepresentation, tmp.fileSystemRepresentation, NULL, COPYFILE_DATA) != 0) {
+        unlink(tmp.fileSystemRepresentation);
+        return NO;
+    }
+    chmod(tmp.fileSystemRepresentation, 0444);
+    if (rename(tmp.fileSystemRepresentation, dest.fileSystemRepresentation) != 0) {
+        unlink(tmp.fileSystemRepresentation);
+        return access(dest.fileSystemRepresentation, F_OK) == 0;
+    }
+    return YES;
+}
+
+- (BOOL)materializeHash:(NSString *)hex algorithm:(NSString *)algorithm toPath:(NSString *)path {
+    if (!hex.length || !path.length || !_root.length) return NO;
+    @synchronized (self) {
+        [self loadIndexIfNeeded];
+        NSString *sha = [self sha256ForHash:hex algorithm:algorithm];
+        if (!sha) return NO;
+        NSString *object = [self objectPathForHash:sha];
+        NSMutableDictionary *obj = _objects[sha];
+        struct stat st;
+        BOOL intact = stat(object.fileSystemRepresentation, &st) == 0 &&
+                      (unsigned long long)st.st_size == [obj[@"size"] unsignedLongLongValue];
+        if (intact && ![self object:obj isUnchangedSince:&st]) {
+            unsigned long long size = 0;
+            NSDictionary<NSString *, NSString *> *digests = jessi_artifact_hash_file(object, &size);
+            intact = [digests[@"sha256"] isEqualToString:sha] && size == [obj[@"size"] unsignedLongLongValue];
+            if (intact) [self recordStat:&st forObject:obj];
+            else NSLog(@"[JESSI] Stored %@ changed on disk; dropping it", sha);
+        }
+        if (!intact) {
+            // Lost, truncated or altered object: forget it and let the caller download.
+            [_objects removeObjectForKey:sha];
+            if (obj[@"sha1"]) [_bySHA1 removeObjectForKey:obj[@"sha1"]];
+            if (obj[@"sha512"]) [_bySHA512 removeObjectForKey:obj[@"sha512"]];
+            unlink(object.fileSystemRepresentation);
+            [self saveIndex];
+            return NO;
+        }
+        if (![self placeObject:object at:path]) return NO;
+        [self addReferenceToObject:obj path:path];
+        [self saveIndex];
+        return YES;
+    }
+}
+
+- (BOOL)ingestFileAtPath:(NSString *)path knownHashes:(NSDictionary<NSString *, NSString *> *)hashes {
+    if (!path.length || !_root.length) return NO;
+    unsigned long long size = 0;
+    NSDictionary<NSString *, NSString *> *digests = jessi_artifact_hash_file(path, &size);
+    if (!digests) return NO;
+    for (NSString *algorithm in hashes) {
+        NSString *want = [hashes[algorithm] lowercaseString];
+        if (digests[algorithm] && want.length && ![digests[algorithm] isEqualToString:want]) {
+            NSLog(@"[JESSI] %@ does not match its published %@; not sharing it", path.lastPathComponent, algorithm);
+            return NO;
+        }
+    }
+
+    NSString *sha = digests[@"sha256"];
+    @synchronized (self) {
+        [self loadIndexIfNeeded];
+        NSString *object = [self objectPathForHash:sha];
+        NSMutableDictionary *obj = _objects[sha];
+        if (obj && access(object.fileSystemRepresentation, F_OK) == 0) {
+            // Already stored: trade this fresh copy for a clone so the blocks are shared.
+            [self placeObject:object at:path];
+        } else {
+            if (![self addObjectFromPath:path sha256:sha]) return NO;
+            obj = [@{@"size": @(size), @"sha1": digests[@"sha1"], @"sha512": digests[@"sha512"], @"refs": [NSMutableArray array]} mutableCopy];
+            struct stat st;
+            if (stat(object.fileSystemRepresentation, &st) == 0) [self recordStat:&st forObject:obj];
+            _objects[sha] = obj;
+            _bySHA1[digests[@"sha1"]] = sha;
+            _bySHA512[digests[@"sha512"]] = sha;
+        }
+        [self addReferenceToObject:obj path:path];
+        [self saveIndex];
+    }
+    return YES;
+}
+
+- (void)moveReferencesFromPath:(NSString *)oldPath toPath:(NSString *)newPath {
+    if (!_root.length) return;
+    NSString *from = [self documentsRelativePath:oldPath];
+    NSString *to = [self documentsRelativePath:newPath];
+    if (!from.length || !to.length || [from isEqualToString:to]) return;
+    NSString *fromDir = [from stringByAppendingString:@"/"];
+    @synchronized (self) {
+        [self loadIndexIfNeeded];
+        NSUInteger moved = 0;
+        for (NSMutableDictionary *obj in _objects.allValues) {
+            NSMutableArray *refs = obj[@"refs"];
+            for (NSUInteger i = 0; i < refs.count; i++) {
+                NSString *path = refs[i][@"path"];
+                NSString *rest = nil;
+                if ([path isEqualToString:from]) rest = @"";
+                else if ([path hasPrefix:fromDir]) rest = [path substringFromIndex:fromDir.length];
+                if (!rest) continue;
+                NSMutableDictionary *ref = [refs[i] mutableCopy];
+                ref[@"path"] = rest.length ? [to stringByAppendingPathComponent:rest] : to;
+                refs[i] = ref;
+                moved++;
+            }
+        }
+        if (moved) [self saveIndex];
+    }
+}
+
+#pragma mark - Garbage collection
+
+- (void)collectGarbage {
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [self collectGarbageNow];
+    });
+}
+
+- (void)collectGarbageNow {
+    if (!_root.length) return;
+    @synchronized (self) {
+        [self loadIndexIfNeeded];
+        NSUInteger removed = 0;
+        unsigned long long freed = 0;
+
+        for (NSString *sha in [_objects allKeys]) {
+            NSMutableDictionary *obj = _objects[sha];
+            NSMutableArray *refs = obj[@"refs"];
+            // A reference counts while the file is still the one we placed (same inode). Server
+            // renames go through moveReferencesFromPath:toPath:; other moves lose their references,
+            // which only costs sharing: their copies are their own.
+            [refs filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSDictionary *ref, NSDictionary *bindings) {
+                struct stat st;
+                NSString *full = [self->_documents stringByAppendingPathComponent:ref[@"path"]];
+                return lstat(full.fileSystemRepresentation, &st) == 0 &&
+                       (unsigned long long)st.st_ino == [ref[@"ino"] unsignedLongLongValue];
+            }]];
+            if (refs.count > 0) continue;
+
+            unlink([self objectPathForHash:sha].fileSystemRepresentation);
+            [_objects removeObjectForKey:sha];
+            if (obj[@"sha1"]) [_bySHA1 removeObjectForKey:obj[@"sha1"]];
+            if (obj[@"sha512"]) [_bySHA512 removeObjectForKey:obj[@"sha512"]];
+            removed++;
+            freed += [obj[@"size"] unsignedLongLongValue];
+        }
+
+        // Objects the index never recorded (an interrupted ingest) and leftover temp files.
+        NSString *objectsDir = [_root stringByAppendingPathComponent:@"objects"];
+        NSDirectoryEnumerator *en = [[NSFileManager defaultManager] enumeratorAtPath:objectsDir];
+        for (NSString *rel in en) {
+            if ([en.fileAttributes[NSFileType] isEqualToString:NSFileTypeDirectory]) continue;
+            NSString *name = rel.lastPathComponent;
+            if (!_objects[name]) unlink([objectsDir stringByAppendingPathComponent:rel].fileSystemRepresentation);
+        }
+
+        [self saveIndex];
+        if (removed) NSLog(@"[JESSI] Artifact store: removed %lu unreferenced objects (%llu bytes)", (unsigned long)removed, freed);
+    }
+}
+
+@end
@@ -0,0 +1,26 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Dynamic AppCDS archive for one server folder (jessi-cds.jsa next to jessi-launch-args.txt).
+// The archive is keyed by the server jar, mods, launch arguments and runtime; the first run for
+// a key dumps it at exit (-XX:ArchiveClassesAtExit), later runs map it (-XX:SharedArchiveFile).
+@interface JessiCDSArchive : NSObject
+
+// nil when the runtime can't use a dynamic archive (Java < 17, no base archive, disabled).
++ (nullable instancetype)archiveForServerDir:(NSString *)serverDir
+                                    javaHome:(NSString *)javaHome
+                                   javaMajor:(int)javaMajor
+                                     jarPath:(NSString *)jarPath
+                                    userArgs:(NSArray<NSString *> *)userArgs;
+
+@property (nonatomic, copy, readonly) NSString *archivePath;
+@property (nonatomic, readonly) BOOL dumping;
+@property (nonatomic, copy, readonly) NSString *summary;
+
+// Called when the server reports Done; returns a console line, or nil if CDS wasn't involved.
++ (nullable NSString *)recordStartupMs:(double)jvmToDoneMs inServerDir:(NSString *)serverDir;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,215 @@
+#import "JessiCDSArchive.h"
+#import "JessiSettings.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString *const JessiCDSArchiveName = @"jessi-cds.jsa";
+static NSString *const JessiCDSMetadataName = @"jessi-cds.json";
+// CDS_DYNAMIC_ARCHIVE_MAGIC; HotSpot writes the header last, so a valid magic means a complete dump.
+static const uint32_t JessiCDSDynamicMagic = 0xf00baba8;
+
+static NSString *jessi_hex_digest(const unsigned char *digest, size_t len) {
+    NSMutableString *hex = [NSMutableString stringWithCapacity:len * 2];
+    for (size_t i = 0; i < len; i++) [hex appendFormat:@"%02x", digest[i]];
+    return hex;
+}
+
+static void jessi_sha_update_string(CC_SHA256_CTX *ctx, NSString *s) {
+    const char *c = s.UTF8String ?: "";
+    CC_SHA256_Update(ctx, c, (CC_LONG)strlen(c) + 1);
+}
+
+static NSString *jessi_sha256_of_file(NSString *path) {
+    NSInputStream *in = [NSInputStream inputStreamWithFileAtPath:path];
+    if (!in) return nil;
+    [in open];
+    CC_SHA256_CTX ctx;
+    CC_SHA256_Init(&ctx);
+    uint8_t buf[64 * 1024];
+    NSInteger n;
+    while ((n = [in read:buf maxLength:sizeof(buf)]) > 0) CC_SHA256_Update(&ctx, buf, (CC_LONG)n);
+    [in close];
+    if (n < 0) return nil;
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &ctx);
+    return jessi_hex_digest(digest, sizeof(digest));
+}
+
+static NSString *jessi_file_stamp(NSString *path) {
+    NSDictionary *attrs = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+    if (!attrs) return @"-";
+    return [NSString stringWithFormat:@"%llu:%.0f", attrs.fileSize, attrs.fileModificationDate.timeIntervalSince1970];
+}
+
+static BOOL jessi_archive_is_complete(NSString *path) {
+    FILE *f = fopen(path.fileSystemRepresentation, "rb");
+    if (!f) return NO;
+    uint32_t magic = 0;
+    size_t n = fread(&magic, sizeof(magic), 1, f);
+    fclose(f);
+    return n == 1 && magic == JessiCDSDynamicMagic;
+}
+
+static NSMutableDictionary *jessi_read_metadata(NSString *serverDir) {
+    NSData *data = [NSData dataWithContentsOfFile:[serverDir stringByAppendingPathComponent:JessiCDSMetadataName]];
+    id obj = data ? [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil] : nil;
+    return [obj isKindOfClass:[NSMutableDictionary class]] ? obj : [NSMutableDictionary dictionary];
+}
+
+static void jessi_write_metadata(NSString *serverDir, NSDictionary *meta) {
+    NSData *out = [NSJSONSerialization dataWithJSONObject:meta options:NSJSONWritingPrettyPrinted error:nil];
+    if (out) [out writeToFile:[serverDir stringByAppendingPathComponent:JessiCDSMetadataName] atomically:YES];
+}
+
+@interface JessiCDSArchive ()
+@property (nonatomic, copy, readwrite) NSString *archivePath;
+@property (nonatomic, readwrite) BOOL dumping;
+@property (nonatomic, copy, readwrite) NSString *summary;
+@end
+
+@implementation JessiCDSArchive
+
++ (NSString *)keyForServerDir:(NSString *)serverDir
+                     javaHome:(NSString *)javaHome
+                    javaMajor:(int)javaMajor
+                      jarPath:(NSString *)jarPath
+                     userArgs:(NSArray<NSString *> *)userArgs
+                     metadata:(NSMutableDictionary *)meta {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    CC_SHA256_CTX ctx;
+    CC_SHA256_Init(&ctx);
+
+    // Hashing a large server jar costs real time on a phone; reuse the digest while size/mtime hold.
+    NSString *jarStamp = jessi_file_stamp(jarPath);
+    NSString *jarHash = nil;
+    if ([meta[@"jar_path"] isEqual:jarPath] && [meta[@"jar_stamp"] isEqual:jarStamp]) jarHash = meta[@"jar_sha256"];
+    if (![jarHash isKindOfClass:[NSString class]] || jarHash.length == 0) {
+        jarHash = jessi_sha256_of_file(jarPath) ?: jarStamp;
+        meta[@"jar_path"] = jarPath;
+        meta[@"jar_stamp"] = jarStamp;
+        meta[@"jar_sha256"] = jarHash;
+    }
+    jessi_sha_update_string(&ctx, jarHash);
+
+    NSString *modsDir = [serverDir stringByAppendingPathComponent:@"mods"];
+    NSArray<NSString *> *mods = [[fm contentsOfDirectoryAtPath:modsDir error:nil] sortedArrayUsingSelector:@selector(compare:)];
+    for (NSString *name in mods) {
+        if (![name.pathExtension.lowercaseString isEqualToString:@"jar"]) continue;
+        jessi_sha_update_string(&ctx, name);
+        jessi_sha_update_string(&ctx, jessi_file_stamp([modsDir stringByAppendingPathComponent:name]));
+    }
+
+    for (NSString *arg in userArgs) {
+        jessi_sha_update_string(&ctx, arg);
+        if ([arg hasPrefix:@"@"] && arg.length > 1) {
+            NSString *argFile = [arg substringFromIndex:1];
+            if (!argFile.isAbsolutePath) argFile = [serverDir stringByAppendingPathComponent:argFile];
+            NSData *contents = [NSData dataWithContentsOfFile:argFile];
+            if (contents.length) CC_SHA256_Update(&ctx, contents.bytes, (CC_LONG)contents.length);
+        }
+    }
+
+    jessi_sha_update_string(&ctx, [NSString stringWithFormat:@"java%d", javaMajor]);
+    jessi_sha_update_string(&ctx, javaHome);
+    NSData *release = [NSData dataWithContentsOfFile:[javaHome stringByAppendingPathComponent:@"release"]];
+    if (release.length) CC_SHA256_Update(&ctx, release.bytes, (CC_LONG)release.length);
+    jessi_sha_update_string(&ctx, jessi_file_stamp([javaHome stringByAppendingPathComponent:@"lib/server/libjvm.dylib"]));
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &ctx);
+    return [jessi_hex_digest(digest, sizeof(digest)) substringToIndex:16];
+}
+
++ (instancetype)archiveForServerDir:(NSString *)serverDir
+                           javaHome:(NSString *)javaHome
+                          javaMajor:(int)javaMajor
+                            jarPath:(NSString *)jarPath
+                           userArgs:(NSArray<NSString *> *)userArgs {
+    JessiSettingsSnapshot *settings = [JessiSettings current];
+    if (!settings.appCDSEnabled || javaMajor < 17 || serverDir.length == 0) return nil;
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+    // A dynamic archive sits on top of the runtime's default CDS archive.
+    NSString *baseArchive = [javaHome stringByAppendingPathComponent:@"lib/server/classes.jsa"];
+    if (![fm fileExistsAtPath:baseArchive]) return nil;
+    for (NSString *arg in userArgs) {
+        if ([arg hasPrefix:@"-Xshare:off"] || [arg hasPrefix:@"-XX:SharedArchiveFile"] || [arg hasPrefix:@"-XX:ArchiveClassesAtExit"]) return nil;
+    }
+
+    NSMutableDictionary *meta = jessi_read_metadata(serverDir);
+    NSString *key = [self keyForServerDir:serverDir javaHome:javaHome javaMajor:javaMajor jarPath:jarPath userArgs:userArgs metadata:meta];
+    NSString *archivePath = [serverDir stringByAppendingPathComponent:JessiCDSArchiveName];
+    long long capBytes = (long long)settings.appCDSMaxMB * 1024 * 1024;
+
+    JessiCDSArchive *archive = [JessiCDSArchive new];
+    archive.archivePath = archivePath;
+
+    NSString *state = meta[@"state"];
+    BOOL sameKey = [meta[@"key"] isEqual:key];
+    if (sameKey && [state isEqual:@"dumping"] && jessi_archive_is_complete(archivePath)) {
+        long long size = (long long)[fm attributesOfItemAtPath:archivePath error:nil].fileSize;
+        if (size > capBytes) {
+            [fm removeItemAtPath:archivePath error:nil];
+            state = @"oversize";
+        } else {
+            state = @"ready";
+            meta[@"size_bytes"] = @(size);
+            meta[@"created"] = @([[NSDate date] timeIntervalSince1970]);
+        }
+        meta[@"state"] = state;
+    }
+
+    if (sameKey && [state isEqual:@"oversize"]) {
+        jessi_write_metadata(serverDir, meta);
+        return nil;
+    }
+
+    if (sameKey && [state isEqual:@"ready"] && jessi_archive_is_complete(archivePath)) {
+        archive.dumping = NO;
+        archive.summary = [NSString stringWithFormat:@"using class archive %@ (%.1f MB)", key,
+                           [meta[@"size_bytes"] doubleValue] / (1024.0 * 1024.0)];
+    } else {
+        BOOL changed = !sameKey && meta[@"key"] != nil;
+        [fm removeItemAtPath:archivePath error:nil];
+        [meta removeObjectsForKeys:@[@"baseline_ms", @"size_bytes", @"created", @"last_ms"]];
+        meta[@"key"] = key;
+        meta[@"state"] = @"dumping";
+        archive.dumping = YES;
+        archive.summary = [NSString stringWithFormat:@"%@class archive %@ at exit",
+                           changed ? @"jar, mods, arguments or runtime changed; recreating " : @"creating ", key];
+    }
+    meta[@"java_major"] = @(javaMajor);
+    meta[@"run"] = archive.dumping ? @"dump" : @"use";
+    jessi_write_metadata(serverDir, meta);
+    return archive;
+}
+
++ (NSString *)recordStartupMs:(double)jvmToDoneMs inServerDir:(NSString *)serverDir {
+    if (serverDir.length == 0 || jvmToDoneMs <= 0) return nil;
+    NSString *path = [serverDir stringByAppendingPathComponent:JessiCDSMetadataName];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:path]) return nil;
+
+    NSMutableDictionary *meta = jessi_read_metadata(serverDir);
+    NSString *run = meta[@"run"];
+    if (![run isKindOfClass:[NSString class]]) return nil;
+    [meta removeObjectForKey:@"run"];
+
+    NSString *line = nil;
+    if ([run isEqualToString:@"dump"]) {
+        meta[@"baseline_ms"] = @(jvmToDoneMs);
+        line = @"[JESSI] AppCDS: class archive will be written when the server stops cleanly.\n";
+    } else {
+        meta[@"last_ms"] = @(jvmToDoneMs);
+        double baseline = [meta[@"baseline_ms"] doubleValue];
+        if (baseline > 0) {
+            line = [NSString stringWithFormat:@"[JESSI] AppCDS: JVM reached Done in %.1f s, %.1f s faster than without the archive (%.1f s).\n",
+                    jvmToDoneMs / 1000.0, (baseline - jvmToDoneMs) / 1000.0, baseline / 1000.0];
+        } else {
+            line = [NSString stringWithFormat:@"[JESSI] AppCDS: JVM reached Done in %.1f s using the class archive.\n", jvmToDoneMs / 1000.0];
+        }
+    }
+    jessi_write_metadata(serverDir, meta);
+    return line;
+}
+
+@end
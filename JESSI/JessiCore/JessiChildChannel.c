@@ -0,0 +1,546 @@
+#include "JessiChildChannel.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define JESSI_CHILD_READ_BUF (64 * 1024)
+#define JESSI_CHILD_STATUS_LINE_MAX 1024
+// After the child is reaped, output still in the pipes gets this long; a grandchild (the external
+// java) that inherited them would otherwise hold them open indefinitely.
+#ifndef JESSI_CHILD_DRAIN_MS
+#define JESSI_CHILD_DRAIN_MS 2000
+#endif
+// Five missed heartbeats at the runner's 2 s interval.
+#ifndef JESSI_CHILD_STALL_MS
+#define JESSI_CHILD_STALL_MS 10000
+#endif
+
+enum {
+    JESSI_CHILD_WAKE_NONE = 0,
+    JESSI_CHILD_WAKE_DRAIN = 1,
+    JESSI_CHILD_WAKE_STOP = 2,
+};
+
+typedef struct jessi_child_log_chunk {
+    struct jessi_child_log_chunk *next;
+    size_t len;
+    uint8_t bytes[];
+} jessi_child_log_chunk;
+
+struct jessi_child_channel {
+    pid_t pid;
+    int out_fd;
+    int err_fd;
+    int status_fd;
+    int wake_pipe[2];
+
+    jessi_child_callbacks callbacks;
+    void *ctx;
+
+    pthread_t reader;
+    int reader_started;
+    int reader_joined;
+    int wake_mode;
+    int hb_stalled;
+
+    // Disk copy: the reader queues chunks, the writer appends them.
+    int log_fd;
+    pthread_t writer;
+    int writer_started;
+    pthread_mutex_t log_lock;
+    pthread_cond_t log_cond;
+    jessi_child_log_chunk *log_head;
+    jessi_child_log_chunk *log_tail;
+    int log_closing;
+
+    char status_line[JESSI_CHILD_STATUS_LINE_MAX];
+    size_t status_len;
+
+    int waited;
+    int wait_status;
+
+    jessi_child_stats stats;
+};
+
+static uint64_t jessi_child_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void jessi_child_count(uint64_t *counter, uint64_t n) {
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static void jessi_child_close(int *fd) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+}
+
+static int jessi_child_set_cloexec(int fd) {
+    int flags = fcntl(fd, F_GETFD);
+    return (flags >= 0 && fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == 0) ? 0 : -1;
+}
+
+// Child ends must not sit on 0-3, or the dup2 onto 1/2/3 could be a no-op that keeps CLOEXEC.
+static int jessi_child_lift_fd(int fd) {
+    if (fd > JESSI_CHILD_STATUS_FD) return fd;
+    int lifted = fcntl(fd, F_DUPFD, JESSI_CHILD_STATUS_FD + 1);
+    close(fd);
+    if (lifted >= 0) jessi_child_set_cloexec(lifted);
+    return lifted;
+}
+
+static void *jessi_child_writer_thread(void *arg) {
+    jessi_child_channel *ch = arg;
+    for (;;) {
+        pthread_mutex_lock(&ch->log_lock);
+        while (!ch->log_head && !ch->log_closing) pthread_cond_wait(&ch->log_cond, &ch->log_lock);
+        jessi_child_log_chunk *batch = ch->log_head;
+        ch->log_head = ch->log_tail = NULL;
+        int closing = ch->log_closing;
+        pthread_mutex_unlock(&ch->log_lock);
+
+        while (batch) {
+            jessi_child_log_chunk *next = batch->next;
+            size_t off = 0;
+            while (off < batch->len) {
+                ssize_t n = write(ch->log_fd, batch->bytes + off, batch->len - off);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                off += (size_t)n;
+            }
+            jessi_child_count(&ch->stats.logged_bytes, off);
+            free(batch);
+            batch = next;
+        }
+        if (closing) {
+            pthread_mutex_lock(&ch->log_lock);
+            int drained = ch->log_head == NULL;
+            pthread_mutex_unlock(&ch->log_lock);
+            if (drained) break;
+        }
+    }
+    return NULL;
+}
+
+static void jessi_child_log_append(jessi_child_channel *ch, const uint8_t *bytes, size_t len) {
+    if (!ch->writer_started || len == 0) return;
+    jessi_child_log_chunk *chunk = malloc(sizeof(*chunk) + len);
+    if (!chunk) return;
+    chunk->next = NULL;
+    chunk->len = len;
+    memcpy(chunk->bytes, bytes, len);
+    pthread_mutex_lock(&ch->log_lock);
+    if (ch->log_tail) ch->log_tail->next = chunk;
+    else ch->log_head = chunk;
+    ch->log_tail = chunk;
+    pthread_cond_signal(&ch->log_cond);
+    pthread_mutex_unlock(&ch->log_lock);
+}
+
+static void jessi_child_status_dispatch(jessi_child_channel *ch, char *line) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+    if (len == 0) return;
+
+    char *space = strchr(line, ' ');
+    jessi_child_status msg = { line, "" };
+    if (space) {
+        *space = '\0';
+        msg.value = space + 1;
+    }
+    jessi_child_count(&ch->stats.status_messages, 1);
+    if (strcmp(msg.key, "hb") == 0) {
+        jessi_child_count(&ch->stats.heartbeats, 1);
+        __atomic_store_n(&ch->stats.last_heartbeat_ns, jessi_child_now_ns(), __ATOMIC_RELAXED);
+        ch->hb_stalled = 0;
+    }
+    if (ch->callbacks.status) ch->callbacks.status(ch->ctx, &msg);
+}
+
+static void jessi_child_status_feed(jessi_child_channel *ch, const uint8_t *bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (bytes[i] == '\n') {
+            ch->status_line[ch->status_len] = '\0';
+            jessi_child_status_dispatch(ch, ch->status_line);
+            ch->status_len = 0;
+        } else if (ch->status_len + 1 < sizeof(ch->status_line)) {
+            ch->status_line[ch->status_len++] = (char)bytes[i];
+        }
+    }
+}
+
+// Returns 0 at EOF or on a hard error, 1 otherwise.
+static int jessi_child_drain(jessi_child_channel *ch, int fd, int which, uint8_t *buf) {
+    for (;;) {
+        ssize_t n = read(fd, buf, JESSI_CHILD_READ_BUF);
+        if (n > 0) {
+            if (which == 2) {
+                jessi_child_status_feed(ch, buf, (size_t)n);
+            } else {
+                jessi_child_count(which == 0 ? &ch->stats.stdout_bytes : &ch->stats.stderr_bytes, (uint64_t)n);
+                if (ch->callbacks.output) {
+                    ch->callbacks.output(ch->ctx, which == 0 ? JESSI_CHILD_STDOUT : JESSI_CHILD_STDERR, buf, (size_t)n);
+                }
+                jessi_child_log_append(ch, buf, (size_t)n);
+            }
+            if ((size_t)n < JESSI_CHILD_READ_BUF) return 1;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+        return 0;
+    }
+}
+
+// Once heartbeats have started, a gap longer than JESSI_CHILD_STALL_MS is reported to the status
+// callback as "stall <ms>", once per gap; the next "hb" clears it. Returns the poll timeout until
+// the next check is due, or -1.
+static int jessi_child_check_heartbeat(jessi_child_channel *ch, uint64_t now) {
+    uint64_t last = __atomic_load_n(&ch->stats.last_heartbeat_ns, __ATOMIC_RELAXED);
+    if (last == 0 || ch->hb_stalled) return -1;
+    uint64_t due = last + (uint64_t)JESSI_CHILD_STALL_MS * 1000000ULL;
+    if (now < due) return (int)((due - now) / 1000000ULL) + 1;
+
+    ch->hb_stalled = 1;
+    char value[32];
+    snprintf(value, sizeof(value), "%llu", (unsigned long long)((now - last) / 1000000ULL));
+    jessi_child_status msg = { "stall", value };
+    if (ch->callbacks.status) ch->callbacks.status(ch->ctx, &msg);
+    return -1;
+}
+
+static void *jessi_child_reader_thread(void *arg) {
+    jessi_child_channel *ch = arg;
+    uint8_t *buf = malloc(JESSI_CHILD_READ_BUF);
+    if (!buf) return NULL;
+
+    struct pollfd fds[4];
+    fds[0].fd = ch->out_fd;
+    fds[1].fd = ch->err_fd;
+    fds[2].fd = ch->status_fd;
+    fds[3].fd = ch->wake_pipe[0];
+    for (int i = 0; i < 4; i++) fds[i].events = POLLIN;
+
+    // Output ends when both pipes hit EOF, or when the drain deadline set after waitpid passes;
+    // the status socket may outlive them briefly.
+    uint64_t drain_deadline = 0;
+    while (fds[0].fd >= 0 || fds[1].fd >= 0) {
+        uint64_t now = jessi_child_now_ns();
+        int timeout = jessi_child_check_heartbeat(ch, now);
+        if (drain_deadline) {
+            if (now >= drain_deadline) break;
+            int left = (int)((drain_deadline - now) / 1000000ULL) + 1;
+            if (timeout < 0 || left < timeout) timeout = left;
+        }
+        int rc = poll(fds, 4, timeout);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (rc == 0) continue;
+        jessi_child_count(&ch->stats.wakeups, 1);
+        if (fds[3].revents) {
+            char c;
+            (void)read(fds[3].fd, &c, 1);
+            int mode = __atomic_load_n(&ch->wake_mode, __ATOMIC_ACQUIRE);
+            if (mode == JESSI_CHILD_WAKE_STOP) break;
+            if (mode == JESSI_CHILD_WAKE_DRAIN && !drain_deadline) {
+                drain_deadline = jessi_child_now_ns() + (uint64_t)JESSI_CHILD_DRAIN_MS * 1000000ULL;
+            }
+        }
+        for (int i = 0; i < 3; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (!jessi_child_drain(ch, fds[i].fd, i, buf)) fds[i].fd = -1;
+        }
+    }
+    if (fds[2].fd >= 0) (void)jessi_child_drain(ch, fds[2].fd, 2, buf);
+    if (ch->status_len > 0) {
+        ch->status_line[ch->status_len] = '\0';
+        jessi_child_status_dispatch(ch, ch->status_line);
+        ch->status_len = 0;
+    }
+    free(buf);
+    return NULL;
+}
+
+static char **jessi_child_environment(char *const envp[]) {
+    size_t n = 0;
+    while (envp && envp[n]) n++;
+    char **env = calloc(n + 2, sizeof(char *));
+    if (!env) return NULL;
+    size_t out = 0;
+    size_t prefix = strlen(JESSI_CHILD_STATUS_FD_ENV "=");
+    for (size_t i = 0; i < n; i++) {
+        if (strncmp(envp[i], JESSI_CHILD_STATUS_FD_ENV "=", prefix) == 0) continue;
+        env[out++] = envp[i];
+    }
+    static char status_env[32];
+    snprintf(status_env, sizeof(status_env), "%s=%d", JESSI_CHILD_STATUS_FD_ENV, JESSI_CHILD_STATUS_FD);
+    env[out++] = status_env;
+    env[out] = NULL;
+    return env;
+}
+
+jessi_child_channel *jessi_child_channel_spawn(const char *path, char *const argv[], char *const envp[],
+                                               const char *log_path, const jessi_child_callbacks *callbacks,
+                                               void *ctx, int *spawn_error) {
+    if (spawn_error) *spawn_error = 0;
+    if (!path || !argv) {
+        if (spawn_error) *spawn_error = EINVAL;
+        return NULL;
+    }
+    jessi_child_channel *ch = calloc(1, sizeof(*ch));
+    if (!ch) {
+        if (spawn_error) *spawn_error = ENOMEM;
+        return NULL;
+    }
+    ch->out_fd = ch->err_fd = ch->status_fd = ch->log_fd = -1;
+    ch->wake_pipe[0] = ch->wake_pipe[1] = -1;
+    if (callbacks) ch->callbacks = *callbacks;
+    ch->ctx = ctx;
+    pthread_mutex_init(&ch->log_lock, NULL);
+    pthread_cond_init(&ch->log_cond, NULL);
+
+    int out_pipe[2] = { -1, -1 }, err_pipe[2] = { -1, -1 }, sock[2] = { -1, -1 };
+    int err = 0;
+    if (pipe(out_pipe) != 0 || pipe(err_pipe) != 0 || socketpair(AF_UNIX, SOCK_STREAM, 0, sock) != 0 ||
+        pipe(ch->wake_pipe) != 0) {
+        err = errno;
+        goto fail;
+    }
+    int all[] = { out_pipe[0], out_pipe[1], err_pipe[0], err_pipe[1], sock[0], sock[1], ch->wake_pipe[0], ch->wake_pipe[1] };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) jessi_child_set_cloexec(all[i]);
+    out_pipe[1] = jessi_child_lift_fd(out_pipe[1]);
+    err_pipe[1] = jessi_child_lift_fd(err_pipe[1]);
+    sock[1] = jessi_child_lift_fd(sock[1]);
+    if (out_pipe[1] < 0 || err_pipe[1] < 0 || sock[1] < 0) {
+        err = EMFILE;
+        goto fail;
+    }
+    // The reader drains until EAGAIN, so no read end may block.
+    fcntl(out_pipe[0], F_SETFL, fcntl(out_pipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl(err_pipe[0], F_SETFL, fcntl(err_pipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl(sock[0], F_SETFL, fcntl(sock[0], F_GETFL) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(sock[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, sock[1], JESSI_CHILD_STATUS_FD);
+
+    char **env = jessi_child_environment(envp);
+    if (!env) {
+        posix_spawn_file_actions_destroy(&actions);
+        err = ENOMEM;
+        goto fail;
+    }
+    err = posix_spawn(&ch->pid, path, &actions, NULL, argv, env);
+    free(env);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) goto fail;
+
+    jessi_child_close(&out_pipe[1]);
+    jessi_child_close(&err_pipe[1]);
+    jessi_child_close(&sock[1]);
+    ch->out_fd = out_pipe[0];
+    ch->err_fd = err_pipe[0];
+    ch->status_fd = sock[0];
+
+    if (log_path) {
+        ch->log_fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (ch->log_fd >= 0 && pthread_create(&ch->writer, NULL, jessi_child_writer_thread, ch) == 0) {
+            ch->writer_started = 1;
+        }
+    }
+    if (pthread_create(&ch->reader, NULL, jessi_child_reader_thread, ch) == 0) ch->reader_started = 1;
+    return ch;
+
+fail:
+    jessi_child_close(&out_pipe[0]);
+    jessi_child_close(&out_pipe[1]);
+    jessi_child_close(&err_pipe[0]);
+    jessi_child_close(&err_pipe[1]);
+    jessi_child_close(&sock[0]);
+    jessi_child_close(&sock[1]);
+    jessi_child_close(&ch->wake_pipe[0]);
+    jessi_child_close(&ch->wake_pipe[1]);
+    pthread_mutex_destroy(&ch->log_lock);
+    pthread_cond_destroy(&ch->log_cond);
+    free(ch);
+    if (spawn_error) *spawn_error = err ? err : EIO;
+    return NULL;
+}
+
+pid_t jessi_child_channel_pid(const jessi_child_channel *ch) {
+    return ch ? ch->pid : -1;
+}
+
+int jessi_child_channel_send(jessi_child_channel *ch, const char *line) {
+    if (!ch || ch->status_fd < 0 || !line) return -1;
+    size_t len = strlen(line);
+    char buf[JESSI_CHILD_STATUS_LINE_MAX];
+    if (len + 2 > sizeof(buf)) return -1;
+    memcpy(buf, line, len);
+    buf[len++] = '\n';
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = send(ch->status_fd, buf + off, len - off, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        off += (size_t)n;
+    }
+    return 0;
+}
+
+static void jessi_child_join_reader(jessi_child_channel *ch, int mode) {
+    if (ch->reader_started && !ch->reader_joined) {
+        __atomic_store_n(&ch->wake_mode, mode, __ATOMIC_RELEASE);
+        char c = 1;
+        (void)write(ch->wake_pipe[1], &c, 1);
+        pthread_join(ch->reader, NULL);
+        ch->reader_joined = 1;
+    }
+}
+
+static void jessi_child_stop_writer(jessi_child_channel *ch) {
+    if (!ch->writer_started) return;
+    pthread_mutex_lock(&ch->log_lock);
+    ch->log_closing = 1;
+    pthread_cond_signal(&ch->log_cond);
+    pthread_mutex_unlock(&ch->log_lock);
+    pthread_join(ch->writer, NULL);
+    ch->writer_started = 0;
+}
+
+int jessi_child_channel_wait(jessi_child_channel *ch, int *wait_status) {
+    if (!ch) return -1;
+    if (!ch->waited) {
+        pid_t r;
+        do {
+            r = waitpid(ch->pid, &ch->wait_status, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) return -1;
+        ch->waited = 1;
+    }
+    jessi_child_join_reader(ch, JESSI_CHILD_WAKE_DRAIN);
+    jessi_child_stop_writer(ch);
+    if (wait_status) *wait_status = ch->wait_status;
+    return 0;
+}
+
+void jessi_child_channel_get_stats(const jessi_child_channel *ch, jessi_child_stats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!ch) return;
+    out->stdout_bytes = __atomic_load_n(&ch->stats.stdout_bytes, __ATOMIC_RELAXED);
+    out->stderr_bytes = __atomic_load_n(&ch->stats.stderr_bytes, __ATOMIC_RELAXED);
+    out->logged_bytes = __atomic_load_n(&ch->stats.logged_bytes, __ATOMIC_RELAXED);
+    out->status_messages = __atomic_load_n(&ch->stats.status_messages, __ATOMIC_RELAXED);
+    out->heartbeats = __atomic_load_n(&ch->stats.heartbeats, __ATOMIC_RELAXED);
+    out->last_heartbeat_ns = __atomic_load_n(&ch->stats.last_heartbeat_ns, __ATOMIC_RELAXED);
+    out->wakeups = __atomic_load_n(&ch->stats.wakeups, __ATOMIC_RELAXED);
+}
+
+void jessi_child_channel_destroy(jessi_child_channel *ch) {
+    if (!ch) return;
+    jessi_child_join_reader(ch, JESSI_CHILD_WAKE_STOP);
+    jessi_child_stop_writer(ch);
+    jessi_child_log_chunk *chunk = ch->log_head;
+    while (chunk) {
+        jessi_child_log_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    jessi_child_close(&ch->out_fd);
+    jessi_child_close(&ch->err_fd);
+    jessi_child_close(&ch->status_fd);
+    jessi_child_close(&ch->log_fd);
+    jessi_child_close(&ch->wake_pipe[0]);
+    jessi_child_close(&ch->wake_pipe[1]);
+    pthread_mutex_destroy(&ch->log_lock);
+    pthread_cond_destroy(&ch->log_cond);
+    free(ch);
+}
+
+static int jessi_child_status_fd_value = -2;
+static pthread_once_t jessi_child_status_once = PTHREAD_ONCE_INIT;
+
+static void jessi_child_status_init(void) {
+    jessi_child_status_fd_value = -1;
+    const char *v = getenv(JESSI_CHILD_STATUS_FD_ENV);
+    if (!v || !*v) return;
+    int fd = atoi(v);
+    if (fd < 0 || fcntl(fd, F_GETFD) < 0) return;
+    // Keep it out of processes this child spawns (the external java), so EOF means we exited.
+    jessi_child_set_cloexec(fd);
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    jessi_child_status_fd_value = fd;
+}
+
+int jessi_child_status_fd(void) {
+    pthread_once(&jessi_child_status_once, jessi_child_status_init);
+    return jessi_child_status_fd_value;
+}
+
+void jessi_child_status_send(const char *key, const char *fmt, ...) {
+    int fd = jessi_child_status_fd();
+    if (fd < 0 || !key) return;
+    char line[JESSI_CHILD_STATUS_LINE_MAX];
+    int n = snprintf(line, sizeof(line), "%s", key);
+    if (fmt && n >= 0 && (size_t)n + 1 < sizeof(line)) {
+        line[n++] = ' ';
+        va_list ap;
+        va_start(ap, fmt);
+        int m = vsnprintf(line + n, sizeof(line) - (size_t)n, fmt, ap);
+        va_end(ap);
+        if (m > 0) n += m;
+    }
+    if (n < 0) return;
+    if ((size_t)n >= sizeof(line) - 1) n = (int)sizeof(line) - 2;
+    line[n++] = '\n';
+    // One send per line keeps concurrent senders (heartbeat vs. launch thread) from interleaving.
+    (void)send(fd, line, (size_t)n, MSG_NOSIGNAL);
+}
+
+static void *jessi_child_heartbeat_thread(void *arg) {
+    unsigned interval_ms = (unsigned)(uintptr_t)arg;
+    struct timespec ts = { (time_t)(interval_ms / 1000), (long)(interval_ms % 1000) * 1000000L };
+    for (uint64_t seq = 1;; seq++) {
+        jessi_child_status_send("hb", "%llu", (unsigned long long)seq);
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+int jessi_child_status_start_heartbeat(unsigned interval_ms) {
+    if (jessi_child_status_fd() < 0 || interval_ms == 0) return -1;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, jessi_child_heartbeat_thread, (void *)(uintptr_t)interval_ms) != 0) return -1;
+    pthread_detach(thread);
+    return 0;
+}
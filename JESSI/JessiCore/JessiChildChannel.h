@@ -0,0 +1,76 @@
+#ifndef JessiChildChannel_h
+#define JessiChildChannel_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Spawns a child with stdout/stderr on pipes and a socketpair for line-based status messages
+// ("phase <name>", "pid <n>", "exit <reason>", "hb <seq>"). One thread polls all three and hands
+// output to the caller as it arrives; a second thread appends it to a log file, so disk writes
+// never delay the console.
+
+#define JESSI_CHILD_STATUS_FD_ENV "JESSI_STATUS_FD"
+#define JESSI_CHILD_STATUS_FD 3
+
+typedef enum {
+    JESSI_CHILD_STDOUT = 0,
+    JESSI_CHILD_STDERR = 1,
+} jessi_child_stream;
+
+typedef struct {
+    const char *key;    // "phase", "pid", "exit", "hb" or anything the child sends; "stall <ms>"
+                        // comes from the reader when heartbeats stop for 10 s
+    const char *value;  // rest of the line, "" when absent
+} jessi_child_status;
+
+// Both run on the reader thread; pointers are only valid for the call.
+typedef struct {
+    void (*output)(void *ctx, jessi_child_stream stream, const uint8_t *bytes, size_t len);
+    void (*status)(void *ctx, const jessi_child_status *msg);
+} jessi_child_callbacks;
+
+typedef struct {
+    uint64_t stdout_bytes;
+    uint64_t stderr_bytes;
+    uint64_t logged_bytes;
+    uint64_t status_messages;
+    uint64_t heartbeats;
+    uint64_t last_heartbeat_ns;  // CLOCK_MONOTONIC, 0 before the first one
+    uint64_t wakeups;
+} jessi_child_stats;
+
+typedef struct jessi_child_channel jessi_child_channel;
+
+// envp gets JESSI_STATUS_FD added; the child sees the status socket on that fd.
+// log_path may be NULL. On failure returns NULL and sets *spawn_error to an errno value.
+jessi_child_channel *jessi_child_channel_spawn(const char *path, char *const argv[], char *const envp[],
+                                               const char *log_path, const jessi_child_callbacks *callbacks,
+                                               void *ctx, int *spawn_error);
+pid_t jessi_child_channel_pid(const jessi_child_channel *ch);
+
+// Sends one control line to the child. Returns 0 on success.
+int jessi_child_channel_send(jessi_child_channel *ch, const char *line);
+
+// Waits for the child to exit, then drains its output for up to 2 s (a grandchild may still hold
+// the pipes); the log is flushed on return. Returns 0 and the waitpid status, or -1.
+int jessi_child_channel_wait(jessi_child_channel *ch, int *wait_status);
+
+void jessi_child_channel_get_stats(const jessi_child_channel *ch, jessi_child_stats *out);
+void jessi_child_channel_destroy(jessi_child_channel *ch);
+
+// Child side. -1 when the process wasn't started through a channel.
+int jessi_child_status_fd(void);
+void jessi_child_status_send(const char *key, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+// Sends "hb <seq>" every interval from a detached thread. Returns 0 when started.
+int jessi_child_status_start_heartbeat(unsigned interval_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface JessiConsoleDelta : NSObject
+@property (nonatomic, readonly, copy) NSString *appendedText;
+// Absolute line numbers touched by appendedText (the first one may continue an unterminated line).
+@property (nonatomic, readonly) NSRange appendedLines;
+// UTF-16 length and line count evicted from the front of the buffer by this append. Never more
+// than earlier deltas delivered; if the append itself overflowed the cap, appendedText is its tail.
+@property (nonatomic, readonly) NSUInteger trimmedLength;
+@property (nonatomic, readonly) NSUInteger trimmedLines;
+// When set, the whole console was replaced by appendedText.
+@property (nonatomic, readonly, getter=isReset) BOOL reset;
+@end
+
+// Main-thread console store: a ring of line-aligned chunks capped by UTF-8 bytes and lines.
+// Eviction drops whole chunks from the front, so appends stay O(appended text). A line longer
+// than a chunk is cut into several and counted as that many lines.
+@interface JessiConsoleBuffer : NSObject
+
+@property (nonatomic, readonly) NSUInteger maxBytes;
+@property (nonatomic, readonly) NSUInteger maxLines;
+
+@property (nonatomic, readonly) NSUInteger length;
+@property (nonatomic, readonly) NSUInteger byteCount;
+@property (nonatomic, readonly) NSUInteger lineCount;
+@property (nonatomic, readonly) NSUInteger firstLineNumber;
+
+- (instancetype)initWithMaxBytes:(NSUInteger)maxBytes maxLines:(NSUInteger)maxLines NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (nullable JessiConsoleDelta *)appendText:(NSString *)text;
+- (JessiConsoleDelta *)resetWithText:(NSString *)text;
+
+- (NSString *)snapshot;
+- (NSString *)textForLines:(NSRange)lineNumbers;
+
+@end
+
+NS_ASSUME_NONNULL_END
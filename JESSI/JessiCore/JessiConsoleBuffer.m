@@ -0,0 +1,241 @@
+#import "JessiConsoleBuffer.h"
+
+@interface JessiConsoleDelta ()
+@property (nonatomic, readwrite, copy) NSString *appendedText;
+@property (nonatomic, readwrite) NSRange appendedLines;
+@property (nonatomic, readwrite) NSUInteger trimmedLength;
+@property (nonatomic, readwrite) NSUInteger trimmedLines;
+@property (nonatomic, readwrite, getter=isReset) BOOL reset;
+@end
+
+@implementation JessiConsoleDelta
+@end
+
+static NSUInteger jessi_console_utf8_length(NSString *text, NSRange range) {
+    CFIndex used = 0;
+    CFStringGetBytes((__bridge CFStringRef)text, CFRangeMake((CFIndex)range.location, (CFIndex)range.length),
+                     kCFStringEncodingUTF8, 0, false, NULL, 0, &used);
+    return (NSUInteger)used;
+}
+
+@interface JessiConsoleChunk : NSObject
+@property (nonatomic, strong) NSMutableString *text;
+@property (nonatomic) NSUInteger byteCount;
+// UTF-16 offsets into `text` where each line starts.
+@property (nonatomic, strong) NSMutableData *lineStarts;
+@property (nonatomic, readonly) NSUInteger lineCount;
+@end
+
+@implementation JessiConsoleChunk
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _text = [NSMutableString string];
+        _lineStarts = [NSMutableData data];
+    }
+    return self;
+}
+
+- (NSUInteger)lineCount {
+    return self.lineStarts.length / sizeof(NSUInteger);
+}
+
+- (void)addLineStart:(NSUInteger)offset {
+    [self.lineStarts appendBytes:&offset length:sizeof(offset)];
+}
+
+- (NSUInteger)lineStartAtIndex:(NSUInteger)idx {
+    return ((const NSUInteger *)self.lineStarts.bytes)[idx];
+}
+
+@end
+
+@interface JessiConsoleBuffer ()
+@property (nonatomic, strong) NSMutableArray<JessiConsoleChunk *> *chunks;
+@property (nonatomic, readwrite) NSUInteger length;
+@property (nonatomic, readwrite) NSUInteger byteCount;
+@property (nonatomic, readwrite) NSUInteger lineCount;
+@property (nonatomic, readwrite) NSUInteger firstLineNumber;
+@property (nonatomic) NSUInteger chunkByteLimit;
+@property (nonatomic) NSUInteger chunkLineLimit;
+// The last stored line has no trailing newline yet.
+@property (nonatomic) BOOL lineOpen;
+// UTF-8 bytes of the open line held by the tail chunk.
+@property (nonatomic) NSUInteger openLineBytes;
+@end
+
+@implementation JessiConsoleBuffer
+
+- (instancetype)initWithMaxBytes:(NSUInteger)maxBytes maxLines:(NSUInteger)maxLines {
+    self = [super init];
+    if (self) {
+        _maxBytes = MAX(maxBytes, (NSUInteger)4096);
+        _maxLines = MAX(maxLines, (NSUInteger)64);
+        // Eviction is chunk-granular, so keep chunks at ~1/8 of the cap to bound the overshoot.
+        _chunkByteLimit = MAX(_maxBytes / 8, (NSUInteger)1024);
+        _chunkLineLimit = MAX(_maxLines / 8, (NSUInteger)8);
+        _chunks = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (JessiConsoleChunk *)tailChunk {
+    JessiConsoleChunk *chunk = self.chunks.lastObject;
+    if (!chunk) {
+        chunk = [JessiConsoleChunk new];
+        [self.chunks addObject:chunk];
+    }
+    return chunk;
+}
+
+- (void)startLineInChunk:(JessiConsoleChunk *)chunk {
+    [chunk addLineStart:chunk.text.length];
+    self.lineCount++;
+    self.lineOpen = YES;
+    self.openLineBytes = 0;
+}
+
+// Appends part of a single line. A line that outgrows a chunk on its own (a spinner or a flood
+// with no newlines) is cut there and carries on in a new chunk, counted as a further line, so
+// every chunk stays evictable and within about twice chunkByteLimit.
+- (void)appendLineRange:(NSRange)range ofText:(NSString *)text touched:(NSUInteger *)touched {
+    while (range.length > 0) {
+        JessiConsoleChunk *chunk = [self tailChunk];
+        NSUInteger room = self.openLineBytes < self.chunkByteLimit ? self.chunkByteLimit - self.openLineBytes : 0;
+        NSUInteger take = MIN(range.length, room);
+        NSUInteger bytes = jessi_console_utf8_length(text, NSMakeRange(range.location, take));
+        if (bytes > room || take < range.length) {
+            // At most 3 UTF-8 bytes per UTF-16 unit; never cut inside a composed character.
+            if (bytes > room) take = room / 3;
+            if (take > 0) take = [text rangeOfComposedCharacterSequenceAtIndex:range.location + take].location - range.location;
+            bytes = jessi_console_utf8_length(text, NSMakeRange(range.location, take));
+        }
+        if (take > 0) {
+            [chunk.text appendString:[text substringWithRange:NSMakeRange(range.location, take)]];
+            chunk.byteCount += bytes;
+            self.byteCount += bytes;
+            self.length += take;
+            self.openLineBytes += bytes;
+            range = NSMakeRange(range.location + take, range.length - take);
+        }
+        if (range.length == 0) break;
+
+        chunk = [JessiConsoleChunk new];
+        [self.chunks addObject:chunk];
+        [self startLineInChunk:chunk];
+        (*touched)++;
+    }
+}
+
+- (nullable JessiConsoleDelta *)appendText:(NSString *)text {
+    NSUInteger len = text.length;
+    if (len == 0) return nil;
+
+    NSUInteger publishedLength = self.length;
+    NSUInteger publishedLines = self.lineCount;
+    NSUInteger firstTouched = self.firstLineNumber + self.lineCount - (self.lineOpen ? 1 : 0);
+    NSUInteger touched = self.lineOpen ? 1 : 0;
+    NSUInteger pos = 0;
+
+    while (pos < len) {
+        if (!self.lineOpen) {
+            // Chunks only end on line boundaries so dropping one never leaves half a line behind.
+            JessiConsoleChunk *chunk = [self tailChunk];
+            if (chunk.byteCount >= self.chunkByteLimit || chunk.lineCount >= self.chunkLineLimit) {
+                chunk = [JessiConsoleChunk new];
+                [self.chunks addObject:chunk];
+            }
+            [self startLineInChunk:chunk];
+            if (pos > 0 || touched == 0) touched++;
+        }
+        NSRange nl = [text rangeOfString:@"\n" options:NSLiteralSearch range:NSMakeRange(pos, len - pos)];
+        NSUInteger end = nl.location == NSNotFound ? len : NSMaxRange(nl);
+        [self appendLineRange:NSMakeRange(pos, end - pos) ofText:text touched:&touched];
+        if (nl.location != NSNotFound) self.lineOpen = NO;
+        pos = end;
+    }
+
+    JessiConsoleDelta *delta = [JessiConsoleDelta new];
+    delta.appendedText = text;
+    delta.appendedLines = NSMakeRange(firstTouched, touched);
+    [self trimIntoDelta:delta publishedLength:publishedLength lines:publishedLines];
+    return delta;
+}
+
+// Consumers delete trimmedLength from what they already hold before appending, so a trim never
+// reaches past the published text: whatever this append itself lost is cut from appendedText.
+- (void)trimIntoDelta:(JessiConsoleDelta *)delta publishedLength:(NSUInteger)publishedLength lines:(NSUInteger)publishedLines {
+    NSUInteger trimmedLength = 0;
+    NSUInteger trimmedLines = 0;
+    while (self.chunks.count > 1 && (self.byteCount > self.maxBytes || self.lineCount > self.maxLines)) {
+        JessiConsoleChunk *head = self.chunks.firstObject;
+        NSUInteger lines = head.lineCount;
+        trimmedLength += head.text.length;
+        trimmedLines += lines;
+        self.length -= head.text.length;
+        self.byteCount -= head.byteCount;
+        self.lineCount -= lines;
+        self.firstLineNumber += lines;
+        [self.chunks removeObjectAtIndex:0];
+    }
+
+    if (trimmedLength > publishedLength) {
+        delta.appendedText = [delta.appendedText substringFromIndex:trimmedLength - publishedLength];
+        trimmedLength = publishedLength;
+        trimmedLines = MIN(trimmedLines, publishedLines);
+        NSRange lines = delta.appendedLines;
+        NSUInteger first = MAX(lines.location, self.firstLineNumber);
+        delta.appendedLines = NSMakeRange(first, MAX(NSMaxRange(lines), first) - first);
+    }
+    delta.trimmedLength = trimmedLength;
+    delta.trimmedLines = trimmedLines;
+}
+
+- (JessiConsoleDelta *)resetWithText:(NSString *)text {
+    [self.chunks removeAllObjects];
+    self.firstLineNumber += self.lineCount;
+    self.length = 0;
+    self.byteCount = 0;
+    self.lineCount = 0;
+    self.lineOpen = NO;
+
+    JessiConsoleDelta *delta = [self appendText:text ?: @""] ?: [JessiConsoleDelta new];
+    delta.appendedText = [self snapshot];
+    delta.trimmedLength = 0;
+    delta.trimmedLines = 0;
+    delta.reset = YES;
+    return delta;
+}
+
+- (NSString *)snapshot {
+    NSMutableString *out = [NSMutableString stringWithCapacity:self.length];
+    for (JessiConsoleChunk *chunk in self.chunks) {
+        [out appendString:chunk.text];
+    }
+    return out;
+}
+
+- (NSString *)textForLines:(NSRange)lineNumbers {
+    NSMutableString *out = [NSMutableString string];
+    if (lineNumbers.length == 0) return out;
+
+    NSUInteger first = MAX(lineNumbers.location, self.firstLineNumber);
+    NSUInteger end = MIN(NSMaxRange(lineNumbers), self.firstLineNumber + self.lineCount);
+    NSUInteger chunkFirst = self.firstLineNumber;
+    for (JessiConsoleChunk *chunk in self.chunks) {
+        if (first >= end) break;
+        NSUInteger count = chunk.lineCount;
+        NSUInteger chunkEnd = chunkFirst + count;
+        if (first < chunkEnd) {
+            NSUInteger from = [chunk lineStartAtIndex:first - chunkFirst];
+            NSUInteger to = end < chunkEnd ? [chunk lineStartAtIndex:end - chunkFirst] : chunk.text.length;
+            [out appendString:[chunk.text substringWithRange:NSMakeRange(from, to - from)]];
+            first = MIN(end, chunkEnd);
+        }
+        chunkFirst = chunkEnd;
+    }
+    return out;
+}
+
+@end
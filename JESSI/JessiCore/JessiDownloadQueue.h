@@ -0,0 +1,39 @@
+#import <Foundation/Foundation.h>
+#import "JessiDownloader.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// received and total are summed over every file; total counts the expected sizes given to
+// addRequest and grows as servers report the rest.
+typedef void (^JessiDownloadQueueProgressBlock)(int64_t received, int64_t total, NSUInteger filesDone, NSUInteger filesTotal);
+typedef void (^JessiDownloadQueueCompletion)(NSError * _Nullable error);
+
+// Runs many file downloads at once (modpacks), each a JessiDownloader writing straight to disk over
+// one shared session. Concurrency is capped overall and per host of the first mirror, and the
+// session holds connections to the same per-host cap; a failed file is requeued with backoff
+// before it counts as failed. Callbacks run on a private serial queue.
+@interface JessiDownloadQueue : NSObject
+
+// Default YES: the first file that still fails after its retries cancels the rest.
+@property (nonatomic) BOOL stopOnFirstError;
+// Filled in as files give up; read it from the completion.
+@property (nonatomic, readonly) NSArray<JessiDownloadRequest *> *failedRequests;
+
+- (instancetype)initWithMaxConcurrent:(NSUInteger)maxConcurrent perHost:(NSUInteger)perHost NS_DESIGNATED_INITIALIZER;
+- (instancetype)init;
+
+// expectedSize is 0 when unknown. Add everything before run.
+- (void)addRequest:(JessiDownloadRequest *)request expectedSize:(int64_t)expectedSize
+    NS_SWIFT_NAME(add(_:expectedSize:));
+
+// Completes once every file is done or given up on. The error is the first failure, or
+// JessiDownloadErrorCancelled after cancel.
+- (void)runWithProgress:(nullable JessiDownloadQueueProgressBlock)progress
+             completion:(JessiDownloadQueueCompletion)completion
+    NS_SWIFT_NAME(run(progress:completion:));
+
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,224 @@
+#import "JessiDownloadQueue.h"
+
+static const NSUInteger JessiDownloadQueueDefaultConcurrent = 8;
+static const NSUInteger JessiDownloadQueueDefaultPerHost = 6;
+// Whole-file retries on top of the downloader's own per-range failover.
+static const NSUInteger JessiDownloadQueueRetries = 2;
+static const NSTimeInterval JessiDownloadQueueProgressInterval = 0.1;
+
+@interface JessiDownloadJob : NSObject
+@property (nonatomic, strong) JessiDownloadRequest *request;
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic) int64_t expected;
+@property (nonatomic) int64_t received;
+@property (nonatomic) int64_t total;
+@property (nonatomic) NSUInteger attempts;
+@property (nonatomic, strong, nullable) JessiDownloader *downloader;
+@end
+
+@implementation JessiDownloadJob
+@end
+
+@implementation JessiDownloadQueue {
+    dispatch_queue_t _queue;
+    NSUInteger _maxConcurrent;
+    NSUInteger _perHost;
+    // Shared by every file so the per-host cap holds for connections, not just files.
+    JessiDownloadSession *_session;
+    NSMutableArray<JessiDownloadJob *> *_jobs;
+    NSMutableArray<JessiDownloadJob *> *_pending;
+    NSMutableSet<JessiDownloadJob *> *_active;
+    NSCountedSet<NSString *> *_hostActive;
+    NSMutableArray<JessiDownloadRequest *> *_failed;
+    NSUInteger _backingOff;
+    NSUInteger _settled;
+    NSError *_firstError;
+    BOOL _running;
+    BOOL _finished;
+    CFAbsoluteTime _lastProgress;
+    JessiDownloadQueueProgressBlock _progress;
+    JessiDownloadQueueCompletion _completion;
+}
+
+- (instancetype)init {
+    return [self initWithMaxConcurrent:JessiDownloadQueueDefaultConcurrent perHost:JessiDownloadQueueDefaultPerHost];
+}
+
+- (instancetype)initWithMaxConcurrent:(NSUInteger)maxConcurrent perHost:(NSUInteger)perHost {
+    if ((self = [super init])) {
+        _queue = dispatch_queue_create("com.baconmania.jessi.downloadqueue", DISPATCH_QUEUE_SERIAL);
+        _maxConcurrent = MAX((NSUInteger)1, maxConcurrent);
+        _perHost = MAX((NSUInteger)1, MIN(perHost, _maxConcurrent));
+        _session = [[JessiDownloadSession alloc] initWithMaxConnectionsPerHost:_perHost];
+        _jobs = [NSMutableArray array];
+        _pending = [NSMutableArray array];
+        _active = [NSMutableSet set];
+        _hostActive = [NSCountedSet set];
+        _failed = [NSMutableArray array];
+        _stopOnFirstError = YES;
+    }
+    return self;
+}
+
+- (NSArray<JessiDownloadRequest *> *)failedRequests {
+    // Not through _queue: the completion runs there and reads this.
+    @synchronized (_failed) {
+        return [_failed copy];
+    }
+}
+
+- (void)addRequest:(JessiDownloadRequest *)request expectedSize:(int64_t)expectedSize {
+    JessiDownloadJob *job = [JessiDownloadJob new];
+    job.request = request;
+    job.host = request.mirrors.firstObject.host.lowercaseString ?: @"";
+    job.expected = MAX((int64_t)0, expectedSize);
+    dispatch_sync(_queue, ^{
+        if (self->_running) return;
+        [self->_jobs addObject:job];
+        [self->_pending addObject:job];
+    });
+}
+
+- (void)runWithProgress:(JessiDownloadQueueProgressBlock)progress completion:(JessiDownloadQueueCompletion)completion {
+    dispatch_async(_queue, ^{
+        if (self->_running) return;
+        self->_running = YES;
+        self->_progress = [progress copy];
+        self->_completion = [completion copy];
+        NSLog(@"[JESSI] Downloading %lu files (%lu at a time, %lu per host)",
+              (unsigned long)self->_jobs.count, (unsigned long)self->_maxConcurrent, (unsigned long)self->_perHost);
+        [self reportProgress:YES];
+        [self pump];
+    });
+}
+
+- (void)cancel {
+    dispatch_async(_queue, ^{
+        if (!self->_running) return;
+        [self finishWithError:[NSError errorWithDomain:JessiDownloadErrorDomain
+                                                  code:JessiDownloadErrorCancelled
+                                              userInfo:@{NSLocalizedDescriptionKey: @"Download cancelled"}]];
+    });
+}
+
+#pragma mark - Scheduling
+
+// Starts pending files in order, skipping over ones whose host is at its cap.
+- (void)pump {
+    if (_finished) return;
+    NSUInteger i = 0;
+    while (i < _pending.count && _active.count < _maxConcurrent) {
+        JessiDownloadJob *job = _pending[i];
+        if ([_hostActive countForObject:job.host] >= _perHost) {
+            i++;
+            continue;
+        }
+        [_pending removeObjectAtIndex:i];
+        [self startJob:job];
+    }
+    if (_active.count == 0 && _pending.count == 0 && _backingOff == 0) {
+        [self finishWithError:_firstError];
+    }
+}
+
+- (void)startJob:(JessiDownloadJob *)job {
+    [_active addObject:job];
+    [_hostActive addObject:job.host];
+    job.attempts++;
+
+    dispatch_queue_t queue = _queue;
+    job.downloader = [JessiDownloader downloadRequest:job.request session:_session progress:^(int64_t received, int64_t total) {
+        dispatch_async(queue, ^{
+            job.received = received;
+            if (total > 0) job.total = total;
+            [self reportProgress:NO];
+        });
+    } completion:^(NSError *error) {
+        dispatch_async(queue, ^{
+            [self job:job finishedWithError:error];
+        });
+    }];
+}
+
+- (void)job:(JessiDownloadJob *)job finishedWithError:(NSError *)error {
+    job.downloader = nil;
+    [_active removeObject:job];
+    [_hostActive removeObject:job.host];
+    if (_finished) return;
+
+    if (!error) {
+        // Files served from the artifact store never report progress; count them by size on disk.
+        NSDictionary *attrs = [[NSFileManager defaultManager] attributesOfItemAtPath:job.request.destinationPath error:nil];
+        int64_t size = attrs ? (int64_t)attrs.fileSize : MAX(job.total, job.expected);
+        job.total = size;
+        job.received = size;
+        _settled++;
+        [self reportProgress:YES];
+        [self pump];
+        return;
+    }
+
+    BOOL retryable = !([error.domain isEqualToString:JessiDownloadErrorDomain] &&
+                       (error.code == JessiDownloadErrorCancelled || error.code == JessiDownloadErrorHashMismatch));
+    if (retryable && job.attempts <= JessiDownloadQueueRetries) {
+        NSTimeInterval delay = (NSTimeInterval)(1u << (job.attempts - 1));
+        NSLog(@"[JESSI] %@ failed (%@); retrying in %.0fs", job.request.destinationPath.lastPathComponent, error.localizedDescription, delay);
+        _backingOff++;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+            self->_backingOff--;
+            if (self->_finished) return;
+            [self->_pending addObject:job];
+            [self pump];
+        });
+        [self pump];
+        return;
+    }
+
+    NSLog(@"[JESSI] %@ failed: %@", job.request.destinationPath.lastPathComponent, error.localizedDescription);
+    @synchronized (_failed) {
+        [_failed addObject:job.request];
+    }
+    _settled++;
+    if (!_firstError) _firstError = error;
+    if (_stopOnFirstError) {
+        [self finishWithError:error];
+        return;
+    }
+    [self reportProgress:YES];
+    [self pump];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (_finished) return;
+    _finished = YES;
+    [_pending removeAllObjects];
+    for (JessiDownloadJob *job in _active) [job.downloader cancel];
+    [_session invalidate];
+
+    [self reportProgress:YES];
+    JessiDownloadQueueCompletion completion = _completion;
+    _completion = nil;
+    _progress = nil;
+    if (completion) completion(error);
+}
+
+- (void)dealloc {
+    [_session invalidate];
+}
+
+- (void)reportProgress:(BOOL)force {
+    if (!_progress) return;
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    if (!force && now - _lastProgress < JessiDownloadQueueProgressInterval) return;
+    _lastProgress = now;
+
+    int64_t received = 0, total = 0;
+    for (JessiDownloadJob *job in _jobs) {
+        int64_t size = job.total > 0 ? job.total : job.expected;
+        total += size;
+        received += size > 0 ? MIN(job.received, size) : job.received;
+    }
+    _progress(received, total, _settled, _jobs.count);
+}
+
+@end
@@ -0,0 +1,90 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSErrorDomain const JessiDownloadErrorDomain;
+
+typedef NS_ENUM(NSInteger, JessiDownloadErrorCode) {
+    JessiDownloadErrorHTTP = 1,
+    JessiDownloadErrorHashMismatch = 2,
+    // A stream was interrupted and no mirror would continue it from the same offset.
+    JessiDownloadErrorCannotResume = 3,
+    JessiDownloadErrorCancelled = 4,
+    JessiDownloadErrorIO = 5,
+};
+
+@interface JessiDownloadRequest : NSObject
+
+// Tried in order. A failed range moves on to the next mirror and keeps the bytes already fetched.
+@property (nonatomic, copy) NSArray<NSURL *> *mirrors;
+// Required for file downloads. The partial copy lives in Caches/Downloads until it is verified.
+@property (nonatomic, copy, nullable) NSString *destinationPath;
+// Hex digests, whichever the source publishes; the file is checked before it's moved into place.
+@property (nonatomic, copy, nullable) NSString *sha1;
+@property (nonatomic, copy, nullable) NSString *sha256;
+@property (nonatomic, copy, nullable) NSString *sha512;
+// Parallel range requests for large files when the server supports them. Default 4; 1 disables.
+@property (nonatomic) NSUInteger maxSegments;
+// Share the file through JessiArtifactStore: skip the download when one of the hashes is already
+// stored, and store the verified file otherwise.
+@property (nonatomic) BOOL storeArtifact;
+
++ (instancetype)requestWithURL:(NSURL *)url destination:(nullable NSString *)path;
++ (instancetype)requestWithMirrors:(NSArray<NSURL *> *)mirrors destination:(nullable NSString *)path;
+
+@end
+
+// One URL session that many downloaders can share, so connections are capped and reused across
+// files instead of each download opening its own. Invalidate it once its downloads are done.
+@interface JessiDownloadSession : NSObject
+
+- (instancetype)initWithMaxConnectionsPerHost:(NSUInteger)perHost;
+- (instancetype)init NS_UNAVAILABLE;
+
+// Cancels whatever is still running on it; downloads that try to go on fail as cancelled.
+- (void)invalidate;
+
+@end
+
+// total is -1 while unknown.
+typedef void (^JessiDownloadProgressBlock)(int64_t received, int64_t total);
+typedef void (^JessiDownloadCompletion)(NSError * _Nullable error);
+// Return NO to stop; the download then completes with JessiDownloadErrorCancelled.
+typedef BOOL (^JessiDownloadDataBlock)(NSData *data);
+
+// One download on its own serial queue, over a private session unless one is passed in; callbacks
+// run on that queue.
+// Interrupted file downloads resume from their partial copy, including on a later attempt with
+// the same source (keyed by hash when one is given, else by the first mirror URL). Downloads with
+// the same key at the same time take turns rather than sharing the partial copy.
+@interface JessiDownloader : NSObject
+
+@property (atomic, readonly) int64_t receivedBytes;
+@property (atomic, readonly) int64_t totalBytes;
+
++ (instancetype)downloadRequest:(JessiDownloadRequest *)request
+                       progress:(nullable JessiDownloadProgressBlock)progress
+                     completion:(JessiDownloadCompletion)completion
+    NS_SWIFT_NAME(download(_:progress:completion:));
+
++ (instancetype)downloadRequest:(JessiDownloadRequest *)request
+                        session:(nullable JessiDownloadSession *)session
+                       progress:(nullable JessiDownloadProgressBlock)progress
+                     completion:(JessiDownloadCompletion)completion
+    NS_SWIFT_NAME(download(_:session:progress:completion:));
+
+// Delivers the body in order as it arrives, for consumers that decode on the fly. Drops are
+// resumed with a range request on the same or the next mirror; nothing is written to disk.
++ (instancetype)streamRequest:(JessiDownloadRequest *)request
+                       onData:(JessiDownloadDataBlock)onData
+                     progress:(nullable JessiDownloadProgressBlock)progress
+                   completion:(JessiDownloadCompletion)completion
+    NS_SWIFT_NAME(stream(_:onData:progress:completion:));
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,915 @@
+#import "JessiDownloader.h"
+#import "JessiArtifactStore.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NSErrorDomain const JessiDownloadErrorDomain = @"JessiDownload";
+
+static const int JessiDownloadStateFormat = 1;
+// Smallest range worth its own connection.
+static const int64_t JessiDownloadMinSegment = 4LL * 1024 * 1024;
+// Per segment, counted across mirrors.
+static const NSUInteger JessiDownloadMaxAttempts = 6;
+static const NSTimeInterval JessiDownloadStateInterval = 1.0;
+static const NSTimeInterval JessiDownloadProgressInterval = 0.1;
+// How often to retry a partial file that another process has locked.
+static const NSTimeInterval JessiDownloadLockRetryInterval = 1.0;
+// Read size when hashing a finished file; heap-allocated, delegate queues have small stacks.
+static const size_t JessiDownloadHashChunk = 256 * 1024;
+
+static NSError *jessi_download_error(JessiDownloadErrorCode code, NSString *message) {
+    return [NSError errorWithDomain:JessiDownloadErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+static NSString *jessi_download_hex(const unsigned char *digest, size_t len) {
+    NSMutableString *hex = [NSMutableString stringWithCapacity:len * 2];
+    for (size_t i = 0; i < len; i++) [hex appendFormat:@"%02x", digest[i]];
+    return hex;
+}
+
+// Downloads that share a partial file take turns: key -> downloaders parked until the holder
+// finishes. A present key means it is held.
+static NSMutableDictionary<NSString *, NSMutableArray *> *jessi_download_holders(void) {
+    static NSMutableDictionary *holders;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        holders = [NSMutableDictionary dictionary];
+    });
+    return holders;
+}
+
+static NSString *jessi_download_normalized_hash(NSString *hash) {
+    NSString *trimmed = [hash stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    return trimmed.length ? trimmed.lowercaseString : nil;
+}
+
+// Only the digests the request asks for are computed.
+typedef struct {
+    BOOL sha1, sha256, sha512;
+    CC_SHA1_CTX c1;
+    CC_SHA256_CTX c256;
+    CC_SHA512_CTX c512;
+} jessi_download_digest;
+
+static void jessi_download_digest_init(jessi_download_digest *d, JessiDownloadRequest *request) {
+    memset(d, 0, sizeof(*d));
+    d->sha1 = request.sha1 != nil;
+    d->sha256 = request.sha256 != nil;
+    d->sha512 = request.sha512 != nil;
+    if (d->sha1) CC_SHA1_Init(&d->c1);
+    if (d->sha256) CC_SHA256_Init(&d->c256);
+    if (d->sha512) CC_SHA512_Init(&d->c512);
+}
+
+static void jessi_download_digest_update(jessi_download_digest *d, const void *bytes, size_t len) {
+    if (d->sha1) CC_SHA1_Update(&d->c1, bytes, (CC_LONG)len);
+    if (d->sha256) CC_SHA256_Update(&d->c256, bytes, (CC_LONG)len);
+    if (d->sha512) CC_SHA512_Update(&d->c512, bytes, (CC_LONG)len);
+}
+
+static NSString *jessi_download_digest_mismatch(jessi_download_digest *d, JessiDownloadRequest *request) {
+    if (d->sha1) {
+        unsigned char out[CC_SHA1_DIGEST_LENGTH];
+        CC_SHA1_Final(out, &d->c1);
+        if (![jessi_download_hex(out, sizeof(out)) isEqualToString:request.sha1]) return @"SHA-1";
+    }
+    if (d->sha256) {
+        unsigned char out[CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256_Final(out, &d->c256);
+        if (![jessi_download_hex(out, sizeof(out)) isEqualToString:request.sha256]) return @"SHA-256";
+    }
+    if (d->sha512) {
+        unsigned char out[CC_SHA512_DIGEST_LENGTH];
+        CC_SHA512_Final(out, &d->c512);
+        if (![jessi_download_hex(out, sizeof(out)) isEqualToString:request.sha512]) return @"SHA-512";
+    }
+    return nil;
+}
+
+// "bytes 100-199/1000" -> first 100, total 1000 (-1 for "*").
+static BOOL jessi_download_parse_content_range(NSString *value, int64_t *first, int64_t *total) {
+    if (![value hasPrefix:@"bytes "]) return NO;
+    NSScanner *scanner = [NSScanner scannerWithString:[value substringFromIndex:6]];
+    long long a = 0, b = 0, t = -1;
+    if (![scanner scanLongLong:&a] || ![scanner scanString:@"-" intoString:NULL] || ![scanner scanLongLong:&b]) return NO;
+    if (![scanner scanString:@"/" intoString:NULL]) return NO;
+    if (![scanner scanString:@"*" intoString:NULL] && ![scanner scanLongLong:&t]) return NO;
+    *first = a;
+    *total = t;
+    return YES;
+}
+
+@implementation JessiDownloadRequest
+
++ (instancetype)requestWithURL:(NSURL *)url destination:(NSString *)path {
+    return [self requestWithMirrors:@[url] destination:path];
+}
+
++ (instancetype)requestWithMirrors:(NSArray<NSURL *> *)mirrors destination:(NSString *)path {
+    JessiDownloadRequest *r = [[self alloc] init];
+    r.mirrors = mirrors;
+    r.destinationPath = path;
+    r.maxSegments = 4;
+    return r;
+}
+
+@end
+
+@interface JessiDownloadSegment : NSObject
+@property (nonatomic) int64_t start;
+// Exclusive; -1 until the size is known.
+@property (nonatomic) int64_t end;
+@property (nonatomic) int64_t done;
+@property (nonatomic) NSUInteger mirror;
+@property (nonatomic) NSUInteger attempts;
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *task;
+@property (nonatomic) BOOL complete;
+@end
+
+@implementation JessiDownloadSegment
+@end
+
+@interface JessiDownloader () <NSURLSessionDataDelegate>
+@property (atomic, readwrite) int64_t receivedBytes;
+@property (atomic, readwrite) int64_t totalBytes;
+@property (nonatomic, readonly) NSOperationQueue *callbackQueue;
+@end
+
+@interface JessiDownloadSession () <NSURLSessionDataDelegate>
+- (instancetype)initWithMaxConnectionsPerHost:(NSUInteger)perHost delegateQueue:(nullable NSOperationQueue *)queue;
+// nil once the session is invalidated.
+- (nullable NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request downloader:(JessiDownloader *)downloader;
+@end
+
+@implementation JessiDownloadSession {
+    NSURLSession *_session;
+    // Task identifier -> downloader, until the task completes.
+    NSMutableDictionary<NSNumber *, JessiDownloader *> *_owners;
+    BOOL _invalidated;
+}
+
+- (instancetype)initWithMaxConnectionsPerHost:(NSUInteger)perHost {
+    return [self initWithMaxConnectionsPerHost:perHost delegateQueue:nil];
+}
+
+- (instancetype)initWithMaxConnectionsPerHost:(NSUInteger)perHost delegateQueue:(NSOperationQueue *)queue {
+    if ((self = [super init])) {
+        _owners = [NSMutableDictionary dictionary];
+        if (!queue) {
+            queue = [[NSOperationQueue alloc] init];
+            queue.maxConcurrentOperationCount = 1;
+            queue.qualityOfService = NSQualityOfServiceUserInitiated;
+            queue.name = @"com.baconmania.jessi.downloadsession";
+        }
+        NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+        // Idle timeout: a stalled connection fails over instead of hanging.
+        config.timeoutIntervalForRequest = 30;
+        config.HTTPMaximumConnectionsPerHost = (NSInteger)MAX((NSUInteger)1, perHost);
+        config.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+        config.URLCache = nil;
+        _session = [NSURLSession sessionWithConfiguration:config delegate:self delegateQueue:queue];
+    }
+    return self;
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request downloader:(JessiDownloader *)downloader {
+    @synchronized (_owners) {
+        if (_invalidated) return nil;
+        NSURLSessionDataTask *task = [_session dataTaskWithRequest:request];
+        _owners[@(task.taskIdentifier)] = downloader;
+        return task;
+    }
+}
+
+- (void)invalidate {
+    @synchronized (_owners) {
+        if (_invalidated) return;
+        _invalidated = YES;
+    }
+    [_session invalidateAndCancel];
+}
+
+- (JessiDownloader *)ownerOfTask:(NSURLSessionTask *)task remove:(BOOL)remove {
+    @synchronized (_owners) {
+        NSNumber *key = @(task.taskIdentifier);
+        JessiDownloader *owner = _owners[key];
+        if (remove) [_owners removeObjectForKey:key];
+        return owner;
+    }
+}
+
+// Callbacks go to the owning downloader's queue, in the order the session delivered them.
+static void jessi_download_forward(JessiDownloader *owner, void (^block)(void)) {
+    NSOperationQueue *queue = owner.callbackQueue;
+    if ([NSOperationQueue currentQueue] == queue) block();
+    else [queue addOperationWithBlock:block];
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    JessiDownloader *owner = [self ownerOfTask:dataTask remove:NO];
+    if (!owner) {
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    jessi_download_forward(owner, ^{
+        [owner URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+    });
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    JessiDownloader *owner = [self ownerOfTask:dataTask remove:NO];
+    if (!owner) return;
+    jessi_download_forward(owner, ^{
+        [owner URLSession:session dataTask:dataTask didReceiveData:data];
+    });
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    JessiDownloader *owner = [self ownerOfTask:task remove:YES];
+    if (!owner) return;
+    jessi_download_forward(owner, ^{
+        [owner URLSession:session task:task didCompleteWithError:error];
+    });
+}
+
+@end
+
+@implementation JessiDownloader {
+    JessiDownloadRequest *_request;
+    BOOL _streaming;
+    JessiDownloadDataBlock _onData;
+    JessiDownloadProgressBlock _progress;
+    JessiDownloadCompletion _completion;
+
+    NSOperationQueue *_queue;
+    JessiDownloadSession *_session;
+    BOOL _ownsSession;
+    NSMutableArray<JessiDownloadSegment *> *_segments;
+    BOOL _rangesSupported;
+    NSString *_validator;
+    NSUInteger _validatorMirror;
+    BOOL _finished;
+    BOOL _restartedAfterMismatch;
+
+    NSString *_partPath;
+    NSString *_statePath;
+    // Under the holders lock.
+    NSString *_heldKey;
+    NSString *_parkedKey;
+    int _fd;
+    NSDate *_lastStateSave;
+    NSDate *_lastProgress;
+
+    jessi_download_digest _digest;
+}
+
++ (instancetype)downloadRequest:(JessiDownloadRequest *)request
+                       progress:(JessiDownloadProgressBlock)progress
+                     completion:(JessiDownloadCompletion)completion {
+    return [self downloadRequest:request session:nil progress:progress completion:completion];
+}
+
++ (instancetype)downloadRequest:(JessiDownloadRequest *)request
+                        session:(JessiDownloadSession *)session
+                       progress:(JessiDownloadProgressBlock)progress
+                     completion:(JessiDownloadCompletion)completion {
+    JessiDownloader *d = [[self alloc] initWithRequest:request streaming:NO session:session onData:nil progress:progress completion:completion];
+    [d->_queue addOperationWithBlock:^{ [d startFile]; }];
+    return d;
+}
+
++ (instancetype)streamRequest:(JessiDownloadRequest *)request
+                       onData:(JessiDownloadDataBlock)onData
+                     progress:(JessiDownloadProgressBlock)progress
+                   completion:(JessiDownloadCompletion)completion {
+    JessiDownloader *d = [[self alloc] initWithRequest:request streaming:YES session:nil onData:onData progress:progress completion:completion];
+    [d->_queue addOperationWithBlock:^{ [d startStream]; }];
+    return d;
+}
+
+- (instancetype)initWithRequest:(JessiDownloadRequest *)request
+                      streaming:(BOOL)streaming
+                        session:(JessiDownloadSession *)session
+                         onData:(JessiDownloadDataBlock)onData
+                       progress:(JessiDownloadProgressBlock)progress
+                     completion:(JessiDownloadCompletion)completion {
+    if ((self = [super init])) {
+        _request = [JessiDownloadRequest requestWithMirrors:request.mirrors destination:request.destinationPath];
+        _request.maxSegments = streaming ? 1 : MAX((NSUInteger)1, request.maxSegments);
+        _request.sha1 = jessi_download_normalized_hash(request.sha1);
+        _request.sha256 = jessi_download_normalized_hash(request.sha256);
+        _request.sha512 = jessi_download_normalized_hash(request.sha512);
+        _request.storeArtifact = request.storeArtifact && !streaming;
+        _streaming = streaming;
+        _onData = [onData copy];
+        _progress = [progress copy];
+        _completion = [completion copy];
+        _fd = -1;
+        _segments = [NSMutableArray array];
+        self.totalBytes = -1;
+
+        _queue = [[NSOperationQueue alloc] init];
+        _queue.maxConcurrentOperationCount = 1;
+        _queue.qualityOfService = NSQualityOfServiceUserInitiated;
+        _queue.name = @"com.baconmania.jessi.download";
+
+        _session = session;
+        if (!_session) {
+            _session = [[JessiDownloadSession alloc] initWithMaxConnectionsPerHost:MAX((NSUInteger)2, _request.maxSegments)
+                                                                     delegateQueue:_queue];
+            _ownsSession = YES;
+        }
+    }
+    return self;
+}
+
+- (NSOperationQueue *)callbackQueue {
+    return _queue;
+}
+
+- (void)cancel {
+    [_queue addOperationWithBlock:^{
+        [self finishWithError:jessi_download_error(JessiDownloadErrorCancelled, @"Download cancelled")];
+    }];
+}
+
+#pragma mark - Setup
+
+- (void)startStream {
+    if (_request.mirrors.count == 0) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorHTTP, @"No download URL")];
+        return;
+    }
+    jessi_download_digest_init(&_digest, _request);
+    JessiDownloadSegment *seg = [JessiDownloadSegment new];
+    seg.end = -1;
+    [_segments addObject:seg];
+    [self startSegment:seg];
+}
+
+- (void)startFile {
+    if (_finished) return;
+    if (_request.mirrors.count == 0 || _request.destinationPath.length == 0) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorHTTP, @"No download URL or destination")];
+        return;
+    }
+
+    if (_request.storeArtifact) {
+        JessiArtifactStore *store = [JessiArtifactStore shared];
+        if ((_request.sha512 && [store materializeHash:_request.sha512 algorithm:@"sha512" toPath:_request.destinationPath]) ||
+            (_request.sha256 && [store materializeHash:_request.sha256 algorithm:@"sha256" toPath:_request.destinationPath]) ||
+            (_request.sha1 && [store materializeHash:_request.sha1 algorithm:@"sha1" toPath:_request.destinationPath])) {
+            NSLog(@"[JESSI] %@ already stored; skipping download", _request.destinationPath.lastPathComponent);
+            [self finishWithError:nil];
+            return;
+        }
+    }
+
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *dir = [caches stringByAppendingPathComponent:@"Downloads"];
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *identity = _request.sha512 ?: _request.sha256 ?: _request.sha1 ?: _request.mirrors.firstObject.absoluteString;
+    NSData *identityData = [identity dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char key[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(identityData.bytes, (CC_LONG)identityData.length, key);
+    NSString *name = jessi_download_hex(key, 16);
+    _partPath = [dir stringByAppendingPathComponent:[name stringByAppendingPathExtension:@"part"]];
+    _statePath = [dir stringByAppendingPathComponent:[name stringByAppendingPathExtension:@"json"]];
+
+    if (![self claimKey:name]) {
+        NSLog(@"[JESSI] %@ is already downloading; waiting for it", _request.destinationPath.lastPathComponent);
+        return;
+    }
+    _fd = open(_partPath.fileSystemRepresentation, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorIO, [NSString stringWithFormat:@"Can't open %@: %s", _partPath, strerror(errno)])];
+        return;
+    }
+    // Another process with the same partial file; the lock goes with its descriptor. A holder that
+    // finished may have renamed the file out from under this descriptor, so check it's still there.
+    struct stat held, named;
+    BOOL locked = flock(_fd, LOCK_EX | LOCK_NB) == 0;
+    if (locked && (fstat(_fd, &held) != 0 || stat(_partPath.fileSystemRepresentation, &named) != 0 ||
+                   held.st_dev != named.st_dev || held.st_ino != named.st_ino)) {
+        locked = NO;
+    }
+    if (!locked) {
+        close(_fd);
+        _fd = -1;
+        [self releaseKey];
+        NSLog(@"[JESSI] %@ is locked by another process; retrying", _partPath.lastPathComponent);
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(JessiDownloadLockRetryInterval * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            [self->_queue addOperationWithBlock:^{ [self startFile]; }];
+        });
+        return;
+    }
+
+    BOOL resumed = [self loadState:identity];
+    if (!resumed && ftruncate(_fd, 0) != 0) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorIO, [NSString stringWithFormat:@"Write failed: %s", strerror(errno)])];
+        return;
+    }
+
+    if (!resumed) {
+        [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+        [_segments removeAllObjects];
+        JessiDownloadSegment *seg = [JessiDownloadSegment new];
+        seg.end = -1;
+        [_segments addObject:seg];
+    } else {
+        NSLog(@"[JESSI] Resuming %@ at %lld of %lld bytes", _request.mirrors.firstObject.lastPathComponent,
+              [self sumDone], self.totalBytes);
+    }
+    self.receivedBytes = [self sumDone];
+    for (JessiDownloadSegment *seg in [_segments copy]) {
+        if (!seg.complete) [self startSegment:seg];
+    }
+    [self checkFinished];
+}
+
+- (BOOL)loadState:(NSString *)identity {
+    NSData *data = [NSData dataWithContentsOfFile:_statePath];
+    NSDictionary *state = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![state isKindOfClass:[NSDictionary class]]) return NO;
+    if ([state[@"format"] intValue] != JessiDownloadStateFormat || ![state[@"identity"] isEqual:identity]) return NO;
+
+    int64_t total = [state[@"total"] longLongValue];
+    struct stat st;
+    if (total <= 0 || fstat(_fd, &st) != 0) return NO;
+
+    NSArray *segments = state[@"segments"];
+    if (![segments isKindOfClass:[NSArray class]] || segments.count == 0) return NO;
+    NSUInteger mirror = [state[@"mirror"] unsignedIntegerValue];
+    if (mirror >= _request.mirrors.count) mirror = 0;
+    int64_t covered = 0;
+    for (NSArray *entry in segments) {
+        if (![entry isKindOfClass:[NSArray class]] || entry.count != 3) return NO;
+        JessiDownloadSegment *seg = [JessiDownloadSegment new];
+        seg.start = [entry[0] longLongValue];
+        seg.end = [entry[1] longLongValue];
+        seg.done = [entry[2] longLongValue];
+        if (seg.start != covered || seg.end <= seg.start || seg.done < 0 || seg.done > seg.end - seg.start) {
+            [_segments removeAllObjects];
+            return NO;
+        }
+        seg.complete = seg.done == seg.end - seg.start;
+        seg.mirror = mirror;
+        covered = seg.end;
+        [_segments addObject:seg];
+    }
+    // The state is saved after the bytes it counts, but a lost write can still leave the file short.
+    int64_t written = 0;
+    for (JessiDownloadSegment *seg in _segments) written = MAX(written, seg.start + seg.done);
+    if (covered != total || (int64_t)st.st_size < written) {
+        [_segments removeAllObjects];
+        return NO;
+    }
+    self.totalBytes = total;
+    _rangesSupported = YES;
+    _validator = [state[@"validator"] isKindOfClass:[NSString class]] ? state[@"validator"] : nil;
+    _validatorMirror = mirror;
+    return YES;
+}
+
+// Only range-capable downloads of known size are worth resuming later.
+- (void)saveState:(BOOL)force {
+    if (_streaming || _finished || !_rangesSupported || self.totalBytes <= 0) return;
+    if (!force && _lastStateSave && -[_lastStateSave timeIntervalSinceNow] < JessiDownloadStateInterval) return;
+    _lastStateSave = [NSDate date];
+
+    NSMutableArray *segments = [NSMutableArray arrayWithCapacity:_segments.count];
+    for (JessiDownloadSegment *seg in _segments) {
+        if (seg.end < 0) return;
+        [segments addObject:@[@(seg.start), @(seg.end), @(seg.done)]];
+    }
+    NSMutableDictionary *state = [@{
+        @"format": @(JessiDownloadStateFormat),
+        @"identity": _request.sha512 ?: _request.sha256 ?: _request.sha1 ?: _request.mirrors.firstObject.absoluteString,
+        @"total": @(self.totalBytes),
+        @"mirror": @(_validatorMirror),
+        @"segments": segments,
+    } mutableCopy];
+    if (_validator) state[@"validator"] = _validator;
+    NSData *out = [NSJSONSerialization dataWithJSONObject:state options:0 error:nil];
+    [out writeToFile:_statePath atomically:YES];
+}
+
+- (int64_t)sumDone {
+    int64_t sum = 0;
+    for (JessiDownloadSegment *seg in _segments) sum += seg.done;
+    return sum;
+}
+
+// NO parks this download until the current holder of key finishes, then startFile runs again.
+- (BOOL)claimKey:(NSString *)key {
+    NSMutableDictionary<NSString *, NSMutableArray *> *holders = jessi_download_holders();
+    @synchronized (holders) {
+        NSMutableArray *waiters = holders[key];
+        if (waiters) {
+            [waiters addObject:self];
+            _parkedKey = key;
+            return NO;
+        }
+        holders[key] = [NSMutableArray array];
+        _heldKey = key;
+        return YES;
+    }
+}
+
+- (void)releaseKey {
+    NSMutableDictionary<NSString *, NSMutableArray *> *holders = jessi_download_holders();
+    NSArray<JessiDownloader *> *waiters = nil;
+    @synchronized (holders) {
+        if (_parkedKey) {
+            [holders[_parkedKey] removeObjectIdenticalTo:self];
+            _parkedKey = nil;
+        }
+        if (_heldKey) {
+            waiters = holders[_heldKey];
+            [holders removeObjectForKey:_heldKey];
+            _heldKey = nil;
+            for (JessiDownloader *d in waiters) d->_parkedKey = nil;
+        }
+    }
+    // They race to claim it again; the artifact store may already have what they want.
+    for (JessiDownloader *d in waiters) {
+        [d->_queue addOperationWithBlock:^{ [d startFile]; }];
+    }
+}
+
+#pragma mark - Segments
+
+- (JessiDownloadSegment *)segmentForTask:(NSURLSessionTask *)task {
+    for (JessiDownloadSegment *seg in _segments) {
+        if (seg.task == task) return seg;
+    }
+    return nil;
+}
+
+- (void)startSegment:(JessiDownloadSegment *)seg {
+    if (_finished) return;
+    NSURL *url = _request.mirrors[seg.mirror];
+    NSMutableURLRequest *req = [NSMutableURLRequest requestWithURL:url];
+    // Ranges count encoded bytes; ask for the file as stored.
+    [req setValue:@"identity" forHTTPHeaderField:@"Accept-Encoding"];
+    int64_t offset = seg.start + seg.done;
+    if (seg.end >= 0) {
+        [req setValue:[NSString stringWithFormat:@"bytes=%lld-%lld", offset, seg.end - 1] forHTTPHeaderField:@"Range"];
+    } else if (offset > 0 || _request.maxSegments > 1) {
+        // Open-ended: doubles as the probe for size and range support.
+        [req setValue:[NSString stringWithFormat:@"bytes=%lld-", offset] forHTTPHeaderField:@"Range"];
+    }
+    if (offset > 0 && _validator && seg.mirror == _validatorMirror) {
+        [req setValue:_validator forHTTPHeaderField:@"If-Range"];
+    }
+    seg.task = [_session dataTaskWithRequest:req downloader:self];
+    if (!seg.task) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorCancelled, @"Download session closed")];
+        return;
+    }
+    [seg.task resume];
+}
+
+// Cuts the probe's open-ended range down and starts the rest as parallel segments.
+- (void)splitAfterProbe:(JessiDownloadSegment *)probe total:(int64_t)total {
+    NSUInteger count = (NSUInteger)MIN((int64_t)_request.maxSegments, total / JessiDownloadMinSegment);
+    if (count < 2) {
+        probe.end = total;
+        return;
+    }
+    int64_t size = total / (int64_t)count;
+    probe.end = size;
+    for (NSUInteger i = 1; i < count; i++) {
+        JessiDownloadSegment *seg = [JessiDownloadSegment new];
+        seg.start = size * (int64_t)i;
+        seg.end = i == count - 1 ? total : size * (int64_t)(i + 1);
+        seg.mirror = probe.mirror;
+        [_segments addObject:seg];
+        [self startSegment:seg];
+    }
+}
+
+// The server ignored a range (no range support, or If-Range found the file changed): keep
+// this full response as the only segment and drop everything fetched so far.
+- (void)restartFromFullResponse:(JessiDownloadSegment *)seg expected:(int64_t)expected {
+    for (JessiDownloadSegment *other in _segments) {
+        if (other != seg) [other.task cancel];
+    }
+    [_segments removeAllObjects];
+    seg.start = 0;
+    seg.done = 0;
+    seg.end = expected >= 0 ? expected : -1;
+    seg.complete = NO;
+    [_segments addObject:seg];
+    self.totalBytes = expected;
+    _rangesSupported = NO;
+    _validator = nil;
+    if (_fd >= 0) ftruncate(_fd, 0);
+    [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+}
+
+// Strong ETag, else Last-Modified; sent as If-Range when resuming from the same mirror.
+- (void)takeValidatorFrom:(NSHTTPURLResponse *)http mirror:(NSUInteger)mirror {
+    NSString *etag = [http valueForHTTPHeaderField:@"ETag"];
+    _validator = (etag.length && ![etag hasPrefix:@"W/"]) ? etag : [http valueForHTTPHeaderField:@"Last-Modified"];
+    _validatorMirror = mirror;
+}
+
+- (void)segment:(JessiDownloadSegment *)seg failed:(NSError *)error {
+    seg.task = nil;
+    [self saveState:YES];
+    seg.attempts++;
+    if (seg.attempts >= MAX(JessiDownloadMaxAttempts, _request.mirrors.count * 2)) {
+        [self finishWithError:error];
+        return;
+    }
+    if (_request.mirrors.count > 1) seg.mirror = (seg.mirror + 1) % _request.mirrors.count;
+    NSLog(@"[JESSI] Download of %@ failed at %lld (%@); retrying from %@", _request.mirrors.firstObject.lastPathComponent,
+          seg.start + seg.done, error.localizedDescription, _request.mirrors[seg.mirror].host ?: @"?");
+
+    NSTimeInterval delay = MIN(0.5 * (double)(1u << MIN(seg.attempts - 1, (NSUInteger)4)), 8.0);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [self->_queue addOperationWithBlock:^{
+            if (!self->_finished && !seg.task && !seg.complete) [self startSegment:seg];
+        }];
+    });
+}
+
+- (void)completeSegment:(JessiDownloadSegment *)seg {
+    seg.complete = YES;
+    NSURLSessionDataTask *task = seg.task;
+    seg.task = nil;
+    // An open-ended probe keeps sending past its share.
+    [task cancel];
+    [self saveState:YES];
+    [self checkFinished];
+}
+
+#pragma mark - NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    JessiDownloadSegment *seg = [self segmentForTask:dataTask];
+    if (!seg || _finished) {
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    NSHTTPURLResponse *http = [response isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)response : nil;
+    NSInteger status = http ? http.statusCode : 200;
+    int64_t offset = seg.start + seg.done;
+
+    if (status == 206) {
+        int64_t first = -1, total = -1;
+        if (!jessi_download_parse_content_range([http valueForHTTPHeaderField:@"Content-Range"], &first, &total) || first != offset) {
+            completionHandler(NSURLSessionResponseCancel);
+            [self segment:seg failed:jessi_download_error(JessiDownloadErrorHTTP, @"Server returned the wrong range")];
+            return;
+        }
+        if (total >= 0 && self.totalBytes >= 0 && total != self.totalBytes) {
+            // A mirror with a different file; its bytes can't be mixed with ours.
+            completionHandler(NSURLSessionResponseCancel);
+            [self segment:seg failed:jessi_download_error(JessiDownloadErrorHTTP, @"Mirror serves a different file size")];
+            return;
+        }
+        if (!_rangesSupported || self.totalBytes < 0) {
+            _rangesSupported = YES;
+            self.totalBytes = total;
+            [self takeValidatorFrom:http mirror:seg.mirror];
+        }
+        if (seg.end < 0 && total > 0) {
+            if (!_streaming && offset == 0 && _segments.count == 1) [self splitAfterProbe:seg total:total];
+            else seg.end = total;
+        }
+    } else if (status >= 200 && status < 300) {
+        if (offset > 0 || _segments.count > 1) {
+            if (_streaming) {
+                completionHandler(NSURLSessionResponseCancel);
+                [self segment:seg failed:jessi_download_error(JessiDownloadErrorCannotResume, @"Server can't resume this download")];
+                return;
+            }
+            [self restartFromFullResponse:seg expected:response.expectedContentLength];
+        } else {
+            self.totalBytes = response.expectedContentLength;
+            seg.end = self.totalBytes >= 0 ? self.totalBytes : -1;
+            _rangesSupported = NO;
+        }
+        if (http) [self takeValidatorFrom:http mirror:seg.mirror];
+    } else {
+        completionHandler(NSURLSessionResponseCancel);
+        [self segment:seg failed:jessi_download_error(JessiDownloadErrorHTTP, [NSString stringWithFormat:@"Download failed (HTTP %ld)", (long)status])];
+        return;
+    }
+    self.receivedBytes = [self sumDone];
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    JessiDownloadSegment *seg = [self segmentForTask:dataTask];
+    if (!seg || _finished || seg.complete) return;
+
+    __block NSUInteger used = 0;
+    __block BOOL ok = YES;
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange range, BOOL *stop) {
+        size_t len = range.length;
+        if (seg.end >= 0) {
+            int64_t left = seg.end - seg.start - seg.done;
+            if ((int64_t)len > left) len = (size_t)MAX(left, (int64_t)0);
+        }
+        if (len == 0) {
+            *stop = YES;
+            return;
+        }
+        if (self->_streaming) {
+            jessi_download_digest_update(&self->_digest, bytes, len);
+            ok = self->_onData(range.location == 0 && len == data.length ? data : [data subdataWithRange:NSMakeRange(range.location, len)]);
+        } else {
+            const uint8_t *p = bytes;
+            size_t off = 0;
+            while (off < len) {
+                ssize_t n = pwrite(self->_fd, p + off, len - off, seg.start + seg.done + (int64_t)off);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    ok = NO;
+                    break;
+                }
+                off += (size_t)n;
+            }
+        }
+        if (!ok) {
+            *stop = YES;
+            return;
+        }
+        seg.done += (int64_t)len;
+        used += len;
+    }];
+
+    if (!ok) {
+        NSError *error = _streaming ? jessi_download_error(JessiDownloadErrorCancelled, @"Download stopped by the consumer")
+                                    : jessi_download_error(JessiDownloadErrorIO, [NSString stringWithFormat:@"Write failed: %s", strerror(errno)]);
+        [self finishWithError:error];
+        return;
+    }
+    // Retries are counted per stall, not per download.
+    if (used) seg.attempts = 0;
+    self.receivedBytes += (int64_t)used;
+    [self reportProgress:NO];
+    [self saveState:NO];
+    if (seg.end >= 0 && seg.start + seg.done >= seg.end) [self completeSegment:seg];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    JessiDownloadSegment *seg = [self segmentForTask:task];
+    if (!seg || _finished) return;
+    if (error) {
+        [self segment:seg failed:error];
+        return;
+    }
+    if (seg.end < 0) {
+        // No length was announced; the body ending is the end.
+        seg.end = seg.start + seg.done;
+        self.totalBytes = seg.end;
+    }
+    if (seg.start + seg.done < seg.end) {
+        [self segment:seg failed:jessi_download_error(JessiDownloadErrorHTTP, @"Connection closed early")];
+        return;
+    }
+    [self completeSegment:seg];
+}
+
+#pragma mark - Completion
+
+- (void)reportProgress:(BOOL)force {
+    if (!_progress) return;
+    if (!force && _lastProgress && -[_lastProgress timeIntervalSinceNow] < JessiDownloadProgressInterval) return;
+    _lastProgress = [NSDate date];
+    _progress(self.receivedBytes, self.totalBytes);
+}
+
+- (void)checkFinished {
+    if (_finished || _segments.count == 0) return;
+    for (JessiDownloadSegment *seg in _segments) {
+        if (!seg.complete) return;
+    }
+    [self reportProgress:YES];
+
+    if (_streaming) {
+        NSString *bad = jessi_download_digest_mismatch(&_digest, _request);
+        [self finishWithError:bad ? jessi_download_error(JessiDownloadErrorHashMismatch, [NSString stringWithFormat:@"%@ mismatch for %@", bad, _request.mirrors.firstObject.lastPathComponent]) : nil];
+        return;
+    }
+
+    if (self.totalBytes >= 0 && ftruncate(_fd, self.totalBytes) != 0) {
+        [self finishWithError:jessi_download_error(JessiDownloadErrorIO, [NSString stringWithFormat:@"Write failed: %s", strerror(errno)])];
+        return;
+    }
+
+    // _fd stays open, and locked, until finishWithError.
+    NSString *bad = [self verifyPartFile];
+    if (bad) {
+        [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+        // One clean retry from the next mirror before giving up.
+        if (!_restartedAfterMismatch) {
+            _restartedAfterMismatch = YES;
+            NSLog(@"[JESSI] %@ mismatch for %@; downloading again", bad, _request.mirrors.firstObject.lastPathComponent);
+            NSUInteger next = _request.mirrors.count > 1 ? (_segments.firstObject.mirror + 1) % _request.mirrors.count : 0;
+            [_segments removeAllObjects];
+            _rangesSupported = NO;
+            _validator = nil;
+            self.totalBytes = -1;
+            self.receivedBytes = 0;
+            if (ftruncate(_fd, 0) != 0) {
+                [self finishWithError:jessi_download_error(JessiDownloadErrorIO, [NSString stringWithFormat:@"Write failed: %s", strerror(errno)])];
+                return;
+            }
+            JessiDownloadSegment *seg = [JessiDownloadSegment new];
+            seg.end = -1;
+            seg.mirror = next;
+            [_segments addObject:seg];
+            [self startSegment:seg];
+            return;
+        }
+        unlink(_partPath.fileSystemRepresentation);
+        _rangesSupported = NO;
+        [self finishWithError:jessi_download_error(JessiDownloadErrorHashMismatch, [NSString stringWithFormat:@"%@ mismatch for %@", bad, _request.mirrors.firstObject.lastPathComponent])];
+        return;
+    }
+
+    NSString *dest = _request.destinationPath;
+    [[NSFileManager defaultManager] createDirectoryAtPath:dest.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+    if (rename(_partPath.fileSystemRepresentation, dest.fileSystemRepresentation) != 0) {
+        NSError *moveError = nil;
+        [[NSFileManager defaultManager] removeItemAtPath:dest error:nil];
+        if (![[NSFileManager defaultManager] moveItemAtPath:_partPath toPath:dest error:&moveError]) {
+            [self finishWithError:moveError];
+            return;
+        }
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+    if (_request.storeArtifact) {
+        NSMutableDictionary *hashes = [NSMutableDictionary dictionary];
+        if (_request.sha1) hashes[@"sha1"] = _request.sha1;
+        if (_request.sha256) hashes[@"sha256"] = _request.sha256;
+        if (_request.sha512) hashes[@"sha512"] = _request.sha512;
+        [[JessiArtifactStore shared] ingestFileAtPath:dest knownHashes:hashes];
+    }
+    [self finishWithError:nil];
+}
+
+- (NSString *)verifyPartFile {
+    if (!_request.sha1 && !_request.sha256 && !_request.sha512) return nil;
+    int fd = open(_partPath.fileSystemRepresentation, O_RDONLY);
+    if (fd < 0) return @"read";
+    uint8_t *buf = malloc(JessiDownloadHashChunk);
+    if (!buf) {
+        close(fd);
+        return @"read";
+    }
+    jessi_download_digest digest;
+    jessi_download_digest_init(&digest, _request);
+    ssize_t n;
+    while ((n = read(fd, buf, JessiDownloadHashChunk)) != 0) {
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        jessi_download_digest_update(&digest, buf, (size_t)n);
+    }
+    free(buf);
+    close(fd);
+    if (n < 0) return @"read";
+    return jessi_download_digest_mismatch(&digest, _request);
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (_finished) return;
+    // Partial state stays on disk for the next attempt unless the bytes are known bad.
+    if (error) [self saveState:YES];
+    _finished = YES;
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    [self releaseKey];
+    for (JessiDownloadSegment *seg in _segments) {
+        [seg.task cancel];
+        seg.task = nil;
+    }
+    if (_ownsSession) [_session invalidate];
+    JessiDownloadCompletion completion = _completion;
+    _completion = nil;
+    _onData = nil;
+    _progress = nil;
+    if (completion) completion(error);
+}
+
+- (void)dealloc {
+    if (_fd >= 0) close(_fd);
+}
+
+@end
@@ -30,7 +30,16 @@
 #if __has_include(<sys/fcntl.h>)
 #import <sys/fcntl.h>
 #endif
+#import <os/lock.h>
 #import "JessiSettings.h"
+#import "JessiLaunchTrace.h"
+#import "JessiLaunchPlan.h"
+#import "JessiMachOPatch.h"
+#import "JessiSigScan.h"
+#import "JessiJitPrep.h"
+#import "JessiChildChannel.h"
+#import "JessiCDSArchive.h"
+#import "JessiRuntimeRegistry.h"
 #import "../SwiftUI/JessiJITCheck.h"
 #import "MachExc/mach_excServer.h"
 
@@ -140,21 +149,27 @@ static void jessi_install_sigtrap_fallback_if_needed(void) {
     }
 }
 
+static int jessi_jit26_prepare_chunk(void *ctx, uintptr_t addr, size_t len) {
+    (void)ctx;
+    void *prepared = jessi_jit26_prepare_region((void *)addr, len);
+    return (!prepared || prepared == (void *)(uintptr_t)0xE000F00Du) ? -1 : 0;
+}
+
+// Every chunk is a debugger round trip, so chunks grow from 1 MB as far as the measured latency pays for it.
+static jessi_jit_prep *jessi_jit26_prep(void) {
+    static jessi_jit_prep *prep = NULL;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        prep = jessi_jit_prep_create(jessi_jit26_prepare_chunk, NULL, 1u << 20, 16u << 20);
+    });
+    return prep;
+}
+
 static BOOL jessi_jit26_prepare_region_chunked(void *addr, size_t len) {
     if (!addr || len == 0) return NO;
-    const size_t chunk = 1u << 20;
-    uint8_t *p = (uint8_t *)addr;
-    size_t remaining = len;
-    while (remaining > 0) {
-        size_t n = remaining > chunk ? chunk : remaining;
-        void *prepared = jessi_jit26_prepare_region(p, n);
-        if (!prepared || prepared == (void *)(uintptr_t)0xE000F00Du) {
-            return NO;
-        }
-        p += n;
-        remaining -= n;
-    }
-    return YES;
+    jessi_jit_prep *prep = jessi_jit26_prep();
+    if (!prep) return jessi_jit26_prepare_chunk(NULL, (uintptr_t)addr, len) == 0;
+    return jessi_jit_prep_range(prep, (uintptr_t)addr, len) == 0;
 }
 
 __attribute__((noinline,optnone,naked))
@@ -290,86 +305,6 @@ static BOOL jessi_has_extended_va_entitlement(void) {
 
 extern int dyld_get_active_platform(void);
 
-static BOOL jessi_patch_macho_platform_for_slice(struct mach_header_64 *header) {
-    if (!header) return NO;
-
-    uint8_t *imageHeaderPtr = (uint8_t *)header + sizeof(struct mach_header_64);
-    struct load_command *command = (struct load_command *)imageHeaderPtr;
-    BOOL patched = NO;
-
-    for (uint32_t i = 0; i < header->ncmds; i++) {
-        if (command->cmd == LC_BUILD_VERSION) {
-            struct build_version_command *buildver = (struct build_version_command *)command;
-            int activePlatform = dyld_get_active_platform();
-            if ((int)buildver->platform != activePlatform) {
-                buildver->platform = (uint32_t)activePlatform;
-                patched = YES;
-            }
-        } else if (command->cmd == LC_LOAD_DYLIB) {
-            struct dylib_command *dylib = (struct dylib_command *)command;
-            char *dylibName = (char *)((uint8_t *)dylib + dylib->dylib.name.offset);
-            char *verPtr = dylibName ? strstr(dylibName, "/Versions/") : NULL;
-            if (verPtr) {
-                
-                int lastComponentLen = (int)strlen(dylibName) - (int)(verPtr - dylibName) - 11;
-                if (lastComponentLen >= 0) {
-                    memmove(verPtr, verPtr + 11, (size_t)lastComponentLen);
-                    verPtr[lastComponentLen] = '\0';
-                    patched = YES;
-                }
-            }
-        }
-        command = (struct load_command *)((uint8_t *)command + command->cmdsize);
-    }
-
-    return patched;
-}
-
-static BOOL jessi_patch_macho_platform_for_file(const char *path) {
-    if (!path || !path[0]) return NO;
-
-    int fd = open(path, O_RDWR, (mode_t)0600);
-    if (fd == -1) return NO;
-
-    struct stat s;
-    if (fstat(fd, &s) != 0 || s.st_size <= 0) {
-        close(fd);
-        return NO;
-    }
-
-    void *map = mmap(NULL, (size_t)s.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (!map || map == MAP_FAILED) {
-        close(fd);
-        return NO;
-    }
-
-    BOOL patched = NO;
-    uint32_t magic = *(uint32_t *)map;
-    if (magic == FAT_CIGAM) {
-        struct fat_header *header = (struct fat_header *)map;
-        struct fat_arch *arch = (struct fat_arch *)((uint8_t *)map + sizeof(struct fat_header));
-        for (uint32_t i = 0; i < OSSwapInt32(header->nfat_arch); i++) {
-            if (OSSwapInt32(arch->cputype) == CPU_TYPE_ARM64) {
-                uint32_t off = OSSwapInt32(arch->offset);
-                patched |= jessi_patch_macho_platform_for_slice((struct mach_header_64 *)((uint8_t *)map + off));
-            }
-            arch = (struct fat_arch *)((uint8_t *)arch + sizeof(struct fat_arch));
-        }
-    } else if (magic == MH_MAGIC_64) {
-        struct mach_header_64 *mh = (struct mach_header_64 *)map;
-        if (mh->cputype == CPU_TYPE_ARM64) {
-            patched = jessi_patch_macho_platform_for_slice(mh);
-        }
-    }
-
-    if (patched) {
-        (void)msync(map, (size_t)s.st_size, MS_SYNC);
-    }
-    munmap(map, (size_t)s.st_size);
-    close(fd);
-    return patched;
-}
-
 static void jessi_for_each_dylib_under_dir(NSString *dir, void (^block)(NSString *fullPath)) {
     if (!dir.length || !block) return;
 
@@ -400,26 +335,59 @@ static void jessi_patch_jvm_dylibs_if_needed(NSString *javaHome) {
     
     if ([javaHome rangeOfString:@"/Library/Application Support/"].location == NSNotFound) return;
 
-    NSArray<NSString *> *roots = @[
-        [javaHome stringByAppendingPathComponent:@"lib"],
-        [javaHome stringByAppendingPathComponent:@"lib/server"],
-        [javaHome stringByAppendingPathComponent:@"lib/jli"],
-    ];
+    uint32_t platform = (uint32_t)dyld_get_active_platform();
+    NSString *manifestPath = [javaHome stringByAppendingPathComponent:@".jessi-patch-manifest"];
+    jessi_patch_manifest *manifest = jessi_patch_manifest_load(manifestPath.fileSystemRepresentation, platform);
+
+    // lib/server and lib/jli are reached by the recursive walk of lib.
+    NSString *libDir = [javaHome stringByAppendingPathComponent:@"lib"];
+    NSMutableArray<NSString *> *pending = [NSMutableArray array];
+    __block NSUInteger skipped = 0;
+    jessi_for_each_dylib_under_dir(libDir, ^(NSString *fullPath) {
+        struct stat st;
+        NSString *rel = [fullPath substringFromIndex:MIN(javaHome.length + 1, fullPath.length)];
+        if (stat(fullPath.fileSystemRepresentation, &st) == 0 &&
+            jessi_patch_manifest_is_current(manifest, rel.fileSystemRepresentation, &st)) {
+            skipped++;
+            return;
+        }
+        [pending addObject:fullPath];
+    });
 
-    __block int patchedCount = 0;
-    for (NSString *root in roots) {
-        if (![[NSFileManager defaultManager] fileExistsAtPath:root]) continue;
-        jessi_for_each_dylib_under_dir(root, ^(NSString *fullPath) {
-            BOOL did = jessi_patch_macho_platform_for_file(fullPath.fileSystemRepresentation);
-            if (did) {
-                patchedCount++;
-                JESSI_TXM_LOG("[JESSI] Patched Mach-O platform for %s\n", fullPath.fileSystemRepresentation);
-            }
+    NSUInteger count = pending.count;
+    jessi_macho_patch_result *results = calloc(MAX(count, 1), sizeof(jessi_macho_patch_result));
+    size_t *written = calloc(MAX(count, 1), sizeof(size_t));
+    if (count > 0 && results && written) {
+        dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+            results[i] = jessi_macho_patch_file(pending[i].fileSystemRepresentation, platform, &written[i]);
         });
     }
 
-    if (patchedCount > 0) {
-        JESSI_TXM_LOG("[JESSI] Patched %d JVM dylib(s)\n", patchedCount);
+    int patchedCount = 0;
+    for (NSUInteger i = 0; i < count && results && written; i++) {
+        NSString *fullPath = pending[i];
+        if (results[i] == JESSI_MACHO_PATCH_PATCHED) {
+            patchedCount++;
+            JESSI_TXM_LOG("[JESSI] Patched Mach-O platform for %s (%zu bytes)\n", fullPath.fileSystemRepresentation, written[i]);
+        } else if (results[i] == JESSI_MACHO_PATCH_FAILED) {
+            JESSI_TXM_LOG("[JESSI] Failed to patch Mach-O platform for %s\n", fullPath.fileSystemRepresentation);
+            continue;
+        }
+        // Record the post-patch stat so the next launch matches it.
+        struct stat st;
+        if (stat(fullPath.fileSystemRepresentation, &st) == 0) {
+            NSString *rel = [fullPath substringFromIndex:MIN(javaHome.length + 1, fullPath.length)];
+            jessi_patch_manifest_record(manifest, rel.fileSystemRepresentation, &st, results[i]);
+        }
+    }
+    free(results);
+    free(written);
+    jessi_patch_manifest_save(manifest);
+    jessi_patch_manifest_free(manifest);
+
+    if (count > 0) {
+        JESSI_TXM_LOG("[JESSI] Patched %d JVM dylib(s), checked %lu, %lu unchanged since last launch\n",
+                      patchedCount, (unsigned long)count, (unsigned long)skipped);
     }
 }
 
@@ -521,11 +489,75 @@ static void jessi_preflight_jvm_dylibs_if_needed(NSString *javaHome) {
 }
 
 static mach_port_t jessi_exc_port = MACH_PORT_NULL;
-static volatile uint64_t jessi_hw_redirect_orig[6] = {0};
-static volatile uint64_t jessi_hw_redirect_target[6] = {0};
-static volatile uint64_t jessi_hw_redirect_hit_count = 0;
+
+#define JESSI_HW_REDIRECT_MAX 6
+#define JESSI_HW_LATENCY_BUCKETS 8
+
+// Bucket i counts handling times below 1us * 4^i; the last bucket is open-ended.
+static const char *const jessi_hw_latency_labels[JESSI_HW_LATENCY_BUCKETS] = {
+    "<1us", "<4us", "<16us", "<64us", "<256us", "<1ms", "<4ms", ">=4ms",
+};
+
+typedef struct {
+    volatile uint64_t orig;
+    volatile uint64_t target;
+    volatile uint64_t hits;
+    volatile uint64_t totalNs;
+    volatile uint64_t maxNs;
+    volatile uint64_t latency[JESSI_HW_LATENCY_BUCKETS];
+} jessi_hw_redirect;
+
+// Slots are filled once and published by bumping the count with release order, so the
+// exception handler reads them without a lock. Registration itself is serialized.
+static jessi_hw_redirect jessi_hw_redirects[JESSI_HW_REDIRECT_MAX];
+static volatile uint32_t jessi_hw_redirect_count = 0;
+static os_unfair_lock jessi_hw_redirect_lock = OS_UNFAIR_LOCK_INIT;
 static volatile uint64_t jessi_hw_redirect_miss_count = 0;
 
+static uint32_t jessi_hw_redirects_published(void) {
+    return __atomic_load_n(&jessi_hw_redirect_count, __ATOMIC_ACQUIRE);
+}
+
+static void jessi_hw_redirect_totals(uint64_t *hits, uint64_t *misses) {
+    uint64_t sum = 0;
+    uint32_t count = jessi_hw_redirects_published();
+    for (uint32_t i = 0; i < count; i++) sum += __atomic_load_n(&jessi_hw_redirects[i].hits, __ATOMIC_RELAXED);
+    if (hits) *hits = sum;
+    if (misses) *misses = __atomic_load_n(&jessi_hw_redirect_miss_count, __ATOMIC_RELAXED);
+}
+
+static void jessi_hw_redirect_record(jessi_hw_redirect *r, uint64_t ns) {
+    size_t bucket = 0;
+    for (uint64_t limit = 1000; bucket < JESSI_HW_LATENCY_BUCKETS - 1 && ns >= limit; limit *= 4) bucket++;
+    __atomic_fetch_add(&r->hits, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&r->totalNs, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&r->latency[bucket], 1, __ATOMIC_RELAXED);
+    uint64_t seen = __atomic_load_n(&r->maxNs, __ATOMIC_RELAXED);
+    while (ns > seen && !__atomic_compare_exchange_n(&r->maxNs, &seen, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void jessi_hw_redirect_dump(const char *stage) {
+    uint32_t count = jessi_hw_redirects_published();
+    if (count == 0) return;
+    for (uint32_t i = 0; i < count; i++) {
+        const jessi_hw_redirect *r = &jessi_hw_redirects[i];
+        uint64_t hits = __atomic_load_n(&r->hits, __ATOMIC_RELAXED);
+        uint64_t totalNs = __atomic_load_n(&r->totalNs, __ATOMIC_RELAXED);
+        NSMutableString *histogram = [NSMutableString string];
+        for (int b = 0; b < JESSI_HW_LATENCY_BUCKETS; b++) {
+            uint64_t n = __atomic_load_n(&r->latency[b], __ATOMIC_RELAXED);
+            if (n) [histogram appendFormat:@" %s=%llu", jessi_hw_latency_labels[b], (unsigned long long)n];
+        }
+        NSLog(@"[JESSI] [HWBypass] stage=%s site=%u orig=%p target=%p hits=%llu avg_us=%.1f max_us=%.1f%@",
+              stage, i, (void *)r->orig, (void *)r->target, (unsigned long long)hits,
+              hits ? (double)totalNs / (double)hits / 1e3 : 0.0,
+              (double)__atomic_load_n(&r->maxNs, __ATOMIC_RELAXED) / 1e3, histogram);
+    }
+    NSLog(@"[JESSI] [HWBypass] stage=%s misses=%llu", stage,
+          (unsigned long long)__atomic_load_n(&jessi_hw_redirect_miss_count, __ATOMIC_RELAXED));
+}
+
 static void *jessi_exc_server_thread(void *unused) {
     (void)unused;
     if (jessi_exc_port == MACH_PORT_NULL) return NULL;
@@ -555,15 +587,22 @@ static void jessi_ensure_exc_server_started(void) {
 
 static BOOL jessi_register_hw_redirect(uint64_t orig, uint64_t target) {
     if (!orig || !target) return NO;
-    for (int i = 0; i < 6; i++) {
-        if (jessi_hw_redirect_orig[i] == orig) return YES;
-        if (jessi_hw_redirect_orig[i] == 0) {
-            jessi_hw_redirect_orig[i] = orig;
-            jessi_hw_redirect_target[i] = target;
-            return YES;
-        }
-    }
-    return NO;
+    BOOL ok = NO;
+    os_unfair_lock_lock(&jessi_hw_redirect_lock);
+    uint32_t count = jessi_hw_redirect_count;
+    for (uint32_t i = 0; i < count && !ok; i++) {
+        if (jessi_hw_redirects[i].orig == orig) ok = YES;
+    }
+    if (!ok && count < JESSI_HW_REDIRECT_MAX) {
+        jessi_hw_redirect *r = &jessi_hw_redirects[count];
+        memset((void *)r, 0, sizeof(*r));
+        r->orig = orig;
+        r->target = target;
+        __atomic_store_n(&jessi_hw_redirect_count, count + 1, __ATOMIC_RELEASE);
+        ok = YES;
+    }
+    os_unfair_lock_unlock(&jessi_hw_redirect_lock);
+    return ok;
 }
 
 static BOOL jessi_setup_hw_breakpoint_bypass(uint8_t *mmapSite, uint8_t *fcntlSite) {
@@ -583,61 +622,86 @@ static BOOL jessi_setup_hw_breakpoint_bypass(uint8_t *mmapSite, uint8_t *fcntlSi
     return any;
 }
 
+// What a thread had before it was armed, restored by jessi_disarm_hw_breakpoints.
+typedef struct {
+    BOOL armed;
+    uint32_t armedCount;
+    arm_debug_state64_t origDebugState;
+    mach_msg_type_number_t masksCnt;
+    exception_mask_t masks[32];
+    exception_handler_t handlers[32];
+    exception_behavior_t behaviors[32];
+    thread_state_flavor_t flavors[32];
+} jessi_hw_thread_arming;
+
+static __thread jessi_hw_thread_arming jessi_hw_arming;
+
+static void jessi_apply_hw_debug_state(mach_port_t thread, uint32_t count) {
+    arm_debug_state64_t hookDebugState = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        hookDebugState.__bvr[i] = jessi_hw_redirects[i].orig;
+        
+        hookDebugState.__bcr[i] = 0x1e5;
+    }
+    thread_set_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&hookDebugState, ARM_DEBUG_STATE64_COUNT);
+    jessi_hw_arming.armedCount = count;
+}
+
+// The calling thread keeps its breakpoints and exception port between calls, so the preflight
+// dlopens, libjli and JLI_Launch all run on one arming. Breakpoints registered later are added.
 static void *jessi_run_with_hw_breakpoints(void *(*fn)(void *), void *ctx) {
     if (!fn) return NULL;
 
-    
-    if (jessi_hw_redirect_orig[0] == 0 || jessi_exc_port == MACH_PORT_NULL) {
+    uint32_t count = jessi_hw_redirects_published();
+    if (count == 0 || jessi_exc_port == MACH_PORT_NULL) {
+        return fn(ctx);
+    }
+
+    if (jessi_hw_arming.armed) {
+        if (jessi_hw_arming.armedCount != count) {
+            mach_port_t thread = mach_thread_self();
+            jessi_apply_hw_debug_state(thread, count);
+            mach_port_deallocate(mach_task_self(), thread);
+        }
         return fn(ctx);
     }
 
-    JESSI_TXM_LOG("[JESSI] HW breakpoint trampoline enter (exc_port=%u)\n", jessi_exc_port);
+    JESSI_TXM_LOG("[JESSI] HW breakpoints arming thread (exc_port=%u)\n", jessi_exc_port);
 
     mach_port_t thread = mach_thread_self();
 
-    
-    arm_debug_state64_t origDebugState = {0};
     mach_msg_type_number_t origDebugCount = ARM_DEBUG_STATE64_COUNT;
-    thread_get_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&origDebugState, &origDebugCount);
+    thread_get_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&jessi_hw_arming.origDebugState, &origDebugCount);
 
-    
-    exception_mask_t masks[32];
-    mach_msg_type_number_t masksCnt = 32;
-    exception_handler_t handlers[32];
-    exception_behavior_t behaviors[32];
-    thread_state_flavor_t flavors[32];
-    thread_get_exception_ports(thread, EXC_MASK_BREAKPOINT, masks, &masksCnt, handlers, behaviors, flavors);
+    jessi_hw_arming.masksCnt = 32;
+    thread_get_exception_ports(thread, EXC_MASK_BREAKPOINT, jessi_hw_arming.masks, &jessi_hw_arming.masksCnt,
+                               jessi_hw_arming.handlers, jessi_hw_arming.behaviors, jessi_hw_arming.flavors);
 
-    
     thread_set_exception_ports(thread, EXC_MASK_BREAKPOINT, jessi_exc_port,
                                EXCEPTION_STATE | MACH_EXCEPTION_CODES,
                                ARM_THREAD_STATE64);
 
-    
-    arm_debug_state64_t hookDebugState = {0};
-    for (int i = 0; i < 6 && jessi_hw_redirect_orig[i]; i++) {
-        hookDebugState.__bvr[i] = (uint64_t)jessi_hw_redirect_orig[i];
-        
-        hookDebugState.__bcr[i] = 0x1e5;
-    }
-    thread_set_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&hookDebugState, ARM_DEBUG_STATE64_COUNT);
+    jessi_apply_hw_debug_state(thread, count);
+    jessi_hw_arming.armed = YES;
+    mach_port_deallocate(mach_task_self(), thread);
 
-    void *result = fn(ctx);
+    return fn(ctx);
+}
 
-    
-    thread_set_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&origDebugState, ARM_DEBUG_STATE64_COUNT);
+static void jessi_disarm_hw_breakpoints(void) {
+    if (!jessi_hw_arming.armed) return;
 
-    
-    for (mach_msg_type_number_t i = 0; i < masksCnt; i++) {
-        thread_set_exception_ports(thread, masks[i], handlers[i], behaviors[i], flavors[i]);
-        mach_port_deallocate(mach_task_self(), handlers[i]);
+    mach_port_t thread = mach_thread_self();
+    thread_set_state(thread, ARM_DEBUG_STATE64, (thread_state_t)&jessi_hw_arming.origDebugState, ARM_DEBUG_STATE64_COUNT);
+    for (mach_msg_type_number_t i = 0; i < jessi_hw_arming.masksCnt; i++) {
+        thread_set_exception_ports(thread, jessi_hw_arming.masks[i], jessi_hw_arming.handlers[i],
+                                   jessi_hw_arming.behaviors[i], jessi_hw_arming.flavors[i]);
+        mach_port_deallocate(mach_task_self(), jessi_hw_arming.handlers[i]);
     }
-
     mach_port_deallocate(mach_task_self(), thread);
+    memset(&jessi_hw_arming, 0, sizeof(jessi_hw_arming));
 
-    JESSI_TXM_LOG("[JESSI] HW breakpoint trampoline exit\n");
-
-    return result;
+    JESSI_TXM_LOG("[JESSI] HW breakpoints disarmed\n");
 }
 
 kern_return_t catch_mach_exception_raise(mach_port_t exception_port,
@@ -663,6 +727,7 @@ kern_return_t catch_mach_exception_raise_state(mach_port_t exception_port,
     (void)code;
     (void)codeCnt;
 
+    uint64_t startNs = jessi_launch_trace_now_ns();
     if (!flavor || !old_state || !new_state || !new_stateCnt) return KERN_FAILURE;
     if (*flavor != ARM_THREAD_STATE64) return KERN_FAILURE;
     if (old_stateCnt < ARM_THREAD_STATE64_COUNT) return KERN_FAILURE;
@@ -675,17 +740,17 @@ kern_return_t catch_mach_exception_raise_state(mach_port_t exception_port,
     if (exception != EXC_BREAKPOINT) return KERN_FAILURE;
 
     uint64_t pc = arm_thread_state64_get_pc(*newTS);
-    JESSI_TXM_LOG("[JESSI] EXC_BREAKPOINT at pc=%p (codeCnt=%u)\n", (void *)pc, (unsigned)codeCnt);
-    for (int i = 0; i < 6 && jessi_hw_redirect_orig[i]; i++) {
-        if (pc == (uint64_t)jessi_hw_redirect_orig[i]) {
-            JESSI_TXM_LOG("[JESSI] Redirecting breakpoint %d to %p\n", i, (void *)jessi_hw_redirect_target[i]);
-            jessi_hw_redirect_hit_count++;
-            arm_thread_state64_set_pc_fptr(*newTS, (void *)jessi_hw_redirect_target[i]);
+    uint32_t count = jessi_hw_redirects_published();
+    for (uint32_t i = 0; i < count; i++) {
+        jessi_hw_redirect *r = &jessi_hw_redirects[i];
+        if (pc == r->orig) {
+            arm_thread_state64_set_pc_fptr(*newTS, (void *)r->target);
+            jessi_hw_redirect_record(r, jessi_launch_trace_now_ns() - startNs);
             return KERN_SUCCESS;
         }
     }
-    jessi_hw_redirect_miss_count++;
-    JESSI_TXM_LOG("[JESSI] Breakpoint PC did not match registered targets\n");
+    __atomic_fetch_add(&jessi_hw_redirect_miss_count, 1, __ATOMIC_RELAXED);
+    JESSI_TXM_LOG("[JESSI] EXC_BREAKPOINT at pc=%p did not match registered targets\n", (void *)pc);
     return KERN_FAILURE;
 }
 
@@ -791,14 +856,269 @@ static bool jessi_write_abs_branch_stub_mirrored(void *patchAddr, void *target)
     return true;
 }
 
-static uint8_t *jessi_find_signature(uint8_t *base, const uint8_t *sig, size_t sigLen) {
-    if (!base || !sig || sigLen == 0) return NULL;
-    for (size_t off = 0; off + sigLen < 0x80000; off += 4) {
-        if (base[off] == sig[0] && memcmp(base + off, sig, sigLen) == 0) {
-            return base + off;
+static const size_t jessi_dyld_scan_len = 0x80000;
+
+static NSString *jessi_dyld_site_cache_path(void) {
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    return [(caches.length ? caches : NSTemporaryDirectory()) stringByAppendingPathComponent:@"jessi-dyld-sites.txt"];
+}
+
+// Both bypass sites come from one pass over dyld's text. The offsets are cached per dyld UUID,
+// so after the first launch on an OS build this is a byte comparison instead of a scan.
+static void jessi_find_dyld_bypass_sites(uint8_t *base, uint8_t **mmapSite, uint8_t **fcntlSite) {
+    *mmapSite = NULL;
+    *fcntlSite = NULL;
+    if (!base) return;
+
+    const jessi_sig_pattern patterns[2] = {
+        { jessi_dyld_mmap_sig, sizeof(jessi_dyld_mmap_sig) },
+        { jessi_dyld_fcntl_sig, sizeof(jessi_dyld_fcntl_sig) },
+    };
+    size_t offsets[2];
+    uint8_t uuid[16];
+    const char *cachePath = jessi_dyld_site_cache_path().fileSystemRepresentation;
+    BOOL haveUUID = jessi_macho_image_uuid(base, uuid) == 0;
+    BOOL cached = haveUUID &&
+                  jessi_sig_cache_load(cachePath, uuid, patterns, 2, offsets) == 0 &&
+                  jessi_sig_verify(base, jessi_dyld_scan_len, patterns, 2, offsets);
+    if (!cached) {
+        jessi_sig_scan(base, jessi_dyld_scan_len, patterns, 2, offsets);
+        if (haveUUID) jessi_sig_cache_store(cachePath, uuid, patterns, 2, offsets);
+    }
+    JESSI_TXM_LOG("[JESSI] dyld bypass sites %s\n", cached ? "from cache" : "scanned");
+
+    if (offsets[0] != JESSI_SIG_NOT_FOUND) *mmapSite = base + offsets[0];
+    if (offsets[1] != JESSI_SIG_NOT_FOUND) *fcntlSite = base + offsets[1];
+}
+
+// Executable file mappings the anonymous fallback already materialized. A later request for the
+// same bytes in this process (a dlopen after dlclose, an in-app tool run then server start)
+// shares the prepared pages instead of copying and preparing again. This only happens on non-TXM
+// devices; TXM devices and spawned JVMs (restarts included) start each process with an empty cache.
+// The cache keeps its own alias of each region, so dyld unmapping its copy (dlclose) or another
+// image landing at that address never changes what a hit hands out. The key is the file's
+// identity (device, inode, size, mtime, ctime) plus a fingerprint of the range's first and last
+// pages, recomputed from the file on every lookup, so a replaced or rewritten image misses.
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    off_t offset;
+    size_t len;
+    off_t size;
+    int64_t mtimeSec;
+    int64_t mtimeNsec;
+    int64_t ctimeSec;
+    int64_t ctimeNsec;
+    uint64_t fingerprint;
+    void *region;
+} jessi_exec_mapping;
+
+#define JESSI_EXEC_MAPPING_CACHE_MAX 64
+#define JESSI_EXEC_FINGERPRINT_SPAN 4096
+static jessi_exec_mapping jessi_exec_mappings[JESSI_EXEC_MAPPING_CACHE_MAX];
+static size_t jessi_exec_mapping_next = 0;
+static os_unfair_lock jessi_exec_mapping_lock = OS_UNFAIR_LOCK_INIT;
+
+static volatile uint64_t jessi_exec_map_materialized = 0;
+static volatile uint64_t jessi_exec_map_reused = 0;
+static volatile uint64_t jessi_exec_map_bytes_copied = 0;
+static volatile uint64_t jessi_exec_map_copy_ns = 0;
+static volatile uint64_t jessi_exec_map_prepare_ns = 0;
+
+static uint64_t jessi_exec_fnv1a(uint64_t h, const uint8_t *bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// FNV-1a over the first and last page of the range. Headers, load commands and the code
+// signature's tail change with any rebuild, so this separates images that share an inode.
+static BOOL jessi_exec_mapping_fingerprint(int fd, off_t offset, size_t len, uint64_t *out) {
+    uint8_t buf[JESSI_EXEC_FINGERPRINT_SPAN];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t head = MIN(len, (size_t)JESSI_EXEC_FINGERPRINT_SPAN);
+    if (pread(fd, buf, head, offset) != (ssize_t)head) return NO;
+    h = jessi_exec_fnv1a(h, buf, head);
+    if (len > head) {
+        size_t tail = MIN(len - head, (size_t)JESSI_EXEC_FINGERPRINT_SPAN);
+        if (pread(fd, buf, tail, offset + (off_t)(len - tail)) != (ssize_t)tail) return NO;
+        h = jessi_exec_fnv1a(h, buf, tail);
+    }
+    *out = h;
+    return YES;
+}
+
+static BOOL jessi_exec_mapping_key(int fd, off_t offset, size_t len, jessi_exec_mapping *out) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return NO;
+    if (offset < 0 || (off_t)len > st.st_size - offset) return NO;
+    memset(out, 0, sizeof(*out));
+    out->dev = st.st_dev;
+    out->ino = st.st_ino;
+    out->offset = offset;
+    out->len = len;
+    out->size = st.st_size;
+    out->mtimeSec = (int64_t)st.st_mtimespec.tv_sec;
+    out->mtimeNsec = (int64_t)st.st_mtimespec.tv_nsec;
+    out->ctimeSec = (int64_t)st.st_ctimespec.tv_sec;
+    out->ctimeNsec = (int64_t)st.st_ctimespec.tv_nsec;
+    return jessi_exec_mapping_fingerprint(fd, offset, len, &out->fingerprint);
+}
+
+static BOOL jessi_exec_mapping_same_key(const jessi_exec_mapping *a, const jessi_exec_mapping *b) {
+    return a->dev == b->dev && a->ino == b->ino && a->offset == b->offset && a->len == b->len &&
+           a->size == b->size && a->mtimeSec == b->mtimeSec && a->mtimeNsec == b->mtimeNsec &&
+           a->ctimeSec == b->ctimeSec && a->ctimeNsec == b->ctimeNsec && a->fingerprint == b->fingerprint;
+}
+
+// The alias is ours alone, but check it is still mapped executable in full before sharing it.
+static BOOL jessi_exec_region_alive(void *region, size_t len) {
+    vm_address_t address = (vm_address_t)region;
+    vm_size_t size = 0;
+    vm_region_basic_info_data_64_t info;
+    mach_msg_type_number_t count = VM_REGION_BASIC_INFO_COUNT_64;
+    mach_port_t object = MACH_PORT_NULL;
+    kern_return_t kr = vm_region_64(mach_task_self(), &address, &size, VM_REGION_BASIC_INFO_64,
+                                    (vm_region_info_t)&info, &count, &object);
+    if (kr != KERN_SUCCESS) return NO;
+    return address <= (vm_address_t)region &&
+           (vm_address_t)region + len <= address + size &&
+           (info.protection & VM_PROT_EXECUTE);
+}
+
+static void *jessi_exec_mapping_remap(void *cached, void *addr, size_t len, int prot, int flags);
+
+// Shares a cached region at addr, under the lock so a concurrent store can't release it midway.
+// MAP_FAILED on a miss.
+static void *jessi_exec_mapping_share(const jessi_exec_mapping *key, void *addr, int prot, int flags) {
+    void *shared = MAP_FAILED;
+    os_unfair_lock_lock(&jessi_exec_mapping_lock);
+    for (size_t i = 0; i < JESSI_EXEC_MAPPING_CACHE_MAX; i++) {
+        void *region = jessi_exec_mappings[i].region;
+        if (region && jessi_exec_mapping_same_key(&jessi_exec_mappings[i], key)) {
+            if (jessi_exec_region_alive(region, key->len)) {
+                shared = jessi_exec_mapping_remap(region, addr, key->len, prot, flags);
+            }
+            break;
         }
     }
-    return NULL;
+    os_unfair_lock_unlock(&jessi_exec_mapping_lock);
+    return shared;
+}
+
+// Takes a cache-owned alias of the freshly materialized region; an evicted entry's alias is released.
+static void jessi_exec_mapping_store(const jessi_exec_mapping *key, void *region) {
+    vm_address_t alias = 0;
+    vm_prot_t curProt = 0, maxProt = 0;
+    kern_return_t kr = vm_remap(mach_task_self(), &alias, (vm_size_t)key->len, 0, VM_FLAGS_ANYWHERE,
+                                mach_task_self(), (vm_address_t)region, false, &curProt, &maxProt, VM_INHERIT_NONE);
+    if (kr != KERN_SUCCESS) return;
+
+    jessi_exec_mapping evicted = { 0 };
+    os_unfair_lock_lock(&jessi_exec_mapping_lock);
+    jessi_exec_mapping *slot = NULL;
+    for (size_t i = 0; i < JESSI_EXEC_MAPPING_CACHE_MAX && !slot; i++) {
+        if (jessi_exec_mappings[i].region && jessi_exec_mapping_same_key(&jessi_exec_mappings[i], key)) slot = &jessi_exec_mappings[i];
+    }
+    if (!slot) {
+        slot = &jessi_exec_mappings[jessi_exec_mapping_next];
+        jessi_exec_mapping_next = (jessi_exec_mapping_next + 1) % JESSI_EXEC_MAPPING_CACHE_MAX;
+    }
+    evicted = *slot;
+    *slot = *key;
+    slot->region = (void *)alias;
+    os_unfair_lock_unlock(&jessi_exec_mapping_lock);
+
+    if (evicted.region) vm_deallocate(mach_task_self(), (vm_address_t)evicted.region, (vm_size_t)evicted.len);
+}
+
+// Shares the pages of an already prepared region at the address dyld asked for.
+static void *jessi_exec_mapping_remap(void *cached, void *addr, size_t len, int prot, int flags) {
+    vm_address_t target = (vm_address_t)addr;
+    int vmFlags = (flags & MAP_FIXED) ? (VM_FLAGS_FIXED | VM_FLAGS_OVERWRITE) : VM_FLAGS_ANYWHERE;
+    vm_prot_t curProt = 0, maxProt = 0;
+    kern_return_t kr = vm_remap(mach_task_self(), &target, (vm_size_t)len, 0, vmFlags,
+                                mach_task_self(), (vm_address_t)cached, false, &curProt, &maxProt, VM_INHERIT_COPY);
+    if (kr != KERN_SUCCESS) return MAP_FAILED;
+    if ((curProt & (vm_prot_t)prot) != (vm_prot_t)prot) {
+        vm_deallocate(mach_task_self(), target, (vm_size_t)len);
+        return MAP_FAILED;
+    }
+    if (curProt != (vm_prot_t)prot) (void)vm_protect(mach_task_self(), target, (vm_size_t)len, NO, (vm_prot_t)prot);
+    return (void *)target;
+}
+
+#define JESSI_EXEC_COPY_CHUNK (4u * 1024u * 1024u)
+
+// Large segments (libjvm text is tens of MB) are copied in 4 MB chunks across cores.
+static BOOL jessi_exec_mapping_copy(uint8_t *dst, int fd, off_t offset, size_t len) {
+    size_t chunks = (len + JESSI_EXEC_COPY_CHUNK - 1) / JESSI_EXEC_COPY_CHUNK;
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+
+    void *fileMap = __mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, offset);
+    if (fileMap != MAP_FAILED) {
+        const uint8_t *src = (const uint8_t *)fileMap;
+        if (chunks <= 1) {
+            memcpy(dst, src, len);
+        } else {
+            dispatch_apply(chunks, queue, ^(size_t i) {
+                size_t start = i * JESSI_EXEC_COPY_CHUNK;
+                memcpy(dst + start, src + start, MIN((size_t)JESSI_EXEC_COPY_CHUNK, len - start));
+            });
+        }
+        munmap(fileMap, len);
+        return YES;
+    }
+
+    __block size_t total = 0;
+    __block BOOL shortRead = NO;
+    dispatch_apply(chunks, queue, ^(size_t i) {
+        size_t start = i * JESSI_EXEC_COPY_CHUNK;
+        size_t want = MIN((size_t)JESSI_EXEC_COPY_CHUNK, len - start);
+        size_t got = 0;
+        while (got < want) {
+            ssize_t n = pread(fd, dst + start + got, want - got, offset + (off_t)(start + got));
+            if (n <= 0) break;
+            got += (size_t)n;
+        }
+        if (got < want) {
+            memset(dst + start + got, 0, want - got);
+            shortRead = YES;
+        }
+        __atomic_fetch_add(&total, got, __ATOMIC_RELAXED);
+    });
+    if (shortRead) {
+        JESSI_TXM_LOG("[JESSI] hooked_mmap short read fd=%d off=%lld len=%zu got=%zu\n", fd, (long long)offset, len, total);
+    }
+    return total > 0;
+}
+
+static void jessi_exec_mapping_stats(uint64_t *materialized, uint64_t *reused, uint64_t *bytesCopied, uint64_t *copyNs, uint64_t *prepareNs) {
+    if (materialized) *materialized = __atomic_load_n(&jessi_exec_map_materialized, __ATOMIC_RELAXED);
+    if (reused) *reused = __atomic_load_n(&jessi_exec_map_reused, __ATOMIC_RELAXED);
+    if (bytesCopied) *bytesCopied = __atomic_load_n(&jessi_exec_map_bytes_copied, __ATOMIC_RELAXED);
+    if (copyNs) *copyNs = __atomic_load_n(&jessi_exec_map_copy_ns, __ATOMIC_RELAXED);
+    if (prepareNs) *prepareNs = __atomic_load_n(&jessi_exec_map_prepare_ns, __ATOMIC_RELAXED);
+}
+
+static void jessi_log_exec_mapping_stats(const char *stage) {
+    uint64_t materialized = 0, reused = 0, bytes = 0, copyNs = 0, prepareNs = 0;
+    jessi_exec_mapping_stats(&materialized, &reused, &bytes, &copyNs, &prepareNs);
+    if (materialized == 0 && reused == 0) return;
+    NSLog(@"[JESSI] [DyldBypass] stage=%s materialized=%llu reused=%llu copied_mb=%.1f copy_ms=%.1f prepare_ms=%.1f",
+          stage, (unsigned long long)materialized, (unsigned long long)reused,
+          (double)bytes / (1024.0 * 1024.0), (double)copyNs / 1e6, (double)prepareNs / 1e6);
+
+    jessi_jit_prep_stats prep;
+    jessi_jit_prep_get_stats(jessi_jit26_prep(), &prep);
+    if (prep.calls == 0) return;
+    NSLog(@"[JESSI] [JIT26] stage=%s calls=%llu failed=%llu prepared_mb=%.1f total_ms=%.1f avg_ms=%.2f max_ms=%.2f last_ms=%.2f chunk_kb=%zu fixed_ms=%.2f ms_per_mb=%.2f",
+          stage, (unsigned long long)prep.calls, (unsigned long long)prep.failed_calls,
+          (double)prep.bytes / (1024.0 * 1024.0), (double)prep.total_ns / 1e6,
+          (double)prep.total_ns / 1e6 / (double)prep.calls, (double)prep.max_call_ns / 1e6,
+          (double)prep.last_call_ns / 1e6, prep.chunk >> 10, prep.fixed_ns / 1e6, prep.ns_per_mb / 1e6);
 }
 
 static void* jessi_hooked_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset) {
@@ -830,6 +1150,19 @@ static void* jessi_hooked_mmap(void *addr, size_t len, int prot, int flags, int
         if (s_mmap_calls <= 20 || (s_mmap_calls % 100 == 0)) {
             JESSI_TXM_LOG("[JESSI] hooked_mmap __mmap failed errno=%d, trying anon fallback\n", errno);
         }
+        jessi_exec_mapping key;
+        BOOL haveKey = jessi_exec_mapping_key(fd, offset, len, &key);
+        // TXM grants execute per prepared address range, so sharing pages into a new range only works without it.
+        BOOL reusable = haveKey && !s_requiresTxm;
+        void *shared = reusable ? jessi_exec_mapping_share(&key, addr, prot, flags) : MAP_FAILED;
+        if (shared != MAP_FAILED) {
+            __atomic_fetch_add(&jessi_exec_map_reused, 1, __ATOMIC_RELAXED);
+            JESSI_TXM_LOG("[JESSI] hooked_mmap reused prepared mapping -> %p len=%zu\n", shared, len);
+            return shared;
+        }
+
+        uint64_t prepareStartNs = jessi_launch_trace_now_ns();
+        uint64_t prepareNs = 0;
         map = __mmap(addr, len, prot, flags | MAP_PRIVATE | MAP_ANON, 0, 0);
         if (map != MAP_FAILED) {
             if (s_requiresTxm) {
@@ -846,6 +1179,7 @@ static void* jessi_hooked_mmap(void *addr, size_t len, int prot, int flags, int
                     JESSI_TXM_LOG("[JESSI] hooked_mmap TXM prepare done\n");
                 }
             }
+            prepareNs = jessi_launch_trace_now_ns() - prepareStartNs;
             vm_address_t mirrored = 0;
             vm_prot_t curProt = 0, maxProt = 0;
             kern_return_t ret = vm_remap(mach_task_self(), &mirrored, (vm_size_t)len, 0, VM_FLAGS_ANYWHERE,
@@ -869,29 +1203,11 @@ static void* jessi_hooked_mmap(void *addr, size_t len, int prot, int flags, int
                 return MAP_FAILED;
             }
 
-            BOOL copied = NO;
-            void *fileMap = __mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, offset);
-            if (fileMap != MAP_FAILED) {
-                memcpy((void *)mirrored, fileMap, len);
-                munmap(fileMap, len);
-                copied = YES;
-            } else {
-                uint8_t *dst = (uint8_t *)mirrored;
-                size_t total = 0;
-                while (total < len) {
-                    ssize_t n = pread(fd, dst + total, len - total, offset + (off_t)total);
-                    if (n <= 0) break;
-                    total += (size_t)n;
-                }
-                if (total > 0) {
-                    if (total < len) {
-                        memset(dst + total, 0, len - total);
-                    }
-                    copied = YES;
-                }
-                if (!copied) {
-                    JESSI_TXM_LOG("[JESSI] hooked_mmap ERROR: failed to source bytes (mmap+pread) fd=%d off=%lld len=%zu errno=%d\n", fd, (long long)offset, len, errno);
-                }
+            uint64_t copyStartNs = jessi_launch_trace_now_ns();
+            BOOL copied = jessi_exec_mapping_copy((uint8_t *)mirrored, fd, offset, len);
+            uint64_t copyNs = jessi_launch_trace_now_ns() - copyStartNs;
+            if (!copied) {
+                JESSI_TXM_LOG("[JESSI] hooked_mmap ERROR: failed to source bytes (mmap+pread) fd=%d off=%lld len=%zu errno=%d\n", fd, (long long)offset, len, errno);
             }
 
             vm_deallocate(mach_task_self(), mirrored, (vm_size_t)len);
@@ -902,6 +1218,15 @@ static void* jessi_hooked_mmap(void *addr, size_t len, int prot, int flags, int
                 return MAP_FAILED;
             }
 
+            __atomic_fetch_add(&jessi_exec_map_materialized, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&jessi_exec_map_bytes_copied, (uint64_t)len, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&jessi_exec_map_copy_ns, copyNs, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&jessi_exec_map_prepare_ns, prepareNs, __ATOMIC_RELAXED);
+            JESSI_TXM_LOG("[JESSI] hooked_mmap materialized len=%zu copy=%.2f ms prepare=%.2f ms (total %llu MB)\n",
+                          len, (double)copyNs / 1e6, (double)prepareNs / 1e6,
+                          (unsigned long long)(__atomic_load_n(&jessi_exec_map_bytes_copied, __ATOMIC_RELAXED) >> 20));
+            if (reusable) jessi_exec_mapping_store(&key, map);
+
             if (offset == 0 && len >= sizeof(uint32_t)) {
                 uint32_t magic = *(volatile uint32_t *)map;
                 if (magic != MH_MAGIC && magic != MH_MAGIC_64 && magic != FAT_MAGIC && magic != FAT_CIGAM && magic != FAT_MAGIC_64 && magic != FAT_CIGAM_64) {
@@ -978,8 +1303,9 @@ static void jessi_init_dyld_validation_bypass_if_needed(void) {
         }
 
         uint8_t *base = (uint8_t *)dyld;
-        uint8_t *mmapSite = jessi_find_signature(base, jessi_dyld_mmap_sig, sizeof(jessi_dyld_mmap_sig));
-        uint8_t *fcntlSite = jessi_find_signature(base, jessi_dyld_fcntl_sig, sizeof(jessi_dyld_fcntl_sig));
+        uint8_t *mmapSite = NULL;
+        uint8_t *fcntlSite = NULL;
+        jessi_find_dyld_bypass_sites(base, &mmapSite, &fcntlSite);
         JESSI_TXM_LOG("[JESSI] dyld base=%p mmapSig=%p fcntlSig=%p\n", base, mmapSite, fcntlSite);
 
         if (ios18OrEarlier) {
@@ -989,7 +1315,7 @@ static void jessi_init_dyld_validation_bypass_if_needed(void) {
         }
 
     if (ios26OrLater) {
-        BOOL txmSupport = [JessiSettings shared].txmSupport;
+        BOOL txmSupport = [JessiSettings current].txmSupport;
         if (!txmSupport) {
             JESSI_TXM_LOG("[JESSI] TXM Support disabled in settings; skipping iOS 26 dyld/JIT bypass init.\n");
             return;
@@ -1208,95 +1534,6 @@ static void jessi_debug_dump_launch_state(NSString *mode,
     }
 }
 
-static NSArray<NSString *> *jessi_filter_extra_jvm_args(NSArray<NSString *> *args, BOOL ios26OrLater, BOOL isJava17Plus) {
-    if (args.count == 0) return args;
-
-    NSMutableArray<NSString *> *out = [NSMutableArray arrayWithCapacity:args.count];
-    for (NSString *arg in args) {
-        if (arg.length == 0) continue;
-
-        
-        if (!ios26OrLater) {
-            if ([arg rangeOfString:@"MirrorMappedCodeCache"].location != NSNotFound) continue;
-            if ([arg isEqualToString:@"-Xverify:none"]) continue;
-            if ([arg isEqualToString:@"-XX:-UseCompressedOops"]) continue;
-            if ([arg isEqualToString:@"-XX:-UseCompressedClassPointers"]) continue;
-        }
-
-        
-        if (!isJava17Plus && [arg rangeOfString:@"MirrorMappedCodeCache"].location != NSNotFound) {
-            continue;
-        }
-
-        [out addObject:arg];
-    }
-    return out;
-}
-
-static BOOL jessi_args_contain_prefix(NSArray<NSString *> *args, NSString *prefix) {
-    if (args.count == 0 || prefix.length == 0) return NO;
-    for (NSString *arg in args) {
-        if ([arg hasPrefix:prefix]) return YES;
-    }
-    return NO;
-}
-
-static NSString *bundleJavaHomeForVersion(NSString *javaVersion) {
-    if (jessi_is_running_on_macos()) {
-        NSString *requested = javaVersion.length ? javaVersion : @"21";
-        NSString *cmd = [NSString stringWithFormat:@"/usr/libexec/java_home -v %@ 2>/dev/null", requested];
-        FILE *fp = popen(cmd.UTF8String, "r");
-        if (fp) {
-            char buf[PATH_MAX] = {0};
-            if (fgets(buf, sizeof(buf), fp)) {
-                pclose(fp);
-                NSString *home = [[NSString stringWithUTF8String:buf ?: ""] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-                if (home.length > 0 && [[NSFileManager defaultManager] fileExistsAtPath:home]) {
-                    return home;
-                }
-            } else {
-                pclose(fp);
-            }
-        }
-
-        // Fallback to macOS default Java if the exact requested major version is unavailable.
-        FILE *defaultFp = popen("/usr/libexec/java_home 2>/dev/null", "r");
-        if (defaultFp) {
-            char buf[PATH_MAX] = {0};
-            if (fgets(buf, sizeof(buf), defaultFp)) {
-                pclose(defaultFp);
-                NSString *home = [[NSString stringWithUTF8String:buf ?: ""] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-                if (home.length > 0 && [[NSFileManager defaultManager] fileExistsAtPath:home]) {
-                    return home;
-                }
-            } else {
-                pclose(defaultFp);
-            }
-        }
-
-        return nil;
-    }
-
-    NSString *bundleRoot = [[NSBundle mainBundle] bundlePath];
-
-    NSString *versioned = [bundleRoot stringByAppendingPathComponent:[NSString stringWithFormat:@"java%@", javaVersion]];
-    if ([[NSFileManager defaultManager] fileExistsAtPath:versioned]) return versioned;
-
-    NSString *generic = [bundleRoot stringByAppendingPathComponent:@"java"]; 
-    if ([[NSFileManager defaultManager] fileExistsAtPath:generic]) return generic;
-
-    
-    NSURL *appSupport = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
-                                                               inDomains:NSUserDomainMask] firstObject];
-    NSString *runtimesRoot = [[appSupport URLByAppendingPathComponent:@"Runtimes" isDirectory:YES] path];
-    if (runtimesRoot.length) {
-        NSString *installed = [runtimesRoot stringByAppendingPathComponent:[NSString stringWithFormat:@"jre%@", javaVersion]];
-        if ([[NSFileManager defaultManager] fileExistsAtPath:installed]) return installed;
-    }
-
-    return nil;
-}
-
 static NSString *tmpDirPath(void) {
     NSString *tmp = NSTemporaryDirectory();
     if (tmp.length == 0) return @"/tmp";
@@ -1331,33 +1568,17 @@ static NSArray<NSString *> *readArgsFile(NSString *path) {
     return out;
 }
 
-static int jessi_spawn_external_java_args(NSArray<NSString *> *args) {
-    if (args.count == 0) return 2;
-
-    int argc = (int)args.count;
-    char **argv = (char **)calloc((size_t)argc + 1, sizeof(char *));
-    if (!argv) return 8;
-
-    for (int i = 0; i < argc; i++) {
-        NSString *s = args[(NSUInteger)i] ?: @"";
-        argv[i] = strdup(s.UTF8String ?: "");
-        if (!argv[i]) {
-            for (int j = 0; j < i; j++) free(argv[j]);
-            free(argv);
-            return 8;
-        }
-    }
-    argv[argc] = NULL;
+static int jessi_spawn_external_java(char *const *argv) {
+    if (!argv || !argv[0]) return 2;
 
     pid_t pid = 0;
     extern char **environ;
     int ret = posix_spawn(&pid, argv[0], NULL, NULL, argv, environ);
     if (ret != 0) {
         fprintf(stderr, "Failed to spawn Java process: %s\n", strerror(ret));
-        for (int i = 0; i < argc; i++) free(argv[i]);
-        free(argv);
         return 253;
     }
+    jessi_child_status_send("pid", "%d java", (int)pid);
 
     int status = 0;
     int code = 252;
@@ -1369,13 +1590,135 @@ static int jessi_spawn_external_java_args(NSArray<NSString *> *args) {
             code = 252;
         }
     }
-
-    for (int i = 0; i < argc; i++) free(argv[i]);
-    free(argv);
     return code;
 }
 
+// Per-server limits set by JessiServerService (see jessi_spawn_environment); 0 when unset.
+static NSInteger jessi_instance_limit(const char *name) {
+    const char *v = getenv(name);
+    return v ? MAX((NSInteger)atol(v), 0) : 0;
+}
+
+static NSString *jessi_server_software(NSString *workingDir) {
+    @try {
+        NSString *cfgPath = [workingDir stringByAppendingPathComponent:@"jessiserverconfig.json"];
+        NSData *cfgData = [NSData dataWithContentsOfFile:cfgPath options:0 error:nil];
+        if (!cfgData.length) return nil;
+        id obj = [NSJSONSerialization JSONObjectWithData:cfgData options:0 error:nil];
+        if (![obj isKindOfClass:[NSDictionary class]]) return nil;
+        id software = ((NSDictionary *)obj)[@"software"];
+        return [software isKindOfClass:[NSString class]] ? [(NSString *)software lowercaseString] : nil;
+    } @catch (__unused NSException *e) {
+        return nil;
+    }
+}
+
+static NSArray<NSString *> *jessi_server_user_args(NSString *workingDir) {
+    NSString *launchArgsPath = [workingDir stringByAppendingPathComponent:@"jessi-launch-args.txt"];
+    NSMutableArray<NSString *> *extra = [[NSFileManager defaultManager] fileExistsAtPath:launchArgsPath] ? [readArgsFile(launchArgsPath) mutableCopy] : [NSMutableArray array];
+    NSString *savedArgs = [JessiSettings current].launchArguments ?: @"";
+    if (savedArgs.length) {
+        NSArray<NSString *> *parts = [savedArgs componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        for (NSString *p in parts) if (p.length) [extra addObject:p];
+    }
+    return extra;
+}
+
+static const char **jessi_cstring_array(NSArray<NSString *> *strings) {
+    const char **out = (const char **)calloc(strings.count + 1, sizeof(char *));
+    if (!out) return NULL;
+    for (NSUInteger i = 0; i < strings.count; i++) out[i] = strings[i].UTF8String ?: "";
+    return out;
+}
+
+// Gathers device, settings and per-instance inputs and lets JessiLaunchPlan pick the JVM flags.
+static jessi_launch_plan *jessi_build_launch_plan(jessi_launch_kind kind,
+                                                  NSString *javaHome,
+                                                  NSString *javaVersion,
+                                                  NSString *workingDir,
+                                                  NSString *tmpDir,
+                                                  const char *jarPathC,
+                                                  NSArray<NSString *> *userArgs,
+                                                  NSArray<NSString *> *programArgs) {
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+    BOOL macos = jessi_is_running_on_macos();
+    NSString *software = kind == JESSI_LAUNCH_SERVER ? jessi_server_software(workingDir) : nil;
+    NSString *javaPath = [javaHome stringByAppendingPathComponent:@"bin/java"];
+    NSString *frameworks = [[NSBundle mainBundle] privateFrameworksPath] ?: @"";
+
+    jessi_launch_inputs in = {0};
+    in.kind = kind;
+    in.spawned = macos;
+    in.java_major = javaVersion.intValue > 0 ? javaVersion.intValue : 8;
+    in.ios_major = macos ? 0 : (int)info.operatingSystemVersion.majorVersion;
+    in.txm_support = [JessiSettings current].txmSupport;
+    in.has_extended_va = (in.java_major >= 17 && !macos) ? jessi_has_extended_va_entitlement() : 1;
+    in.device_ram_mb = info.physicalMemory / (1024ull * 1024ull);
+    in.cpu_cores = (int)info.activeProcessorCount;
+    in.software = software.UTF8String;
+
+    if (kind == JESSI_LAUNCH_SERVER) {
+        NSInteger heapMB = [defaults integerForKey:@"jessi.maxHeapMB"];
+        if (jessi_instance_limit("JESSI_MAX_HEAP_MB") > 0) heapMB = jessi_instance_limit("JESSI_MAX_HEAP_MB");
+        in.heap_mb = (int)MAX(heapMB, 0);
+        in.initial_heap_mb = (int)MAX([defaults integerForKey:@"jessi.initialHeapMB"], 0);
+        in.active_cpus = (int)jessi_instance_limit("JESSI_ACTIVE_CPUS");
+    }
+    in.netty_no_native = [defaults boolForKey:@"jessi.jvm.flagNettyNoNative"];
+    in.jna_no_sys = [defaults boolForKey:@"jessi.jvm.flagJnaNoSys"];
+
+    in.java_path = javaPath.UTF8String;
+    in.java_home = javaHome.UTF8String;
+    in.working_dir = workingDir.UTF8String;
+    in.tmp_dir = tmpDir.UTF8String;
+    in.library_path = frameworks.length ? frameworks.UTF8String : NULL;
+    in.jar_path = jarPathC;
+
+    JessiCDSArchive *cds = nil;
+    // CDS needs compressed class pointers, which the JIT path turns off without the extended VA entitlement.
+    if (kind == JESSI_LAUNCH_SERVER && in.has_extended_va) {
+        cds = [JessiCDSArchive archiveForServerDir:workingDir
+                                          javaHome:javaHome
+                                         javaMajor:in.java_major
+                                           jarPath:[NSString stringWithUTF8String:jarPathC ?: ""]
+                                          userArgs:userArgs ?: @[]];
+    }
+    in.cds_archive = cds.archivePath.UTF8String;
+    in.cds_dump = cds.dumping;
+
+    const char **user = jessi_cstring_array(userArgs ?: @[]);
+    const char **program = jessi_cstring_array(programArgs ?: @[]);
+    in.user_args = user;
+    in.user_arg_count = user ? userArgs.count : 0;
+    in.program_args = program;
+    in.program_arg_count = program ? programArgs.count : 0;
+
+    jessi_launch_plan *plan = jessi_launch_plan_build(&in);
+    free(user);
+    free(program);
+    if (plan) {
+        fprintf(stderr, "[JESSI] Launch profile: %s (Java %d, %llu MB RAM, %d cores)\n",
+                jessi_launch_plan_profile(plan), in.java_major,
+                (unsigned long long)in.device_ram_mb, in.cpu_cores);
+        if (cds) fprintf(stderr, "[JESSI] AppCDS: %s\n", cds.summary.UTF8String);
+    } else {
+        fprintf(stderr, "Error: failed to build JVM arguments\n");
+    }
+    return plan;
+}
+
+static void jessi_launch_trace_flush(NSString *workingDir) {
+    NSString *path = [workingDir stringByAppendingPathComponent:@"jessi-launch-timings.json"];
+    jessi_launch_trace_write_json(path.fileSystemRepresentation);
+    char summary[1024];
+    jessi_launch_trace_format_summary(summary, sizeof(summary));
+    fprintf(stderr, "[JESSI] Launch phases: %s\n", summary);
+}
+
 int jessi_server_main(int argc, char *argv[]) {
+    jessi_launch_trace_reset();
+    int traceTotal = jessi_launch_trace_begin("server_main");
     (void)[NSBundle mainBundle];
     (void)[NSFileManager defaultManager];
 
@@ -1393,7 +1736,10 @@ int jessi_server_main(int argc, char *argv[]) {
             const char *javaVersionC = javaVersion.UTF8String;
             const char *workingDirC = argv[3];
 
-            NSString *javaHome = bundleJavaHomeForVersion(javaVersion);
+            int tracePhase = jessi_launch_trace_begin("java_home");
+            JessiRuntimeInfo *runtime = [[JessiRuntimeRegistry shared] runtimeForVersion:javaVersion];
+            NSString *javaHome = runtime.home;
+            jessi_launch_trace_end(tracePhase);
             if (!javaHome) {
                 fprintf(stderr, "Error: bundled Java runtime not found (java/ or java<ver>/)\n");
                 return 3;
@@ -1402,27 +1748,13 @@ int jessi_server_main(int argc, char *argv[]) {
             [[NSFileManager defaultManager] createDirectoryAtPath:[NSString stringWithUTF8String:workingDirC] withIntermediateDirectories:YES attributes:nil error:nil];
 
             NSString *workingDir = [NSString stringWithUTF8String:workingDirC];
-            NSString *stdioLog = [workingDir stringByAppendingPathComponent:@"jessi-stdio.log"]; 
-            redirect_stdio_to(stdioLog);
-
-            BOOL isPaperServer = NO;
-            @try {
-                NSString *cfgPath = [workingDir stringByAppendingPathComponent:@"jessiserverconfig.json"]; 
-                NSData *cfgData = [NSData dataWithContentsOfFile:cfgPath options:0 error:nil];
-                if (cfgData.length) {
-                    id obj = [NSJSONSerialization JSONObjectWithData:cfgData options:0 error:nil];
-                    if ([obj isKindOfClass:[NSDictionary class]]) {
-                        id software = ((NSDictionary *)obj)[@"software"];
-                        if ([software isKindOfClass:[NSString class]]) {
-                            NSString *sw = [(NSString *)software lowercaseString];
-                            if ([sw isEqualToString:@"paper"]) {
-                                isPaperServer = YES;
-                            }
-                        }
-                    }
-                }
-            } @catch (__unused NSException *e) {
-                isPaperServer = NO;
+            // Spawned through a JessiChildChannel, stdout/stderr are already pipes the app copies to disk.
+            if (jessi_child_status_fd() >= 0) {
+                jessi_child_status_send("pid", "%d", (int)getpid());
+                jessi_child_status_start_heartbeat(2000);
+            } else {
+                NSString *stdioLog = [workingDir stringByAppendingPathComponent:@"jessi-stdio.log"]; 
+                redirect_stdio_to(stdioLog);
             }
 
             NSString *tmpDir = tmpDirPath();
@@ -1447,103 +1779,29 @@ int jessi_server_main(int argc, char *argv[]) {
                     return 3;
                 }
 
-                NSInteger heapMB = 768;
-                @try {
-                    heapMB = [[NSUserDefaults standardUserDefaults] integerForKey:@"jessi.maxHeapMB"];
-                    if (heapMB <= 0) heapMB = 768;
-                } @catch (__unused NSException *e) {
-                    heapMB = 768;
-                }
+                jessi_launch_plan *plan = jessi_build_launch_plan(JESSI_LAUNCH_SERVER, javaHome, javaVersion, workingDir, tmpDir, jarPathC, jessi_server_user_args(workingDir), nil);
+                if (!plan) return 8;
 
-                NSInteger initialHeapMB = MIN(heapMB, 256);
-                @try {
-                    NSInteger configuredInitial = [[NSUserDefaults standardUserDefaults] integerForKey:@"jessi.initialHeapMB"];
-                    if (configuredInitial > 0) initialHeapMB = configuredInitial;
-                } @catch (__unused NSException *e) {
-                }
-                if (initialHeapMB <= 0) initialHeapMB = MIN(heapMB, 256);
-                if (initialHeapMB > heapMB) initialHeapMB = heapMB;
-
-                NSString *xmx = [NSString stringWithFormat:@"-Xmx%ldM", (long)heapMB];
-                NSString *xms = [NSString stringWithFormat:@"-Xms%ldM", (long)initialHeapMB];
-                NSString *userDirArg = [@"-Duser.dir=" stringByAppendingString:workingDir];
-                NSString *userHomeArg = [@"-Duser.home=" stringByAppendingString:workingDir];
-                NSString *javaHomeArg = [@"-Djava.home=" stringByAppendingString:javaHome];
-                NSString *tmpArg = [@"-Djava.io.tmpdir=" stringByAppendingString:tmpDir];
-
-                NSString *frameworks = [[NSBundle mainBundle] privateFrameworksPath];
-                NSString *frameworksPath = frameworks ?: @"";
-                NSString *libPathArg = frameworksPath.length ? [@"-Djava.library.path=" stringByAppendingString:frameworksPath] : nil;
-
-                BOOL flagNettyNoNative = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagNettyNoNative"];
-                BOOL flagJnaNoSys = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagJnaNoSys"];
-
-                BOOL isPaperServer = NO;
-                @try {
-                    NSString *cfgPath = [workingDir stringByAppendingPathComponent:@"jessiserverconfig.json"];
-                    NSData *cfgData = [NSData dataWithContentsOfFile:cfgPath options:0 error:nil];
-                    if (cfgData.length) {
-                        id obj = [NSJSONSerialization JSONObjectWithData:cfgData options:0 error:nil];
-                        if ([obj isKindOfClass:[NSDictionary class]]) {
-                            NSString *sw = [((NSDictionary *)obj)[@"software"] lowercaseString];
-                            isPaperServer = [sw isEqualToString:@"paper"];
-                        }
-                    }
-                } @catch (__unused NSException *e) {
-                }
-
-                NSString *launchArgsPath = [workingDir stringByAppendingPathComponent:@"jessi-launch-args.txt"];
-                NSMutableArray<NSString *> *extra = [[NSFileManager defaultManager] fileExistsAtPath:launchArgsPath] ? [readArgsFile(launchArgsPath) mutableCopy] : [NSMutableArray array];
-                NSString *savedArgs = [JessiSettings shared].launchArguments ?: @"";
-                if (savedArgs.length) {
-                    NSArray<NSString *> *parts = [savedArgs componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-                    for (NSString *p in parts) if (p.length) [extra addObject:p];
-                }
-                BOOL userSetPaperIgnoreJavaVersion = jessi_args_contain_prefix(extra, @"-DPaper.IgnoreJavaVersion");
-
-                NSMutableArray<NSString *> *args = [NSMutableArray array];
-                [args addObject:javaPath];
-                [args addObject:xmx];
-                [args addObject:xms];
-                [args addObject:@"-XX:+UseSerialGC"];
-                if (flagNettyNoNative) [args addObject:@"-Dio.netty.transport.noNative=true"];
-                if (flagJnaNoSys) {
-                    [args addObject:@"-Djna.nosys=true"];
-                    [args addObject:@"-Djna.nounpack=true"];
-                }
-                if (isPaperServer && !userSetPaperIgnoreJavaVersion) [args addObject:@"-DPaper.IgnoreJavaVersion=true"];
-                [args addObject:@"-XX:MaxGCPauseMillis=50"];
-                [args addObject:userDirArg];
-                [args addObject:userHomeArg];
-                [args addObject:javaHomeArg];
-                [args addObject:tmpArg];
-                if (libPathArg) [args addObject:libPathArg];
-                [args addObject:@"-Djava.awt.headless=true"];
-                [args addObject:@"-Djava.net.preferIPv4Stack=true"];
-                [args addObject:@"-Dsun.net.client.defaultConnectTimeout=30000"];
-                [args addObject:@"-Dsun.net.client.defaultReadTimeout=30000"];
-                [args addObject:@"-Dsun.nio.ch.disableSystemWideOverlappingFileLockCheck=true"];
-
-                if (extra.count) {
-                    [args addObjectsFromArray:extra];
-                } else {
-                    [args addObject:@"-jar"];
-                    [args addObject:[NSString stringWithUTF8String:jarPathC ?: ""]];
-                    [args addObject:@"nogui"];
-                }
-
-                return jessi_spawn_external_java_args(args);
+                jessi_launch_trace_end(traceTotal);
+                jessi_launch_trace_mark("spawn_java");
+                jessi_launch_trace_flush(workingDir);
+                int code = jessi_spawn_external_java(jessi_launch_plan_argv(plan));
+                jessi_launch_plan_destroy(plan);
+                return code;
             }
 
-            NSString *libjliPath8 = [javaHome stringByAppendingPathComponent:@"lib/jli/libjli.dylib"];
-            NSString *libjliPath11 = [javaHome stringByAppendingPathComponent:@"lib/libjli.dylib"];
-            NSString *libjliPath = [[NSFileManager defaultManager] fileExistsAtPath:libjliPath8] ? libjliPath8 : libjliPath11;
+            NSString *libjliPath = runtime.libjliPath ?: [javaHome stringByAppendingPathComponent:@"lib/libjli.dylib"];
 
+            tracePhase = jessi_launch_trace_begin("patch_dylibs");
             jessi_patch_jvm_dylibs_if_needed(javaHome);
+            jessi_launch_trace_end(tracePhase);
 
-            
+            tracePhase = jessi_launch_trace_begin("dyld_bypass");
             jessi_init_dyld_validation_bypass_if_needed();
+            jessi_launch_trace_end(tracePhase);
+            tracePhase = jessi_launch_trace_begin("preflight_dylibs");
             jessi_preflight_jvm_dylibs_if_needed(javaHome);
+            jessi_launch_trace_end(tracePhase);
 
             if (jessi_is_ios26_or_later_core() &&
                 [javaHome rangeOfString:@"/Library/Application Support/"].location != NSNotFound &&
@@ -1565,17 +1823,20 @@ int jessi_server_main(int argc, char *argv[]) {
             }
 
             JessiDlopenCtx dlCtx = { .path = libjliPath.fileSystemRepresentation, .flags = RTLD_GLOBAL | RTLD_NOW };
-            uint64_t hwHitsBefore = jessi_hw_redirect_hit_count;
-            uint64_t hwMissBefore = jessi_hw_redirect_miss_count;
+            uint64_t hwHitsBefore = 0, hwMissBefore = 0;
+            jessi_hw_redirect_totals(&hwHitsBefore, &hwMissBefore);
+            tracePhase = jessi_launch_trace_begin("dlopen_libjli");
             void *libjli = jessi_run_with_hw_breakpoints(jessi_dlopen_trampoline, &dlCtx);
-            uint64_t hwHitsAfter = jessi_hw_redirect_hit_count;
-            uint64_t hwMissAfter = jessi_hw_redirect_miss_count;
+            jessi_launch_trace_end(tracePhase);
+            uint64_t hwHitsAfter = 0, hwMissAfter = 0;
+            jessi_hw_redirect_totals(&hwHitsAfter, &hwMissAfter);
             NSLog(@"[JESSI] [HWBypass] stage=dlopen-libjli mode=server hits_delta=%llu misses_delta=%llu hits_total=%llu misses_total=%llu dyldBypassReady=%d",
                   (unsigned long long)(hwHitsAfter - hwHitsBefore),
                   (unsigned long long)(hwMissAfter - hwMissBefore),
                   (unsigned long long)hwHitsAfter,
                   (unsigned long long)hwMissAfter,
                   jessi_dyld_bypass_ready ? 1 : 0);
+            jessi_log_exec_mapping_stats("dlopen-libjli");
             if (!libjli) {
                 const char *err = dlerror();
                 fprintf(stderr, "Error: dlopen(libjli) failed: %s\n", err ? err : "unknown");
@@ -1599,133 +1860,17 @@ int jessi_server_main(int argc, char *argv[]) {
             }
             jessi_debug_dump_launch_state(@"server", javaHome, libjliPath, (const void *)JLI_Launch);
             JESSI_TXM_LOG("[JESSI] JLI_Launch resolved at %p\n", (void *)JLI_Launch);
-
-            NSString *javaPath = [javaHome stringByAppendingPathComponent:@"bin/java"]; 
-            NSString *userDirArg = [@"-Duser.dir=" stringByAppendingString:workingDir];
-            NSString *userHomeArg = [@"-Duser.home=" stringByAppendingString:workingDir];
-            NSString *javaHomeArg = [@"-Djava.home=" stringByAppendingString:javaHome];
-            NSString *tmpArg = [@"-Djava.io.tmpdir=" stringByAppendingString:tmpDir];
-
-            NSString *frameworks = [[NSBundle mainBundle] privateFrameworksPath];
-            NSString *frameworksPath = frameworks ?: @"";
-            NSString *libPathArg = frameworksPath.length ? [@"-Djava.library.path=" stringByAppendingString:frameworksPath] : nil;
+            tracePhase = jessi_launch_trace_begin("build_args");
 
             NSInteger iosMajor = [NSProcessInfo processInfo].operatingSystemVersion.majorVersion;
-
-            NSInteger heapMB = 768;
-            @try {
-                heapMB = [[NSUserDefaults standardUserDefaults] integerForKey:@"jessi.maxHeapMB"]; 
-                if (heapMB <= 0) heapMB = 768;
-            } @catch (__unused NSException *e) {
-                heapMB = 768;
-            }
-
-            
-            NSInteger initialHeapMB = MIN(heapMB, 256);
-            @try {
-                NSInteger configuredInitial = [[NSUserDefaults standardUserDefaults] integerForKey:@"jessi.initialHeapMB"];
-                if (configuredInitial > 0) initialHeapMB = configuredInitial;
-            } @catch (__unused NSException *e) {
-                
-            }
-            if (initialHeapMB <= 0) initialHeapMB = MIN(heapMB, 256);
-            if (initialHeapMB > heapMB) initialHeapMB = heapMB;
-
-            NSString *xmx = [NSString stringWithFormat:@"-Xmx%ldM", (long)heapMB];
-            NSString *xms = [NSString stringWithFormat:@"-Xms%ldM", (long)initialHeapMB];
-
             NSString *javaVersionStr = javaVersion;
-            BOOL isJava17Plus = [javaVersionStr isEqualToString:@"17"] || [javaVersionStr isEqualToString:@"21"];
-            BOOL ios26OrLater = jessi_is_ios26_or_later_core();
-            BOOL txmSupport = [JessiSettings shared].txmSupport;
-
-            BOOL flagNettyNoNative = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagNettyNoNative"];
-            BOOL flagJnaNoSys = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagJnaNoSys"];
-
-            const char *jargv[80];
-            int idx = 0;
-            jargv[idx++] = javaPath.UTF8String;
-            jargv[idx++] = xmx.UTF8String;
-            jargv[idx++] = xms.UTF8String;
-
             JESSI_TXM_LOG("[JESSI] Launching JVM (iOS%ld, Java %s)\n", (long)iosMajor, javaVersionC);
 
-            
-            if (ios26OrLater && txmSupport) {
-                jargv[idx++] = "-XX:+UnlockExperimentalVMOptions";
-                jargv[idx++] = "-XX:+DisablePrimordialThreadGuardPages";
-            }
-            
-            if (ios26OrLater && txmSupport && isJava17Plus) {
-                jargv[idx++] = "-XX:+MirrorMappedCodeCache";
-            }
-            
-            if (isJava17Plus && !jessi_has_extended_va_entitlement()) {
-                jargv[idx++] = "-XX:-UseCompressedClassPointers";
-            }
-            
-            jargv[idx++] = "-XX:+UseSerialGC";
-
-            
-            
-            NSString *launchArgsPath = [workingDir stringByAppendingPathComponent:@"jessi-launch-args.txt"]; 
-            NSMutableArray<NSString *> *extra = [[NSFileManager defaultManager] fileExistsAtPath:launchArgsPath] ? [readArgsFile(launchArgsPath) mutableCopy] : [NSMutableArray array];
-            NSString *savedArgs = [JessiSettings shared].launchArguments ?: @"";
-            if (savedArgs.length) {
-                NSArray<NSString *> *parts = [savedArgs componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-                for (NSString *p in parts) if (p.length) [extra addObject:p];
-            }
-            
-            NSMutableArray<NSString *> *filteredExtra = [[jessi_filter_extra_jvm_args(extra, ios26OrLater, isJava17Plus) mutableCopy] mutableCopy];
-            if (filteredExtra) {
-                extra = filteredExtra;
-            }
-
-            BOOL userSetCodeCache = jessi_args_contain_prefix(extra, @"-XX:ReservedCodeCacheSize=");
-            BOOL userSetPaperIgnoreJavaVersion = jessi_args_contain_prefix(extra, @"-DPaper.IgnoreJavaVersion");
-            
-            if (!ios26OrLater && iosMajor <= 18) {
-                if (!userSetCodeCache) {
-                    jargv[idx++] = "-XX:ReservedCodeCacheSize=64M";
-                }
-            }
-
-            if (flagNettyNoNative) {
-                jargv[idx++] = "-Dio.netty.transport.noNative=true";
-            }
-            if (flagJnaNoSys) {
-                jargv[idx++] = "-Djna.nosys=true";
-                jargv[idx++] = "-Djna.nounpack=true";
-            }
-
-            if (isPaperServer && !userSetPaperIgnoreJavaVersion) {
-                jargv[idx++] = "-DPaper.IgnoreJavaVersion=true";
-            }
-            jargv[idx++] = "-XX:MaxGCPauseMillis=50";
-            jargv[idx++] = userDirArg.UTF8String;
-            jargv[idx++] = userHomeArg.UTF8String;
-            jargv[idx++] = javaHomeArg.UTF8String;
-            jargv[idx++] = tmpArg.UTF8String;
-            if (libPathArg) jargv[idx++] = libPathArg.UTF8String;
-            jargv[idx++] = "-Djava.awt.headless=true";
-            jargv[idx++] = "-Djava.net.preferIPv4Stack=true";
-            jargv[idx++] = "-Dsun.net.client.defaultConnectTimeout=30000";
-            jargv[idx++] = "-Dsun.net.client.defaultReadTimeout=30000";
-            jargv[idx++] = "-Dsun.nio.ch.disableSystemWideOverlappingFileLockCheck=true";
-            if (extra.count) {
-                for (NSString *arg in extra) {
-                    if (idx >= 78) break;
-                    jargv[idx++] = arg.UTF8String;
-                }
-            } else {
-                jargv[idx++] = "-jar";
-                jargv[idx++] = jarPathC;
-                jargv[idx++] = "nogui";
-            }
-            jargv[idx++] = NULL;
-
-            int jargc = idx - 1;
-            char **ownedJargv = jessi_dup_argv(jargv, jargc);
+            jessi_launch_plan *plan = jessi_build_launch_plan(JESSI_LAUNCH_SERVER, javaHome, javaVersion, workingDir, tmpDir, jarPathC, jessi_server_user_args(workingDir), nil);
+            if (!plan) return 8;
+            int jargc = jessi_launch_plan_argc(plan);
+            char **ownedJargv = jessi_dup_argv((const char *const *)jessi_launch_plan_argv(plan), jargc);
+            jessi_launch_plan_destroy(plan);
             if (!ownedJargv) {
                 fprintf(stderr, "Error: failed to allocate JVM argument vector\n");
                 return 8;
@@ -1753,9 +1898,15 @@ int jessi_server_main(int argc, char *argv[]) {
                 .launchername = "openjdk",
                 .result = 0,
             };
+            jessi_launch_trace_end(tracePhase);
+            jessi_launch_trace_end(traceTotal);
+            jessi_launch_trace_mark("jli_launch");
+            jessi_launch_trace_flush(workingDir);
             JESSI_TXM_LOG("[JESSI] Invoking JLI_Launch (server)\n");
             (void)jessi_run_with_hw_breakpoints(jessi_jli_launch_trampoline, &launchCtx);
             JESSI_TXM_LOG("[JESSI] JLI_Launch returned %d\n", (int)launchCtx.result);
+            jessi_log_exec_mapping_stats("jli-launch");
+            jessi_hw_redirect_dump("jli-launch");
             jessi_free_argv(ownedJargv, jargc);
             int exitCode = (int)launchCtx.result;
             return exitCode;
@@ -1768,6 +1919,9 @@ int jessi_server_main(int argc, char *argv[]) {
             fprintf(stderr, "JVM launch threw unknown C++ exception\n");
             return 249;
         }
+        @finally {
+            jessi_disarm_hw_breakpoints();
+        }
     }
 }
 
@@ -1824,7 +1978,8 @@ int jessi_tool_main(int argc, char *argv[]) {
             const char *workingDirC = argv[3];
             const char *argsPathC = (argc >= 5 && argv[4] && argv[4][0]) ? argv[4] : NULL;
 
-            NSString *javaHome = bundleJavaHomeForVersion(javaVersion);
+            JessiRuntimeInfo *runtime = [[JessiRuntimeRegistry shared] runtimeForVersion:javaVersion];
+            NSString *javaHome = runtime.home;
             if (!javaHome) {
                 fprintf(stderr, "Error: bundled Java runtime not found (java/ or java<ver>/)\n");
                 return 3;
@@ -1859,50 +2014,15 @@ int jessi_tool_main(int argc, char *argv[]) {
                     return 3;
                 }
 
-                NSString *userDirArg = [@"-Duser.dir=" stringByAppendingString:workingDir];
-                NSString *userHomeArg = [@"-Duser.home=" stringByAppendingString:workingDir];
-                NSString *javaHomeArg = [@"-Djava.home=" stringByAppendingString:javaHome];
-                NSString *tmpArg = [@"-Djava.io.tmpdir=" stringByAppendingString:tmpDir];
-                NSString *xmx = @"-Xmx512M";
-                NSString *xms = @"-Xms16M";
-                NSString *maxMeta = @"-XX:MaxMetaspaceSize=256M";
-
-                NSString *frameworks = [[NSBundle mainBundle] privateFrameworksPath];
-                NSString *frameworksPath = frameworks ?: @"";
-                NSString *libPathArg = frameworksPath.length ? [@"-Djava.library.path=" stringByAppendingString:frameworksPath] : nil;
-
-                BOOL flagNettyNoNative = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagNettyNoNative"];
-                BOOL flagJnaNoSys = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagJnaNoSys"];
                 NSArray<NSString *> *extra = argsPathC ? readArgsFile([NSString stringWithUTF8String:argsPathC]) : @[];
-
-                NSMutableArray<NSString *> *args = [NSMutableArray array];
-                [args addObject:javaPath];
-                [args addObject:xmx];
-                [args addObject:xms];
-                [args addObject:@"-XX:+UseSerialGC"];
-                if (flagNettyNoNative) [args addObject:@"-Dio.netty.transport.noNative=true"];
-                if (flagJnaNoSys) {
-                    [args addObject:@"-Djna.nosys=true"];
-                    [args addObject:@"-Djna.nounpack=true"];
-                }
-                [args addObject:maxMeta];
-                [args addObject:userDirArg];
-                [args addObject:userHomeArg];
-                [args addObject:javaHomeArg];
-                [args addObject:tmpArg];
-                if (libPathArg) [args addObject:libPathArg];
-                [args addObject:@"-Djava.awt.headless=true"];
-                [args addObject:@"-Djava.net.preferIPv4Stack=true"];
-                [args addObject:@"-jar"];
-                [args addObject:[NSString stringWithUTF8String:jarPathC ?: ""]];
-                [args addObjectsFromArray:extra];
-
-                return jessi_spawn_external_java_args(args);
+                jessi_launch_plan *plan = jessi_build_launch_plan(JESSI_LAUNCH_TOOL, javaHome, javaVersion, workingDir, tmpDir, jarPathC, nil, extra);
+                if (!plan) return 8;
+                int code = jessi_spawn_external_java(jessi_launch_plan_argv(plan));
+                jessi_launch_plan_destroy(plan);
+                return code;
             }
 
-            NSString *libjliPath8 = [javaHome stringByAppendingPathComponent:@"lib/jli/libjli.dylib"];
-            NSString *libjliPath11 = [javaHome stringByAppendingPathComponent:@"lib/libjli.dylib"];
-            NSString *libjliPath = [[NSFileManager defaultManager] fileExistsAtPath:libjliPath8] ? libjliPath8 : libjliPath11;
+            NSString *libjliPath = runtime.libjliPath ?: [javaHome stringByAppendingPathComponent:@"lib/libjli.dylib"];
 
             jessi_patch_jvm_dylibs_if_needed(javaHome);
 
@@ -1920,17 +2040,18 @@ int jessi_tool_main(int argc, char *argv[]) {
             JESSI_TXM_LOG("[JESSI] Loading libjli (tool) from %s\n", libjliPath.fileSystemRepresentation);
 
             JessiDlopenCtx dlCtx = { .path = libjliPath.fileSystemRepresentation, .flags = RTLD_GLOBAL | RTLD_NOW };
-            uint64_t hwHitsBefore = jessi_hw_redirect_hit_count;
-            uint64_t hwMissBefore = jessi_hw_redirect_miss_count;
+            uint64_t hwHitsBefore = 0, hwMissBefore = 0;
+            jessi_hw_redirect_totals(&hwHitsBefore, &hwMissBefore);
             void *libjli = jessi_run_with_hw_breakpoints(jessi_dlopen_trampoline, &dlCtx);
-            uint64_t hwHitsAfter = jessi_hw_redirect_hit_count;
-            uint64_t hwMissAfter = jessi_hw_redirect_miss_count;
+            uint64_t hwHitsAfter = 0, hwMissAfter = 0;
+            jessi_hw_redirect_totals(&hwHitsAfter, &hwMissAfter);
             NSLog(@"[JESSI][HWBypass] stage=dlopen-libjli mode=tool hits_delta=%llu misses_delta=%llu hits_total=%llu misses_total=%llu dyldBypassReady=%d",
                   (unsigned long long)(hwHitsAfter - hwHitsBefore),
                   (unsigned long long)(hwMissAfter - hwMissBefore),
                   (unsigned long long)hwHitsAfter,
                   (unsigned long long)hwMissAfter,
                   jessi_dyld_bypass_ready ? 1 : 0);
+            jessi_log_exec_mapping_stats("dlopen-libjli");
             if (!libjli) {
                 const char *err = dlerror();
                 fprintf(stderr, "Error: dlopen(libjli) failed: %s\n", err ? err : "unknown");
@@ -1953,62 +2074,13 @@ int jessi_tool_main(int argc, char *argv[]) {
             jessi_debug_dump_launch_state(@"tool", javaHome, libjliPath, (const void *)JLI_Launch);
             JESSI_TXM_LOG("[JESSI] JLI_Launch (tool) resolved at %p\n", (void *)JLI_Launch);
 
-            NSString *javaPath = [javaHome stringByAppendingPathComponent:@"bin/java"]; 
-            NSString *userDirArg = [@"-Duser.dir=" stringByAppendingString:workingDir];
-            NSString *userHomeArg = [@"-Duser.home=" stringByAppendingString:workingDir];
-            NSString *javaHomeArg = [@"-Djava.home=" stringByAppendingString:javaHome];
-            NSString *tmpArg = [@"-Djava.io.tmpdir=" stringByAppendingString:tmpDir];
-
-            NSString *frameworks = [[NSBundle mainBundle] privateFrameworksPath];
-            NSString *frameworksPath = frameworks ?: @"";
-            NSString *libPathArg = frameworksPath.length ? [@"-Djava.library.path=" stringByAppendingString:frameworksPath] : nil;
-
-            NSString *xmx = @"-Xmx512M";
-            NSString *xms = @"-Xms16M";
-
-            NSString *maxMeta = @"-XX:MaxMetaspaceSize=256M";
-
             NSString *javaVersionStr = javaVersion;
-            BOOL ios26OrLater = jessi_is_ios26_or_later_core();
-
-            BOOL flagNettyNoNative = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagNettyNoNative"];
-            BOOL flagJnaNoSys = [[NSUserDefaults standardUserDefaults] boolForKey:@"jessi.jvm.flagJnaNoSys"];
-
-            NSArray<NSString *> *extraRaw = argsPathC ? readArgsFile([NSString stringWithUTF8String:argsPathC]) : @[];
-            NSArray<NSString *> *extra = jessi_filter_extra_jvm_args(extraRaw, ios26OrLater, [javaVersionStr isEqualToString:@"17"] || [javaVersionStr isEqualToString:@"21"]);
-
-            const char *jargv[96];
-            int idx = 0;
-            jargv[idx++] = javaPath.UTF8String;
-            jargv[idx++] = xmx.UTF8String;
-            jargv[idx++] = xms.UTF8String;
-            jargv[idx++] = "-XX:+UseSerialGC";
-
-            if (flagNettyNoNative) {
-                jargv[idx++] = "-Dio.netty.transport.noNative=true";
-            }
-            if (flagJnaNoSys) {
-                jargv[idx++] = "-Djna.nosys=true";
-                jargv[idx++] = "-Djna.nounpack=true";
-            }
-            jargv[idx++] = maxMeta.UTF8String;
-            jargv[idx++] = userDirArg.UTF8String;
-            jargv[idx++] = userHomeArg.UTF8String;
-            jargv[idx++] = javaHomeArg.UTF8String;
-            jargv[idx++] = tmpArg.UTF8String;
-            if (libPathArg) jargv[idx++] = libPathArg.UTF8String;
-            jargv[idx++] = "-Djava.awt.headless=true";
-            jargv[idx++] = "-Djava.net.preferIPv4Stack=true";
-            jargv[idx++] = "-jar";
-            jargv[idx++] = jarPathC;
-            for (NSString *arg in extra) {
-                if (idx >= 94) break;
-                jargv[idx++] = arg.UTF8String;
-            }
-            jargv[idx++] = NULL;
-
-            int jargc = idx - 1;
-            char **ownedJargv = jessi_dup_argv(jargv, jargc);
+            NSArray<NSString *> *extra = argsPathC ? readArgsFile([NSString stringWithUTF8String:argsPathC]) : @[];
+            jessi_launch_plan *plan = jessi_build_launch_plan(JESSI_LAUNCH_TOOL, javaHome, javaVersion, workingDir, tmpDir, jarPathC, nil, extra);
+            if (!plan) return 8;
+            int jargc = jessi_launch_plan_argc(plan);
+            char **ownedJargv = jessi_dup_argv((const char *const *)jessi_launch_plan_argv(plan), jargc);
+            jessi_launch_plan_destroy(plan);
             if (!ownedJargv) {
                 fprintf(stderr, "Error: failed to allocate JVM argument vector\n");
                 return 8;
@@ -2032,6 +2104,7 @@ int jessi_tool_main(int argc, char *argv[]) {
             JESSI_TXM_LOG("[JESSI] Invoking JLI_Launch (tool)\n");
             (void)jessi_run_with_hw_breakpoints(jessi_jli_launch_trampoline, &launchCtx);
             JESSI_TXM_LOG("[JESSI] JLI_Launch (tool) returned %d\n", (int)launchCtx.result);
+            jessi_hw_redirect_dump("jli-launch-tool");
             jessi_free_argv(ownedJargv, jargc);
             int exitCode = (int)launchCtx.result;
             return exitCode;
@@ -2044,6 +2117,9 @@ int jessi_tool_main(int argc, char *argv[]) {
             fprintf(stderr, "Java tool launch threw unknown C++ exception\n");
             return 249;
         }
+        @finally {
+            jessi_disarm_hw_breakpoints();
+        }
     }
 }
 
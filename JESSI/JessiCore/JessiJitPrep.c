@@ -0,0 +1,136 @@
+#include "JessiJitPrep.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Grow until the fixed round trip is at most this share of a call.
+#define JESSI_JIT_PREP_OVERHEAD_SHARE 0.1
+#define JESSI_JIT_PREP_MIN_SAMPLES 3
+
+struct jessi_jit_prep {
+    jessi_jit_prep_fn fn;
+    void *ctx;
+    size_t min_chunk;
+    size_t max_chunk;
+    size_t ceiling;            // lowered when a chunk size fails
+    pthread_mutex_t lock;
+    jessi_jit_prep_stats stats;
+    // Least-squares sums over (size in MB, latency in ns).
+    double n, sx, sy, sxx, sxy;
+};
+
+static uint64_t jessi_jit_prep_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t jessi_jit_prep_clamp(const jessi_jit_prep *p, size_t chunk) {
+    if (chunk > p->ceiling) chunk = p->ceiling;
+    if (chunk < p->min_chunk) chunk = p->min_chunk;
+    return chunk;
+}
+
+static void jessi_jit_prep_fit(jessi_jit_prep *p, size_t len, uint64_t ns) {
+    double x = (double)len / (1024.0 * 1024.0);
+    double y = (double)ns;
+    p->n += 1;
+    p->sx += x;
+    p->sy += y;
+    p->sxx += x * x;
+    p->sxy += x * y;
+
+    size_t chunk = p->stats.chunk;
+    double denom = p->n * p->sxx - p->sx * p->sx;
+    if (p->n >= JESSI_JIT_PREP_MIN_SAMPLES && denom > 1e-9) {
+        double slope = (p->n * p->sxy - p->sx * p->sy) / denom;
+        double intercept = (p->sy - slope * p->sx) / p->n;
+        if (intercept < 0) intercept = 0;
+        p->stats.fixed_ns = intercept;
+        p->stats.ns_per_mb = slope > 0 ? slope : 0;
+        if (slope <= 0) {
+            chunk = p->ceiling;
+        } else {
+            double mb = intercept * (1.0 - JESSI_JIT_PREP_OVERHEAD_SHARE) / (JESSI_JIT_PREP_OVERHEAD_SHARE * slope);
+            double bytes = mb * 1024.0 * 1024.0;
+            chunk = bytes >= (double)p->ceiling ? p->ceiling : (size_t)bytes;
+        }
+    } else if (len >= chunk) {
+        // Not enough spread in sizes to fit yet: double, which also provides the spread.
+        chunk = chunk <= p->ceiling / 2 ? chunk * 2 : p->ceiling;
+    }
+    p->stats.chunk = jessi_jit_prep_clamp(p, chunk);
+}
+
+static int jessi_jit_prep_call(jessi_jit_prep *p, uintptr_t addr, size_t len) {
+    uint64_t start = jessi_jit_prep_now_ns();
+    int rc = p->fn(p->ctx, addr, len);
+    uint64_t ns = jessi_jit_prep_now_ns() - start;
+
+    p->stats.calls++;
+    p->stats.total_ns += ns;
+    p->stats.last_call_ns = ns;
+    if (ns > p->stats.max_call_ns) p->stats.max_call_ns = ns;
+    if (rc != 0) {
+        p->stats.failed_calls++;
+        return rc;
+    }
+    p->stats.bytes += len;
+    jessi_jit_prep_fit(p, len, ns);
+    return 0;
+}
+
+static int jessi_jit_prep_run(jessi_jit_prep *p, uintptr_t addr, size_t len) {
+    while (len > 0) {
+        size_t n = len < p->stats.chunk ? len : p->stats.chunk;
+        if (jessi_jit_prep_call(p, addr, n) != 0) {
+            // The channel may cap the size it accepts; retry smaller, and stop at the floor.
+            if (n <= p->min_chunk) return -1;
+            p->ceiling = jessi_jit_prep_clamp(p, n / 2);
+            p->stats.chunk = p->ceiling;
+            continue;
+        }
+        addr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+jessi_jit_prep *jessi_jit_prep_create(jessi_jit_prep_fn fn, void *ctx, size_t min_chunk, size_t max_chunk) {
+    if (!fn || min_chunk == 0 || max_chunk < min_chunk) return NULL;
+    jessi_jit_prep *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    p->fn = fn;
+    p->ctx = ctx;
+    p->min_chunk = min_chunk;
+    p->max_chunk = max_chunk;
+    p->ceiling = max_chunk;
+    p->stats.chunk = min_chunk;
+    pthread_mutex_init(&p->lock, NULL);
+    return p;
+}
+
+void jessi_jit_prep_destroy(jessi_jit_prep *p) {
+    if (!p) return;
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+}
+
+int jessi_jit_prep_range(jessi_jit_prep *p, uintptr_t addr, size_t len) {
+    if (!p) return -1;
+    pthread_mutex_lock(&p->lock);
+    int rc = jessi_jit_prep_run(p, addr, len);
+    pthread_mutex_unlock(&p->lock);
+    return rc;
+}
+
+void jessi_jit_prep_get_stats(jessi_jit_prep *p, jessi_jit_prep_stats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    *out = p->stats;
+    pthread_mutex_unlock(&p->lock);
+}
@@ -0,0 +1,45 @@
+#ifndef JessiJitPrep_h
+#define JessiJitPrep_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Drives region preparation through a slow per-call channel (the JIT26 debugger trap on TXM
+// devices). Each range is cut into chunks whose size adapts to a cost model fitted from measured
+// round trips: latency = fixed + per_mb * size.
+
+// Prepares one chunk. Returns 0 on success.
+typedef int (*jessi_jit_prep_fn)(void *ctx, uintptr_t addr, size_t len);
+
+typedef struct {
+    uint64_t calls;
+    uint64_t failed_calls;
+    uint64_t bytes;
+    uint64_t total_ns;
+    uint64_t max_call_ns;
+    uint64_t last_call_ns;
+    size_t chunk;              // next chunk size
+    double fixed_ns;           // fitted per-call overhead, 0 until known
+    double ns_per_mb;          // fitted transfer cost, 0 until known
+} jessi_jit_prep_stats;
+
+typedef struct jessi_jit_prep jessi_jit_prep;
+
+// Chunks start at min_chunk, grow while round trips dominate and shrink after a failed call.
+jessi_jit_prep *jessi_jit_prep_create(jessi_jit_prep_fn fn, void *ctx, size_t min_chunk, size_t max_chunk);
+void jessi_jit_prep_destroy(jessi_jit_prep *p);
+
+// Prepares [addr, addr + len) chunk by chunk. Returns 0 on success.
+int jessi_jit_prep_range(jessi_jit_prep *p, uintptr_t addr, size_t len);
+
+void jessi_jit_prep_get_stats(jessi_jit_prep *p, jessi_jit_prep_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
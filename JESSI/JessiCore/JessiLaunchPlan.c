@@ -0,0 +1,385 @@
+#include "JessiLaunchPlan.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JESSI_ARG_KEY_MAX 96
+// Unchanged from the hand-written argument lists; profiles differ in what they add around it.
+#define JESSI_DEFAULT_HEAP_MB 768
+
+enum {
+    JESSI_ARG_REQUIRED = 1 << 0,  // platform flag the user cannot override
+    JESSI_ARG_GC_TUNING = 1 << 1, // only meaningful for the profile's collector
+    JESSI_ARG_HEAP_SIZED = 1 << 2, // derived from the default -Xmx
+};
+
+typedef struct {
+    char *arg;
+    char key[JESSI_ARG_KEY_MAX];
+    int flags;
+} jessi_plan_arg;
+
+struct jessi_launch_plan {
+    jessi_plan_arg *args;
+    size_t count;
+    size_t cap;
+    const char *profile;
+    char **argv;
+    int failed;
+};
+
+typedef struct {
+    const char *name;
+    const char *gc;               // "-XX:+UseSerialGC", ...
+    int default_heap_mb;
+    int initial_heap_cap_mb;      // -Xms = min(heap, cap); 0 means -Xms = -Xmx
+} jessi_profile;
+
+static const jessi_profile jessi_profiles[] = {
+    { "mobile-standard",   "-XX:+UseSerialGC", JESSI_DEFAULT_HEAP_MB, 256 },
+    { "mobile-low-memory", "-XX:+UseSerialGC", JESSI_DEFAULT_HEAP_MB, 128 },
+    { "mobile-modded",     "-XX:+UseSerialGC", JESSI_DEFAULT_HEAP_MB, 512 },
+    { "desktop-serial",    "-XX:+UseSerialGC", JESSI_DEFAULT_HEAP_MB, 256 },
+    { "desktop-g1",        "-XX:+UseG1GC",     JESSI_DEFAULT_HEAP_MB, 0 },
+    { "tool",              "-XX:+UseSerialGC", 512, 16 },
+};
+
+static const jessi_profile *jessi_profile_named(const char *name) {
+    for (size_t i = 0; i < sizeof(jessi_profiles) / sizeof(jessi_profiles[0]); i++) {
+        if (strcmp(jessi_profiles[i].name, name) == 0) return &jessi_profiles[i];
+    }
+    return &jessi_profiles[0];
+}
+
+static int jessi_software_is(const char *software, const char *name) {
+    return software && strcmp(software, name) == 0;
+}
+
+static int jessi_software_is_modded(const char *software) {
+    return jessi_software_is(software, "forge") || jessi_software_is(software, "neoforge") ||
+           jessi_software_is(software, "fabric") || jessi_software_is(software, "quilt");
+}
+
+static const jessi_profile *jessi_pick_profile(const jessi_launch_inputs *in) {
+    if (in->kind == JESSI_LAUNCH_TOOL) return jessi_profile_named("tool");
+    if (in->spawned) {
+        int heap = in->heap_mb > 0 ? in->heap_mb : JESSI_DEFAULT_HEAP_MB;
+        // G1 needs spare cores for its concurrent threads and only pays off on bigger heaps.
+        if (in->java_major >= 17 && in->cpu_cores >= 4 && heap >= 2048) return jessi_profile_named("desktop-g1");
+        return jessi_profile_named("desktop-serial");
+    }
+    if (in->device_ram_mb > 0 && in->device_ram_mb <= 4096) return jessi_profile_named("mobile-low-memory");
+    if (jessi_software_is_modded(in->software)) return jessi_profile_named("mobile-modded");
+    return jessi_profile_named("mobile-standard");
+}
+
+// Flags that pick the collector; only one can be on, so they share the "gc" key.
+static const char *const jessi_gc_selectors[] = {
+    "UseSerialGC", "UseParallelGC", "UseG1GC", "UseZGC", "UseShenandoahGC", "UseEpsilonGC", "UseConcMarkSweepGC",
+};
+
+static int jessi_is_gc_selector(const char *name, size_t n) {
+    for (size_t i = 0; i < sizeof(jessi_gc_selectors) / sizeof(jessi_gc_selectors[0]); i++) {
+        if (strlen(jessi_gc_selectors[i]) == n && strncmp(name, jessi_gc_selectors[i], n) == 0) return 1;
+    }
+    return 0;
+}
+
+// "-Xmx2G" -> "-Xmx", "-XX:+UseG1GC" -> "gc", "-XX:-UseSerialGC" -> "-XX:UseSerialGC",
+// "-XX:MaxGCPauseMillis=50" -> "-XX:MaxGCPauseMillis", "-Dfoo=bar" -> "-Dfoo". Anything else has
+// no key and is never replaced.
+static void jessi_arg_key(const char *arg, char *key, size_t cap) {
+    key[0] = '\0';
+    if (!arg || cap < 8) return;
+    if (strncmp(arg, "-Xmx", 4) == 0 || strncmp(arg, "-Xms", 4) == 0 ||
+        strncmp(arg, "-Xss", 4) == 0 || strncmp(arg, "-Xmn", 4) == 0) {
+        memcpy(key, arg, 4);
+        key[4] = '\0';
+        return;
+    }
+    if (strncmp(arg, "-XX:", 4) == 0) {
+        const char *name = arg + 4;
+        int enable = *name == '+';
+        if (*name == '+' || *name == '-') name++;
+        size_t n = strcspn(name, "=");
+        // Turning a collector off, or a flag that merely ends in GC, must not displace the choice.
+        if (enable && jessi_is_gc_selector(name, n)) {
+            snprintf(key, cap, "gc");
+            return;
+        }
+        snprintf(key, cap, "-XX:%.*s", (int)n, name);
+        return;
+    }
+    if (strncmp(arg, "-D", 2) == 0 && arg[2]) {
+        size_t n = strcspn(arg, "=");
+        snprintf(key, cap, "%.*s", (int)n, arg);
+    }
+}
+
+// -jar, -cp/-classpath, @argfiles (Forge's unix_args.txt) or a bare class name start the command.
+static int jessi_is_main_token(const char *arg) {
+    if (!arg || !arg[0]) return 0;
+    if (strcmp(arg, "-jar") == 0 || strcmp(arg, "-cp") == 0 || strcmp(arg, "-classpath") == 0 ||
+        strcmp(arg, "--class-path") == 0 || strcmp(arg, "-m") == 0 || strcmp(arg, "--module") == 0) {
+        return 1;
+    }
+    return arg[0] == '@' || arg[0] != '-';
+}
+
+static jessi_plan_arg *jessi_plan_find(jessi_launch_plan *p, const char *key) {
+    if (!key[0]) return NULL;
+    for (size_t i = 0; i < p->count; i++) {
+        if (strcmp(p->args[i].key, key) == 0) return &p->args[i];
+    }
+    return NULL;
+}
+
+static void jessi_plan_remove(jessi_launch_plan *p, size_t idx) {
+    free(p->args[idx].arg);
+    memmove(&p->args[idx], &p->args[idx + 1], (p->count - idx - 1) * sizeof(jessi_plan_arg));
+    p->count--;
+}
+
+static void jessi_plan_push_raw(jessi_launch_plan *p, char *arg, const char *key, int flags) {
+    if (!arg) {
+        p->failed = 1;
+        return;
+    }
+    if (p->count == p->cap) {
+        size_t cap = p->cap ? p->cap * 2 : 48;
+        jessi_plan_arg *grown = realloc(p->args, cap * sizeof(jessi_plan_arg));
+        if (!grown) {
+            free(arg);
+            p->failed = 1;
+            return;
+        }
+        p->args = grown;
+        p->cap = cap;
+    }
+    jessi_plan_arg *slot = &p->args[p->count++];
+    slot->arg = arg;
+    snprintf(slot->key, sizeof(slot->key), "%s", key ? key : "");
+    slot->flags = flags;
+}
+
+// Adds a keyed default; a later default with the same key replaces the earlier one.
+static void jessi_plan_default(jessi_launch_plan *p, int flags, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    va_list copy;
+    va_copy(copy, ap);
+    int len = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    char *arg = len >= 0 ? malloc((size_t)len + 1) : NULL;
+    if (arg) vsnprintf(arg, (size_t)len + 1, fmt, ap);
+    va_end(ap);
+    if (!arg) {
+        p->failed = 1;
+        return;
+    }
+    char key[JESSI_ARG_KEY_MAX];
+    jessi_arg_key(arg, key, sizeof(key));
+    jessi_plan_arg *existing = jessi_plan_find(p, key);
+    if (existing) {
+        free(existing->arg);
+        existing->arg = arg;
+        existing->flags = flags;
+        return;
+    }
+    jessi_plan_push_raw(p, arg, key, flags);
+}
+
+static void jessi_plan_append(jessi_launch_plan *p, const char *arg) {
+    jessi_plan_push_raw(p, strdup(arg ? arg : ""), "", 0);
+}
+
+// Flags the in-process JVM cannot honour on this OS/runtime combination.
+static int jessi_user_arg_unsupported(const jessi_launch_inputs *in, const char *arg) {
+    if (in->spawned) return 0;
+    int ios26 = in->ios_major >= 26;
+    if (strstr(arg, "MirrorMappedCodeCache") && (!ios26 || in->java_major < 17)) return 1;
+    if (!ios26) {
+        if (strcmp(arg, "-Xverify:none") == 0) return 1;
+        if (strcmp(arg, "-XX:-UseCompressedOops") == 0) return 1;
+        if (strcmp(arg, "-XX:-UseCompressedClassPointers") == 0) return 1;
+    }
+    return 0;
+}
+
+static void jessi_plan_apply_user_args(jessi_launch_plan *p, const jessi_launch_inputs *in, int *has_main) {
+    int in_command = 0;
+    for (size_t i = 0; i < in->user_arg_count; i++) {
+        const char *arg = in->user_args[i];
+        if (!arg || !arg[0]) continue;
+        if (!in_command && jessi_is_main_token(arg)) {
+            in_command = 1;
+            *has_main = 1;
+        }
+        if (in_command) {
+            jessi_plan_append(p, arg);
+            continue;
+        }
+        if (jessi_user_arg_unsupported(in, arg)) continue;
+
+        char key[JESSI_ARG_KEY_MAX];
+        jessi_arg_key(arg, key, sizeof(key));
+        jessi_plan_arg *existing = jessi_plan_find(p, key);
+        if (existing && (existing->flags & JESSI_ARG_REQUIRED)) continue;
+        if (existing && strcmp(existing->arg, arg) == 0) {
+            existing->flags &= ~(JESSI_ARG_GC_TUNING | JESSI_ARG_HEAP_SIZED);
+            continue;
+        }
+        if (existing) {
+            size_t idx = (size_t)(existing - p->args);
+            jessi_plan_remove(p, idx);
+            if (strcmp(key, "gc") == 0) {
+                // Pause targets etc. were chosen for the profile's collector.
+                for (size_t j = p->count; j-- > 0;) {
+                    if (p->args[j].flags & JESSI_ARG_GC_TUNING) jessi_plan_remove(p, j);
+                }
+            }
+            if (strcmp(key, "-Xmx") == 0) {
+                // A default -Xms sized for the old heap could now exceed it.
+                for (size_t j = p->count; j-- > 0;) {
+                    if (p->args[j].flags & JESSI_ARG_HEAP_SIZED) jessi_plan_remove(p, j);
+                }
+            }
+        }
+        jessi_plan_push_raw(p, strdup(arg), key, 0);
+    }
+}
+
+jessi_launch_plan *jessi_launch_plan_build(const jessi_launch_inputs *in) {
+    if (!in || !in->java_path) return NULL;
+    jessi_launch_plan *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+
+    const jessi_profile *profile = jessi_pick_profile(in);
+    p->profile = profile->name;
+    int server = in->kind == JESSI_LAUNCH_SERVER;
+
+    int heap = in->heap_mb > 0 ? in->heap_mb : profile->default_heap_mb;
+    int initial = in->initial_heap_mb > 0 ? in->initial_heap_mb
+                : (profile->initial_heap_cap_mb > 0 ? profile->initial_heap_cap_mb : heap);
+    if (initial > heap) initial = heap;
+
+    jessi_plan_append(p, in->java_path);
+    jessi_plan_default(p, 0, "-Xmx%dM", heap);
+    jessi_plan_default(p, in->initial_heap_mb > 0 ? 0 : JESSI_ARG_HEAP_SIZED, "-Xms%dM", initial);
+
+    if (!in->spawned && server) {
+        int ios26 = in->ios_major >= 26;
+        if (ios26 && in->txm_support) {
+            jessi_plan_default(p, JESSI_ARG_REQUIRED, "-XX:+UnlockExperimentalVMOptions");
+            jessi_plan_default(p, JESSI_ARG_REQUIRED, "-XX:+DisablePrimordialThreadGuardPages");
+            if (in->java_major >= 17) jessi_plan_default(p, JESSI_ARG_REQUIRED, "-XX:+MirrorMappedCodeCache");
+        }
+        if (in->java_major >= 17 && !in->has_extended_va) {
+            jessi_plan_default(p, JESSI_ARG_REQUIRED, "-XX:-UseCompressedClassPointers");
+        }
+    }
+
+    jessi_plan_default(p, 0, "%s", profile->gc);
+    if (strcmp(profile->name, "desktop-g1") == 0) {
+        jessi_plan_default(p, JESSI_ARG_GC_TUNING, "-XX:MaxGCPauseMillis=50");
+        jessi_plan_default(p, JESSI_ARG_GC_TUNING, "-XX:+ParallelRefProcEnabled");
+    }
+    if (strcmp(profile->name, "mobile-low-memory") == 0) {
+        // Fewer JIT compiler threads and their arenas; 2 is the minimum with tiered compilation.
+        jessi_plan_default(p, 0, "-XX:CICompilerCount=2");
+    }
+    if (in->active_cpus > 0) jessi_plan_default(p, 0, "-XX:ActiveProcessorCount=%d", in->active_cpus);
+    if (server && !in->spawned && in->ios_major > 0 && in->ios_major <= 18) {
+        jessi_plan_default(p, 0, "-XX:ReservedCodeCacheSize=64M");
+    }
+    if (!server) jessi_plan_default(p, 0, "-XX:MaxMetaspaceSize=256M");
+
+    if (in->netty_no_native) jessi_plan_default(p, 0, "-Dio.netty.transport.noNative=true");
+    if (in->jna_no_sys) {
+        jessi_plan_default(p, 0, "-Djna.nosys=true");
+        jessi_plan_default(p, 0, "-Djna.nounpack=true");
+    }
+    if (server && jessi_software_is(in->software, "paper")) {
+        jessi_plan_default(p, 0, "-DPaper.IgnoreJavaVersion=true");
+    }
+
+    if (in->working_dir) {
+        jessi_plan_default(p, 0, "-Duser.dir=%s", in->working_dir);
+        jessi_plan_default(p, 0, "-Duser.home=%s", in->working_dir);
+    }
+    if (in->java_home) jessi_plan_default(p, 0, "-Djava.home=%s", in->java_home);
+    if (in->tmp_dir) jessi_plan_default(p, 0, "-Djava.io.tmpdir=%s", in->tmp_dir);
+    if (in->library_path && in->library_path[0]) jessi_plan_default(p, 0, "-Djava.library.path=%s", in->library_path);
+    jessi_plan_default(p, 0, "-Djava.awt.headless=true");
+    jessi_plan_default(p, 0, "-Djava.net.preferIPv4Stack=true");
+    if (server) {
+        jessi_plan_default(p, 0, "-Dsun.net.client.defaultConnectTimeout=30000");
+        jessi_plan_default(p, 0, "-Dsun.net.client.defaultReadTimeout=30000");
+        jessi_plan_default(p, 0, "-Dsun.nio.ch.disableSystemWideOverlappingFileLockCheck=true");
+    }
+
+    if (server && in->cds_archive && in->cds_archive[0]) {
+        if (in->cds_dump) jessi_plan_default(p, 0, "-XX:ArchiveClassesAtExit=%s", in->cds_archive);
+        else jessi_plan_default(p, 0, "-XX:SharedArchiveFile=%s", in->cds_archive);
+    }
+
+    int has_main = 0;
+    if (server) jessi_plan_apply_user_args(p, in, &has_main);
+    if (!has_main) {
+        jessi_plan_append(p, "-jar");
+        jessi_plan_append(p, in->jar_path ? in->jar_path : "");
+        if (server) jessi_plan_append(p, "nogui");
+    }
+    if (!server) {
+        for (size_t i = 0; i < in->program_arg_count; i++) {
+            if (in->program_args[i] && in->program_args[i][0]) jessi_plan_append(p, in->program_args[i]);
+        }
+    }
+
+    if (!p->failed) {
+        p->argv = calloc(p->count + 1, sizeof(char *));
+        if (p->argv) {
+            for (size_t i = 0; i < p->count; i++) p->argv[i] = p->args[i].arg;
+        } else {
+            p->failed = 1;
+        }
+    }
+    if (p->failed) {
+        jessi_launch_plan_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+void jessi_launch_plan_destroy(jessi_launch_plan *plan) {
+    if (!plan) return;
+    for (size_t i = 0; i < plan->count; i++) free(plan->args[i].arg);
+    free(plan->args);
+    free(plan->argv);
+    free(plan);
+}
+
+const char *jessi_launch_plan_profile(const jessi_launch_plan *plan) {
+    return plan ? plan->profile : "";
+}
+
+int jessi_launch_plan_argc(const jessi_launch_plan *plan) {
+    return plan ? (int)plan->count : 0;
+}
+
+char *const *jessi_launch_plan_argv(const jessi_launch_plan *plan) {
+    return plan ? plan->argv : NULL;
+}
+
+size_t jessi_launch_plan_format(const jessi_launch_plan *plan, char *buf, size_t cap) {
+    size_t need = 0;
+    if (buf && cap) buf[0] = '\0';
+    if (!plan) return 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        int n = snprintf(buf && need < cap ? buf + need : NULL, buf && need < cap ? cap - need : 0, "%s\n", plan->args[i].arg);
+        if (n > 0) need += (size_t)n;
+    }
+    return need;
+}
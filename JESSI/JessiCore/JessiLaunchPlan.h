@@ -0,0 +1,70 @@
+#ifndef JessiLaunchPlan_h
+#define JessiLaunchPlan_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    JESSI_LAUNCH_SERVER = 0,
+    JESSI_LAUNCH_TOOL,
+} jessi_launch_kind;
+
+typedef struct {
+    jessi_launch_kind kind;
+    int spawned;                  // external java process (macOS) rather than JLI in-process
+    int java_major;               // 8, 17, 21, ...
+    int ios_major;                // 0 when not on iOS
+    int txm_support;
+    int has_extended_va;
+    uint64_t device_ram_mb;       // 0 = unknown
+    int cpu_cores;                // 0 = unknown
+    const char *software;         // "vanilla", "paper", "forge", "fabric", ... (may be NULL)
+
+    int heap_mb;                  // 0 = profile default
+    int initial_heap_mb;          // 0 = profile default
+    int active_cpus;              // 0 = all
+    int netty_no_native;
+    int jna_no_sys;
+
+    const char *java_path;
+    const char *java_home;
+    const char *working_dir;
+    const char *tmp_dir;
+    const char *library_path;     // may be NULL
+    const char *jar_path;
+    const char *cds_archive;      // dynamic AppCDS archive, NULL to disable
+    int cds_dump;                 // write cds_archive at exit instead of mapping it
+
+    // Server: JVM flags and/or a full main-class command (jessi-launch-args.txt, settings).
+    // Flags with the same key as a default (-Xmx, -Xms, -XX:Name, -Dname, any collector
+    // selector such as -XX:+UseG1GC) replace it; once a main token (-jar, -cp, @argfile, a
+    // class name) appears, the rest is passed through untouched.
+    const char *const *user_args;
+    size_t user_arg_count;
+    // Tool: program arguments appended after "-jar <jar>".
+    const char *const *program_args;
+    size_t program_arg_count;
+} jessi_launch_inputs;
+
+typedef struct jessi_launch_plan jessi_launch_plan;
+
+jessi_launch_plan *jessi_launch_plan_build(const jessi_launch_inputs *in);
+void jessi_launch_plan_destroy(jessi_launch_plan *plan);
+
+// Name of the tuning profile the plan was built from, e.g. "mobile-standard".
+const char *jessi_launch_plan_profile(const jessi_launch_plan *plan);
+int jessi_launch_plan_argc(const jessi_launch_plan *plan);
+// NULL-terminated; owned by the plan.
+char *const *jessi_launch_plan_argv(const jessi_launch_plan *plan);
+// One argument per line; returns the length it needed.
+size_t jessi_launch_plan_format(const jessi_launch_plan *plan, char *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+#include "JessiLaunchTrace.h"
+#include "JessiChildChannel.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static jessi_launch_phase jessi_launch_phases[JESSI_LAUNCH_TRACE_MAX_PHASES];
+static int jessi_launch_phase_count;
+
+uint64_t jessi_launch_trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void jessi_launch_trace_reset(void) {
+    __atomic_store_n(&jessi_launch_phase_count, 0, __ATOMIC_RELEASE);
+}
+
+int jessi_launch_trace_begin(const char *name) {
+    int idx = __atomic_fetch_add(&jessi_launch_phase_count, 1, __ATOMIC_ACQ_REL);
+    if (idx >= JESSI_LAUNCH_TRACE_MAX_PHASES) {
+        __atomic_store_n(&jessi_launch_phase_count, JESSI_LAUNCH_TRACE_MAX_PHASES, __ATOMIC_RELEASE);
+        return -1;
+    }
+    jessi_launch_phases[idx].name = name ? name : "?";
+    jessi_launch_phases[idx].end_ns = 0;
+    jessi_launch_phases[idx].start_ns = jessi_launch_trace_now_ns();
+    // A spawned server reports its phases to the app as they start; no-op otherwise.
+    jessi_child_status_send("phase", "%s", jessi_launch_phases[idx].name);
+    return idx;
+}
+
+void jessi_launch_trace_end(int phase) {
+    if (phase < 0 || phase >= JESSI_LAUNCH_TRACE_MAX_PHASES) return;
+    jessi_launch_phases[phase].end_ns = jessi_launch_trace_now_ns();
+}
+
+void jessi_launch_trace_mark(const char *name) {
+    int idx = jessi_launch_trace_begin(name);
+    if (idx >= 0) jessi_launch_phases[idx].end_ns = jessi_launch_phases[idx].start_ns;
+}
+
+size_t jessi_launch_trace_count(void) {
+    int n = __atomic_load_n(&jessi_launch_phase_count, __ATOMIC_ACQUIRE);
+    return (size_t)(n > JESSI_LAUNCH_TRACE_MAX_PHASES ? JESSI_LAUNCH_TRACE_MAX_PHASES : n);
+}
+
+int jessi_launch_trace_get(size_t idx, jessi_launch_phase *out) {
+    if (!out || idx >= jessi_launch_trace_count()) return -1;
+    *out = jessi_launch_phases[idx];
+    return 0;
+}
+
+int jessi_launch_trace_write_json(const char *path) {
+    if (!path) return -1;
+    char tmp[1024];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return -1;
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+
+    fprintf(f, "{\n  \"version\": 1,\n  \"clock\": \"monotonic\",\n  \"pid\": %d,\n  \"written_at\": %lld,\n  \"phases\": [",
+            (int)getpid(), (long long)time(NULL));
+    size_t count = jessi_launch_trace_count();
+    for (size_t i = 0; i < count; i++) {
+        const jessi_launch_phase *p = &jessi_launch_phases[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"start_ns\": %llu, \"end_ns\": %llu, \"duration_ms\": %.3f}",
+                i ? "," : "", p->name,
+                (unsigned long long)p->start_ns, (unsigned long long)p->end_ns,
+                p->end_ns >= p->start_ns ? (double)(p->end_ns - p->start_ns) / 1e6 : 0.0);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    if (fclose(f) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return rename(tmp, path) == 0 ? 0 : -1;
+}
+
+size_t jessi_launch_trace_format_summary(char *buf, size_t cap) {
+    size_t len = 0;
+    size_t count = jessi_launch_trace_count();
+    if (cap) buf[0] = 0;
+    for (size_t i = 0; i < count; i++) {
+        const jessi_launch_phase *p = &jessi_launch_phases[i];
+        if (p->end_ns <= p->start_ns) continue;
+        int n = snprintf(len < cap ? buf + len : NULL, len < cap ? cap - len : 0, "%s%s %.0f ms",
+                         len ? ", " : "", p->name, (double)(p->end_ns - p->start_ns) / 1e6);
+        if (n > 0) len += (size_t)n;
+    }
+    return len;
+}
@@ -0,0 +1,41 @@
+#ifndef JessiLaunchTrace_h
+#define JessiLaunchTrace_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Process-wide launch phase tracer. Always compiled in; a phase costs two clock reads.
+// Timestamps are CLOCK_MONOTONIC, which is system-wide, so traces from the spawned JVM
+// process and the app line up.
+
+#define JESSI_LAUNCH_TRACE_MAX_PHASES 32
+
+typedef struct {
+    const char *name;     // must outlive the trace (use string literals)
+    uint64_t start_ns;
+    uint64_t end_ns;      // 0 while the phase is still open
+} jessi_launch_phase;
+
+uint64_t jessi_launch_trace_now_ns(void);
+void jessi_launch_trace_reset(void);
+// Returns a phase handle for jessi_launch_trace_end, or -1 when the table is full.
+int jessi_launch_trace_begin(const char *name);
+void jessi_launch_trace_end(int phase);
+void jessi_launch_trace_mark(const char *name);
+
+size_t jessi_launch_trace_count(void);
+int jessi_launch_trace_get(size_t idx, jessi_launch_phase *out);
+
+int jessi_launch_trace_write_json(const char *path);
+// "name 12 ms, name 340 ms, ..." for closed phases; returns the length it needed.
+size_t jessi_launch_trace_format_summary(char *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
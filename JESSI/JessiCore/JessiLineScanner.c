@@ -0,0 +1,274 @@
+#include "JessiLineScanner.h"
+
+#include <regex.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define JESSI_LINE_SCANNER_NEON 1
+#elif defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define JESSI_LINE_SCANNER_SSE2 1
+#endif
+
+#define JESSI_LINE_SCANNER_DEFAULT_MAX (1024 * 1024)
+#define JESSI_LINE_SCANNER_MIN_CAP 256
+
+const uint8_t *jessi_find_newline(const uint8_t *p, size_t len) {
+#if JESSI_LINE_SCANNER_NEON
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    while (len >= 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(p), nl);
+        if (vmaxvq_u8(eq)) {
+            // Narrow each 8-bit lane to 4 bits so the first match is ctz / 4.
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+        len -= 16;
+    }
+#elif JESSI_LINE_SCANNER_SSE2
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (len >= 16) {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), nl));
+        if (mask) return p + __builtin_ctz((unsigned)mask);
+        p += 16;
+        len -= 16;
+    }
+#endif
+    return len ? (const uint8_t *)memchr(p, '\n', len) : NULL;
+}
+
+size_t jessi_utf8_complete_prefix(const uint8_t *bytes, size_t len) {
+    size_t i = len;
+    size_t back = 0;
+    while (i > 0 && back < 4 && (bytes[i - 1] & 0xC0) == 0x80) {
+        i--;
+        back++;
+    }
+    if (i == 0) return len;
+
+    uint8_t lead = bytes[i - 1];
+    size_t need;
+    if (lead < 0x80) need = 1;
+    else if ((lead & 0xE0) == 0xC0) need = 2;
+    else if ((lead & 0xF0) == 0xE0) need = 3;
+    else if ((lead & 0xF8) == 0xF0) need = 4;
+    else return len;
+
+    return (back + 1 < need) ? i - 1 : len;
+}
+
+struct jessi_line_scanner {
+    uint8_t *carry;
+    size_t carry_len;
+    size_t carry_cap;
+    size_t max_line;
+};
+
+jessi_line_scanner *jessi_line_scanner_create(size_t max_line) {
+    jessi_line_scanner *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->max_line = max_line ? max_line : JESSI_LINE_SCANNER_DEFAULT_MAX;
+    if (s->max_line < 16) s->max_line = 16;
+    return s;
+}
+
+static int jessi_line_scanner_reserve(jessi_line_scanner *s, size_t need) {
+    if (need <= s->carry_cap) return 0;
+    size_t cap = s->carry_cap ? s->carry_cap : JESSI_LINE_SCANNER_MIN_CAP;
+    while (cap < need) cap *= 2;
+    if (cap > s->max_line) cap = s->max_line;
+    uint8_t *carry = realloc(s->carry, cap);
+    if (!carry) return -1;
+    s->carry = carry;
+    s->carry_cap = cap;
+    return 0;
+}
+
+// Emits the carried bytes up to the last complete UTF-8 sequence and keeps the rest.
+static void jessi_line_scanner_spill(jessi_line_scanner *s, jessi_line_fn fn, void *ctx) {
+    size_t cut = jessi_utf8_complete_prefix(s->carry, s->carry_len);
+    if (cut == 0) cut = s->carry_len;
+    fn(ctx, s->carry, cut, 0);
+    memmove(s->carry, s->carry + cut, s->carry_len - cut);
+    s->carry_len -= cut;
+}
+
+static void jessi_line_scanner_append(jessi_line_scanner *s, const uint8_t *p, size_t n,
+                                      jessi_line_fn fn, void *ctx) {
+    while (n > 0) {
+        size_t room = s->max_line - s->carry_len;
+        size_t take = n < room ? n : room;
+        if (jessi_line_scanner_reserve(s, s->carry_len + take) != 0) {
+            if (s->carry_len) jessi_line_scanner_spill(s, fn, ctx);
+            size_t cut = jessi_utf8_complete_prefix(p, n);
+            if (cut) fn(ctx, p, cut, 0);
+            p += cut;
+            n -= cut;
+            if (n && n < 4 && jessi_line_scanner_reserve(s, s->carry_len + n) == 0) {
+                memcpy(s->carry + s->carry_len, p, n);
+                s->carry_len += n;
+            }
+            return;
+        }
+        memcpy(s->carry + s->carry_len, p, take);
+        s->carry_len += take;
+        p += take;
+        n -= take;
+        if (s->carry_len >= s->max_line) jessi_line_scanner_spill(s, fn, ctx);
+    }
+}
+
+void jessi_line_scanner_feed(jessi_line_scanner *s, const uint8_t *bytes, size_t len, jessi_line_fn fn, void *ctx) {
+    if (!s || !bytes || !len || !fn) return;
+    const uint8_t *p = bytes;
+    const uint8_t *end = bytes + len;
+
+    if (s->carry_len) {
+        const uint8_t *nl = jessi_find_newline(p, len);
+        jessi_line_scanner_append(s, p, nl ? (size_t)(nl - p) : len, fn, ctx);
+        if (!nl) return;
+        fn(ctx, s->carry, s->carry_len, 1);
+        s->carry_len = 0;
+        p = nl + 1;
+    }
+
+    while (p < end) {
+        const uint8_t *nl = jessi_find_newline(p, (size_t)(end - p));
+        if (!nl) break;
+        fn(ctx, p, (size_t)(nl - p), 1);
+        p = nl + 1;
+    }
+
+    if (p < end) jessi_line_scanner_append(s, p, (size_t)(end - p), fn, ctx);
+}
+
+void jessi_line_scanner_flush(jessi_line_scanner *s, jessi_line_fn fn, void *ctx) {
+    if (!s || !s->carry_len) return;
+    if (fn) fn(ctx, s->carry, s->carry_len, 0);
+    s->carry_len = 0;
+}
+
+void jessi_line_scanner_reset(jessi_line_scanner *s) {
+    if (s) s->carry_len = 0;
+}
+
+size_t jessi_line_scanner_pending(const jessi_line_scanner *s) {
+    return s ? s->carry_len : 0;
+}
+
+void jessi_line_scanner_destroy(jessi_line_scanner *s) {
+    if (!s) return;
+    free(s->carry);
+    free(s);
+}
+
+typedef struct {
+    jessi_line_rule_kind kind;
+    uint8_t *pattern;
+    size_t len;
+    regex_t re;
+} jessi_line_rule;
+
+struct jessi_line_filter {
+    jessi_line_rule *rules;
+    size_t count;
+    size_t cap;
+};
+
+jessi_line_filter *jessi_line_filter_create(void) {
+    return calloc(1, sizeof(jessi_line_filter));
+}
+
+int jessi_line_filter_add(jessi_line_filter *f, jessi_line_rule_kind kind, const char *pattern) {
+    if (!f || !pattern || !pattern[0]) return -1;
+    if (f->count == f->cap) {
+        size_t cap = f->cap ? f->cap * 2 : 4;
+        jessi_line_rule *rules = realloc(f->rules, cap * sizeof(*rules));
+        if (!rules) return -1;
+        f->rules = rules;
+        f->cap = cap;
+    }
+
+    jessi_line_rule *r = &f->rules[f->count];
+    memset(r, 0, sizeof(*r));
+    r->kind = kind;
+    if (kind == JESSI_LINE_RULE_REGEX) {
+        if (regcomp(&r->re, pattern, REG_EXTENDED | REG_NOSUB) != 0) return -1;
+    } else if (kind == JESSI_LINE_RULE_SUBSTRING || kind == JESSI_LINE_RULE_PREFIX) {
+        r->len = strlen(pattern);
+        r->pattern = malloc(r->len);
+        if (!r->pattern) return -1;
+        memcpy(r->pattern, pattern, r->len);
+    } else {
+        return -1;
+    }
+    f->count++;
+    return 0;
+}
+
+static int jessi_line_contains(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+    if (needle_len > hay_len) return 0;
+    const uint8_t *p = hay;
+    const uint8_t *last = hay + (hay_len - needle_len);
+    while (p <= last) {
+        p = memchr(p, needle[0], (size_t)(last - p) + 1);
+        if (!p) return 0;
+        if (memcmp(p + 1, needle + 1, needle_len - 1) == 0) return 1;
+        p++;
+    }
+    return 0;
+}
+
+static int jessi_line_regex_matches(const regex_t *re, const uint8_t *line, size_t len) {
+#ifdef REG_STARTEND
+    regmatch_t m;
+    m.rm_so = 0;
+    m.rm_eo = (regoff_t)len;
+    return regexec(re, (const char *)line, 1, &m, REG_STARTEND) == 0;
+#else
+    char stackbuf[1024];
+    char *buf = len < sizeof(stackbuf) ? stackbuf : malloc(len + 1);
+    if (!buf) return 0;
+    memcpy(buf, line, len);
+    buf[len] = 0;
+    int hit = regexec(re, buf, 0, NULL, 0) == 0;
+    if (buf != stackbuf) free(buf);
+    return hit;
+#endif
+}
+
+int jessi_line_filter_matches(const jessi_line_filter *f, const uint8_t *line, size_t len) {
+    if (!f || !line) return 0;
+    for (size_t i = 0; i < f->count; i++) {
+        const jessi_line_rule *r = &f->rules[i];
+        switch (r->kind) {
+            case JESSI_LINE_RULE_SUBSTRING:
+                if (jessi_line_contains(line, len, r->pattern, r->len)) return 1;
+                break;
+            case JESSI_LINE_RULE_PREFIX:
+                if (len >= r->len && memcmp(line, r->pattern, r->len) == 0) return 1;
+                break;
+            case JESSI_LINE_RULE_REGEX:
+                if (jessi_line_regex_matches(&r->re, line, len)) return 1;
+                break;
+        }
+    }
+    return 0;
+}
+
+size_t jessi_line_filter_count(const jessi_line_filter *f) {
+    return f ? f->count : 0;
+}
+
+void jessi_line_filter_destroy(jessi_line_filter *f) {
+    if (!f) return;
+    for (size_t i = 0; i < f->count; i++) {
+        if (f->rules[i].kind == JESSI_LINE_RULE_REGEX) regfree(&f->rules[i].re);
+        free(f->rules[i].pattern);
+    }
+    free(f->rules);
+    free(f);
+}
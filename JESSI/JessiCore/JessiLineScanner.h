@@ -0,0 +1,51 @@
+#ifndef JessiLineScanner_h
+#define JessiLineScanner_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// `line` excludes the trailing '\n'. `terminated` is 0 when a partial line is forced out
+// by a flush or by the length cap; such a line always ends on a UTF-8 boundary.
+typedef void (*jessi_line_fn)(void *ctx, const uint8_t *line, size_t len, int terminated);
+
+typedef struct jessi_line_scanner jessi_line_scanner;
+
+// Lines longer than `max_line` bytes are emitted in pieces. 0 picks a default (1 MB).
+jessi_line_scanner *jessi_line_scanner_create(size_t max_line);
+// Complete lines are emitted straight from `bytes`; only the trailing partial line is copied.
+void jessi_line_scanner_feed(jessi_line_scanner *s, const uint8_t *bytes, size_t len, jessi_line_fn fn, void *ctx);
+void jessi_line_scanner_flush(jessi_line_scanner *s, jessi_line_fn fn, void *ctx);
+void jessi_line_scanner_reset(jessi_line_scanner *s);
+size_t jessi_line_scanner_pending(const jessi_line_scanner *s);
+void jessi_line_scanner_destroy(jessi_line_scanner *s);
+
+// Vectorized on arm64 (NEON) and x86_64 (SSE2).
+const uint8_t *jessi_find_newline(const uint8_t *p, size_t len);
+// Length of the longest prefix of `bytes` that does not end inside a UTF-8 sequence.
+size_t jessi_utf8_complete_prefix(const uint8_t *bytes, size_t len);
+
+typedef enum {
+    JESSI_LINE_RULE_SUBSTRING = 0,
+    JESSI_LINE_RULE_PREFIX = 1,
+    JESSI_LINE_RULE_REGEX = 2,
+} jessi_line_rule_kind;
+
+typedef struct jessi_line_filter jessi_line_filter;
+
+jessi_line_filter *jessi_line_filter_create(void);
+// Returns 0 on success, -1 if the pattern is empty or the regex does not compile (POSIX ERE).
+int jessi_line_filter_add(jessi_line_filter *f, jessi_line_rule_kind kind, const char *pattern);
+// Non-zero if any rule matches. Safe to call concurrently once all rules are added.
+int jessi_line_filter_matches(const jessi_line_filter *f, const uint8_t *line, size_t len);
+size_t jessi_line_filter_count(const jessi_line_filter *f);
+void jessi_line_filter_destroy(jessi_line_filter *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
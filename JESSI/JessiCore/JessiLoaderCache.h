@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Forge/NeoForge installer output shared by every server (Application Support/LoaderCache).
+// objects/ holds files by SHA-256, manifests/ lists what one loader version's installer left in a
+// server folder. Materializing clones each object into the folder (copy-on-write on APFS), then
+// falls back to a hard link for libraries/ and a plain copy for everything else.
+@interface JessiLoaderCache : NSObject
+
++ (instancetype)shared;
+
+// loader is "forge" or "neoforge". Returns the unix_args.txt path relative to serverDir, or nil
+// when the version isn't cached or an object is missing; the caller then runs the installer.
+- (nullable NSString *)materializeLoader:(NSString *)loader
+                                 version:(NSString *)version
+                           intoServerDir:(NSString *)serverDir;
+
+// Records what the installer produced. Top-level names in preexisting (and the installer jar,
+// logs and jessi-* files) are left out, so server.properties and friends are never shared.
+- (BOOL)storeLoader:(NSString *)loader
+            version:(NSString *)version
+      fromServerDir:(NSString *)serverDir
+       unixArgsPath:(NSString *)unixArgsRel
+        preexisting:(NSSet<NSString *> *)preexisting;
+
+@end
+
+NS_ASSUME_NONNULL_END
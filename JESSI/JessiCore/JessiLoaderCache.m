@@ -0,0 +1,252 @@
+#import "JessiLoaderCache.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#include <copyfile.h>
+#include <sys/clonefile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const int JessiLoaderManifestFormat = 1;
+
+static NSString *jessi_loader_sha256_of_file(NSString *path) {
+    NSInputStream *in = [NSInputStream inputStreamWithFileAtPath:path];
+    if (!in) return nil;
+    [in open];
+    CC_SHA256_CTX ctx;
+    CC_SHA256_Init(&ctx);
+    uint8_t buf[64 * 1024];
+    NSInteger n;
+    while ((n = [in read:buf maxLength:sizeof(buf)]) > 0) CC_SHA256_Update(&ctx, buf, (CC_LONG)n);
+    [in close];
+    if (n < 0) return nil;
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &ctx);
+    NSMutableString *hex = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (size_t i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) [hex appendFormat:@"%02x", digest[i]];
+    return hex;
+}
+
+static BOOL jessi_loader_is_sha256(id s) {
+    if (![s isKindOfClass:[NSString class]] || [s length] != CC_SHA256_DIGEST_LENGTH * 2) return NO;
+    NSCharacterSet *bad = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    return [s rangeOfCharacterFromSet:bad].location == NSNotFound;
+}
+
+// Manifest paths come from disk; only accept plain relative paths inside the server folder.
+static BOOL jessi_loader_is_safe_relative(id rel) {
+    if (![rel isKindOfClass:[NSString class]] || [rel length] == 0 || [rel hasPrefix:@"/"]) return NO;
+    for (NSString *part in [rel componentsSeparatedByString:@"/"]) {
+        if (part.length == 0 || [part isEqualToString:@"."] || [part isEqualToString:@".."]) return NO;
+    }
+    return YES;
+}
+
+typedef NS_ENUM(NSInteger, JessiLoaderPlace) {
+    JessiLoaderPlaceFailed = 0,
+    JessiLoaderPlaceCloned,
+    JessiLoaderPlaceLinked,
+    JessiLoaderPlaceCopied,
+};
+
+@implementation JessiLoaderCache {
+    NSString *_root;
+}
+
++ (instancetype)shared {
+    static JessiLoaderCache *shared;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        shared = [[JessiLoaderCache alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        NSURL *appSupport = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
+                                                                    inDomains:NSUserDomainMask] firstObject];
+        _root = [[appSupport URLByAppendingPathComponent:@"LoaderCache" isDirectory:YES] path];
+    }
+    return self;
+}
+
+- (NSString *)manifestPathForLoader:(NSString *)loader version:(NSString *)version {
+    NSString *name = [[NSString stringWithFormat:@"%@-%@", loader, version] stringByReplacingOccurrencesOfString:@"/" withString:@"_"];
+    return [[_root stringByAppendingPathComponent:@"manifests"] stringByAppendingPathComponent:[name stringByAppendingPathExtension:@"json"]];
+}
+
+- (NSString *)objectPathForHash:(NSString *)sha {
+    return [[[_root stringByAppendingPathComponent:@"objects"] stringByAppendingPathComponent:[sha substringToIndex:2]]
+            stringByAppendingPathComponent:sha];
+}
+
+- (nullable NSDictionary *)manifestForLoader:(NSString *)loader version:(NSString *)version {
+    NSData *data = [NSData dataWithContentsOfFile:[self manifestPathForLoader:loader version:version]];
+    id obj = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![obj isKindOfClass:[NSDictionary class]]) return nil;
+    if ([obj[@"format"] intValue] != JessiLoaderManifestFormat) return nil;
+    if (!jessi_loader_is_safe_relative(obj[@"unixArgs"]) || ![obj[@"files"] isKindOfClass:[NSArray class]]) return nil;
+    return obj;
+}
+
+// Objects are read-only so a hard-linked library can't be modified through a server folder.
+- (BOOL)addObjectFromPath:(NSString *)src sha256:(NSString *)sha {
+    NSString *dest = [self objectPathForHash:sha];
+    if (access(dest.fileSystemRepresentation, F_OK) == 0) return YES;
+    [[NSFileManager defaultManager] createDirectoryAtPath:[dest stringByDeletingLastPathComponent]
+                              withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *tmp = [dest stringByAppendingFormat:@".%@.tmp", [NSUUID UUID].UUIDString];
+    if (clonefile(src.fileSystemRepresentation, tmp.fileSystemRepresentation, 0) != 0 &&
+        copyfile(src.fileSystemRepresentation, tmp.fileSystemRepresentation, NULL, COPYFILE_DATA) != 0) {
+        unlink(tmp.fileSystemRepresentation);
+        return NO;
+    }
+    chmod(tmp.fileSystemRepresentation, 0444);
+    if (rename(tmp.fileSystemRepresentation, dest.fileSystemRepresentation) != 0) {
+        unlink(tmp.fileSystemRepresentation);
+        return access(dest.fileSystemRepresentation, F_OK) == 0;
+    }
+    return YES;
+}
+
+- (JessiLoaderPlace)placeObject:(NSString *)object at:(NSString *)dest mode:(mode_t)mode library:(BOOL)library {
+    const char *o = object.fileSystemRepresentation;
+    const char *d = dest.fileSystemRepresentation;
+    unlink(d);
+    if (clonefile(o, d, 0) == 0) {
+        chmod(d, mode);
+        return JessiLoaderPlaceCloned;
+    }
+    if (library && link(o, d) == 0) return JessiLoaderPlaceLinked;
+    if (copyfile(o, d, NULL, COPYFILE_DATA) == 0) {
+        chmod(d, mode);
+        return JessiLoaderPlaceCopied;
+    }
+    return JessiLoaderPlaceFailed;
+}
+
+- (NSString *)materializeLoader:(NSString *)loader version:(NSString *)version intoServerDir:(NSString *)serverDir {
+    if (!loader.length || !version.length || !serverDir.length || !_root.length) return nil;
+    @synchronized (self) {
+        NSDictionary *manifest = [self manifestForLoader:loader version:version];
+        if (!manifest) return nil;
+        NSArray *files = manifest[@"files"];
+
+        // Check everything first so a miss never leaves a half-populated folder behind.
+        BOOL sawUnixArgs = NO;
+        for (NSDictionary *f in files) {
+            if (![f isKindOfClass:[NSDictionary class]] || !jessi_loader_is_safe_relative(f[@"path"]) ||
+                !jessi_loader_is_sha256(f[@"sha256"])) {
+                return nil;
+            }
+            struct stat st;
+            if (stat([self objectPathForHash:f[@"sha256"]].fileSystemRepresentation, &st) != 0 ||
+                (unsigned long long)st.st_size != [f[@"size"] unsignedLongLongValue]) {
+                NSLog(@"[JESSI] [LoaderCache] %@ %@: object for %@ is missing, running the installer", loader, version, f[@"path"]);
+                return nil;
+            }
+            if ([f[@"path"] isEqualToString:manifest[@"unixArgs"]]) sawUnixArgs = YES;
+        }
+        if (!sawUnixArgs) return nil;
+
+        NSFileManager *fm = [NSFileManager defaultManager];
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSUInteger counts[4] = {0};
+        unsigned long long bytes = 0;
+        for (NSDictionary *f in files) {
+            NSString *rel = f[@"path"];
+            NSString *dest = [serverDir stringByAppendingPathComponent:rel];
+            [fm createDirectoryAtPath:[dest stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+            mode_t mode = ([f[@"mode"] unsignedShortValue] & 0777) ?: 0644;
+            JessiLoaderPlace how = [self placeObject:[self objectPathForHash:f[@"sha256"]]
+                                                  at:dest
+                                                mode:mode
+                                             library:[rel hasPrefix:@"libraries/"]];
+            if (how == JessiLoaderPlaceFailed) {
+                NSLog(@"[JESSI] [LoaderCache] %@ %@: couldn't place %@ (%s)", loader, version, rel, strerror(errno));
+                return nil;
+            }
+            counts[how]++;
+            bytes += [f[@"size"] unsignedLongLongValue];
+        }
+
+        NSLog(@"[JESSI] [LoaderCache] %@ %@: %lu files (%.1f MB) from cache in %.0f ms, cloned=%lu linked=%lu copied=%lu",
+              loader, version, (unsigned long)files.count, bytes / (1024.0 * 1024.0),
+              (CFAbsoluteTimeGetCurrent() - start) * 1000.0, (unsigned long)counts[JessiLoaderPlaceCloned],
+              (unsigned long)counts[JessiLoaderPlaceLinked], (unsigned long)counts[JessiLoaderPlaceCopied]);
+        return manifest[@"unixArgs"];
+    }
+}
+
+- (BOOL)storeLoader:(NSString *)loader
+            version:(NSString *)version
+      fromServerDir:(NSString *)serverDir
+       unixArgsPath:(NSString *)unixArgsRel
+        preexisting:(NSSet<NSString *> *)preexisting {
+    if (!loader.length || !version.length || !serverDir.length || !_root.length) return NO;
+    if (!jessi_loader_is_safe_relative(unixArgsRel)) return NO;
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSURL *base = [NSURL fileURLWithPath:serverDir isDirectory:YES];
+    NSDirectoryEnumerator<NSURL *> *e = [fm enumeratorAtURL:base
+                                 includingPropertiesForKeys:@[NSURLIsRegularFileKey, NSURLIsDirectoryKey]
+                                                    options:NSDirectoryEnumerationSkipsHiddenFiles
+                                               errorHandler:nil];
+    NSString *prefix = [base.path stringByAppendingString:@"/"];
+    NSMutableArray<NSDictionary *> *files = [NSMutableArray array];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    unsigned long long bytes = 0;
+    BOOL sawUnixArgs = NO;
+
+    @synchronized (self) {
+        for (NSURL *url in e) {
+            if (e.level == 1) {
+                NSString *name = url.lastPathComponent;
+                if ([preexisting containsObject:name] || [name hasPrefix:@"jessi-"] ||
+                    [name hasSuffix:@"-installer.jar"] || [name hasSuffix:@".log"]) {
+                    NSNumber *isDir = nil;
+                    [url getResourceValue:&isDir forKey:NSURLIsDirectoryKey error:nil];
+                    if (isDir.boolValue) [e skipDescendants];
+                    continue;
+                }
+            }
+            NSNumber *isFile = nil;
+            [url getResourceValue:&isFile forKey:NSURLIsRegularFileKey error:nil];
+            if (!isFile.boolValue || ![url.path hasPrefix:prefix]) continue;
+
+            NSString *rel = [url.path substringFromIndex:prefix.length];
+            struct stat st;
+            if (stat(url.path.fileSystemRepresentation, &st) != 0) return NO;
+            NSString *sha = jessi_loader_sha256_of_file(url.path);
+            if (!sha || ![self addObjectFromPath:url.path sha256:sha]) {
+                NSLog(@"[JESSI] [LoaderCache] %@ %@: couldn't store %@", loader, version, rel);
+                return NO;
+            }
+            [files addObject:@{@"path": rel, @"sha256": sha, @"size": @((unsigned long long)st.st_size),
+                               @"mode": @(st.st_mode & 0777)}];
+            bytes += (unsigned long long)st.st_size;
+            if ([rel isEqualToString:unixArgsRel]) sawUnixArgs = YES;
+        }
+        if (!sawUnixArgs) return NO;
+
+        NSDictionary *manifest = @{
+            @"format": @(JessiLoaderManifestFormat),
+            @"loader": loader,
+            @"version": version,
+            @"unixArgs": unixArgsRel,
+            @"created": @((long long)[NSDate date].timeIntervalSince1970),
+            @"files": files,
+        };
+        NSData *out = [NSJSONSerialization dataWithJSONObject:manifest options:0 error:nil];
+        NSString *path = [self manifestPathForLoader:loader version:version];
+        [fm createDirectoryAtPath:[path stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+        if (!out || ![out writeToFile:path atomically:YES]) return NO;
+    }
+
+    NSLog(@"[JESSI] [LoaderCache] stored %@ %@: %lu files (%.1f MB) in %.0f ms",
+          loader, version, (unsigned long)files.count, bytes / (1024.0 * 1024.0),
+          (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+    return YES;
+}
+
+@end
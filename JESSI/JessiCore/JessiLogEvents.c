@@ -0,0 +1,257 @@
+#include "JessiLogEvents.h"
+
+#include <string.h>
+
+#define JESSI_LIT(s) (const uint8_t *)(s), (sizeof(s) - 1)
+
+void jessi_log_parser_init(jessi_log_parser *p) {
+    if (!p) return;
+    p->in_exception = 0;
+    p->exception_has_body = 0;
+}
+
+static int jessi_has_prefix(const uint8_t *p, size_t len, const uint8_t *lit, size_t lit_len) {
+    return len >= lit_len && memcmp(p, lit, lit_len) == 0;
+}
+
+static int jessi_has_suffix(const uint8_t *p, size_t len, const uint8_t *lit, size_t lit_len) {
+    return len >= lit_len && memcmp(p + len - lit_len, lit, lit_len) == 0;
+}
+
+static const uint8_t *jessi_find_byte(const uint8_t *p, size_t len, uint8_t c) {
+    return len ? (const uint8_t *)memchr(p, c, len) : NULL;
+}
+
+static const uint8_t *jessi_find_lit(const uint8_t *p, size_t len, const uint8_t *lit, size_t lit_len) {
+    if (lit_len == 0 || len < lit_len) return NULL;
+    const uint8_t *end = p + (len - lit_len);
+    while (p <= end) {
+        p = memchr(p, lit[0], (size_t)(end - p) + 1);
+        if (!p) return NULL;
+        if (memcmp(p, lit, lit_len) == 0) return p;
+        p++;
+    }
+    return NULL;
+}
+
+static jessi_log_level jessi_parse_level(const uint8_t *p, size_t len) {
+    if (len == 4 && memcmp(p, "INFO", 4) == 0) return JESSI_LOG_LEVEL_INFO;
+    if (len == 4 && memcmp(p, "WARN", 4) == 0) return JESSI_LOG_LEVEL_WARN;
+    if (len == 7 && memcmp(p, "WARNING", 7) == 0) return JESSI_LOG_LEVEL_WARN;
+    if (len == 5 && memcmp(p, "ERROR", 5) == 0) return JESSI_LOG_LEVEL_ERROR;
+    if (len == 6 && memcmp(p, "SEVERE", 6) == 0) return JESSI_LOG_LEVEL_ERROR;
+    if (len == 5 && memcmp(p, "FATAL", 5) == 0) return JESSI_LOG_LEVEL_FATAL;
+    if (len == 5 && memcmp(p, "DEBUG", 5) == 0) return JESSI_LOG_LEVEL_DEBUG;
+    if (len == 5 && memcmp(p, "TRACE", 5) == 0) return JESSI_LOG_LEVEL_DEBUG;
+    return JESSI_LOG_LEVEL_UNKNOWN;
+}
+
+// Returns 1 and fills level/thread/message when the line starts with a recognised header.
+static int jessi_parse_header(const uint8_t *line, size_t len, jessi_log_event *ev) {
+    if (len < 3 || line[0] != '[') return 0;
+    const uint8_t *close = jessi_find_byte(line + 1, len - 1, ']');
+    if (!close) return 0;
+    size_t pos = (size_t)(close - line) + 1;
+
+    // Paper: "[12:34:56 INFO]". Anything else in the first bracket is a timestamp, with or
+    // without a date: Forge/NeoForge write "[15Oct2026 12:34:56.789]".
+    int paper = 0;
+    for (const uint8_t *q = close - 1; q > line; q--) {
+        if (*q != ' ') continue;
+        ev->level = jessi_parse_level(q + 1, (size_t)(close - q) - 1);
+        paper = ev->level != JESSI_LOG_LEVEL_UNKNOWN;
+        break;
+    }
+
+    // Vanilla/Forge/Fabric: "[12:34:56] [Server thread/INFO]"
+    if (!paper && pos + 1 < len && line[pos] == ' ' && line[pos + 1] == '[') {
+        const uint8_t *open = line + pos + 1;
+        const uint8_t *tclose = jessi_find_byte(open + 1, len - pos - 2, ']');
+        if (!tclose) return 0;
+        const uint8_t *slash = NULL;
+        for (const uint8_t *q = tclose - 1; q > open; q--) {
+            if (*q == '/') { slash = q; break; }
+        }
+        if (!slash) return 0;
+        ev->level = jessi_parse_level(slash + 1, (size_t)(tclose - slash) - 1);
+        if (ev->level == JESSI_LOG_LEVEL_UNKNOWN) return 0;
+        ev->thread.offset = (size_t)(open + 1 - line);
+        ev->thread.length = (size_t)(slash - open) - 1;
+        pos = (size_t)(tclose - line) + 1;
+
+        // Forge "[logger]:" or Fabric "(logger)".
+        if (pos + 1 < len && line[pos] == ' ' && (line[pos + 1] == '[' || line[pos + 1] == '(')) {
+            uint8_t want = line[pos + 1] == '[' ? ']' : ')';
+            const uint8_t *lclose = jessi_find_byte(line + pos + 2, len - pos - 2, want);
+            if (lclose) pos = (size_t)(lclose - line) + 1;
+        }
+    } else if (!paper) {
+        return 0;
+    }
+
+    if (pos < len && line[pos] == ':') pos++;
+    while (pos < len && line[pos] == ' ') pos++;
+    ev->message.offset = pos;
+    ev->message.length = len - pos;
+    return 1;
+}
+
+static int jessi_is_stack_continuation(const uint8_t *m, size_t len) {
+    size_t ws = 0;
+    while (ws < len && (m[ws] == ' ' || m[ws] == '\t')) ws++;
+    const uint8_t *p = m + ws;
+    size_t n = len - ws;
+    if (ws && jessi_has_prefix(p, n, JESSI_LIT("at "))) return 1;
+    if (ws && jessi_has_prefix(p, n, JESSI_LIT("... "))) return 1;
+    if (jessi_has_prefix(p, n, JESSI_LIT("Caused by: "))) return 1;
+    if (jessi_has_prefix(p, n, JESSI_LIT("Suppressed: "))) return 1;
+    return 0;
+}
+
+// "java.lang.IllegalStateException: ..." or "Exception in thread ..."
+static int jessi_is_exception_header(const uint8_t *m, size_t len) {
+    if (jessi_has_prefix(m, len, JESSI_LIT("Exception in thread "))) return 1;
+    size_t i = 0;
+    int dots = 0;
+    while (i < len) {
+        uint8_t c = m[i];
+        if (c == '.') dots++;
+        else if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$')) break;
+        i++;
+    }
+    if (!dots || i == 0) return 0;
+    if (i < len && m[i] != ':') return 0;
+    return jessi_has_suffix(m, i, JESSI_LIT("Exception")) ||
+           jessi_has_suffix(m, i, JESSI_LIT("Error")) ||
+           jessi_has_suffix(m, i, JESSI_LIT("Throwable"));
+}
+
+static int jessi_parse_uint(const uint8_t *p, size_t len, size_t *pos, int64_t *out) {
+    size_t i = *pos;
+    int64_t v = 0;
+    size_t start = i;
+    while (i < len && p[i] >= '0' && p[i] <= '9') {
+        if (v < INT64_MAX / 10) v = v * 10 + (p[i] - '0');
+        i++;
+    }
+    if (i == start) return 0;
+    *pos = i;
+    *out = v;
+    return 1;
+}
+
+// "Done (12.345s)!" -> 12345
+static int jessi_parse_done(const uint8_t *m, size_t len, int64_t *ms) {
+    if (!jessi_has_prefix(m, len, JESSI_LIT("Done ("))) return 0;
+    size_t pos = 6;
+    int64_t whole = 0;
+    if (!jessi_parse_uint(m, len, &pos, &whole)) return 0;
+    int64_t frac = 0;
+    int digits = 0;
+    if (pos < len && (m[pos] == '.' || m[pos] == ',')) {
+        pos++;
+        while (pos < len && m[pos] >= '0' && m[pos] <= '9') {
+            if (digits < 3) {
+                frac = frac * 10 + (m[pos] - '0');
+                digits++;
+            }
+            pos++;
+        }
+    }
+    if (pos >= len || m[pos] != 's') return 0;
+    while (digits < 3) {
+        frac *= 10;
+        digits++;
+    }
+    *ms = whole * 1000 + frac;
+    return 1;
+}
+
+// "Can't keep up! Is the server overloaded? Running 2034ms or 40 ticks behind"
+static int jessi_parse_lag(const uint8_t *m, size_t len, int64_t *ms, int64_t *ticks) {
+    if (!jessi_has_prefix(m, len, JESSI_LIT("Can't keep up!"))) return 0;
+    const uint8_t *run = jessi_find_lit(m, len, JESSI_LIT("Running "));
+    *ms = 0;
+    *ticks = 0;
+    if (!run) return 1;
+    size_t pos = (size_t)(run - m) + 8;
+    if (!jessi_parse_uint(m, len, &pos, ms)) return 1;
+    if (jessi_has_prefix(m + pos, len - pos, JESSI_LIT("ms or "))) {
+        pos += 6;
+        jessi_parse_uint(m, len, &pos, ticks);
+    }
+    return 1;
+}
+
+static int jessi_parse_player(const uint8_t *m, size_t len, const uint8_t *suffix, size_t suffix_len, jessi_log_span *name, size_t base) {
+    if (!jessi_has_suffix(m, len, suffix, suffix_len)) return 0;
+    size_t n = len - suffix_len;
+    if (n == 0 || n > 64) return 0;
+    for (size_t i = 0; i < n; i++) {
+        if (m[i] == ' ' || m[i] == '<' || m[i] == '[') return 0;
+    }
+    name->offset = base;
+    name->length = n;
+    return 1;
+}
+
+jessi_log_event_kind jessi_log_parser_feed(jessi_log_parser *p, const uint8_t *line, size_t len, jessi_log_event *out) {
+    jessi_log_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if (len && line[len - 1] == '\r') len--;
+
+    int has_header = jessi_parse_header(line, len, &ev);
+    if (!has_header) {
+        ev.message.offset = 0;
+        ev.message.length = len;
+    }
+    const uint8_t *m = line + ev.message.offset;
+    size_t mlen = ev.message.length;
+
+    if (!has_header && p->in_exception) {
+        if (jessi_is_stack_continuation(m, mlen)) {
+            p->exception_has_body = 1;
+            ev.kind = JESSI_LOG_EVENT_STACK_FRAME;
+            goto done;
+        }
+        // An ERROR line is usually followed by the exception it describes; count them once.
+        if (!p->exception_has_body && jessi_is_exception_header(m, mlen)) {
+            p->exception_has_body = 1;
+            ev.kind = JESSI_LOG_EVENT_STACK_FRAME;
+            goto done;
+        }
+    }
+
+    if (jessi_is_exception_header(m, mlen) ||
+        (has_header && ev.level >= JESSI_LOG_LEVEL_ERROR)) {
+        p->in_exception = 1;
+        p->exception_has_body = jessi_is_exception_header(m, mlen);
+        ev.kind = JESSI_LOG_EVENT_EXCEPTION;
+        ev.subject = ev.message;
+        goto done;
+    }
+    if (has_header) p->in_exception = 0;
+
+    if (jessi_parse_done(m, mlen, &ev.value)) {
+        ev.kind = JESSI_LOG_EVENT_DONE;
+    } else if (jessi_parse_lag(m, mlen, &ev.value, &ev.value2)) {
+        ev.kind = JESSI_LOG_EVENT_LAG;
+    } else if (jessi_parse_player(m, mlen, JESSI_LIT(" joined the game"), &ev.subject, ev.message.offset)) {
+        ev.kind = JESSI_LOG_EVENT_JOIN;
+    } else if (jessi_parse_player(m, mlen, JESSI_LIT(" left the game"), &ev.subject, ev.message.offset)) {
+        ev.kind = JESSI_LOG_EVENT_LEAVE;
+    } else if (jessi_has_prefix(m, mlen, JESSI_LIT("Saving the game")) ||
+               jessi_has_prefix(m, mlen, JESSI_LIT("Saving chunks for level"))) {
+        ev.kind = JESSI_LOG_EVENT_SAVE_STARTED;
+    } else if (jessi_has_prefix(m, mlen, JESSI_LIT("Saved the game")) ||
+               jessi_has_prefix(m, mlen, JESSI_LIT("Saved the world"))) {
+        ev.kind = JESSI_LOG_EVENT_SAVED;
+    } else if (jessi_has_prefix(m, mlen, JESSI_LIT("Stopping server")) ||
+               jessi_has_prefix(m, mlen, JESSI_LIT("Stopping the server"))) {
+        ev.kind = JESSI_LOG_EVENT_STOPPING;
+    }
+
+done:
+    if (out) *out = ev;
+    return ev.kind;
+}
@@ -0,0 +1,66 @@
+#ifndef JessiLogEvents_h
+#define JessiLogEvents_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    JESSI_LOG_EVENT_NONE = 0,
+    JESSI_LOG_EVENT_DONE,          // value = startup time in ms
+    JESSI_LOG_EVENT_LAG,           // value = ms behind, value2 = ticks behind
+    JESSI_LOG_EVENT_JOIN,          // subject = player name
+    JESSI_LOG_EVENT_LEAVE,         // subject = player name
+    JESSI_LOG_EVENT_SAVE_STARTED,
+    JESSI_LOG_EVENT_SAVED,
+    JESSI_LOG_EVENT_STOPPING,
+    JESSI_LOG_EVENT_EXCEPTION,     // subject = message of the first line of the report
+    JESSI_LOG_EVENT_STACK_FRAME,   // continuation of the current exception report
+} jessi_log_event_kind;
+
+typedef enum {
+    JESSI_LOG_LEVEL_UNKNOWN = 0,
+    JESSI_LOG_LEVEL_DEBUG,
+    JESSI_LOG_LEVEL_INFO,
+    JESSI_LOG_LEVEL_WARN,
+    JESSI_LOG_LEVEL_ERROR,
+    JESSI_LOG_LEVEL_FATAL,
+} jessi_log_level;
+
+// Byte range into the line passed to jessi_log_parser_feed.
+typedef struct {
+    size_t offset;
+    size_t length;
+} jessi_log_span;
+
+typedef struct {
+    jessi_log_event_kind kind;
+    jessi_log_level level;
+    jessi_log_span thread;
+    jessi_log_span message;
+    jessi_log_span subject;
+    int64_t value;
+    int64_t value2;
+} jessi_log_event;
+
+// Per-stream state; lives wherever the caller wants it and never allocates.
+typedef struct {
+    int in_exception;
+    int exception_has_body;
+} jessi_log_parser;
+
+void jessi_log_parser_init(jessi_log_parser *p);
+
+// Understands the vanilla/Forge "[time] [thread/LEVEL] [logger]: msg" (Forge and NeoForge put a
+// date in the first bracket), Fabric "(logger) msg" and Paper "[time LEVEL]: msg" layouts; lines
+// without a header are treated as bare messages.
+jessi_log_event_kind jessi_log_parser_feed(jessi_log_parser *p, const uint8_t *line, size_t len, jessi_log_event *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+#include "JessiLogTailer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/event.h>
+#define JESSI_LOG_TAILER_KQUEUE 1
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#define JESSI_LOG_TAILER_INOTIFY 1
+#else
+#error "JessiLogTailer needs kqueue or inotify"
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+#if JESSI_LOG_TAILER_KQUEUE && !defined(O_EVTONLY)
+#define O_EVTONLY O_RDONLY
+#endif
+
+#define JESSI_LOG_TAILER_BUF_SIZE (64 * 1024)
+#define JESSI_LOG_TAILER_MAX_DIRS 4
+
+typedef struct {
+    char *path;
+    int fd;
+    int wd;
+    dev_t dev;
+    ino_t ino;
+    off_t offset;
+
+    int has_stale;
+    dev_t stale_dev;
+    ino_t stale_ino;
+    off_t stale_size;
+    // kqueue: an O_EVTONLY fd; inotify: a watch descriptor. -1 when not armed.
+    int stale_watch;
+} jessi_log_file;
+
+typedef struct {
+    char *path;
+    int fd;
+} jessi_log_dir_watch;
+
+struct jessi_log_tailer {
+    jessi_log_file files[2];
+    int active;
+    int latest_seen;
+
+    jessi_log_dir_watch dirs[JESSI_LOG_TAILER_MAX_DIRS];
+    int dir_count;
+
+    uint8_t *buf;
+    size_t buf_cap;
+
+    int ev_fd;
+    int wake_pipe[2];
+    pthread_t thread;
+    int thread_started;
+
+    jessi_log_tailer_fn fn;
+    void *ctx;
+
+    jessi_log_tailer_stats stats;
+};
+
+static void jessi_log_tailer_count(uint64_t *counter, uint64_t n) {
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static char *jessi_log_dirname(const char *path) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) return strdup(".");
+    if (slash == path) return strdup("/");
+    size_t n = (size_t)(slash - path);
+    char *out = (char *)malloc(n + 1);
+    if (!out) return NULL;
+    memcpy(out, path, n);
+    out[n] = '\0';
+    return out;
+}
+
+static void jessi_log_tailer_watch_dir(jessi_log_tailer *t, const char *path) {
+    for (int i = 0; i < t->dir_count; i++) {
+        if (strcmp(t->dirs[i].path, path) == 0) return;
+    }
+    if (t->dir_count >= JESSI_LOG_TAILER_MAX_DIRS) return;
+
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) return;
+
+#if JESSI_LOG_TAILER_KQUEUE
+    int fd = open(path, O_EVTONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct kevent kev;
+    EV_SET(&kev, (uintptr_t)fd, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_DELETE | NOTE_RENAME, 0, NULL);
+    if (kevent(t->ev_fd, &kev, 1, NULL, 0, NULL) != 0) {
+        close(fd);
+        return;
+    }
+#else
+    int fd = inotify_add_watch(t->ev_fd, path, IN_CREATE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF);
+    if (fd < 0) return;
+#endif
+
+    char *copy = strdup(path);
+    if (!copy) {
+#if JESSI_LOG_TAILER_KQUEUE
+        close(fd);
+#else
+        inotify_rm_watch(t->ev_fd, fd);
+#endif
+        return;
+    }
+    t->dirs[t->dir_count].path = copy;
+    t->dirs[t->dir_count].fd = fd;
+    t->dir_count++;
+}
+
+static void jessi_log_tailer_arm_dirs(jessi_log_tailer *t) {
+    for (int i = 0; i < 2; i++) {
+        char *dir = jessi_log_dirname(t->files[i].path);
+        if (!dir) continue;
+        struct stat st;
+        if (stat(dir, &st) == 0) {
+            jessi_log_tailer_watch_dir(t, dir);
+        } else {
+            char *parent = jessi_log_dirname(dir);
+            if (parent) jessi_log_tailer_watch_dir(t, parent);
+            free(parent);
+        }
+        free(dir);
+    }
+}
+
+static void jessi_log_file_watch(jessi_log_tailer *t, jessi_log_file *f) {
+#if JESSI_LOG_TAILER_KQUEUE
+    struct kevent kev;
+    EV_SET(&kev, (uintptr_t)f->fd, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+           NOTE_WRITE | NOTE_EXTEND | NOTE_DELETE | NOTE_RENAME | NOTE_ATTRIB | NOTE_REVOKE, 0, NULL);
+    (void)kevent(t->ev_fd, &kev, 1, NULL, 0, NULL);
+#else
+    f->wd = inotify_add_watch(t->ev_fd, f->path, IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+#endif
+}
+
+// A stale file that is appended to rather than replaced only shows up as a write to the file
+// itself, which the directory watch doesn't report.
+static void jessi_log_file_watch_stale(jessi_log_tailer *t, jessi_log_file *f) {
+    if (f->stale_watch >= 0) return;
+#if JESSI_LOG_TAILER_KQUEUE
+    int fd = open(f->path, O_EVTONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct kevent kev;
+    EV_SET(&kev, (uintptr_t)fd, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_EXTEND | NOTE_DELETE | NOTE_RENAME, 0, NULL);
+    if (kevent(t->ev_fd, &kev, 1, NULL, 0, NULL) != 0) {
+        close(fd);
+        return;
+    }
+    f->stale_watch = fd;
+#else
+    f->stale_watch = inotify_add_watch(t->ev_fd, f->path, IN_MODIFY);
+#endif
+}
+
+static void jessi_log_file_unwatch_stale(jessi_log_tailer *t, jessi_log_file *f) {
+    if (f->stale_watch < 0) return;
+#if JESSI_LOG_TAILER_KQUEUE
+    (void)t;
+    close(f->stale_watch);
+#else
+    // Same inode as the file now being tailed: inotify handed back the same watch, keep it.
+    if (f->stale_watch != f->wd) inotify_rm_watch(t->ev_fd, f->stale_watch);
+#endif
+    f->stale_watch = -1;
+}
+
+static void jessi_log_file_close(jessi_log_tailer *t, jessi_log_file *f) {
+    if (f->fd < 0) return;
+#if JESSI_LOG_TAILER_INOTIFY
+    if (f->wd >= 0) inotify_rm_watch(t->ev_fd, f->wd);
+#else
+    (void)t;
+#endif
+    f->wd = -1;
+    close(f->fd);
+    f->fd = -1;
+    f->offset = 0;
+}
+
+static void jessi_log_file_drain(jessi_log_tailer *t, jessi_log_file *f) {
+    if (f->fd < 0) return;
+    jessi_log_source source = (f == &t->files[JESSI_LOG_SOURCE_LATEST]) ? JESSI_LOG_SOURCE_LATEST : JESSI_LOG_SOURCE_STDIO;
+
+    for (;;) {
+        ssize_t n = pread(f->fd, t->buf, t->buf_cap, f->offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        jessi_log_tailer_count(&t->stats.read_calls, 1);
+        if (n == 0) return;
+
+        f->offset += n;
+        jessi_log_tailer_count(&t->stats.bytes_read, (uint64_t)n);
+        if (t->fn) t->fn(t->ctx, source, t->buf, (size_t)n);
+        if ((size_t)n < t->buf_cap) return;
+    }
+}
+
+// Brings `f` in sync with what is on disk: follows rotation (new inode) and truncation,
+// draining whatever was left in the old file first. Returns 1 if `f` has an open fd.
+static int jessi_log_file_refresh(jessi_log_tailer *t, jessi_log_file *f) {
+    struct stat st;
+    if (stat(f->path, &st) != 0) {
+        if (f->fd >= 0) {
+            jessi_log_file_drain(t, f);
+            jessi_log_file_close(t, f);
+            jessi_log_tailer_count(&t->stats.reopens, 1);
+        }
+        return 0;
+    }
+
+    if (f->fd >= 0 && (st.st_ino != f->ino || st.st_dev != f->dev)) {
+        jessi_log_file_drain(t, f);
+        jessi_log_file_close(t, f);
+        jessi_log_tailer_count(&t->stats.reopens, 1);
+    }
+
+    if (f->fd < 0) {
+        off_t start = 0;
+        if (f->has_stale && st.st_ino == f->stale_ino && st.st_dev == f->stale_dev) {
+            if (st.st_size <= f->stale_size) {
+                jessi_log_file_watch_stale(t, f);
+                return 0;
+            }
+            start = f->stale_size;
+        }
+        f->has_stale = 0;
+
+        int fd = open(f->path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return 0;
+        struct stat fst;
+        if (fstat(fd, &fst) != 0) {
+            close(fd);
+            return 0;
+        }
+        f->fd = fd;
+        f->dev = fst.st_dev;
+        f->ino = fst.st_ino;
+        f->offset = start;
+        jessi_log_file_watch(t, f);
+        jessi_log_file_unwatch_stale(t, f);
+    }
+
+    struct stat cur;
+    if (fstat(f->fd, &cur) == 0 && cur.st_size < f->offset) {
+        f->offset = 0;
+        jessi_log_tailer_count(&t->stats.reopens, 1);
+    }
+    return 1;
+}
+
+static void jessi_log_tailer_activate(jessi_log_tailer *t, int source) {
+    if (t->active == source) return;
+    if (t->active >= 0) jessi_log_tailer_count(&t->stats.source_switches, 1);
+    t->active = source;
+}
+
+static void jessi_log_tailer_pump(jessi_log_tailer *t) {
+    jessi_log_file *latest = &t->files[JESSI_LOG_SOURCE_LATEST];
+    jessi_log_file *stdio = &t->files[JESSI_LOG_SOURCE_STDIO];
+
+    if (jessi_log_file_refresh(t, latest)) {
+        if (!t->latest_seen) {
+            t->latest_seen = 1;
+            if (stdio->fd >= 0) {
+                jessi_log_file_drain(t, stdio);
+                jessi_log_file_close(t, stdio);
+            }
+        }
+        jessi_log_tailer_activate(t, JESSI_LOG_SOURCE_LATEST);
+        jessi_log_file_drain(t, latest);
+        return;
+    }
+
+    // Once latest.log exists we stay on it, even across the brief gap while log4j rolls it.
+    if (t->latest_seen) return;
+
+    if (jessi_log_file_refresh(t, stdio)) {
+        jessi_log_tailer_activate(t, JESSI_LOG_SOURCE_STDIO);
+        jessi_log_file_drain(t, stdio);
+    }
+}
+
+// Blocks until something changes on disk. Returns 1 when a stop was requested.
+static int jessi_log_tailer_wait(jessi_log_tailer *t) {
+#if JESSI_LOG_TAILER_KQUEUE
+    struct kevent events[16];
+    for (;;) {
+        int n = kevent(t->ev_fd, NULL, 0, events, 16, NULL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+        int stop = 0;
+        for (int i = 0; i < n; i++) {
+            if (events[i].filter == EVFILT_READ && (int)events[i].ident == t->wake_pipe[0]) stop = 1;
+        }
+        return stop;
+    }
+#else
+    struct pollfd fds[2] = {
+        { .fd = t->ev_fd, .events = POLLIN },
+        { .fd = t->wake_pipe[0], .events = POLLIN },
+    };
+    for (;;) {
+        int n = poll(fds, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+        if (fds[0].revents & POLLIN) {
+            char evbuf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            while (read(t->ev_fd, evbuf, sizeof(evbuf)) > 0) {
+            }
+        }
+        return (fds[1].revents & (POLLIN | POLLHUP)) ? 1 : 0;
+    }
+#endif
+}
+
+static void *jessi_log_tailer_thread(void *arg) {
+    jessi_log_tailer *t = (jessi_log_tailer *)arg;
+
+    jessi_log_tailer_arm_dirs(t);
+    jessi_log_tailer_pump(t);
+
+    for (;;) {
+        int stop = jessi_log_tailer_wait(t);
+        jessi_log_tailer_count(&t->stats.wakeups, 1);
+        jessi_log_tailer_arm_dirs(t);
+        jessi_log_tailer_pump(t);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+static void jessi_log_file_init(jessi_log_file *f, const char *path, int snapshot_stale) {
+    f->path = strdup(path ? path : "");
+    f->fd = -1;
+    f->wd = -1;
+    f->offset = 0;
+    f->has_stale = 0;
+    f->stale_watch = -1;
+
+    struct stat st;
+    if (snapshot_stale && f->path && stat(f->path, &st) == 0) {
+        f->has_stale = 1;
+        f->stale_dev = st.st_dev;
+        f->stale_ino = st.st_ino;
+        f->stale_size = st.st_size;
+    }
+}
+
+jessi_log_tailer *jessi_log_tailer_create(const char *latest_path, const char *stdio_path,
+                                          jessi_log_tailer_fn fn, void *ctx) {
+    if (!latest_path || !stdio_path) return NULL;
+
+    jessi_log_tailer *t = (jessi_log_tailer *)calloc(1, sizeof(*t));
+    if (!t) return NULL;
+
+    t->active = -1;
+    t->fn = fn;
+    t->ctx = ctx;
+    t->ev_fd = -1;
+    t->wake_pipe[0] = t->wake_pipe[1] = -1;
+
+    jessi_log_file_init(&t->files[JESSI_LOG_SOURCE_LATEST], latest_path, 1);
+    jessi_log_file_init(&t->files[JESSI_LOG_SOURCE_STDIO], stdio_path, 0);
+
+    t->buf_cap = JESSI_LOG_TAILER_BUF_SIZE;
+    t->buf = (uint8_t *)malloc(t->buf_cap);
+
+#if JESSI_LOG_TAILER_KQUEUE
+    t->ev_fd = kqueue();
+#else
+    t->ev_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+    if (!t->buf || !t->files[0].path || !t->files[1].path || t->ev_fd < 0 || pipe(t->wake_pipe) != 0) {
+        jessi_log_tailer_destroy(t);
+        return NULL;
+    }
+    fcntl(t->wake_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(t->wake_pipe[1], F_SETFD, FD_CLOEXEC);
+
+#if JESSI_LOG_TAILER_KQUEUE
+    struct kevent kev;
+    EV_SET(&kev, (uintptr_t)t->wake_pipe[0], EVFILT_READ, EV_ADD, 0, 0, NULL);
+    if (kevent(t->ev_fd, &kev, 1, NULL, 0, NULL) != 0) {
+        jessi_log_tailer_destroy(t);
+        return NULL;
+    }
+#endif
+    return t;
+}
+
+int jessi_log_tailer_start(jessi_log_tailer *t) {
+    if (!t || t->thread_started) return -1;
+    if (pthread_create(&t->thread, NULL, jessi_log_tailer_thread, t) != 0) return -1;
+    t->thread_started = 1;
+    return 0;
+}
+
+void jessi_log_tailer_stop(jessi_log_tailer *t) {
+    if (!t || !t->thread_started) return;
+    char b = 1;
+    while (write(t->wake_pipe[1], &b, 1) < 0 && errno == EINTR) {
+    }
+    pthread_join(t->thread, NULL);
+    t->thread_started = 0;
+}
+
+void jessi_log_tailer_destroy(jessi_log_tailer *t) {
+    if (!t) return;
+    jessi_log_tailer_stop(t);
+
+    for (int i = 0; i < 2; i++) {
+        jessi_log_file_unwatch_stale(t, &t->files[i]);
+        jessi_log_file_close(t, &t->files[i]);
+        free(t->files[i].path);
+    }
+    for (int i = 0; i < t->dir_count; i++) {
+#if JESSI_LOG_TAILER_KQUEUE
+        close(t->dirs[i].fd);
+#endif
+        free(t->dirs[i].path);
+    }
+    if (t->ev_fd >= 0) close(t->ev_fd);
+    if (t->wake_pipe[0] >= 0) close(t->wake_pipe[0]);
+    if (t->wake_pipe[1] >= 0) close(t->wake_pipe[1]);
+    free(t->buf);
+    free(t);
+}
+
+void jessi_log_tailer_get_stats(const jessi_log_tailer *t, jessi_log_tailer_stats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!t) return;
+    out->bytes_read = __atomic_load_n(&t->stats.bytes_read, __ATOMIC_RELAXED);
+    out->wakeups = __atomic_load_n(&t->stats.wakeups, __ATOMIC_RELAXED);
+    out->read_calls = __atomic_load_n(&t->stats.read_calls, __ATOMIC_RELAXED);
+    out->reopens = __atomic_load_n(&t->stats.reopens, __ATOMIC_RELAXED);
+    out->source_switches = __atomic_load_n(&t->stats.source_switches, __ATOMIC_RELAXED);
+}
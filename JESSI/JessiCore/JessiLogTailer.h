@@ -0,0 +1,42 @@
+#ifndef JessiLogTailer_h
+#define JessiLogTailer_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    JESSI_LOG_SOURCE_STDIO = 0,
+    JESSI_LOG_SOURCE_LATEST = 1,
+} jessi_log_source;
+
+typedef struct {
+    uint64_t bytes_read;
+    uint64_t wakeups;
+    uint64_t read_calls;
+    uint64_t reopens;
+    uint64_t source_switches;
+} jessi_log_tailer_stats;
+
+// Called on the tailer thread. `bytes` is only valid for the duration of the call.
+typedef void (*jessi_log_tailer_fn)(void *ctx, jessi_log_source source, const uint8_t *bytes, size_t len);
+
+typedef struct jessi_log_tailer jessi_log_tailer;
+
+// Tails `stdio_path` until `latest_path` shows up, then drains stdio and sticks to latest.
+// Content already present in latest_path at creation time is treated as stale and skipped.
+jessi_log_tailer *jessi_log_tailer_create(const char *latest_path, const char *stdio_path,
+                                          jessi_log_tailer_fn fn, void *ctx);
+int jessi_log_tailer_start(jessi_log_tailer *t);
+void jessi_log_tailer_stop(jessi_log_tailer *t);
+void jessi_log_tailer_destroy(jessi_log_tailer *t);
+void jessi_log_tailer_get_stats(const jessi_log_tailer *t, jessi_log_tailer_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
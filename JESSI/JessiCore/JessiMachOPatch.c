@@ -0,0 +1,340 @@
+#include "JessiMachOPatch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#define JESSI_ST_MTIME_SEC(st) ((int64_t)(st)->st_mtimespec.tv_sec)
+#define JESSI_ST_MTIME_NSEC(st) ((int64_t)(st)->st_mtimespec.tv_nsec)
+#else
+#define JESSI_ST_MTIME_SEC(st) ((int64_t)(st)->st_mtim.tv_sec)
+#define JESSI_ST_MTIME_NSEC(st) ((int64_t)(st)->st_mtim.tv_nsec)
+#endif
+
+// <mach-o/loader.h> and <mach-o/fat.h> values, spelled out so this builds off Apple too.
+#define JESSI_MH_MAGIC_64 0xfeedfacfu
+#define JESSI_FAT_MAGIC 0xcafebabeu
+#define JESSI_CPU_TYPE_ARM64 0x0100000cu
+#define JESSI_LC_LOAD_DYLIB 0x0cu
+#define JESSI_LC_BUILD_VERSION 0x32u
+#define JESSI_MH_HEADER_64_SIZE 32
+#define JESSI_FAT_MAX_ARCHS 16
+#define JESSI_MAX_SIZEOFCMDS (4u * 1024u * 1024u)
+
+static uint32_t jessi_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t jessi_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void jessi_put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static int jessi_pread_full(int fd, void *buf, size_t len, off_t off) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        off += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int jessi_pwrite_full(int fd, const void *buf, size_t len, off_t off) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        off += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Patches the load commands in buf (header + sizeofcmds bytes of one slice). Returns 1 if changed.
+static int jessi_patch_load_commands(uint8_t *buf, size_t len, uint32_t ncmds, uint32_t platform) {
+    int patched = 0;
+    size_t off = JESSI_MH_HEADER_64_SIZE;
+    for (uint32_t i = 0; i < ncmds; i++) {
+        if (off + 8 > len) break;
+        uint32_t cmd = jessi_le32(buf + off);
+        uint32_t cmdsize = jessi_le32(buf + off + 4);
+        if (cmdsize < 8 || off + cmdsize > len) break;
+
+        if (cmd == JESSI_LC_BUILD_VERSION && cmdsize >= 12) {
+            if (jessi_le32(buf + off + 8) != platform) {
+                jessi_put_le32(buf + off + 8, platform);
+                patched = 1;
+            }
+        } else if (cmd == JESSI_LC_LOAD_DYLIB && cmdsize >= 24) {
+            uint32_t name_off = jessi_le32(buf + off + 8);
+            if (name_off < cmdsize) {
+                char *name = (char *)(buf + off + name_off);
+                size_t max = cmdsize - name_off;
+                size_t name_len = strnlen(name, max);
+                if (name_len < max) {
+                    // ".../Foo.framework/Versions/A/Foo" -> ".../Foo.framework/Foo"
+                    char *ver = strstr(name, "/Versions/");
+                    if (ver && (size_t)(ver - name) + 11 <= name_len) {
+                        size_t tail = name_len - (size_t)(ver - name) - 11;
+                        memmove(ver, ver + 11, tail);
+                        memset(ver + tail, 0, 11);
+                        patched = 1;
+                    }
+                }
+            }
+        }
+        off += cmdsize;
+    }
+    return patched;
+}
+
+// Writes back only the runs that differ between orig and patched.
+static int jessi_write_changed_runs(int fd, const uint8_t *orig, const uint8_t *patched, size_t len,
+                                    off_t base, size_t *bytes_written) {
+    size_t i = 0;
+    while (i < len) {
+        if (orig[i] == patched[i]) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < len && orig[i] != patched[i]) i++;
+        if (jessi_pwrite_full(fd, patched + start, i - start, base + (off_t)start) != 0) return -1;
+        if (bytes_written) *bytes_written += i - start;
+    }
+    return 0;
+}
+
+static int jessi_patch_slice(int fd, off_t slice_off, off_t file_size, uint32_t platform, size_t *bytes_written) {
+    uint8_t header[JESSI_MH_HEADER_64_SIZE];
+    if (slice_off + JESSI_MH_HEADER_64_SIZE > file_size) return 0;
+    if (jessi_pread_full(fd, header, sizeof(header), slice_off) != 0) return -1;
+    if (jessi_le32(header) != JESSI_MH_MAGIC_64 || jessi_le32(header + 4) != JESSI_CPU_TYPE_ARM64) return 0;
+
+    uint32_t ncmds = jessi_le32(header + 16);
+    uint32_t sizeofcmds = jessi_le32(header + 20);
+    if (sizeofcmds == 0 || sizeofcmds > JESSI_MAX_SIZEOFCMDS) return 0;
+    size_t len = JESSI_MH_HEADER_64_SIZE + (size_t)sizeofcmds;
+    if (slice_off + (off_t)len > file_size) return 0;
+
+    uint8_t *orig = malloc(len * 2);
+    if (!orig) return -1;
+    uint8_t *work = orig + len;
+    int rc = jessi_pread_full(fd, orig, len, slice_off);
+    if (rc == 0) {
+        memcpy(work, orig, len);
+        rc = jessi_patch_load_commands(work, len, ncmds, platform);
+        if (rc == 1 && jessi_write_changed_runs(fd, orig, work, len, slice_off, bytes_written) != 0) rc = -1;
+    }
+    free(orig);
+    return rc;
+}
+
+jessi_macho_patch_result jessi_macho_patch_file(const char *path, uint32_t platform, size_t *bytes_written) {
+    if (bytes_written) *bytes_written = 0;
+    if (!path || !path[0]) return JESSI_MACHO_PATCH_FAILED;
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return JESSI_MACHO_PATCH_FAILED;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return JESSI_MACHO_PATCH_FAILED;
+    }
+    if (st.st_size < JESSI_MH_HEADER_64_SIZE) {
+        close(fd);
+        return JESSI_MACHO_PATCH_UNCHANGED;
+    }
+
+    uint8_t magic[4];
+    if (jessi_pread_full(fd, magic, sizeof(magic), 0) != 0) {
+        close(fd);
+        return JESSI_MACHO_PATCH_FAILED;
+    }
+
+    int changed = 0;
+    int failed = 0;
+    if (jessi_be32(magic) == JESSI_FAT_MAGIC) {
+        uint8_t fat[8 + JESSI_FAT_MAX_ARCHS * 20];
+        uint32_t nfat = 0;
+        if (jessi_pread_full(fd, fat, 8, 0) == 0) nfat = jessi_be32(fat + 4);
+        if (nfat > JESSI_FAT_MAX_ARCHS) nfat = JESSI_FAT_MAX_ARCHS;
+        if (nfat > 0 && jessi_pread_full(fd, fat + 8, nfat * 20, 8) != 0) nfat = 0;
+        for (uint32_t i = 0; i < nfat; i++) {
+            const uint8_t *arch = fat + 8 + i * 20;
+            if (jessi_be32(arch) != JESSI_CPU_TYPE_ARM64) continue;
+            int rc = jessi_patch_slice(fd, (off_t)jessi_be32(arch + 8), st.st_size, platform, bytes_written);
+            if (rc < 0) failed = 1;
+            if (rc > 0) changed = 1;
+        }
+    } else if (jessi_le32(magic) == JESSI_MH_MAGIC_64) {
+        int rc = jessi_patch_slice(fd, 0, st.st_size, platform, bytes_written);
+        if (rc < 0) failed = 1;
+        if (rc > 0) changed = 1;
+    }
+
+    // Only the pages holding the load commands are dirty, so this flushes a few KB, not the dylib.
+    if (changed && fsync(fd) != 0) failed = 1;
+    close(fd);
+    if (failed) return JESSI_MACHO_PATCH_FAILED;
+    return changed ? JESSI_MACHO_PATCH_PATCHED : JESSI_MACHO_PATCH_UNCHANGED;
+}
+
+typedef struct {
+    char *rel_path;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int result;
+} jessi_patch_manifest_entry;
+
+struct jessi_patch_manifest {
+    char *path;
+    uint32_t platform;
+    jessi_patch_manifest_entry *entries;
+    size_t count;
+    size_t cap;
+    int dirty;
+};
+
+#define JESSI_PATCH_MANIFEST_MAGIC "jessi-macho-patch 1"
+
+static jessi_patch_manifest_entry *jessi_manifest_find(const jessi_patch_manifest *m, const char *rel_path) {
+    for (size_t i = 0; i < m->count; i++) {
+        if (strcmp(m->entries[i].rel_path, rel_path) == 0) return &m->entries[i];
+    }
+    return NULL;
+}
+
+static jessi_patch_manifest_entry *jessi_manifest_add(jessi_patch_manifest *m, const char *rel_path) {
+    if (m->count == m->cap) {
+        size_t cap = m->cap ? m->cap * 2 : 32;
+        jessi_patch_manifest_entry *grown = realloc(m->entries, cap * sizeof(*grown));
+        if (!grown) return NULL;
+        m->entries = grown;
+        m->cap = cap;
+    }
+    char *copy = strdup(rel_path);
+    if (!copy) return NULL;
+    jessi_patch_manifest_entry *e = &m->entries[m->count++];
+    memset(e, 0, sizeof(*e));
+    e->rel_path = copy;
+    return e;
+}
+
+jessi_patch_manifest *jessi_patch_manifest_load(const char *manifest_path, uint32_t platform) {
+    if (!manifest_path) return NULL;
+    jessi_patch_manifest *m = calloc(1, sizeof(*m));
+    if (!m) return NULL;
+    m->path = strdup(manifest_path);
+    m->platform = platform;
+    if (!m->path) {
+        free(m);
+        return NULL;
+    }
+
+    FILE *f = fopen(manifest_path, "r");
+    if (!f) return m;
+    char line[4096];
+    unsigned long file_platform = 0;
+    // A manifest written for another platform (or format) is ignored and rewritten.
+    if (!fgets(line, sizeof(line), f) ||
+        sscanf(line, JESSI_PATCH_MANIFEST_MAGIC " platform=%lu", &file_platform) != 1 ||
+        file_platform != platform) {
+        fclose(f);
+        m->dirty = 1;
+        return m;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long ino = 0;
+        long long size = 0, sec = 0, nsec = 0;
+        int result = 0, consumed = 0;
+        if (sscanf(line, "%llu %lld %lld %lld %d %n", &ino, &size, &sec, &nsec, &result, &consumed) != 5) continue;
+        char *rel = line + consumed;
+        rel[strcspn(rel, "\n")] = '\0';
+        if (!rel[0] || jessi_manifest_find(m, rel)) continue;
+        jessi_patch_manifest_entry *e = jessi_manifest_add(m, rel);
+        if (!e) break;
+        e->ino = ino;
+        e->size = size;
+        e->mtime_sec = sec;
+        e->mtime_nsec = nsec;
+        e->result = result;
+    }
+    fclose(f);
+    return m;
+}
+
+void jessi_patch_manifest_free(jessi_patch_manifest *m) {
+    if (!m) return;
+    for (size_t i = 0; i < m->count; i++) free(m->entries[i].rel_path);
+    free(m->entries);
+    free(m->path);
+    free(m);
+}
+
+int jessi_patch_manifest_is_current(const jessi_patch_manifest *m, const char *rel_path, const struct stat *st) {
+    if (!m || !rel_path || !st) return 0;
+    const jessi_patch_manifest_entry *e = jessi_manifest_find(m, rel_path);
+    return e && e->result != JESSI_MACHO_PATCH_FAILED &&
+           e->ino == (uint64_t)st->st_ino && e->size == (int64_t)st->st_size &&
+           e->mtime_sec == JESSI_ST_MTIME_SEC(st) && e->mtime_nsec == JESSI_ST_MTIME_NSEC(st);
+}
+
+void jessi_patch_manifest_record(jessi_patch_manifest *m, const char *rel_path, const struct stat *st,
+                                 jessi_macho_patch_result result) {
+    if (!m || !rel_path || !st) return;
+    jessi_patch_manifest_entry *e = jessi_manifest_find(m, rel_path);
+    if (!e) e = jessi_manifest_add(m, rel_path);
+    if (!e) return;
+    e->ino = (uint64_t)st->st_ino;
+    e->size = (int64_t)st->st_size;
+    e->mtime_sec = JESSI_ST_MTIME_SEC(st);
+    e->mtime_nsec = JESSI_ST_MTIME_NSEC(st);
+    e->result = result;
+    m->dirty = 1;
+}
+
+int jessi_patch_manifest_save(jessi_patch_manifest *m) {
+    if (!m) return -1;
+    if (!m->dirty) return 0;
+
+    size_t tmp_len = strlen(m->path) + 8;
+    char *tmp = malloc(tmp_len);
+    if (!tmp) return -1;
+    snprintf(tmp, tmp_len, "%s.tmp", m->path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        free(tmp);
+        return -1;
+    }
+    fprintf(f, JESSI_PATCH_MANIFEST_MAGIC " platform=%lu\n", (unsigned long)m->platform);
+    for (size_t i = 0; i < m->count; i++) {
+        const jessi_patch_manifest_entry *e = &m->entries[i];
+        fprintf(f, "%llu %lld %lld %lld %d %s\n", (unsigned long long)e->ino, (long long)e->size,
+                (long long)e->mtime_sec, (long long)e->mtime_nsec, e->result, e->rel_path);
+    }
+    int rc = (fclose(f) == 0 && rename(tmp, m->path) == 0) ? 0 : -1;
+    if (rc != 0) unlink(tmp);
+    free(tmp);
+    if (rc == 0) m->dirty = 0;
+    return rc;
+}
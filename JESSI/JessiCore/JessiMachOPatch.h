@@ -0,0 +1,41 @@
+#ifndef JessiMachOPatch_h
+#define JessiMachOPatch_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rewrites the LC_BUILD_VERSION platform of arm64 slices and strips "/Versions/X" from
+// LC_LOAD_DYLIB paths so dyld on iOS 26 accepts runtime dylibs built for another platform.
+// Only the header and load commands are read; changed bytes go back with pwrite.
+
+typedef enum {
+    JESSI_MACHO_PATCH_FAILED = -1,
+    JESSI_MACHO_PATCH_UNCHANGED = 0,   // already matches, or not an arm64 Mach-O
+    JESSI_MACHO_PATCH_PATCHED = 1,
+} jessi_macho_patch_result;
+
+jessi_macho_patch_result jessi_macho_patch_file(const char *path, uint32_t platform, size_t *bytes_written);
+
+// Remembers (path, inode, size, mtime) of files already handled for a platform so later
+// launches skip them with a single stat. Stored as text in the runtime directory.
+typedef struct jessi_patch_manifest jessi_patch_manifest;
+
+jessi_patch_manifest *jessi_patch_manifest_load(const char *manifest_path, uint32_t platform);
+void jessi_patch_manifest_free(jessi_patch_manifest *m);
+// 1 when rel_path was recorded with the same inode, size and mtime.
+int jessi_patch_manifest_is_current(const jessi_patch_manifest *m, const char *rel_path, const struct stat *st);
+void jessi_patch_manifest_record(jessi_patch_manifest *m, const char *rel_path, const struct stat *st,
+                                 jessi_macho_patch_result result);
+// Writes via a temp file and rename; no-op when nothing changed.
+int jessi_patch_manifest_save(jessi_patch_manifest *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSErrorDomain const JessiRconErrorDomain;
+
+typedef NS_ENUM(NSInteger, JessiRconErrorCode) {
+    JessiRconErrorConnect = 1,
+    JessiRconErrorAuth = 2,
+    JessiRconErrorDisconnected = 3,
+    JessiRconErrorTimeout = 4,
+    JessiRconErrorProtocol = 5,
+};
+
+// `response` may hold a partial reply when `error` is set (e.g. "stop" closes the connection).
+typedef void (^JessiRconCompletion)(NSString * _Nullable response, NSError * _Nullable error);
+
+// Long-lived, authenticated RCON session to 127.0.0.1. Requests are queued and matched
+// by request id; the end of a reply is detected by echoing an empty sentinel packet.
+// Connects lazily and reconnects on the next request after a drop.
+@interface JessiRconClient : NSObject
+
+@property (nonatomic, readonly) int port;
+@property (nonatomic, readonly, copy) NSString *password;
+@property (atomic, readonly, getter=isConnected) BOOL connected;
+@property (nonatomic) NSTimeInterval requestTimeout;
+@property (nonatomic, strong) dispatch_queue_t completionQueue;
+
+- (instancetype)initWithPort:(int)port password:(NSString *)password NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)sendCommand:(NSString *)command completion:(nullable JessiRconCompletion)completion;
+// `timeout` overrides requestTimeout for this request (0 = use requestTimeout).
+- (void)sendCommand:(NSString *)command timeout:(NSTimeInterval)timeout completion:(nullable JessiRconCompletion)completion;
+// Responses are in command order; a failed command yields @"" and the first error is reported.
+- (void)sendCommands:(NSArray<NSString *> *)commands
+          completion:(nullable void (^)(NSArray<NSString *> *responses, NSError * _Nullable error))completion;
+- (void)disconnect;
+
+@end
+
+NS_ASSUME_NONNULL_END
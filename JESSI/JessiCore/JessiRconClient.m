@@ -0,0 +1,406 @@
+#import "JessiRconClient.h"
+
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <netinet/tcp.h>
+#import <sys/time.h>
+#import <unistd.h>
+#import <errno.h>
+
+NSErrorDomain const JessiRconErrorDomain = @"JessiRcon";
+
+static const int32_t JessiRconTypeResponse = 0;
+static const int32_t JessiRconTypeCommand = 2;
+static const int32_t JessiRconTypeAuth = 3;
+static const int32_t JessiRconMaxPacket = 1024 * 1024;
+
+typedef NS_ENUM(NSInteger, JessiRconStage) {
+    JessiRconStageQueued = 0,
+    // Vanilla reads one packet per recv() and drops the connection if two arrive together,
+    // so the sentinel only goes out after the first reply packet has come back.
+    JessiRconStageAwaitingFirst,
+    JessiRconStageAwaitingSentinel,
+};
+
+@interface JessiRconRequest : NSObject
+@property (nonatomic, copy) NSString *command;
+@property (nonatomic, copy, nullable) JessiRconCompletion completion;
+@property (nonatomic) int32_t commandId;
+@property (nonatomic) int32_t sentinelId;
+@property (nonatomic) JessiRconStage stage;
+@property (nonatomic) BOOL retried;
+@property (nonatomic) NSTimeInterval timeout;
+@property (nonatomic, strong) NSMutableData *payload;
+@end
+
+@implementation JessiRconRequest
+@end
+
+static NSError *jessi_rcon_error(JessiRconErrorCode code, NSString *message) {
+    return [NSError errorWithDomain:JessiRconErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+static NSData *jessi_rcon_packet(int32_t pid, int32_t type, NSString *payload) {
+    NSData *payloadData = [payload dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
+    int32_t length = (int32_t)(4 + 4 + payloadData.length + 2);
+    NSMutableData *d = [NSMutableData dataWithCapacity:(NSUInteger)length + 4];
+    [d appendBytes:&length length:4];
+    [d appendBytes:&pid length:4];
+    [d appendBytes:&type length:4];
+    [d appendData:payloadData];
+    uint8_t nul[2] = {0, 0};
+    [d appendBytes:nul length:2];
+    return d;
+}
+
+static BOOL jessi_rcon_write_all(int fd, NSData *data) {
+    const uint8_t *p = data.bytes;
+    size_t off = 0;
+    while (off < data.length) {
+        ssize_t n = send(fd, p + off, data.length - off, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return NO;
+        off += (size_t)n;
+    }
+    return YES;
+}
+
+static BOOL jessi_rcon_read_all(int fd, void *buf, size_t len) {
+    uint8_t *p = buf;
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = recv(fd, p + off, len - off, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return NO;
+        off += (size_t)n;
+    }
+    return YES;
+}
+
+@interface JessiRconClient ()
+@property (atomic, readwrite, getter=isConnected) BOOL connected;
+@property (nonatomic, strong) dispatch_queue_t ioQueue;
+@property (nonatomic, strong, nullable) dispatch_source_t readSource;
+@property (nonatomic) int fd;
+@property (nonatomic) int32_t nextId;
+@property (nonatomic, strong) NSMutableArray<JessiRconRequest *> *queue;
+@property (nonatomic, strong, nullable) JessiRconRequest *inflight;
+@property (nonatomic, strong) NSMutableData *rx;
+@end
+
+@implementation JessiRconClient
+
+- (instancetype)initWithPort:(int)port password:(NSString *)password {
+    self = [super init];
+    if (self) {
+        _port = port;
+        _password = [password copy];
+        _requestTimeout = 10.0;
+        _completionQueue = dispatch_get_main_queue();
+        _ioQueue = dispatch_queue_create("com.baconmania.jessi.rcon", DISPATCH_QUEUE_SERIAL);
+        _fd = -1;
+        _nextId = 1;
+        _queue = [NSMutableArray array];
+        _rx = [NSMutableData data];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_readSource) dispatch_source_cancel(_readSource);
+    else if (_fd >= 0) close(_fd);
+}
+
+- (int32_t)allocateId {
+    int32_t pid = self.nextId;
+    // -1 is the auth failure marker; keep ids positive.
+    self.nextId = (pid >= INT32_MAX - 1) ? 1 : pid + 1;
+    return pid;
+}
+
+#pragma mark - Public
+
+- (void)sendCommand:(NSString *)command completion:(JessiRconCompletion)completion {
+    [self sendCommand:command timeout:0 completion:completion];
+}
+
+- (void)sendCommand:(NSString *)command timeout:(NSTimeInterval)timeout completion:(JessiRconCompletion)completion {
+    JessiRconRequest *req = [JessiRconRequest new];
+    req.command = command ?: @"";
+    req.timeout = timeout;
+    req.completion = completion;
+    req.payload = [NSMutableData data];
+    dispatch_async(self.ioQueue, ^{
+        [self.queue addObject:req];
+        [self pump];
+    });
+}
+
+- (void)sendCommands:(NSArray<NSString *> *)commands
+          completion:(void (^)(NSArray<NSString *> *, NSError *))completion {
+    NSUInteger count = commands.count;
+    if (count == 0) {
+        if (completion) dispatch_async(self.completionQueue, ^{ completion(@[], nil); });
+        return;
+    }
+
+    NSMutableArray<NSString *> *responses = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) [responses addObject:@""];
+    __block NSUInteger remaining = count;
+    __block NSError *firstError = nil;
+
+    // Per-command completions hop back onto ioQueue so the shared state is only touched there.
+    dispatch_queue_t ioQueue = self.ioQueue;
+    dispatch_queue_t completionQueue = self.completionQueue;
+    for (NSUInteger i = 0; i < count; i++) {
+        JessiRconRequest *req = [JessiRconRequest new];
+        req.command = commands[i];
+        req.payload = [NSMutableData data];
+        req.completion = ^(NSString *response, NSError *error) {
+            dispatch_async(ioQueue, ^{
+                responses[i] = response ?: @"";
+                if (error && !firstError) firstError = error;
+                if (--remaining == 0 && completion) {
+                    NSArray<NSString *> *result = [responses copy];
+                    NSError *err = firstError;
+                    dispatch_async(completionQueue, ^{ completion(result, err); });
+                }
+            });
+        };
+        dispatch_async(ioQueue, ^{
+            [self.queue addObject:req];
+        });
+    }
+    dispatch_async(ioQueue, ^{ [self pump]; });
+}
+
+- (void)disconnect {
+    dispatch_async(self.ioQueue, ^{
+        [self closeWithError:jessi_rcon_error(JessiRconErrorDisconnected, @"RCON disconnected")];
+    });
+}
+
+#pragma mark - IO queue
+
+- (BOOL)openConnection:(NSError **)outError {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        *outError = jessi_rcon_error(JessiRconErrorConnect, @"Failed to create RCON socket");
+        return NO;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    struct timeval tv = { .tv_sec = 5, .tv_usec = 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)self.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        *outError = jessi_rcon_error(JessiRconErrorConnect, @"RCON is not reachable");
+        return NO;
+    }
+
+    int32_t authId = [self allocateId];
+    if (!jessi_rcon_write_all(fd, jessi_rcon_packet(authId, JessiRconTypeAuth, self.password))) {
+        close(fd);
+        *outError = jessi_rcon_error(JessiRconErrorConnect, @"Failed to send RCON auth");
+        return NO;
+    }
+
+    // Source servers send an empty response before the auth result; vanilla sends only the result.
+    for (int i = 0; i < 2; i++) {
+        int32_t len = 0;
+        if (!jessi_rcon_read_all(fd, &len, 4) || len < 10 || len > 4096) break;
+        uint8_t buf[4096];
+        if (!jessi_rcon_read_all(fd, buf, (size_t)len)) break;
+        int32_t pid = 0, type = 0;
+        memcpy(&pid, buf, 4);
+        memcpy(&type, buf + 4, 4);
+        if (type == JessiRconTypeResponse && pid == authId) continue;
+        if (pid == -1) {
+            close(fd);
+            *outError = jessi_rcon_error(JessiRconErrorAuth, @"RCON authentication failed");
+            return NO;
+        }
+        if (pid == authId) {
+            self.fd = fd;
+            self.connected = YES;
+            [self startReading];
+            return YES;
+        }
+        break;
+    }
+
+    close(fd);
+    *outError = jessi_rcon_error(JessiRconErrorProtocol, @"Unexpected RCON auth response");
+    return NO;
+}
+
+- (void)startReading {
+    int fd = self.fd;
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)fd, 0, self.ioQueue);
+    __weak JessiRconClient *weakSelf = self;
+    dispatch_source_set_event_handler(source, ^{
+        [weakSelf readAvailable];
+    });
+    dispatch_source_set_cancel_handler(source, ^{
+        close(fd);
+    });
+    self.readSource = source;
+    dispatch_resume(source);
+}
+
+- (void)readAvailable {
+    if (self.fd < 0) return;
+    uint8_t buf[16384];
+    for (;;) {
+        ssize_t n = recv(self.fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            [self.rx appendBytes:buf length:(NSUInteger)n];
+            if ((size_t)n < sizeof(buf)) break;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        [self parsePackets];
+        [self closeWithError:jessi_rcon_error(JessiRconErrorDisconnected, @"RCON connection closed")];
+        return;
+    }
+    [self parsePackets];
+}
+
+- (void)parsePackets {
+    const uint8_t *bytes = self.rx.bytes;
+    NSUInteger avail = self.rx.length;
+    NSUInteger off = 0;
+    while (avail - off >= 4) {
+        int32_t len = 0;
+        memcpy(&len, bytes + off, 4);
+        if (len < 10 || len > JessiRconMaxPacket) {
+            [self.rx setLength:0];
+            [self closeWithError:jessi_rcon_error(JessiRconErrorProtocol, @"Malformed RCON packet")];
+            return;
+        }
+        if (avail - off < 4 + (NSUInteger)len) break;
+
+        int32_t pid = 0;
+        memcpy(&pid, bytes + off + 4, 4);
+        [self handlePacketId:pid payload:bytes + off + 12 length:(NSUInteger)len - 10];
+        off += 4 + (NSUInteger)len;
+
+        // handlePacketId may have closed the connection and reset rx.
+        if (self.rx.length != avail) return;
+    }
+    if (off) [self.rx replaceBytesInRange:NSMakeRange(0, off) withBytes:NULL length:0];
+}
+
+- (void)handlePacketId:(int32_t)pid payload:(const uint8_t *)payload length:(NSUInteger)len {
+    JessiRconRequest *req = self.inflight;
+    if (!req) return;
+
+    if (pid == req.commandId) {
+        if (len) [req.payload appendBytes:payload length:len];
+        if (req.stage == JessiRconStageAwaitingFirst) {
+            req.stage = JessiRconStageAwaitingSentinel;
+            if (!jessi_rcon_write_all(self.fd, jessi_rcon_packet(req.sentinelId, JessiRconTypeResponse, @""))) {
+                [self closeWithError:jessi_rcon_error(JessiRconErrorDisconnected, @"RCON connection closed")];
+            }
+        }
+    } else if (pid == req.sentinelId && req.stage == JessiRconStageAwaitingSentinel) {
+        self.inflight = nil;
+        [self finishRequest:req error:nil];
+        [self pump];
+    }
+}
+
+- (void)pump {
+    while (!self.inflight && self.queue.count) {
+        JessiRconRequest *req = self.queue.firstObject;
+        [self.queue removeObjectAtIndex:0];
+
+        if (self.fd < 0) {
+            NSError *err = nil;
+            if (![self openConnection:&err]) {
+                [self finishRequest:req error:err];
+                continue;
+            }
+        }
+
+        req.commandId = [self allocateId];
+        req.sentinelId = [self allocateId];
+        req.stage = JessiRconStageAwaitingFirst;
+        self.inflight = req;
+
+        if (!jessi_rcon_write_all(self.fd, jessi_rcon_packet(req.commandId, JessiRconTypeCommand, req.command))) {
+            // Most likely a connection left over from a previous server run; retry once on a fresh one.
+            self.inflight = nil;
+            [self closeWithError:nil];
+            if (!req.retried) {
+                req.retried = YES;
+                [self.queue insertObject:req atIndex:0];
+            } else {
+                [self finishRequest:req error:jessi_rcon_error(JessiRconErrorDisconnected, @"RCON connection closed")];
+            }
+            continue;
+        }
+        [self armTimeoutForRequest:req];
+    }
+}
+
+- (void)armTimeoutForRequest:(JessiRconRequest *)req {
+    NSTimeInterval timeout = req.timeout > 0 ? req.timeout : self.requestTimeout;
+    if (timeout <= 0) return;
+    __weak JessiRconClient *weakSelf = self;
+    __weak JessiRconRequest *weakReq = req;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)), self.ioQueue, ^{
+        JessiRconClient *client = weakSelf;
+        JessiRconRequest *pending = weakReq;
+        if (!client || !pending || client.inflight != pending) return;
+        // The session state is unknown after a lost reply, so start over on a new connection.
+        [client closeWithError:jessi_rcon_error(JessiRconErrorTimeout, @"RCON request timed out")];
+    });
+}
+
+- (void)closeWithError:(nullable NSError *)error {
+    if (self.readSource) {
+        dispatch_source_cancel(self.readSource);
+        self.readSource = nil;
+    } else if (self.fd >= 0) {
+        close(self.fd);
+    }
+    self.fd = -1;
+    self.connected = NO;
+    [self.rx setLength:0];
+
+    JessiRconRequest *req = self.inflight;
+    self.inflight = nil;
+    if (req && error) [self finishRequest:req error:error];
+    if (error) [self pump];
+}
+
+- (void)finishRequest:(JessiRconRequest *)req error:(nullable NSError *)error {
+    JessiRconCompletion completion = req.completion;
+    req.completion = nil;
+    if (!completion) return;
+
+    NSString *response = nil;
+    if (req.payload.length) {
+        response = [[NSString alloc] initWithData:req.payload encoding:NSUTF8StringEncoding]
+            ?: [[NSString alloc] initWithData:req.payload encoding:NSISOLatin1StringEncoding];
+    }
+    if (!response && !error) response = @"";
+    dispatch_async(self.completionQueue, ^{
+        completion(response, error);
+    });
+}
+
+@end
@@ -0,0 +1,76 @@
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "JessiReadahead.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define JESSI_READAHEAD_DEFAULT_CHUNK (8u * 1024u * 1024u)
+
+static int jessi_readahead_range(int fd, off_t offset, size_t len) {
+#if defined(__APPLE__)
+    struct radvisory ra;
+    ra.ra_offset = offset;
+    ra.ra_count = (int)len;
+    return fcntl(fd, F_RDADVISE, &ra) == 0 ? 0 : -1;
+#elif defined(__linux__)
+    return posix_fadvise(fd, offset, (off_t)len, POSIX_FADV_WILLNEED) == 0 ? 0 : -1;
+#else
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, offset);
+    if (map == MAP_FAILED) return -1;
+    int rc = madvise(map, len, MADV_WILLNEED);
+    munmap(map, len);
+    return rc == 0 ? 0 : -1;
+#endif
+}
+
+jessi_readahead_result jessi_readahead_file(const char *path, size_t chunk, jessi_readahead_should_stop stop,
+                                            void *ctx, uint64_t *advised) {
+    if (advised) *advised = 0;
+    if (!path || !path[0]) return JESSI_READAHEAD_FAILED;
+    if (chunk == 0) chunk = JESSI_READAHEAD_DEFAULT_CHUNK;
+    // F_RDADVISE takes an int count; mmap offsets must stay page aligned.
+    if (chunk > (size_t)INT_MAX) chunk = (size_t)INT_MAX;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (page > 0 && chunk > page) chunk -= chunk % page;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return JESSI_READAHEAD_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return JESSI_READAHEAD_FAILED;
+    }
+
+    jessi_readahead_result result = JESSI_READAHEAD_DONE;
+    uint64_t size = (uint64_t)st.st_size;
+    for (uint64_t off = 0; off < size; off += chunk) {
+        if (stop && stop(ctx)) {
+            result = JESSI_READAHEAD_CANCELED;
+            break;
+        }
+        size_t n = (size - off) < chunk ? (size_t)(size - off) : chunk;
+        if (jessi_readahead_range(fd, (off_t)off, n) != 0) {
+            result = JESSI_READAHEAD_FAILED;
+            break;
+        }
+        if (advised) *advised += n;
+    }
+    close(fd);
+    return result;
+}
+
+uint32_t jessi_readahead_magic32(const char *path) {
+    if (!path || !path[0]) return 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    uint32_t magic = 0;
+    ssize_t n = pread(fd, &magic, sizeof(magic), 0);
+    close(fd);
+    return n == (ssize_t)sizeof(magic) ? magic : 0;
+}
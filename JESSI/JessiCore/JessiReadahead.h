@@ -0,0 +1,33 @@
+#ifndef JessiReadahead_h
+#define JessiReadahead_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    JESSI_READAHEAD_FAILED = -1,
+    JESSI_READAHEAD_DONE = 0,
+    JESSI_READAHEAD_CANCELED = 1,
+} jessi_readahead_result;
+
+// Polled between chunks; nonzero stops the pass.
+typedef int (*jessi_readahead_should_stop)(void *ctx);
+
+// Asks the kernel to page a file into the buffer cache without copying it: F_RDADVISE on
+// Apple, posix_fadvise(WILLNEED) on Linux, madvise(WILLNEED) on a mapping elsewhere.
+// Issued in `chunk`-sized pieces so a pass can be stopped early. `advised` gets the bytes hinted.
+jessi_readahead_result jessi_readahead_file(const char *path, size_t chunk, jessi_readahead_should_stop stop,
+                                            void *ctx, uint64_t *advised);
+
+// Reads the first four bytes (little-endian as stored). 0 if the file is shorter or unreadable.
+uint32_t jessi_readahead_magic32(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
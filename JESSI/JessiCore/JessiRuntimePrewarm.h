@@ -0,0 +1,26 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Pages the configured Java runtime (libjli, libjvm, lib/modules, ...) and the selected server's
+// jar into the file cache at low QoS, so the first start after app launch doesn't read them
+// cold from flash. Passes stop under memory pressure, serious thermal state or Low Power Mode.
+@interface JessiRuntimePrewarm : NSObject
+
++ (instancetype)shared;
+
+// Replaces any pending or running pass. serverName may be nil to prewarm only the runtime.
+- (void)prewarmServerNamed:(nullable NSString *)serverName afterDelay:(NSTimeInterval)delay;
+- (void)cancel;
+
+// Called when a server starts: cancels the pass and reports whether the runtime and this
+// folder's jar were fully prewarmed and unchanged since.
+- (BOOL)noteLaunchOfServerDir:(NSString *)serverDir;
+
+// Called when the server reports Done; keeps recent warm/cold totals in jessi-prewarm.json
+// and returns a console line comparing them, or nil when prewarm is disabled.
++ (nullable NSString *)recordStartupMs:(double)totalMs prewarmed:(BOOL)prewarmed inServerDir:(NSString *)serverDir;
+
+@end
+
+NS_ASSUME_NONNULL_END
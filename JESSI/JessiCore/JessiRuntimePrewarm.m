@@ -0,0 +1,250 @@
+#import "JessiRuntimePrewarm.h"
+#import "JessiPaths.h"
+#import "JessiReadahead.h"
+#import "JessiRuntimeRegistry.h"
+#import "JessiServerSupervisor.h"
+#import "JessiSettings.h"
+#import "../SwiftUI/JessiJITCheck.h"
+
+#import <mach-o/fat.h>
+#import <mach-o/loader.h>
+#import <stdatomic.h>
+
+static NSString *const JessiPrewarmStatsName = @"jessi-prewarm.json";
+static const NSUInteger JessiPrewarmKeptSamples = 8;
+// A memory warning keeps prewarm off for this long.
+static const uint64_t JessiPrewarmPressureBackoffNs = 60ULL * NSEC_PER_SEC;
+
+// Runtime files touched before the first class loads; missing ones are skipped.
+static NSArray<NSString *> *jessi_prewarm_runtime_files(void) {
+    return @[
+        @"lib/server/libjvm.dylib",
+        @"lib/modules",
+        @"lib/libjava.dylib",
+        @"lib/libjimage.dylib",
+        @"lib/libzip.dylib",
+        @"lib/libnio.dylib",
+        @"lib/libnet.dylib",
+        @"lib/server/classes.jsa",
+    ];
+}
+
+static NSString *jessi_prewarm_stamp(NSString *path) {
+    struct stat st;
+    if (stat(path.fileSystemRepresentation, &st) != 0) return nil;
+    return [NSString stringWithFormat:@"%lld:%ld.%ld", (long long)st.st_size,
+            (long)st.st_mtimespec.tv_sec, (long)st.st_mtimespec.tv_nsec];
+}
+
+static NSString *jessi_prewarm_server_jar(NSString *dir) {
+    NSString *named = [dir stringByAppendingPathComponent:@"server.jar"];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:named]) return named;
+    for (NSString *name in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir error:nil]) {
+        if ([name.pathExtension.lowercaseString isEqualToString:@"jar"]) return [dir stringByAppendingPathComponent:name];
+    }
+    return nil;
+}
+
+@interface JessiRuntimePrewarm ()
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) dispatch_source_t pressureSource;
+// path -> stamp of files fully advised this session.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *warmed;
+@end
+
+@implementation JessiRuntimePrewarm {
+    atomic_uint_fast64_t _generation;
+    atomic_uint_fast64_t _pressureUntilNs;
+}
+
+typedef struct {
+    __unsafe_unretained JessiRuntimePrewarm *owner;
+    uint64_t generation;
+} jessi_prewarm_pass;
+
++ (instancetype)shared {
+    static JessiRuntimePrewarm *s;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s = [[JessiRuntimePrewarm alloc] init];
+    });
+    return s;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+        _queue = dispatch_queue_create("com.baconmania.jessi.prewarm", attr);
+        _warmed = [NSMutableDictionary dictionary];
+        atomic_init(&_generation, 0);
+        atomic_init(&_pressureUntilNs, 0);
+
+        __weak typeof(self) weakSelf = self;
+        _pressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                                 DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                                 dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        dispatch_source_set_event_handler(_pressureSource, ^{
+            JessiRuntimePrewarm *strongSelf = weakSelf;
+            if (!strongSelf) return;
+            atomic_store(&strongSelf->_pressureUntilNs, clock_gettime_nsec_np(CLOCK_UPTIME_RAW) + JessiPrewarmPressureBackoffNs);
+            [strongSelf cancel];
+        });
+        dispatch_resume(_pressureSource);
+    }
+    return self;
+}
+
+- (BOOL)shouldBackOff {
+    if (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) < atomic_load(&_pressureUntilNs)) return YES;
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+    if (info.thermalState >= NSProcessInfoThermalStateSerious) return YES;
+    if (info.isLowPowerModeEnabled) return YES;
+    return [JessiServerSupervisor shared].runningServerNames.count > 0;
+}
+
+static int jessi_prewarm_should_stop(void *ctx) {
+    jessi_prewarm_pass *pass = (jessi_prewarm_pass *)ctx;
+    JessiRuntimePrewarm *owner = pass->owner;
+    return atomic_load(&owner->_generation) != pass->generation || [owner shouldBackOff];
+}
+
+- (void)cancel {
+    atomic_fetch_add(&_generation, 1);
+}
+
+- (void)prewarmServerNamed:(NSString *)serverName afterDelay:(NSTimeInterval)delay {
+    if (![JessiSettings current].runtimePrewarm) return;
+    // The Mac build spawns the system JVM from fast storage; nothing to gain there.
+    if (jessi_is_running_on_macos()) return;
+
+    uint64_t generation = atomic_fetch_add(&_generation, 1) + 1;
+    NSString *javaVersion = [JessiSettings current].javaVersion ?: @"8";
+    NSString *serverDir = serverName.length ? [[JessiPaths serversRoot] stringByAppendingPathComponent:serverName] : nil;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(delay, 0) * NSEC_PER_SEC)), self.queue, ^{
+        if (atomic_load(&self->_generation) != generation) return;
+        [self runPassWithGeneration:generation javaVersion:javaVersion serverDir:serverDir];
+    });
+}
+
+- (NSArray<NSString *> *)filesForJavaHome:(NSString *)javaHome serverDir:(nullable NSString *)serverDir libjli:(NSString *)libjli {
+    NSMutableArray<NSString *> *files = [NSMutableArray arrayWithObject:libjli];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    for (NSString *rel in jessi_prewarm_runtime_files()) {
+        NSString *path = [javaHome stringByAppendingPathComponent:rel];
+        if ([fm fileExistsAtPath:path]) [files addObject:path];
+    }
+    if (serverDir.length) {
+        NSString *jar = jessi_prewarm_server_jar(serverDir);
+        if (jar) [files addObject:jar];
+        NSString *cds = [serverDir stringByAppendingPathComponent:@"jessi-cds.jsa"];
+        if ([fm fileExistsAtPath:cds]) [files addObject:cds];
+    }
+    return files;
+}
+
+- (void)runPassWithGeneration:(uint64_t)generation javaVersion:(NSString *)javaVersion serverDir:(nullable NSString *)serverDir {
+    if ([self shouldBackOff]) {
+        NSLog(@"[JESSI] Prewarm: skipped (memory pressure, thermal state, Low Power Mode or a running server)");
+        return;
+    }
+    JessiRuntimeInfo *runtime = [[JessiRuntimeRegistry shared] runtimeForVersion:javaVersion];
+    NSString *javaHome = runtime.home;
+    if (!javaHome) return;
+
+    // Same check the runner does before dlopen: a truncated install is not worth warming.
+    NSString *libjli = runtime.libjliPath;
+    uint32_t magic = libjli ? jessi_readahead_magic32(libjli.fileSystemRepresentation) : 0;
+    if (magic != MH_MAGIC_64 && magic != FAT_MAGIC && magic != FAT_CIGAM) {
+        NSLog(@"[JESSI] Prewarm: skipped, libjli in %@ is missing or not Mach-O", javaHome);
+        return;
+    }
+
+    uint64_t startNs = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    uint64_t advisedTotal = 0;
+    NSUInteger fileCount = 0;
+    jessi_prewarm_pass pass = { self, generation };
+    for (NSString *path in [self filesForJavaHome:javaHome serverDir:serverDir libjli:libjli]) {
+        NSString *stamp = jessi_prewarm_stamp(path);
+        if (!stamp) continue;
+        BOOL current = NO;
+        @synchronized(self) { current = [self.warmed[path] isEqualToString:stamp]; }
+        if (current) continue;
+        uint64_t advised = 0;
+        jessi_readahead_result r = jessi_readahead_file(path.fileSystemRepresentation, 0, jessi_prewarm_should_stop, &pass, &advised);
+        advisedTotal += advised;
+        if (r == JESSI_READAHEAD_CANCELED) {
+            NSLog(@"[JESSI] Prewarm: stopped after %.1f MB", (double)advisedTotal / (1024.0 * 1024.0));
+            return;
+        }
+        if (r == JESSI_READAHEAD_DONE) {
+            @synchronized(self) { self.warmed[path] = stamp; }
+            fileCount++;
+        }
+    }
+    if (fileCount > 0) {
+        NSLog(@"[JESSI] Prewarm: advised %lu file(s), %.1f MB in %.1f ms (%@)", (unsigned long)fileCount,
+              (double)advisedTotal / (1024.0 * 1024.0), (double)(clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startNs) / 1e6,
+              serverDir.lastPathComponent ?: @"runtime only");
+    }
+}
+
+- (BOOL)noteLaunchOfServerDir:(NSString *)serverDir {
+    [self cancel];
+    if (![JessiSettings current].runtimePrewarm || jessi_is_running_on_macos()) return NO;
+    JessiRuntimeInfo *runtime = [[JessiRuntimeRegistry shared] runtimeForVersion:[JessiSettings current].javaVersion ?: @"8"];
+    NSString *javaHome = runtime.home;
+    NSString *libjli = runtime.libjliPath;
+    if (!libjli) return NO;
+    NSArray<NSString *> *files = [self filesForJavaHome:javaHome serverDir:serverDir libjli:libjli];
+    @synchronized(self) {
+        for (NSString *path in files) {
+            NSString *stamp = jessi_prewarm_stamp(path);
+            if (!stamp || ![self.warmed[path] isEqualToString:stamp]) return NO;
+        }
+    }
+    return YES;
+}
+
+static double jessi_prewarm_average(NSArray *samples) {
+    double sum = 0;
+    for (NSNumber *n in samples) sum += n.doubleValue;
+    return samples.count ? sum / (double)samples.count : 0;
+}
+
++ (NSString *)recordStartupMs:(double)totalMs prewarmed:(BOOL)prewarmed inServerDir:(NSString *)serverDir {
+    if (serverDir.length == 0 || totalMs <= 0) return nil;
+    if (![JessiSettings current].runtimePrewarm || jessi_is_running_on_macos()) return nil;
+
+    NSString *path = [serverDir stringByAppendingPathComponent:JessiPrewarmStatsName];
+    NSMutableDictionary *stats = nil;
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    if (data) {
+        id obj = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+        if ([obj isKindOfClass:[NSMutableDictionary class]]) stats = obj;
+    }
+    if (!stats) stats = [NSMutableDictionary dictionary];
+
+    NSString *key = prewarmed ? @"warm_ms" : @"cold_ms";
+    NSString *otherKey = prewarmed ? @"cold_ms" : @"warm_ms";
+    NSMutableArray *samples = [stats[key] isKindOfClass:[NSMutableArray class]] ? stats[key] : [NSMutableArray array];
+    [samples addObject:@(totalMs)];
+    while (samples.count > JessiPrewarmKeptSamples) [samples removeObjectAtIndex:0];
+    stats[key] = samples;
+
+    NSData *out = [NSJSONSerialization dataWithJSONObject:stats options:NSJSONWritingPrettyPrinted error:nil];
+    if (out) [out writeToFile:path atomically:YES];
+
+    NSArray *other = [stats[otherKey] isKindOfClass:[NSArray class]] ? stats[otherKey] : @[];
+    NSString *state = prewarmed ? @"with the runtime prewarmed" : @"without prewarm";
+    if (other.count == 0) {
+        return [NSString stringWithFormat:@"[JESSI] Prewarm: reached Done in %.1f s %@.\n", totalMs / 1000.0, state];
+    }
+    return [NSString stringWithFormat:@"[JESSI] Prewarm: reached Done in %.1f s %@ (average %.1f s warm, %.1f s cold over the last %lu/%lu starts).\n",
+            totalMs / 1000.0, state,
+            jessi_prewarm_average(prewarmed ? samples : other) / 1000.0,
+            jessi_prewarm_average(prewarmed ? other : samples) / 1000.0,
+            (unsigned long)(prewarmed ? samples.count : other.count),
+            (unsigned long)(prewarmed ? other.count : samples.count)];
+}
+
+@end
@@ -0,0 +1,53 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface JessiRuntimeInfo : NSObject
+
+// Major version the runtime serves ("8", "17", "21"); taken from `release` for the generic java/.
+@property (nonatomic, copy, readonly) NSString *version;
+@property (nonatomic, copy, readonly) NSString *home;
+// "bundle", "installed" (Application Support/Runtimes) or "system" (java_home on macOS).
+@property (nonatomic, copy, readonly) NSString *source;
+@property (nonatomic, copy, readonly, nullable) NSString *vendor;
+@property (nonatomic, copy, readonly, nullable) NSString *fullVersion;
+@property (nonatomic, copy, readonly, nullable) NSString *libjliPath;
+@property (nonatomic, copy, readonly, nullable) NSString *libjvmPath;
+@property (nonatomic, readonly) BOOL libjliIsMachO;
+// LC_BUILD_VERSION platform of libjli, 0 when it has none (or is fat).
+@property (nonatomic, readonly) uint32_t platform;
+// Filled in by a background pass after a runtime is first seen or changes: 0 and "" until then.
+@property (nonatomic, readonly) unsigned long long sizeBytes;
+// SHA-256 over release, libjli and libjvm.
+@property (nonatomic, copy, readonly) NSString *fingerprint;
+
+@end
+
+// Every Java runtime the app can launch, indexed in Application Support/Runtimes/jessi-runtimes.json.
+// The index is loaded once per process and revalidated with a stat per runtime (libjli and release
+// size and mtime, which survive the container moving); new or changed runtimes are described from
+// a few header reads, and hashed and sized on a background queue. Lookups afterwards are in
+// memory, and on macOS java_home runs once per version instead of on every launch.
+@interface JessiRuntimeRegistry : NSObject
+
++ (instancetype)shared;
+
+// The runtime a launch for this version uses: bundled java<ver>/, the bundled generic java/, then
+// Runtimes/jre<ver>. On macOS, whatever java_home reports (falling back to the default JDK).
+- (nullable JessiRuntimeInfo *)runtimeForVersion:(NSString *)version;
+
+// Versions offered in Settings (bundled and installed runtimes), ascending.
+- (NSArray<NSString *> *)availableVersions;
+// Versions installed under Application Support/Runtimes.
+- (NSArray<NSString *> *)installedVersions;
+
+// Checks a staged download before it's moved into place: libjli must exist, be Mach-O and, on
+// Mac Catalyst, be built for Mac Catalyst.
+- (BOOL)validateRuntimeAtPath:(NSString *)home error:(NSError **)error;
+// Re-index Runtimes/jre<version> after an install or delete.
+- (void)registerInstalledVersion:(NSString *)version;
+- (void)removeInstalledVersion:(NSString *)version;
+
+@end
+
+NS_ASSUME_NONNULL_END
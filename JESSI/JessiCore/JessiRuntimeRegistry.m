@@ -0,0 +1,487 @@
+#import "JessiRuntimeRegistry.h"
+#import "JessiSettings.h"
+#import "../SwiftUI/JessiJITCheck.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <mach-o/fat.h>
+#import <mach-o/loader.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static NSString *const JessiRuntimeIndexName = @"jessi-runtimes.json";
+static const int JessiRuntimeIndexFormat = 2;
+
+static NSArray<NSString *> *jessi_runtime_majors(void) {
+    return @[@"8", @"17", @"21"];
+}
+
+static BOOL jessi_runtime_is_ios26_or_later(void) {
+    return [NSProcessInfo processInfo].operatingSystemVersion.majorVersion >= 26;
+}
+
+static NSString *jessi_runtimes_dir(void) {
+    NSURL *appSupport = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
+                                                               inDomains:NSUserDomainMask] firstObject];
+    return [[appSupport URLByAppendingPathComponent:@"Runtimes" isDirectory:YES] path];
+}
+
+// Index keys are "<root>/<dir>" so entries survive the container path changing across updates.
+static NSDictionary<NSString *, NSString *> *jessi_runtime_roots(void) {
+    NSMutableDictionary<NSString *, NSString *> *roots = [NSMutableDictionary dictionary];
+    NSBundle *b = [NSBundle mainBundle];
+    NSString *bundleRoot = b.bundlePath;
+    NSString *resourceRoot = b.resourcePath;
+    if (bundleRoot.length) {
+        roots[@"bundle"] = bundleRoot;
+        roots[@"bundle-resources"] = [bundleRoot stringByAppendingPathComponent:@"Resources"];
+    }
+    if (resourceRoot.length && ![resourceRoot isEqualToString:bundleRoot]) roots[@"resources"] = resourceRoot;
+    NSString *runtimes = jessi_runtimes_dir();
+    if (runtimes.length) roots[@"runtimes"] = runtimes;
+    return roots;
+}
+
+static NSArray<NSString *> *jessi_bundle_root_tags(void) {
+    return @[@"bundle", @"resources", @"bundle-resources"];
+}
+
+static NSString *jessi_runtime_libjli_rel(NSString *home) {
+    // Java 8 keeps it under lib/jli; prefer that like the launcher always has.
+    for (NSString *rel in @[@"lib/jli/libjli.dylib", @"lib/libjli.dylib"]) {
+        if (access([home stringByAppendingPathComponent:rel].fileSystemRepresentation, F_OK) == 0) return rel;
+    }
+    return nil;
+}
+
+// Relative path, size and mtime only: device and inode change whenever the container moves (every
+// app install or update), and that must not force a rehash.
+static NSString *jessi_runtime_file_stamp(NSString *home, NSString *rel) {
+    struct stat st;
+    if (!rel || stat([home stringByAppendingPathComponent:rel].fileSystemRepresentation, &st) != 0) return @"-";
+    return [NSString stringWithFormat:@"%@:%lld:%ld.%ld", rel, (long long)st.st_size,
+            (long)st.st_mtimespec.tv_sec, (long)st.st_mtimespec.tv_nsec];
+}
+
+static NSString *jessi_runtime_stamp(NSString *home) {
+    return [NSString stringWithFormat:@"%@|%@",
+            jessi_runtime_file_stamp(home, jessi_runtime_libjli_rel(home)),
+            jessi_runtime_file_stamp(home, @"release")];
+}
+
+static NSDictionary<NSString *, NSString *> *jessi_runtime_release(NSString *home) {
+    NSString *text = [NSString stringWithContentsOfFile:[home stringByAppendingPathComponent:@"release"]
+                                               encoding:NSUTF8StringEncoding
+                                                  error:nil];
+    NSMutableDictionary<NSString *, NSString *> *out = [NSMutableDictionary dictionary];
+    for (NSString *line in [text componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]) {
+        NSRange eq = [line rangeOfString:@"="];
+        if (eq.location == NSNotFound) continue;
+        NSString *key = [line substringToIndex:eq.location];
+        NSString *value = [[line substringFromIndex:eq.location + 1]
+                           stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\" \t\r"]];
+        out[key] = value;
+    }
+    return out;
+}
+
+// "1.8.0_402" -> "8", "17.0.10" -> "17".
+static NSString *jessi_runtime_major(NSString *fullVersion) {
+    NSArray<NSString *> *parts = [fullVersion componentsSeparatedByString:@"."];
+    if (parts.count >= 2 && [parts[0] isEqualToString:@"1"]) return parts[1];
+    NSString *first = parts.firstObject;
+    return first.integerValue > 0 ? [NSString stringWithFormat:@"%ld", (long)first.integerValue] : nil;
+}
+
+// Returns YES when the file starts with a Mach-O or fat magic; *platform gets LC_BUILD_VERSION.
+static BOOL jessi_runtime_macho_platform(NSString *path, uint32_t *platform) {
+    *platform = 0;
+    int fd = path ? open(path.fileSystemRepresentation, O_RDONLY) : -1;
+    if (fd < 0) return NO;
+    struct mach_header_64 mh;
+    BOOL ok = NO;
+    if (pread(fd, &mh, sizeof(mh), 0) == (ssize_t)sizeof(mh)) {
+        if (mh.magic == FAT_MAGIC || mh.magic == FAT_CIGAM) {
+            ok = YES;
+        } else if (mh.magic == MH_MAGIC_64) {
+            ok = YES;
+            uint32_t len = MIN(mh.sizeofcmds, 1024u * 1024u);
+            uint8_t *cmds = malloc(len);
+            if (cmds && pread(fd, cmds, len, sizeof(mh)) == (ssize_t)len) {
+                uint32_t off = 0;
+                for (uint32_t i = 0; i < mh.ncmds && off + sizeof(struct load_command) <= len; i++) {
+                    struct load_command lc;
+                    memcpy(&lc, cmds + off, sizeof(lc));
+                    if (lc.cmdsize < sizeof(lc) || off + lc.cmdsize > len) break;
+                    if (lc.cmd == LC_BUILD_VERSION && lc.cmdsize >= sizeof(struct build_version_command)) {
+                        struct build_version_command bv;
+                        memcpy(&bv, cmds + off, sizeof(bv));
+                        *platform = bv.platform;
+                        break;
+                    }
+                    off += lc.cmdsize;
+                }
+            }
+            free(cmds);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+static void jessi_runtime_hash_file(CC_SHA256_CTX *ctx, NSString *path) {
+    const char *tag = path.lastPathComponent.UTF8String ?: "";
+    CC_SHA256_Update(ctx, tag, (CC_LONG)strlen(tag) + 1);
+    NSInputStream *in = path ? [NSInputStream inputStreamWithFileAtPath:path] : nil;
+    if (!in) return;
+    [in open];
+    uint8_t buf[64 * 1024];
+    NSInteger n;
+    while ((n = [in read:buf maxLength:sizeof(buf)]) > 0) CC_SHA256_Update(ctx, buf, (CC_LONG)n);
+    [in close];
+}
+
+static unsigned long long jessi_runtime_tree_size(NSString *home) {
+    unsigned long long total = 0;
+    NSDirectoryEnumerator<NSURL *> *e = [[NSFileManager defaultManager] enumeratorAtURL:[NSURL fileURLWithPath:home isDirectory:YES]
+                                                             includingPropertiesForKeys:@[NSURLFileSizeKey]
+                                                                                options:0
+                                                                           errorHandler:nil];
+    for (NSURL *url in e) {
+        NSNumber *size = nil;
+        [url getResourceValue:&size forKey:NSURLFileSizeKey error:nil];
+        total += size.unsignedLongLongValue;
+    }
+    return total;
+}
+
+// What lookups need: a few stats and header reads. Runs inline for new or changed runtimes.
+static NSDictionary *jessi_runtime_describe(NSString *home, NSString *_Nullable version, NSString *source) {
+    BOOL isDir = NO;
+    if (![[NSFileManager defaultManager] fileExistsAtPath:home isDirectory:&isDir] || !isDir) return nil;
+
+    NSDictionary<NSString *, NSString *> *release = jessi_runtime_release(home);
+    NSString *fullVersion = release[@"JAVA_VERSION"];
+    NSString *major = version ?: jessi_runtime_major(fullVersion);
+    if (!major.length) return nil;
+
+    NSString *libjli = jessi_runtime_libjli_rel(home);
+    NSString *libjvm = nil;
+    for (NSString *rel in @[@"lib/server/libjvm.dylib", @"jre/lib/server/libjvm.dylib"]) {
+        if (access([home stringByAppendingPathComponent:rel].fileSystemRepresentation, F_OK) == 0) {
+            libjvm = rel;
+            break;
+        }
+    }
+    uint32_t platform = 0;
+    BOOL machO = libjli && jessi_runtime_macho_platform([home stringByAppendingPathComponent:libjli], &platform);
+
+    NSMutableDictionary *entry = [@{
+        @"version": major,
+        @"source": source,
+        @"machO": @(machO),
+        @"platform": @(platform),
+        @"stamp": jessi_runtime_stamp(home),
+    } mutableCopy];
+    if (release[@"IMPLEMENTOR"].length) entry[@"vendor"] = release[@"IMPLEMENTOR"];
+    if (fullVersion.length) entry[@"fullVersion"] = fullVersion;
+    if (libjli) entry[@"libjli"] = libjli;
+    if (libjvm) entry[@"libjvm"] = libjvm;
+    return entry;
+}
+
+// The expensive part (hashing release/libjli/libjvm and walking the tree); runs on the registry's
+// background queue, never under its lock.
+static NSDictionary *jessi_runtime_measure(NSString *home, NSDictionary *entry) {
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    CC_SHA256_CTX ctx;
+    CC_SHA256_Init(&ctx);
+    jessi_runtime_hash_file(&ctx, [home stringByAppendingPathComponent:@"release"]);
+    if ([entry[@"libjli"] length]) jessi_runtime_hash_file(&ctx, [home stringByAppendingPathComponent:entry[@"libjli"]]);
+    if ([entry[@"libjvm"] length]) jessi_runtime_hash_file(&ctx, [home stringByAppendingPathComponent:entry[@"libjvm"]]);
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &ctx);
+    NSMutableString *fingerprint = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (size_t i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) [fingerprint appendFormat:@"%02x", digest[i]];
+
+    unsigned long long size = jessi_runtime_tree_size(home);
+    NSLog(@"[JESSI] Runtime registry: indexed %@ (Java %@, %@, %.1f MB, platform %u) in %.0f ms",
+          home.lastPathComponent, entry[@"fullVersion"] ?: entry[@"version"], entry[@"vendor"] ?: @"unknown vendor",
+          size / (1024.0 * 1024.0), [entry[@"platform"] unsignedIntValue], (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+    return @{@"fingerprint": fingerprint, @"size": @(size)};
+}
+
+static NSString *jessi_java_home_from_tool(NSString *_Nullable version) {
+    NSString *cmd = version.length ? [NSString stringWithFormat:@"/usr/libexec/java_home -v %@ 2>/dev/null", version]
+                                   : @"/usr/libexec/java_home 2>/dev/null";
+    FILE *fp = popen(cmd.UTF8String, "r");
+    if (!fp) return nil;
+    char buf[PATH_MAX] = {0};
+    BOOL got = fgets(buf, sizeof(buf), fp) != NULL;
+    pclose(fp);
+    if (!got) return nil;
+    NSString *home = [[NSString stringWithUTF8String:buf] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    return home.length > 0 && [[NSFileManager defaultManager] fileExistsAtPath:home] ? home : nil;
+}
+
+@interface JessiRuntimeInfo ()
+- (instancetype)initWithEntry:(NSDictionary *)entry home:(NSString *)home;
+@end
+
+@implementation JessiRuntimeInfo
+
+- (instancetype)initWithEntry:(NSDictionary *)entry home:(NSString *)home {
+    if (!(self = [super init])) return nil;
+    _version = [entry[@"version"] copy] ?: @"";
+    _home = [home copy];
+    _source = [entry[@"source"] copy] ?: @"bundle";
+    _vendor = [entry[@"vendor"] copy];
+    _fullVersion = [entry[@"fullVersion"] copy];
+    _libjliPath = [entry[@"libjli"] length] ? [home stringByAppendingPathComponent:entry[@"libjli"]] : nil;
+    _libjvmPath = [entry[@"libjvm"] length] ? [home stringByAppendingPathComponent:entry[@"libjvm"]] : nil;
+    _libjliIsMachO = [entry[@"machO"] boolValue];
+    _platform = [entry[@"platform"] unsignedIntValue];
+    _sizeBytes = [entry[@"size"] unsignedLongLongValue];
+    _fingerprint = [entry[@"fingerprint"] copy] ?: @"";
+    return self;
+}
+
+@end
+
+@implementation JessiRuntimeRegistry {
+    BOOL _loaded;
+    NSMutableDictionary<NSString *, NSDictionary *> *_entries;
+    NSMutableDictionary<NSString *, JessiRuntimeInfo *> *_runtimes;
+    dispatch_queue_t _measureQueue;
+    NSMutableSet<NSString *> *_measuring;
+}
+
++ (instancetype)shared {
+    static JessiRuntimeRegistry *shared;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        shared = [[JessiRuntimeRegistry alloc] init];
+    });
+    return shared;
+}
+
+- (nullable NSString *)homeForKey:(NSString *)key entry:(nullable NSDictionary *)entry {
+    if ([key hasPrefix:@"system/"]) return entry[@"home"];
+    NSRange slash = [key rangeOfString:@"/"];
+    if (slash.location == NSNotFound) return nil;
+    NSString *root = jessi_runtime_roots()[[key substringToIndex:slash.location]];
+    return root ? [root stringByAppendingPathComponent:[key substringFromIndex:slash.location + 1]] : nil;
+}
+
+- (void)saveIndex {
+    NSString *dir = jessi_runtimes_dir();
+    if (!dir.length) return;
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    NSDictionary *index = @{@"format": @(JessiRuntimeIndexFormat), @"runtimes": _entries};
+    NSData *out = [NSJSONSerialization dataWithJSONObject:index options:NSJSONWritingPrettyPrinted error:nil];
+    [out writeToFile:[dir stringByAppendingPathComponent:JessiRuntimeIndexName] atomically:YES];
+}
+
+- (void)setEntry:(nullable NSDictionary *)entry forKey:(NSString *)key {
+    _entries[key] = entry;
+    NSString *home = entry ? [self homeForKey:key entry:entry] : nil;
+    _runtimes[key] = home ? [[JessiRuntimeInfo alloc] initWithEntry:entry home:home] : nil;
+}
+
+// Hashes and sizes an entry in the background; the entry is served without them meanwhile and
+// only updated if its stamp hasn't moved on. Caller holds the lock.
+- (void)measureKey:(NSString *)key home:(NSString *)home {
+    if ([_measuring containsObject:key]) return;
+    if (!_measureQueue) {
+        _measureQueue = dispatch_queue_create("com.baconmania.jessi.runtimes", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _measuring = [NSMutableSet set];
+    }
+    [_measuring addObject:key];
+    NSDictionary *entry = _entries[key];
+    dispatch_async(_measureQueue, ^{
+        NSDictionary *measured = jessi_runtime_measure(home, entry);
+        @synchronized (self) {
+            [self->_measuring removeObject:key];
+            NSDictionary *current = self->_entries[key];
+            if (![current[@"stamp"] isEqualToString:entry[@"stamp"]]) return;
+            NSMutableDictionary *updated = [current mutableCopy];
+            [updated addEntriesFromDictionary:measured];
+            [self setEntry:updated forKey:key];
+            [self saveIndex];
+        }
+    });
+}
+
+// Reuses an indexed entry while its stamp still matches; otherwise describes the folder again and
+// leaves hashing to the background queue.
+- (BOOL)refreshKey:(NSString *)key stored:(nullable NSDictionary *)stored version:(nullable NSString *)version source:(NSString *)source {
+    NSString *home = [self homeForKey:key entry:stored];
+    struct stat st;
+    if (!home || stat(home.fileSystemRepresentation, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        [self setEntry:nil forKey:key];
+        return stored != nil;
+    }
+    if (stored && [stored[@"stamp"] isEqualToString:jessi_runtime_stamp(home)]) {
+        [self setEntry:stored forKey:key];
+        if (![stored[@"fingerprint"] length]) [self measureKey:key home:home];
+        return NO;
+    }
+    NSMutableDictionary *entry = [jessi_runtime_describe(home, version, source) mutableCopy];
+    if (entry && [key hasPrefix:@"system/"]) entry[@"home"] = home;
+    [self setEntry:entry forKey:key];
+    if (entry) [self measureKey:key home:home];
+    return YES;
+}
+
+- (void)loadIfNeeded {
+    if (_loaded) return;
+    _loaded = YES;
+    _entries = [NSMutableDictionary dictionary];
+    _runtimes = [NSMutableDictionary dictionary];
+
+    NSData *data = [NSData dataWithContentsOfFile:[jessi_runtimes_dir() stringByAppendingPathComponent:JessiRuntimeIndexName]];
+    id obj = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    NSDictionary *stored = nil;
+    if ([obj isKindOfClass:[NSDictionary class]] && [obj[@"format"] intValue] == JessiRuntimeIndexFormat &&
+        [obj[@"runtimes"] isKindOfClass:[NSDictionary class]]) {
+        stored = obj[@"runtimes"];
+    }
+
+    BOOL changed = (stored == nil);
+    NSDictionary<NSString *, NSString *> *roots = jessi_runtime_roots();
+    NSMutableSet<NSString *> *seenRoots = [NSMutableSet set];
+    for (NSString *tag in jessi_bundle_root_tags()) {
+        NSString *root = roots[tag];
+        if (!root || [seenRoots containsObject:root]) continue;
+        [seenRoots addObject:root];
+        for (NSString *ver in jessi_runtime_majors()) {
+            NSString *key = [NSString stringWithFormat:@"%@/java%@", tag, ver];
+            changed |= [self refreshKey:key stored:stored[key] version:ver source:@"bundle"];
+        }
+        NSString *generic = [tag stringByAppendingString:@"/java"];
+        changed |= [self refreshKey:generic stored:stored[generic] version:nil source:@"bundle"];
+    }
+    for (NSString *ver in jessi_runtime_majors()) {
+        NSString *key = [NSString stringWithFormat:@"runtimes/jre%@", ver];
+        changed |= [self refreshKey:key stored:stored[key] version:ver source:@"installed"];
+    }
+    for (NSString *key in stored) {
+        if ([key hasPrefix:@"system/"] && [stored[key] isKindOfClass:[NSDictionary class]]) {
+            changed |= [self refreshKey:key stored:stored[key] version:stored[key][@"version"] source:@"system"];
+        }
+    }
+    for (NSString *key in stored) {
+        if (!_entries[key]) changed = YES;
+    }
+    if (changed) [self saveIndex];
+}
+
+- (JessiRuntimeInfo *)runtimeForVersion:(NSString *)version {
+    if (!version.length) version = @"21";
+    @synchronized (self) {
+        [self loadIfNeeded];
+        if (jessi_is_running_on_macos()) {
+            NSString *key = [@"system/" stringByAppendingString:version];
+            if (_runtimes[key]) return _runtimes[key];
+            // Fall back to the default JDK if the exact requested major version is unavailable.
+            NSString *home = jessi_java_home_from_tool(version) ?: jessi_java_home_from_tool(nil);
+            if (!home) return nil;
+            [self refreshKey:key stored:@{@"home": home} version:version source:@"system"];
+            [self saveIndex];
+            return _runtimes[key];
+        }
+
+        for (NSString *tag in jessi_bundle_root_tags()) {
+            JessiRuntimeInfo *rt = _runtimes[[NSString stringWithFormat:@"%@/java%@", tag, version]];
+            if (rt) return rt;
+        }
+        for (NSString *tag in jessi_bundle_root_tags()) {
+            JessiRuntimeInfo *rt = _runtimes[[tag stringByAppendingString:@"/java"]];
+            if (rt) return rt;
+        }
+        return _runtimes[[NSString stringWithFormat:@"runtimes/jre%@", version]];
+    }
+}
+
+- (NSArray<NSString *> *)availableVersions {
+    BOOL isIOS26OrLater = jessi_runtime_is_ios26_or_later();
+    NSMutableOrderedSet<NSString *> *available = [NSMutableOrderedSet orderedSet];
+    @synchronized (self) {
+        [self loadIfNeeded];
+        for (NSString *ver in jessi_runtime_majors()) {
+            if (isIOS26OrLater && [ver isEqualToString:@"8"]) continue;
+            for (NSString *tag in jessi_bundle_root_tags()) {
+                if (_runtimes[[NSString stringWithFormat:@"%@/java%@", tag, ver]]) [available addObject:ver];
+            }
+        }
+        if (!isIOS26OrLater && available.count == 0) {
+            for (NSString *tag in jessi_bundle_root_tags()) {
+                JessiRuntimeInfo *generic = _runtimes[[tag stringByAppendingString:@"/java"]];
+                if (generic && [jessi_runtime_majors() containsObject:generic.version]) {
+                    [available addObject:generic.version];
+                    break;
+                }
+            }
+        }
+        for (NSString *ver in jessi_runtime_majors()) {
+            if (isIOS26OrLater && [ver isEqualToString:@"8"]) continue;
+            if (_runtimes[[NSString stringWithFormat:@"runtimes/jre%@", ver]]) [available addObject:ver];
+        }
+    }
+    return [available.array sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+        return [a integerValue] - [b integerValue] > 0 ? NSOrderedDescending : NSOrderedAscending;
+    }];
+}
+
+- (NSArray<NSString *> *)installedVersions {
+    NSMutableArray<NSString *> *installed = [NSMutableArray array];
+    @synchronized (self) {
+        [self loadIfNeeded];
+        for (NSString *ver in jessi_runtime_majors()) {
+            if (_runtimes[[NSString stringWithFormat:@"runtimes/jre%@", ver]]) [installed addObject:ver];
+        }
+    }
+    return installed;
+}
+
+- (BOOL)validateRuntimeAtPath:(NSString *)home error:(NSError **)error {
+    if (![NSProcessInfo processInfo].isMacCatalystApp) return YES;
+
+    NSString *libjli = jessi_runtime_libjli_rel(home);
+    if (!libjli) {
+        if (error) *error = [NSError errorWithDomain:@"JESSI" code:106 userInfo:@{NSLocalizedDescriptionKey: @"Downloaded runtime is missing libjli.dylib"}];
+        return NO;
+    }
+    uint32_t platform = 0;
+    if (!jessi_runtime_macho_platform([home stringByAppendingPathComponent:libjli], &platform) || platform == 0) {
+        if (error) *error = [NSError errorWithDomain:@"JESSI" code:107 userInfo:@{NSLocalizedDescriptionKey: @"Could not verify runtime platform for libjli.dylib"}];
+        return NO;
+    }
+    if (platform != PLATFORM_MACCATALYST) {
+        NSString *msg = [NSString stringWithFormat:@"Downloaded JVM is not Mac Catalyst compatible (platform %u).", platform];
+        if (error) *error = [NSError errorWithDomain:@"JESSI" code:108 userInfo:@{NSLocalizedDescriptionKey: msg}];
+        return NO;
+    }
+    return YES;
+}
+
+- (void)registerInstalledVersion:(NSString *)version {
+    @synchronized (self) {
+        [self loadIfNeeded];
+        NSString *key = [NSString stringWithFormat:@"runtimes/jre%@", version];
+        [self refreshKey:key stored:nil version:version source:@"installed"];
+        [self saveIndex];
+    }
+    [JessiSettings runtimesDidChange];
+}
+
+- (void)removeInstalledVersion:(NSString *)version {
+    @synchronized (self) {
+        [self loadIfNeeded];
+        [self setEntry:nil forKey:[NSString stringWithFormat:@"runtimes/jre%@", version]];
+        [self saveIndex];
+    }
+    [JessiSettings runtimesDidChange];
+}
+
+@end
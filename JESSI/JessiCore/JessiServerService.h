@@ -1,24 +1,70 @@
 #import <Foundation/Foundation.h>
+#import "JessiConsoleBuffer.h"
+#import "JessiServerState.h"
+#import "JessiTelemetrySampler.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Posted with the instance as the object whenever one starts or stops.
+extern NSString *const JessiServerRunningChanged;
+
+typedef NS_ENUM(NSInteger, JessiShutdownStage) {
+    JessiShutdownStageIdle = 0,
+    JessiShutdownStageSaving,       // "save-all flush" sent, waiting for "Saved the game"
+    JessiShutdownStageStopping,     // "stop" sent, waiting for the JVM to exit
+    JessiShutdownStageTerminating,  // SIGTERM sent
+    JessiShutdownStageKilling,      // SIGKILL sent; spawned JVMs only
+};
+
 @protocol JessiServerServiceDelegate <NSObject>
-- (void)serverServiceDidUpdateConsole:(NSString *)consoleText;
 - (void)serverServiceDidChangeRunning:(BOOL)isRunning;
+@optional
+// Preferred: only the appended text plus how much was evicted from the front.
+- (void)serverServiceDidAppendConsole:(JessiConsoleDelta *)delta;
+// Fallback for delegates that want the full text on every update.
+- (void)serverServiceDidUpdateConsole:(NSString *)consoleText;
+- (void)serverServiceDidChangeShutdownStage:(JessiShutdownStage)stage;
 @end
 
 @interface JessiServerService : NSObject
 @property (nonatomic, assign, nullable) id<JessiServerServiceDelegate> delegate;
 @property (nonatomic, readonly, getter=isRunning) BOOL running;
+// Main queue. Each stage is bounded by the JessiSettings shutdown timeouts.
+@property (nonatomic, readonly) JessiShutdownStage shutdownStage;
+// Set for instances owned by JessiServerSupervisor; they also keep console.log up to date.
+@property (nonatomic, readonly, copy, nullable) NSString *serverName;
+// Ports written to server.properties for the current (or last) run.
+@property (nonatomic, readonly) int gamePort;
+@property (nonatomic, readonly) int rconPort;
+// Applied at start: -Xmx override and -XX:ActiveProcessorCount; 0 keeps the global settings.
+@property (nonatomic) NSInteger maxHeapMB;
+@property (nonatomic) NSInteger cpuCores;
+// Players, startup time, lag spikes etc. parsed from the server log; read on the main queue.
+@property (nonatomic, readonly, strong) JessiServerState *serverState;
+// Per-second RSS/footprint, CPU, threads and disk I/O of the running server; exported to
+// jessi-telemetry.csv in the server folder when it exits.
+@property (nonatomic, readonly, strong) JessiTelemetrySampler *telemetry;
+
+// YES when the JVM runs in a spawned process (macOS, TrollStore) rather than via JLI in-process.
++ (BOOL)usesSeparateJVMProcess;
+
+- (instancetype)initWithServerName:(nullable NSString *)serverName;
 
 - (NSArray<NSString *> *)availableServerFolders;
 - (NSString *)serversRoot;
 
 - (void)startServerNamed:(NSString *)serverName;
+// Saves, stops, then escalates to SIGTERM/SIGKILL when a stage times out. Calling it again
+// while a shutdown is in progress skips to the next stage.
 - (void)stopServer;
 - (void)clearConsole;
+- (NSString *)consoleSnapshot;
+// Queues the command on the persistent RCON session and echoes the reply to the console.
 - (BOOL)sendRcon:(NSString *)command;
+- (void)sendRconCommand:(NSString *)command completion:(nullable void (^)(NSString * _Nullable response, NSError * _Nullable error))completion;
+- (void)sendRconCommands:(NSArray<NSString *> *)commands completion:(nullable void (^)(NSArray<NSString *> *responses, NSError * _Nullable error))completion;
 - (NSString *)cleanupStaleJVMProcessesOnMac;
+- (NSDictionary<NSString *, NSNumber *> *)logTailerStatistics;
 
 - (void)importServerJarFromURL:(NSURL *)url serverNameHint:(NSString *)nameHint completion:(void (^)(NSError * _Nullable error, NSString * _Nullable serverName))completion;
 
@@ -1,5 +1,16 @@
 #import "JessiServerService.h"
-
+#import "JessiServerSupervisor.h"
+
+#import "JessiLogTailer.h"
+#import "JessiChildChannel.h"
+#import "JessiLineScanner.h"
+#import "JessiLogEvents.h"
+#import "JessiConsoleBuffer.h"
+#import "JessiRconClient.h"
+#import "JessiTelemetrySampler.h"
+#import "JessiLaunchTrace.h"
+#import "JessiCDSArchive.h"
+#import "JessiRuntimePrewarm.h"
 #import "JessiPaths.h"
 #import "JessiSettings.h"
 
@@ -21,9 +32,10 @@ static const UIBackgroundTaskIdentifier UIBackgroundTaskInvalid = -1;
 
 extern int jessi_server_main(int argc, char *argv[]);
 
+NSString *const JessiServerRunningChanged = @"JessiServerRunningChanged";
 static NSString *const JessiServerRunningKey = @"jessi.server.running";
-static NSString *const JessiServerRunningChanged = @"JessiServerRunningChanged";
-static BOOL g_serverRunning = NO;
+// Instances running across the process; the in-process JVM can only be started when this is 0.
+static NSInteger g_runningServerCount = 0;
 
 static NSString *jessi_server_pid_file_path(NSString *dir) {
     return [dir stringByAppendingPathComponent:@".jessi_server_pid"];
@@ -94,53 +106,159 @@ static BOOL jessi_looks_like_jessi_java(NSString *cmd) {
     return hasJava && hasMarker;
 }
 
-@interface JessiServerService ()
+static NSMutableDictionary<NSString *, NSString *> *jessi_read_server_properties(NSString *path) {
+    NSMutableDictionary<NSString *, NSString *> *kv = [NSMutableDictionary dictionary];
+    NSString *content = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    for (NSString *line in [content componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]) {
+        if (line.length == 0 || [line hasPrefix:@"#"]) continue;
+        NSRange r = [line rangeOfString:@"="];
+        if (r.location == NSNotFound) continue;
+        NSString *k = [line substringToIndex:r.location];
+        NSString *v = [line substringFromIndex:r.location + 1];
+        if (k.length) kv[k] = v ?: @"";
+    }
+    return kv;
+}
+
+// Per-instance limits reach the runner through the environment of the spawned process.
+static char **jessi_spawn_environment(char **base, NSInteger maxHeapMB, NSInteger cpuCores) {
+    size_t n = 0;
+    while (base && base[n]) n++;
+    char **env = calloc(n + 3, sizeof(char *));
+    size_t out = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (strncmp(base[i], "JESSI_MAX_HEAP_MB=", 18) == 0 || strncmp(base[i], "JESSI_ACTIVE_CPUS=", 18) == 0) continue;
+        env[out++] = strdup(base[i]);
+    }
+    if (maxHeapMB > 0) asprintf(&env[out++], "JESSI_MAX_HEAP_MB=%ld", (long)maxHeapMB);
+    if (cpuCores > 0) asprintf(&env[out++], "JESSI_ACTIVE_CPUS=%ld", (long)cpuCores);
+    env[out] = NULL;
+    return env;
+}
+
+static void jessi_free_environment(char **env) {
+    if (!env) return;
+    for (size_t i = 0; env[i]; i++) free(env[i]);
+    free(env);
+}
+
+static void jessi_set_limit_env(const char *name, NSInteger value) {
+    if (value > 0) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%ld", (long)value);
+        setenv(name, buf, 1);
+    } else {
+        unsetenv(name);
+    }
+}
+
+@interface JessiServerService () {
+    jessi_log_parser _stdioParser;
+    jessi_log_parser _latestParser;
+    BOOL _running;
+}
 @property (nonatomic, readwrite, getter=isRunning) BOOL running;
-@property (nonatomic, strong) NSMutableString *console;
+@property (nonatomic, readwrite, copy, nullable) NSString *serverName;
+@property (nonatomic, readwrite) int gamePort;
+@property (nonatomic, readwrite) int rconPort;
+@property (nonatomic, strong, nullable) NSFileHandle *consoleLogHandle;
+@property (nonatomic, readwrite) JessiShutdownStage shutdownStage;
+@property (nonatomic) NSUInteger shutdownGeneration;
+@property (nonatomic) CFAbsoluteTime shutdownStartedAt;
+@property (nonatomic) BOOL runsInSeparateProcess;
+@property (nonatomic, readwrite, strong) JessiServerState *serverState;
+@property (nonatomic, readwrite, strong) JessiTelemetrySampler *telemetry;
+@property (nonatomic, strong) JessiConsoleBuffer *console;
 @property (nonatomic, strong) dispatch_queue_t runQueue;
-@property (nonatomic, strong) dispatch_queue_t logQueue;
-@property (nonatomic, strong) dispatch_source_t logTimer;
-@property (nonatomic) off_t logOffset;
-@property (nonatomic) off_t stdioOffset;
+@property (nonatomic, assign, nullable) jessi_log_tailer *logTailer;
+@property (nonatomic) jessi_log_tailer_stats lastLogTailerStats;
+@property (nonatomic, assign) jessi_line_scanner *stdioScanner;
+@property (nonatomic, assign) jessi_line_scanner *latestScanner;
+@property (nonatomic, strong) NSMutableData *logLineBuffer;
 @property (nonatomic, copy) NSString *activeServerDir;
 @property (nonatomic, copy) NSString *activeRconPassword;
-@property (nonatomic) int activeRconPort;
+@property (nonatomic) uint64_t launchStartNs;
+@property (nonatomic) BOOL launchPrewarmed;
+@property (atomic, copy, nullable) NSString *childExitReason;
+// macOS: the java the spawned child handed over to; that is the process shutdown has to signal.
+@property (atomic) pid_t childJavaPid;
+// The channel reported missing heartbeats and none has arrived since.
+@property (atomic) BOOL childStalled;
+@property (nonatomic, strong, nullable) JessiRconClient *rconClient;
 @property (nonatomic) UIBackgroundTaskIdentifier bgTask;
+- (void)handleLogBytes:(const uint8_t *)bytes length:(size_t)len fromLatestLog:(BOOL)fromLatest;
+- (void)handleChildBytes:(const uint8_t *)bytes length:(size_t)len fromStderr:(BOOL)fromStderr;
+- (void)handleChildStatus:(NSString *)key value:(NSString *)value;
+- (void)flushLogScanners;
+- (void)handleLogEvent:(const jessi_log_event *)event line:(const uint8_t *)line;
+- (void)stopTailingLog;
 @end
 
 @implementation JessiServerService
 
++ (BOOL)usesSeparateJVMProcess {
+    return jessi_is_running_on_macos() ||
+           (jessi_is_trollstore_installed() && ![JessiSettings current].disableSeparateJVMProcessOnTrollStore);
+}
+
 - (instancetype)init {
+    return [self initWithServerName:nil];
+}
+
+- (instancetype)initWithServerName:(NSString *)serverName {
     self = [super init];
     if (self) {
-        _console = [NSMutableString string];
+        _serverName = [serverName copy];
+        JessiSettingsSnapshot *settings = [JessiSettings current];
+        _console = [[JessiConsoleBuffer alloc] initWithMaxBytes:(NSUInteger)MAX(settings.consoleMaxKB, 64) * 1024
+                                                       maxLines:(NSUInteger)MAX(settings.consoleMaxLines, 100)];
+        _stdioScanner = jessi_line_scanner_create(0);
+        _latestScanner = jessi_line_scanner_create(0);
+        _logLineBuffer = [NSMutableData dataWithCapacity:64 * 1024];
+        _serverState = [JessiServerState new];
+        _telemetry = [JessiTelemetrySampler new];
+        jessi_log_parser_init(&_stdioParser);
+        jessi_log_parser_init(&_latestParser);
         _runQueue = dispatch_queue_create("com.baconmania.jessi.run", DISPATCH_QUEUE_SERIAL);
-        _logQueue = dispatch_queue_create("com.baconmania.jessi.log", DISPATCH_QUEUE_SERIAL);
-        _activeRconPort = 25575;
+        _gamePort = 25565;
+        _rconPort = 25575;
         _bgTask = UIBackgroundTaskInvalid;
         [JessiPaths ensureBaseDirectories];
-        [[NSUserDefaults standardUserDefaults] setBool:g_serverRunning forKey:JessiServerRunningKey];
+        @synchronized([JessiServerService class]) {
+            [[NSUserDefaults standardUserDefaults] setBool:(g_runningServerCount > 0) forKey:JessiServerRunningKey];
+        }
     }
     return self;
 }
 
+- (void)dealloc {
+    [self stopTailingLog];
+    jessi_line_scanner_destroy(_stdioScanner);
+    jessi_line_scanner_destroy(_latestScanner);
+}
+
 - (BOOL)isRunning {
     @synchronized([JessiServerService class]) {
-        return g_serverRunning;
+        return _running;
     }
 }
 
 - (void)setRunning:(BOOL)running {
     BOOL changed = NO;
+    BOOL anyRunning = NO;
     @synchronized([JessiServerService class]) {
-        if (g_serverRunning != running) {
-            g_serverRunning = running;
+        if (_running != running) {
+            _running = running;
+            g_runningServerCount += running ? 1 : -1;
             changed = YES;
         }
+        anyRunning = g_runningServerCount > 0;
     }
     if (changed) {
-        [[NSUserDefaults standardUserDefaults] setBool:running forKey:JessiServerRunningKey];
-        [[NSNotificationCenter defaultCenter] postNotificationName:JessiServerRunningChanged object:nil];
+        [[NSUserDefaults standardUserDefaults] setBool:anyRunning forKey:JessiServerRunningKey];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [[NSNotificationCenter defaultCenter] postNotificationName:JessiServerRunningChanged object:self];
+        });
     }
 }
 
@@ -165,11 +283,52 @@ static BOOL jessi_looks_like_jessi_java(NSString *cmd) {
 - (void)emitConsole:(NSString *)text {
     if (!text) return;
     dispatch_async(dispatch_get_main_queue(), ^{
-        [self.console appendString:text];
-        [self.delegate serverServiceDidUpdateConsole:self.console];
+        JessiConsoleDelta *delta = [self.console appendText:text];
+        if (delta) [self deliverConsoleDelta:delta];
     });
 }
 
+- (void)deliverConsoleDelta:(JessiConsoleDelta *)delta {
+    [self writeConsoleLogDelta:delta];
+    id<JessiServerServiceDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(serverServiceDidAppendConsole:)]) {
+        [delegate serverServiceDidAppendConsole:delta];
+    } else if ([delegate respondsToSelector:@selector(serverServiceDidUpdateConsole:)]) {
+        [delegate serverServiceDidUpdateConsole:[self.console snapshot]];
+    }
+}
+
+- (NSString *)consoleSnapshot {
+    return [self.console snapshot];
+}
+
+// Main queue only. Every supervised instance mirrors its console into its own folder,
+// whether or not the UI is currently showing it.
+- (void)writeConsoleLogDelta:(JessiConsoleDelta *)delta {
+    if (self.serverName.length == 0) return;
+    NSString *path = [[self.serversRoot stringByAppendingPathComponent:self.serverName] stringByAppendingPathComponent:@"console.log"];
+    if (delta.isReset) {
+        [self.consoleLogHandle closeFile];
+        self.consoleLogHandle = nil;
+        [delta.appendedText writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+        return;
+    }
+    NSData *data = [delta.appendedText dataUsingEncoding:NSUTF8StringEncoding];
+    if (data.length == 0) return;
+    if (!self.consoleLogHandle) {
+        if (![[NSFileManager defaultManager] fileExistsAtPath:path]) {
+            [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil];
+        }
+        self.consoleLogHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+        [self.consoleLogHandle seekToEndOfFile];
+    }
+    @try {
+        [self.consoleLogHandle writeData:data];
+    } @catch (__unused NSException *e) {
+        self.consoleLogHandle = nil;
+    }
+}
+
 - (NSString *)findJarInServerDir:(NSString *)dir {
     NSFileManager *fm = [NSFileManager defaultManager];
     NSArray<NSString *> *items = [fm contentsOfDirectoryAtPath:dir error:nil] ?: @[];
@@ -212,27 +371,21 @@ static BOOL jessi_looks_like_jessi_java(NSString *cmd) {
 
     self.activeServerDir = dir;
     self.activeRconPassword = pw;
-    self.activeRconPort = 25575;
 
     NSString *propertiesPath = [dir stringByAppendingPathComponent:@"server.properties"]; 
-    NSMutableDictionary<NSString *, NSString *> *kv = [NSMutableDictionary dictionary];
-    if ([fm fileExistsAtPath:propertiesPath]) {
-        NSString *content = [NSString stringWithContentsOfFile:propertiesPath encoding:NSUTF8StringEncoding error:nil];
-        for (NSString *line in [content componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]) {
-            if (line.length == 0 || [line hasPrefix:@"#"]) continue;
-            NSRange r = [line rangeOfString:@"="];
-            if (r.location == NSNotFound) continue;
-            NSString *k = [line substringToIndex:r.location];
-            NSString *v = [line substringFromIndex:r.location + 1];
-            if (k.length) kv[k] = v ?: @"";
-        }
-    }
+    NSMutableDictionary<NSString *, NSString *> *kv = jessi_read_server_properties(propertiesPath);
+
+    int gamePort = kv[@"server-port"] ? [kv[@"server-port"] intValue] : 25565;
+    int rconPort = kv[@"rcon.port"] ? [kv[@"rcon.port"] intValue] : 25575;
+    [[JessiServerSupervisor shared] reserveGamePort:&gamePort rconPort:&rconPort forServerNamed:(self.serverName ?: dir.lastPathComponent)];
+    self.gamePort = gamePort;
+    self.rconPort = rconPort;
 
     kv[@"server-ip"] = @"";
-    if (!kv[@"server-port"]) kv[@"server-port"] = @"25565";
+    kv[@"server-port"] = [NSString stringWithFormat:@"%d", gamePort];
 
     kv[@"enable-rcon"] = @"true";
-    kv[@"rcon.port"] = [NSString stringWithFormat:@"%d", self.activeRconPort];
+    kv[@"rcon.port"] = [NSString stringWithFormat:@"%d", rconPort];
     kv[@"rcon.password"] = pw;
 
     NSMutableString *out = [NSMutableString string];
@@ -254,200 +407,327 @@ static BOOL jessi_looks_like_jessi_java(NSString *cmd) {
     }
 }
 
-- (void)startTailingLatestLogInDir:(NSString *)dir {
-    if (self.logTimer) {
-        dispatch_source_cancel(self.logTimer);
-        self.logTimer = nil;
+static void jessi_server_log_output(void *ctx, jessi_log_source source, const uint8_t *bytes, size_t len) {
+    JessiServerService *service = (__bridge JessiServerService *)ctx;
+    @autoreleasepool {
+        [service handleLogBytes:bytes length:len fromLatestLog:(source == JESSI_LOG_SOURCE_LATEST)];
+    }
+}
+
+static void jessi_server_child_output(void *ctx, jessi_child_stream stream, const uint8_t *bytes, size_t len) {
+    JessiServerService *service = (__bridge JessiServerService *)ctx;
+    @autoreleasepool {
+        [service handleChildBytes:bytes length:len fromStderr:(stream == JESSI_CHILD_STDERR)];
     }
-    self.logOffset = 0;
+}
 
-    self.stdioOffset = 0;
+static void jessi_server_child_status(void *ctx, const jessi_child_status *msg) {
+    JessiServerService *service = (__bridge JessiServerService *)ctx;
+    @autoreleasepool {
+        [service handleChildStatus:[NSString stringWithUTF8String:msg->key] ?: @""
+                             value:[NSString stringWithUTF8String:msg->value] ?: @""];
+    }
+}
 
-    NSString *logPath = [[dir stringByAppendingPathComponent:@"logs"] stringByAppendingPathComponent:@"latest.log"]; 
-    NSString *stdioPath = [dir stringByAppendingPathComponent:@"jessi-stdio.log"]; 
+// Compiled once; matched against raw line bytes before anything is decoded.
+static const jessi_line_filter *jessi_rcon_noise_filter(void) {
+    static jessi_line_filter *filter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        filter = jessi_line_filter_create();
+        jessi_line_filter_add(filter, JESSI_LINE_RULE_SUBSTRING, "RCON");
+        jessi_line_filter_add(filter, JESSI_LINE_RULE_SUBSTRING, "Rcon");
+        jessi_line_filter_add(filter, JESSI_LINE_RULE_SUBSTRING, "remote control");
+    });
+    return filter;
+}
 
-    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.logQueue);
-    dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, (uint64_t)(250 * NSEC_PER_MSEC), (uint64_t)(50 * NSEC_PER_MSEC));
+typedef struct {
+    __unsafe_unretained JessiServerService *service;
+    __unsafe_unretained NSMutableData *out;
+    const jessi_line_filter *filter;
+    jessi_log_parser *parser;
+} jessi_log_line_sink;
+
+static void jessi_server_log_line(void *ctx, const uint8_t *line, size_t len, int terminated) {
+    jessi_log_line_sink *sink = ctx;
+    if (terminated) {
+        jessi_log_event ev;
+        jessi_log_event_kind kind = jessi_log_parser_feed(sink->parser, line, len, &ev);
+        if (kind != JESSI_LOG_EVENT_NONE && kind != JESSI_LOG_EVENT_STACK_FRAME) {
+            [sink->service handleLogEvent:&ev line:line];
+        }
+    }
+    if (sink->filter && jessi_line_filter_matches(sink->filter, line, len)) return;
+    [sink->out appendBytes:line length:len];
+    if (terminated) [sink->out appendBytes:"\n" length:1];
+}
 
-    __unsafe_unretained typeof(self) weakSelf = self;
-    dispatch_source_set_event_handler(timer, ^{
-        typeof(self) strongSelf = weakSelf;
-        if (!strongSelf || !strongSelf.isRunning) return;
+- (void)emitLogLineBuffer {
+    NSMutableData *out = self.logLineBuffer;
+    if (!out.length) return;
+    NSString *s = [[NSString alloc] initWithBytes:out.bytes length:out.length encoding:NSUTF8StringEncoding];
+    if (!s) s = [[NSString alloc] initWithBytes:out.bytes length:out.length encoding:NSISOLatin1StringEncoding];
+    out.length = 0;
+    if (s.length) [self emitConsole:s];
+}
 
-        NSFileManager *fm = [NSFileManager defaultManager];
+- (void)handleLogEvent:(const jessi_log_event *)event line:(const uint8_t *)line {
+    jessi_log_event_kind kind = event->kind;
+    int64_t value = event->value;
+    NSString *subject = nil;
+    if (event->subject.length) {
+        subject = [[NSString alloc] initWithBytes:line + event->subject.offset length:event->subject.length encoding:NSUTF8StringEncoding];
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (kind == JESSI_LOG_EVENT_DONE) [self finishLaunchTimingWithReportedMs:value];
+        if (kind == JESSI_LOG_EVENT_SAVED) [self shutdownSaveConfirmed];
+        if ([self.serverState applyEvent:kind subject:subject value:value]) {
+            [[NSNotificationCenter defaultCenter] postNotificationName:JessiServerStateChanged object:self.serverState];
+        }
+    });
+}
 
-        BOOL hasLatest = [fm fileExistsAtPath:logPath];
-        NSString *pathToTail = hasLatest ? logPath : stdioPath;
-        off_t *offsetPtr = hasLatest ? &strongSelf->_logOffset : &strongSelf->_stdioOffset;
+// The runner writes its phases before handing over to Java; the "Done" line closes the trace.
+- (void)finishLaunchTimingWithReportedMs:(int64_t)reportedMs {
+    uint64_t startNs = self.launchStartNs;
+    NSString *dir = self.activeServerDir;
+    if (startNs == 0 || dir.length == 0) return;
+    self.launchStartNs = 0;
+
+    uint64_t nowNs = jessi_launch_trace_now_ns();
+    NSString *path = [dir stringByAppendingPathComponent:@"jessi-launch-timings.json"];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSMutableDictionary *trace = nil;
+    if (data) {
+        id obj = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+        if ([obj isKindOfClass:[NSMutableDictionary class]]) trace = obj;
+    }
+    if (!trace) trace = [@{ @"version": @1, @"clock": @"monotonic" } mutableCopy];
+
+    NSMutableArray *phases = [trace[@"phases"] isKindOfClass:[NSMutableArray class]] ? trace[@"phases"] : [NSMutableArray array];
+    NSMutableString *summary = [NSMutableString string];
+    uint64_t jvmStartNs = 0;
+    for (NSDictionary *phase in phases) {
+        if (![phase isKindOfClass:[NSDictionary class]]) continue;
+        NSString *name = phase[@"name"];
+        uint64_t phaseStart = [phase[@"start_ns"] unsignedLongLongValue];
+        uint64_t phaseEnd = [phase[@"end_ns"] unsignedLongLongValue];
+        if ([name isEqualToString:@"jli_launch"] || [name isEqualToString:@"spawn_java"]) jvmStartNs = phaseStart;
+        if (phaseEnd > phaseStart && ![name isEqualToString:@"server_main"]) {
+            [summary appendFormat:@"%@ %llu ms, ", name, (phaseEnd - phaseStart) / 1000000ULL];
+        }
+    }
 
-        if (![fm fileExistsAtPath:pathToTail]) return;
+    NSDictionary *(^mark)(NSString *, uint64_t, uint64_t) = ^NSDictionary *(NSString *name, uint64_t s, uint64_t e) {
+        return @{ @"name": name, @"start_ns": @(s), @"end_ns": @(e), @"duration_ms": @((double)(e - s) / 1e6) };
+    };
+    [phases insertObject:mark(@"start_requested", startNs, startNs) atIndex:0];
+    if (jvmStartNs > startNs && jvmStartNs < nowNs) {
+        [phases addObject:mark(@"jvm_to_done", jvmStartNs, nowNs)];
+        [summary appendFormat:@"jvm_to_done %.1f s, ", (double)(nowNs - jvmStartNs) / 1e9];
+    }
+    [phases addObject:mark(@"done", nowNs, nowNs)];
+    trace[@"phases"] = phases;
+    trace[@"total_ms"] = @((double)(nowNs - startNs) / 1e6);
+    trace[@"reported_done_ms"] = @(reportedMs);
 
-        NSDictionary *attrs = [fm attributesOfItemAtPath:pathToTail error:nil];
-        unsigned long long size = [attrs fileSize];
-        if ((unsigned long long)(*offsetPtr) > size) *offsetPtr = 0;
-        if ((unsigned long long)(*offsetPtr) == size) return;
+    NSData *out = [NSJSONSerialization dataWithJSONObject:trace options:NSJSONWritingPrettyPrinted error:nil];
+    if (out) [out writeToFile:path atomically:YES];
 
-        NSFileHandle *fh = [NSFileHandle fileHandleForReadingAtPath:pathToTail];
-        if (!fh) return;
-        @try {
-            [fh seekToFileOffset:(unsigned long long)(*offsetPtr)];
-            NSData *data = [fh readDataToEndOfFile];
-            *offsetPtr = (off_t)[fh offsetInFile];
-
-            if (data.length) {
-                NSString *s = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-                if (s.length) {
-                    if (hasLatest) {
-                        NSMutableArray *filteredLines = [NSMutableArray array];
-                        for (NSString *line in [s componentsSeparatedByString:@"\n"]) {
-                            if ([line containsString:@"RCON"] ||
-                                [line containsString:@"Rcon"] ||
-                                [line containsString:@"remote control"]) {
-                                continue;
-                            }
-                            [filteredLines addObject:line];
-                        }
-                        NSString *filtered = [filteredLines componentsJoinedByString:@"\n"];
-                        if (filtered.length) [strongSelf emitConsole:filtered];
-                    } else {
-                        [strongSelf emitConsole:s];
-                    }
-                }
-            }
-        } @catch (__unused NSException *e) {
-        }
-        [fh closeFile];
-    });
+    [self emitConsole:[NSString stringWithFormat:@"[JESSI] Launch timings: %@total %.1f s to Done (server reported %.1f s)\n",
+                       summary, (double)(nowNs - startNs) / 1e9, (double)reportedMs / 1000.0]];
 
-    dispatch_resume(timer);
-    self.logTimer = timer;
+    if (jvmStartNs > startNs && jvmStartNs < nowNs) {
+        NSString *cdsLine = [JessiCDSArchive recordStartupMs:(double)(nowNs - jvmStartNs) / 1e6 inServerDir:dir];
+        if (cdsLine) [self emitConsole:cdsLine];
+    }
+
+    NSString *prewarmLine = [JessiRuntimePrewarm recordStartupMs:(double)(nowNs - startNs) / 1e6
+                                                       prewarmed:self.launchPrewarmed
+                                                     inServerDir:dir];
+    if (prewarmLine) [self emitConsole:prewarmLine];
 }
 
-static BOOL jessi_write_all(int fd, const void *buf, size_t len) {
-    const uint8_t *p = (const uint8_t *)buf;
-    size_t off = 0;
-    while (off < len) {
-        ssize_t n = write(fd, p + off, len - off);
-        if (n <= 0) return NO;
-        off += (size_t)n;
+- (void)handleLogBytes:(const uint8_t *)bytes length:(size_t)len fromLatestLog:(BOOL)fromLatest {
+    if (!self.isRunning || len == 0) return;
+
+    jessi_log_line_sink plain = { self, self.logLineBuffer, NULL, &_stdioParser };
+    jessi_log_line_sink filtered = { self, self.logLineBuffer, jessi_rcon_noise_filter(), &_latestParser };
+    if (fromLatest) {
+        // Once latest.log takes over, whatever stdio still holds is complete output.
+        jessi_line_scanner_flush(self.stdioScanner, jessi_server_log_line, &plain);
+        jessi_line_scanner_feed(self.latestScanner, bytes, len, jessi_server_log_line, &filtered);
+    } else {
+        jessi_line_scanner_feed(self.stdioScanner, bytes, len, jessi_server_log_line, &plain);
     }
-    return YES;
+    [self emitLogLineBuffer];
 }
 
-static BOOL jessi_read_all(int fd, void *buf, size_t len) {
-    uint8_t *p = (uint8_t *)buf;
-    size_t off = 0;
-    while (off < len) {
-        ssize_t n = read(fd, p + off, len - off);
-        if (n <= 0) return NO;
-        off += (size_t)n;
+// Spawned JVM output straight from the pipes: stdout carries what latest.log would, so it gets the
+// RCON filter; stderr keeps its own scanner so partial lines of the two never mix.
+- (void)handleChildBytes:(const uint8_t *)bytes length:(size_t)len fromStderr:(BOOL)fromStderr {
+    if (!self.isRunning || len == 0) return;
+    if (fromStderr) {
+        jessi_log_line_sink plain = { self, self.logLineBuffer, NULL, &_stdioParser };
+        jessi_line_scanner_feed(self.stdioScanner, bytes, len, jessi_server_log_line, &plain);
+    } else {
+        jessi_log_line_sink filtered = { self, self.logLineBuffer, jessi_rcon_noise_filter(), &_latestParser };
+        jessi_line_scanner_feed(self.latestScanner, bytes, len, jessi_server_log_line, &filtered);
     }
-    return YES;
+    [self emitLogLineBuffer];
 }
 
-- (BOOL)sendRcon:(NSString *)command {
-    if (command.length == 0) return NO;
-    if (self.activeRconPassword.length == 0) return NO;
-
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0) return NO;
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons((uint16_t)self.activeRconPort);
-    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-
-    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
-        close(fd);
-        return NO;
-    }
-
-    int32_t reqId = 0x12345678;
-    NSData *(^packet)(int32_t, int32_t, NSString *) = ^NSData *(int32_t pid, int32_t type, NSString *payload) {
-        NSData *payloadData = [payload dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
-        int32_t length = (int32_t)(4 + 4 + payloadData.length + 2);
-        NSMutableData *d = [NSMutableData dataWithCapacity:(NSUInteger)length + 4];
-        [d appendBytes:&length length:4];
-        [d appendBytes:&pid length:4];
-        [d appendBytes:&type length:4];
-        [d appendData:payloadData];
-        uint8_t nul[2] = {0, 0};
-        [d appendBytes:nul length:2];
-        return d;
-    };
-
-    NSData *auth = packet(reqId, 3, self.activeRconPassword);
-    if (!jessi_write_all(fd, auth.bytes, auth.length)) { close(fd); return NO; }
-
-    int32_t respLen = 0;
-    if (!jessi_read_all(fd, &respLen, 4)) { close(fd); return NO; }
-    if (respLen < 10 || respLen > 4096) { close(fd); return NO; }
-    NSMutableData *resp = [NSMutableData dataWithLength:(NSUInteger)respLen];
-    if (!jessi_read_all(fd, resp.mutableBytes, (size_t)respLen)) { close(fd); return NO; }
-    int32_t respId = 0;
-    memcpy(&respId, resp.bytes, 4);
-    if (respId == -1) { close(fd); return NO; }
-
-    NSData *cmd = packet(reqId + 1, 2, command);
-    if (!jessi_write_all(fd, cmd.bytes, cmd.length)) { close(fd); return NO; }
-
-    NSMutableString *responseText = [NSMutableString string];
-    while (1) {
-        fd_set rfds;
-        FD_ZERO(&rfds);
-        FD_SET(fd, &rfds);
-
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = 300000;
-
-        int ready = select(fd + 1, &rfds, NULL, NULL, &tv);
-        if (ready <= 0) break;
-
-        int32_t outLen = 0;
-        ssize_t n = recv(fd, &outLen, 4, MSG_WAITALL);
-        if (n != 4) break;
-        if (outLen < 10 || outLen > 65536) break;
-
-        NSMutableData *out = [NSMutableData dataWithLength:(NSUInteger)outLen];
-        n = recv(fd, out.mutableBytes, (size_t)outLen, MSG_WAITALL);
-        if (n != outLen) break;
-
-        int32_t outId = 0;
-        memcpy(&outId, out.bytes, 4);
-        if (outId == -1) break;
-
-        NSUInteger payloadLen = (NSUInteger)outLen - 10;
-        if (payloadLen == 0) break;
-
-        NSData *payloadData = [out subdataWithRange:NSMakeRange(8, payloadLen)];
-        NSString *payload = [[NSString alloc] initWithData:payloadData encoding:NSUTF8StringEncoding];
-        if (payload.length) {
-            [responseText appendString:payload];
+- (void)handleChildStatus:(NSString *)key value:(NSString *)value {
+    if ([key isEqualToString:@"hb"]) {
+        if (self.childStalled) {
+            self.childStalled = NO;
+            [self emitConsole:@"[JESSI] Server process is responding again.\n"];
+        }
+        return;
+    }
+    if ([key isEqualToString:@"stall"]) {
+        self.childStalled = YES;
+        [self emitConsole:[NSString stringWithFormat:@"[JESSI] Server process has not responded for %ld s.\n", (long)(value.longLongValue / 1000)]];
+    } else if ([key isEqualToString:@"exit"]) {
+        self.childExitReason = value;
+    } else if ([key isEqualToString:@"pid"] && [value hasSuffix:@" java"]) {
+        // macOS: the runner hands over to an external java; sample that process instead.
+        pid_t javaPid = (pid_t)value.intValue;
+        if (javaPid > 0) {
+            self.childJavaPid = javaPid;
+            [self.telemetry startWithPid:javaPid];
         }
     }
+    NSLog(@"[JESSI] [%@] child %@ %@", self.serverName ?: @"server", key, value);
+}
+
+- (void)flushLogScanners {
+    if (self.isRunning) {
+        jessi_log_line_sink plain = { self, self.logLineBuffer, NULL, &_stdioParser };
+        jessi_log_line_sink filtered = { self, self.logLineBuffer, jessi_rcon_noise_filter(), &_latestParser };
+        jessi_line_scanner_flush(self.stdioScanner, jessi_server_log_line, &plain);
+        jessi_line_scanner_flush(self.latestScanner, jessi_server_log_line, &filtered);
+        [self emitLogLineBuffer];
+    }
+    jessi_line_scanner_reset(self.stdioScanner);
+    jessi_line_scanner_reset(self.latestScanner);
+}
+
+- (void)startTailingLatestLogInDir:(NSString *)dir {
+    [self stopTailingLog];
+    jessi_log_parser_init(&_stdioParser);
+    jessi_log_parser_init(&_latestParser);
+
+    NSString *logPath = [[dir stringByAppendingPathComponent:@"logs"] stringByAppendingPathComponent:@"latest.log"]; 
+    NSString *stdioPath = [dir stringByAppendingPathComponent:@"jessi-stdio.log"]; 
+
+    jessi_log_tailer *tailer = jessi_log_tailer_create(logPath.fileSystemRepresentation,
+                                                       stdioPath.fileSystemRepresentation,
+                                                       jessi_server_log_output,
+                                                       (__bridge void *)self);
+    if (!tailer) {
+        [self emitConsole:@"Failed to start log tailer.\n"];
+        return;
+    }
+    if (jessi_log_tailer_start(tailer) != 0) {
+        jessi_log_tailer_destroy(tailer);
+        [self emitConsole:@"Failed to start log tailer.\n"];
+        return;
+    }
+    self.logTailer = tailer;
+}
+
+- (void)stopTailingLog {
+    jessi_log_tailer *tailer = self.logTailer;
+    if (!tailer) return;
+    self.logTailer = NULL;
+
+    jessi_log_tailer_stop(tailer);
+    [self flushLogScanners];
+    jessi_log_tailer_stats stats;
+    jessi_log_tailer_get_stats(tailer, &stats);
+    self.lastLogTailerStats = stats;
+    jessi_log_tailer_destroy(tailer);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)logTailerStatistics {
+    jessi_log_tailer_stats stats = self.lastLogTailerStats;
+    jessi_log_tailer *tailer = self.logTailer;
+    if (tailer) jessi_log_tailer_get_stats(tailer, &stats);
+    return @{
+        @"bytesRead": @(stats.bytes_read),
+        @"wakeups": @(stats.wakeups),
+        @"readCalls": @(stats.read_calls),
+        @"reopens": @(stats.reopens),
+        @"sourceSwitches": @(stats.source_switches),
+    };
+}
 
-    if (responseText.length > 0) {
-        if (![responseText hasSuffix:@"\n"]) {
-            [responseText appendString:@"\n"]; 
+- (JessiRconClient *)currentRconClient {
+    NSString *password = self.activeRconPassword;
+    if (password.length == 0) return nil;
+    @synchronized(self) {
+        JessiRconClient *client = self.rconClient;
+        if (!client || client.port != self.rconPort || ![client.password isEqualToString:password]) {
+            [client disconnect];
+            client = [[JessiRconClient alloc] initWithPort:self.rconPort password:password];
+            self.rconClient = client;
         }
-        [self emitConsole:responseText];
+        return client;
     }
+}
+
+- (BOOL)sendRcon:(NSString *)command {
+    if (command.length == 0) return NO;
+    JessiRconClient *client = [self currentRconClient];
+    if (!client) return NO;
 
-    close(fd);
+    [client sendCommand:command completion:^(NSString *response, NSError *error) {
+        if (response.length == 0) return;
+        [self emitConsole:[response hasSuffix:@"\n"] ? response : [response stringByAppendingString:@"\n"]];
+    }];
     return YES;
 }
 
+- (void)sendRconCommand:(NSString *)command completion:(void (^)(NSString * _Nullable, NSError * _Nullable))completion {
+    JessiRconClient *client = [self currentRconClient];
+    if (!client) {
+        if (completion) completion(nil, [NSError errorWithDomain:JessiRconErrorDomain code:JessiRconErrorConnect userInfo:@{NSLocalizedDescriptionKey: @"RCON is not configured"}]);
+        return;
+    }
+    [client sendCommand:command completion:completion];
+}
+
+- (void)sendRconCommands:(NSArray<NSString *> *)commands completion:(void (^)(NSArray<NSString *> *, NSError * _Nullable))completion {
+    JessiRconClient *client = [self currentRconClient];
+    if (!client) {
+        if (completion) completion(@[], [NSError errorWithDomain:JessiRconErrorDomain code:JessiRconErrorConnect userInfo:@{NSLocalizedDescriptionKey: @"RCON is not configured"}]);
+        return;
+    }
+    [client sendCommands:commands completion:completion];
+}
+
 - (void)startServerNamed:(NSString *)serverName {
     if (self.isRunning) {
         [self emitConsole:@"Server already running.\n"]; 
         return;
     }
 
+    BOOL shouldUseSeparateProcess = [JessiServerService usesSeparateJVMProcess];
+    self.runsInSeparateProcess = shouldUseSeparateProcess;
+    @synchronized([JessiServerService class]) {
+        if (g_runningServerCount > 0 && !shouldUseSeparateProcess) {
+            [self emitConsole:@"Another server is already running. Running several servers at once needs the separate JVM process (macOS or TrollStore).\n"];
+            return;
+        }
+    }
+
     NSString *dir = [self.serversRoot stringByAppendingPathComponent:serverName];
 
     NSFileManager *fm = [NSFileManager defaultManager];
+    [self.consoleLogHandle closeFile];
+    self.consoleLogHandle = nil;
     NSString *consoleLogPath = [dir stringByAppendingPathComponent:@"console.log"]; 
     NSString *stdioLogPath = [dir stringByAppendingPathComponent:@"jessi-stdio.log"]; 
     if ([fm fileExistsAtPath:consoleLogPath]) {
@@ -456,6 +736,9 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
     if ([fm fileExistsAtPath:stdioLogPath]) {
         [fm removeItemAtPath:stdioLogPath error:nil];
     }
+    [fm removeItemAtPath:[dir stringByAppendingPathComponent:@"jessi-launch-timings.json"] error:nil];
+    self.launchStartNs = jessi_launch_trace_now_ns();
+    self.launchPrewarmed = [[JessiRuntimePrewarm shared] noteLaunchOfServerDir:dir];
 
     NSString *launchArgsPath = [dir stringByAppendingPathComponent:@"jessi-launch-args.txt"]; 
     BOOL hasLaunchArgs = [fm fileExistsAtPath:launchArgsPath];
@@ -474,22 +757,34 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
     [self configureServerFilesInDir:dir];
 
     dispatch_async(dispatch_get_main_queue(), ^{
-        [self.console setString:@""]; 
+        [self deliverConsoleDelta:[self.console resetWithText:@""]];
+        [self.serverState reset];
+        [[NSNotificationCenter defaultCenter] postNotificationName:JessiServerStateChanged object:self.serverState];
         [self emitConsole:[NSString stringWithFormat:@"Starting server: %@\n", serverName]];
         [self emitConsole:[NSString stringWithFormat:@"Jar: %@\n", jar.lastPathComponent]];
         [self emitConsole:[NSString stringWithFormat:@"Working dir: %@\n", dir]];
+        [self emitConsole:[NSString stringWithFormat:@"Ports: game %d, RCON %d\n", self.gamePort, self.rconPort]];
     });
 
     self.running = YES;
     dispatch_async(dispatch_get_main_queue(), ^{ [self.delegate serverServiceDidChangeRunning:YES]; });
 
-    [self startTailingLatestLogInDir:dir];
+    if (shouldUseSeparateProcess) {
+        // Output arrives over the child channel; nothing to tail.
+        [self stopTailingLog];
+        jessi_log_parser_init(&_stdioParser);
+        jessi_log_parser_init(&_latestParser);
+    } else {
+        [self startTailingLatestLogInDir:dir];
+    }
 
-    JessiSettings *settings = [JessiSettings shared];
+    JessiSettingsSnapshot *settings = [JessiSettings current];
     NSString *javaVersion = settings.javaVersion ?: @"8";
+    NSInteger maxHeapMB = self.maxHeapMB;
+    NSInteger cpuCores = self.cpuCores;
 
 #if !(TARGET_OS_OSX && !TARGET_OS_MACCATALYST)
-    if ([JessiSettings shared].runInBackground) {
+    if ([JessiSettings current].runInBackground) {
         self.bgTask = [[UIApplication sharedApplication] beginBackgroundTaskWithExpirationHandler:^{
             [[UIApplication sharedApplication] endBackgroundTask:self.bgTask];
             self.bgTask = UIBackgroundTaskInvalid;
@@ -506,33 +801,55 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
 
         int code = 0;
         @try {
-            BOOL shouldUseSeparateProcess = jessi_is_running_on_macos() ||
-                                           (jessi_is_trollstore_installed() && !settings.disableSeparateJVMProcessOnTrollStore);
             if (shouldUseSeparateProcess) {
-                pid_t pid;
                 NSString *executablePath = [[NSBundle mainBundle] executablePath];
                 char *execPathC = strdup([executablePath fileSystemRepresentation]);
                 char *spawnArgv[] = { execPathC, argv0, argv1, argv2, argv3, NULL };
                 
                 extern char **environ;
+                char **spawnEnv = jessi_spawn_environment(environ, maxHeapMB, cpuCores);
                 
-                int ret = posix_spawn(&pid, execPathC, NULL, NULL, spawnArgv, environ);
-                
-                if (ret == 0) {
+                self.childExitReason = nil;
+                self.childJavaPid = 0;
+                self.childStalled = NO;
+                jessi_child_callbacks callbacks = { jessi_server_child_output, jessi_server_child_status };
+                NSString *stdioPath = [dir stringByAppendingPathComponent:@"jessi-stdio.log"];
+                int spawnError = 0;
+                jessi_child_channel *channel = jessi_child_channel_spawn(execPathC, spawnArgv, spawnEnv,
+                                                                         stdioPath.fileSystemRepresentation,
+                                                                         &callbacks, (__bridge void *)self, &spawnError);
+                jessi_free_environment(spawnEnv);
+
+                if (channel) {
+                    pid_t pid = jessi_child_channel_pid(channel);
+                    [self.telemetry startWithPid:pid];
                     NSString *pidPath = jessi_server_pid_file_path(dir);
                     NSString *pidText = [NSString stringWithFormat:@"%d\n", (int)pid];
                     [pidText writeToFile:pidPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
 
-                    int status;
-                    waitpid(pid, &status, 0);
+                    int status = 0;
+                    if (jessi_child_channel_wait(channel, &status) != 0) status = -1;
+                    jessi_child_stats channelStats;
+                    jessi_child_channel_get_stats(channel, &channelStats);
+                    jessi_child_channel_destroy(channel);
+                    [self flushLogScanners];
+                    NSLog(@"[JESSI] [%@] child channel: stdout=%llu stderr=%llu logged=%llu status=%llu heartbeats=%llu wakeups=%llu exit=%@",
+                          self.serverName ?: @"server",
+                          (unsigned long long)channelStats.stdout_bytes, (unsigned long long)channelStats.stderr_bytes,
+                          (unsigned long long)channelStats.logged_bytes, (unsigned long long)channelStats.status_messages,
+                          (unsigned long long)channelStats.heartbeats, (unsigned long long)channelStats.wakeups,
+                          self.childExitReason ?: @"(none)");
 
                     [[NSFileManager defaultManager] removeItemAtPath:pidPath error:nil];
+                    self.childJavaPid = 0;
 
-                    if (WIFEXITED(status)) {
+                    if (status != -1 && WIFEXITED(status)) {
                         code = WEXITSTATUS(status);
                     } else {
                         code = 252;
-                        if (WIFSIGNALED(status)) {
+                        if (status == -1) {
+                            [self emitConsole:@"\nLost track of the JVM process.\n"];
+                        } else if (WIFSIGNALED(status)) {
                             [self emitConsole:[NSString stringWithFormat:@"\nJVM process terminated by signal: %d\n", WTERMSIG(status)]];
                         } else if (WIFSTOPPED(status)) {
                             [self emitConsole:[NSString stringWithFormat:@"\nJVM process stopped by signal: %d\n", WSTOPSIG(status)]];
@@ -542,10 +859,13 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
                     }
                 } else {
                     code = 253;
-                    [self emitConsole:[NSString stringWithFormat:@"\nFailed to spawn JVM process: %s\n", strerror(ret)]];
+                    [self emitConsole:[NSString stringWithFormat:@"\nFailed to spawn JVM process: %s\n", strerror(spawnError)]];
                 }
                 free(execPathC);
             } else {
+                jessi_set_limit_env("JESSI_MAX_HEAP_MB", maxHeapMB);
+                jessi_set_limit_env("JESSI_ACTIVE_CPUS", cpuCores);
+                [self.telemetry startWithPid:0];
                 code = jessi_server_main(4, argvv);
             }
         } @catch (NSException *e) {
@@ -555,12 +875,17 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
 
         free(argv0); free(argv1); free(argv2); free(argv3);
 
-        self.running = NO;
-        if (self.logTimer) {
-            dispatch_source_cancel(self.logTimer);
-            self.logTimer = nil;
+        if (self.telemetry.isSampling) {
+            [self.telemetry stop];
+            [self.telemetry writeCSVToPath:[dir stringByAppendingPathComponent:@"jessi-telemetry.csv"] error:nil];
         }
+
+        [self stopTailingLog];
+        [self.rconClient disconnect];
+        [[JessiServerSupervisor shared] releasePortsForServerNamed:(self.serverName ?: dir.lastPathComponent)];
+        self.running = NO;
         dispatch_async(dispatch_get_main_queue(), ^{
+            [self finishShutdown];
             [self emitConsole:[NSString stringWithFormat:@"\nServer exited with code: %d\n", code]];
             [self.delegate serverServiceDidChangeRunning:NO];
             
@@ -575,14 +900,160 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
 }
 
 - (void)stopServer {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (!self.isRunning) return;
+        switch (self.shutdownStage) {
+            case JessiShutdownStageIdle:
+                self.shutdownStartedAt = CFAbsoluteTimeGetCurrent();
+                [self enterShutdownStage:JessiShutdownStageSaving];
+                break;
+            case JessiShutdownStageKilling:
+                break;
+            default:
+                [self emitConsole:@"[JESSI] Shutdown: skipping ahead.\n"];
+                [self enterShutdownStage:self.shutdownStage + 1];
+                break;
+        }
+    });
+}
+
+#pragma mark - Shutdown
+
+// Main queue. Every stage bumps the generation, which cancels the previous stage's timer and
+// late RCON completions.
+- (void)enterShutdownStage:(JessiShutdownStage)stage {
     if (!self.isRunning) return;
-    [self sendRcon:@"stop"];
+    if (stage == JessiShutdownStageKilling && !self.runsInSeparateProcess) {
+        // The in-process JVM is this app; SIGKILL would only take JESSI down with it.
+        [self emitConsole:@"[JESSI] Shutdown: the server is still running after SIGTERM; not force-killing JESSI. Close the app to end it.\n"];
+        self.shutdownStage = JessiShutdownStageIdle;
+        [self finishShutdown];
+        return;
+    }
+    NSUInteger generation = ++self.shutdownGeneration;
+    self.shutdownStage = stage;
+
+    JessiSettingsSnapshot *settings = [JessiSettings current];
+    NSInteger timeout = 0;
+    switch (stage) {
+        case JessiShutdownStageSaving: {
+            timeout = settings.shutdownSaveTimeout;
+            JessiRconClient *client = [self currentRconClient];
+            if (!client) {
+                [self emitConsole:@"[JESSI] Shutdown: RCON is not configured; skipping the save.\n"];
+                [self enterShutdownStage:JessiShutdownStageTerminating];
+                return;
+            }
+            [self emitConsole:@"[JESSI] Shutdown: flushing the world to disk (save-all flush)...\n"];
+            // The reply only arrives once the flush is done; the "Saved the game" log line counts too.
+            [client sendCommand:@"save-all flush" timeout:timeout completion:^(NSString *response, NSError *error) {
+                if (self.shutdownGeneration != generation) return;
+                if (!error) {
+                    [self shutdownSaveConfirmed];
+                    return;
+                }
+                [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: save-all failed (%@); stopping anyway.\n", error.localizedDescription]];
+                [self enterShutdownStage:JessiShutdownStageStopping];
+            }];
+            break;
+        }
+        case JessiShutdownStageStopping: {
+            timeout = settings.shutdownStopTimeout;
+            JessiRconClient *client = [self currentRconClient];
+            if (!client) {
+                [self enterShutdownStage:JessiShutdownStageTerminating];
+                return;
+            }
+            [self emitConsole:@"[JESSI] Shutdown: sending stop...\n"];
+            [client sendCommand:@"stop" timeout:timeout completion:^(NSString *response, NSError *error) {
+                if (self.shutdownGeneration != generation || !error) return;
+                // The server closing the session while it stops is the expected outcome.
+                if ([error.domain isEqualToString:JessiRconErrorDomain] && error.code == JessiRconErrorDisconnected) return;
+                [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: stop failed (%@).\n", error.localizedDescription]];
+                [self enterShutdownStage:JessiShutdownStageTerminating];
+            }];
+            break;
+        }
+        case JessiShutdownStageTerminating:
+            timeout = settings.shutdownTermTimeout;
+            [self signalServer:SIGTERM];
+            break;
+        case JessiShutdownStageKilling:
+            [self signalServer:SIGKILL];
+            break;
+        case JessiShutdownStageIdle:
+            break;
+    }
+
+    id<JessiServerServiceDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(serverServiceDidChangeShutdownStage:)]) {
+        [delegate serverServiceDidChangeShutdownStage:stage];
+    }
+
+    if (timeout > 0) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout * NSEC_PER_SEC), dispatch_get_main_queue(), ^{
+            if (self.shutdownGeneration != generation || !self.isRunning) return;
+            [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: no progress after %ld s.\n", (long)timeout]];
+            [self enterShutdownStage:stage + 1];
+        });
+    }
+}
+
+- (void)shutdownSaveConfirmed {
+    if (self.shutdownStage != JessiShutdownStageSaving) return;
+    [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: world saved after %.1f s.\n", CFAbsoluteTimeGetCurrent() - self.shutdownStartedAt]];
+    [self enterShutdownStage:JessiShutdownStageStopping];
+}
+
+// Spawned JVMs are signalled through the pid file; the in-process JVM shares our pid, so it only
+// ever gets SIGTERM, which HotSpot turns into an orderly exit that runs the server's shutdown hook.
+// On macOS the spawned child only supervises an external java and doesn't forward signals, so
+// java (from its "pid <n> java" status line) is the target; SIGKILL takes the child down too.
+- (void)signalServer:(int)sig {
+    const char *name = sig == SIGKILL ? "SIGKILL" : "SIGTERM";
+    pid_t pid = 0;
+    pid_t childPid = 0;
+    if (self.runsInSeparateProcess) {
+        NSString *pidText = [[NSString stringWithContentsOfFile:jessi_server_pid_file_path(self.activeServerDir) encoding:NSUTF8StringEncoding error:nil]
+                             stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        childPid = (pid_t)pidText.intValue;
+        pid_t javaPid = self.childJavaPid;
+        pid = javaPid > 1 ? javaPid : childPid;
+    } else if (sig == SIGTERM) {
+        pid = getpid();
+    }
+    if (pid <= 1) {
+        [self emitConsole:@"[JESSI] Shutdown: no JVM pid to signal.\n"];
+        return;
+    }
+    if (pid != childPid && childPid > 1) {
+        [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: sending %s to java %d (child %d).\n", name, (int)pid, (int)childPid]];
+    } else {
+        [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: sending %s to %d.\n", name, (int)pid]];
+    }
+    if (kill(pid, sig) != 0) {
+        NSLog(@"[JESSI] [%@] %s to %d failed: %s", self.serverName ?: @"server", name, (int)pid, strerror(errno));
+    }
+    if (sig == SIGKILL && pid != childPid && childPid > 1) {
+        kill(childPid, SIGKILL);
+    }
+}
+
+- (void)finishShutdown {
+    if (self.shutdownStage != JessiShutdownStageIdle) {
+        [self emitConsole:[NSString stringWithFormat:@"[JESSI] Shutdown: finished in %.1f s.\n", CFAbsoluteTimeGetCurrent() - self.shutdownStartedAt]];
+    }
+    self.shutdownGeneration++;
+    self.shutdownStage = JessiShutdownStageIdle;
+    id<JessiServerServiceDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(serverServiceDidChangeShutdownStage:)]) {
+        [delegate serverServiceDidChangeShutdownStage:JessiShutdownStageIdle];
+    }
 }
 
 - (void)clearConsole {
     dispatch_async(dispatch_get_main_queue(), ^{
-        [self.console setString:@"Console cleared.\n"];
-        [self.delegate serverServiceDidUpdateConsole:self.console];
+        [self deliverConsoleDelta:[self.console resetWithText:@"Console cleared.\n"]];
     });
 }
 
@@ -597,6 +1068,10 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
 
     NSMutableSet<NSNumber *> *targetPIDs = [NSMutableSet set];
     NSMutableArray<NSString *> *pidFiles = [NSMutableArray array];
+    NSArray<NSString *> *runningNames = [[JessiServerSupervisor shared] runningServerNames];
+    NSMutableSet<NSNumber *> *livePIDs = [NSMutableSet set];
+    NSMutableSet<NSNumber *> *ports = [NSMutableSet set];
+    NSMutableSet<NSNumber *> *livePorts = [NSMutableSet set];
 
     for (NSString *name in entries) {
         NSString *dir = [root stringByAppendingPathComponent:name];
@@ -604,18 +1079,38 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
         if (![fm fileExistsAtPath:dir isDirectory:&isDir] || !isDir) continue;
 
         NSString *pidFile = jessi_server_pid_file_path(dir);
-        [pidFiles addObject:pidFile];
+        BOOL live = [runningNames containsObject:name];
+        if (!live) [pidFiles addObject:pidFile];
+
+        // A server's ports are the ones the supervisor reserved for it; for one that isn't
+        // running here, the last reservation is what its start wrote to server.properties.
+        NSArray<NSNumber *> *reserved = [[JessiServerSupervisor shared] reservedPortsForServerNamed:name];
+        if (live) {
+            [livePorts addObjectsFromArray:reserved];
+        } else if (reserved.count) {
+            [ports addObjectsFromArray:reserved];
+        } else {
+            NSDictionary<NSString *, NSString *> *kv = jessi_read_server_properties([dir stringByAppendingPathComponent:@"server.properties"]);
+            int gamePort = [kv[@"server-port"] intValue];
+            int rconPort = [kv[@"rcon.port"] intValue];
+            if (gamePort > 0) [ports addObject:@(gamePort)];
+            if (rconPort > 0) [ports addObject:@(rconPort)];
+        }
 
         NSString *pidText = [[NSString stringWithContentsOfFile:pidFile encoding:NSUTF8StringEncoding error:nil]
                              stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
         if (pidText.length) {
             pid_t pid = (pid_t)[pidText intValue];
-            if (pid > 1) [targetPIDs addObject:@(pid)];
+            if (pid > 1) [(live ? livePIDs : targetPIDs) addObject:@(pid)];
         }
     }
 
-    [targetPIDs unionSet:[jessi_pids_listening_on_port(25565) mutableCopy]];
-    [targetPIDs unionSet:[jessi_pids_listening_on_port(25575) mutableCopy]];
+    [ports minusSet:livePorts];
+    for (NSNumber *port in ports) {
+        [targetPIDs unionSet:jessi_pids_listening_on_port(port.intValue)];
+    }
+    // Servers this app is supervising right now are not stale.
+    [targetPIDs minusSet:livePIDs];
 
     int checked = 0;
     int killed = 0;
@@ -638,7 +1133,8 @@ static BOOL jessi_read_all(int fd, void *buf, size_t len) {
     }
 
     if (killed > 0) {
-        return [NSString stringWithFormat:@"Stopped %d stale JVM process(es). Port 25565 should now be clear.", killed];
+        NSArray<NSNumber *> *sorted = [ports.allObjects sortedArrayUsingSelector:@selector(compare:)];
+        return [NSString stringWithFormat:@"Stopped %d stale JVM process(es). Ports %@ should now be clear.", killed, [sorted componentsJoinedByString:@", "]];
     }
     if (checked > 0) {
         return @"No stale JESSI JVM process needed termination.";
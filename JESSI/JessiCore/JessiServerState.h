@@ -0,0 +1,36 @@
+#import <Foundation/Foundation.h>
+#import "JessiLogEvents.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Posted on the main queue with the JessiServerState as the object.
+extern NSString *const JessiServerStateChanged;
+
+// Live server state derived from typed log events. Main-thread only.
+@interface JessiServerState : NSObject
+
+@property (nonatomic, readonly, copy) NSArray<NSString *> *onlinePlayers;
+@property (nonatomic, readonly, getter=isReady) BOOL ready;
+@property (nonatomic, readonly, getter=isStopping) BOOL stopping;
+@property (nonatomic, readonly) NSTimeInterval startupSeconds;
+
+@property (nonatomic, readonly) NSUInteger lagSpikeCount;
+@property (nonatomic, readonly) NSUInteger lastLagMs;
+@property (nonatomic, readonly) NSUInteger worstLagMs;
+@property (nonatomic, readonly) NSUInteger totalLagMs;
+
+@property (nonatomic, readonly) NSUInteger saveCount;
+@property (nonatomic, readonly, nullable) NSDate *lastSaveDate;
+@property (nonatomic, readonly, getter=isSaving) BOOL saving;
+
+@property (nonatomic, readonly) NSUInteger exceptionCount;
+@property (nonatomic, readonly, copy, nullable) NSString *lastException;
+
+- (void)reset;
+// Returns YES if the event changed the state.
+- (BOOL)applyEvent:(jessi_log_event_kind)kind subject:(nullable NSString *)subject value:(int64_t)value;
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,114 @@
+#import "JessiServerState.h"
+
+NSString *const JessiServerStateChanged = @"JessiServerStateChanged";
+
+@interface JessiServerState ()
+@property (nonatomic, strong) NSMutableOrderedSet<NSString *> *players;
+@property (nonatomic, readwrite, getter=isReady) BOOL ready;
+@property (nonatomic, readwrite, getter=isStopping) BOOL stopping;
+@property (nonatomic, readwrite) NSTimeInterval startupSeconds;
+@property (nonatomic, readwrite) NSUInteger lagSpikeCount;
+@property (nonatomic, readwrite) NSUInteger lastLagMs;
+@property (nonatomic, readwrite) NSUInteger worstLagMs;
+@property (nonatomic, readwrite) NSUInteger totalLagMs;
+@property (nonatomic, readwrite) NSUInteger saveCount;
+@property (nonatomic, readwrite, nullable) NSDate *lastSaveDate;
+@property (nonatomic, readwrite, getter=isSaving) BOOL saving;
+@property (nonatomic, readwrite) NSUInteger exceptionCount;
+@property (nonatomic, readwrite, copy, nullable) NSString *lastException;
+@end
+
+@implementation JessiServerState
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _players = [NSMutableOrderedSet orderedSet];
+    }
+    return self;
+}
+
+- (NSArray<NSString *> *)onlinePlayers {
+    return self.players.array;
+}
+
+- (void)reset {
+    [self.players removeAllObjects];
+    self.ready = NO;
+    self.stopping = NO;
+    self.startupSeconds = 0;
+    self.lagSpikeCount = 0;
+    self.lastLagMs = 0;
+    self.worstLagMs = 0;
+    self.totalLagMs = 0;
+    self.saveCount = 0;
+    self.lastSaveDate = nil;
+    self.saving = NO;
+    self.exceptionCount = 0;
+    self.lastException = nil;
+}
+
+- (BOOL)applyEvent:(jessi_log_event_kind)kind subject:(NSString *)subject value:(int64_t)value {
+    NSUInteger v = value > 0 ? (NSUInteger)value : 0;
+    switch (kind) {
+        case JESSI_LOG_EVENT_DONE:
+            self.ready = YES;
+            self.startupSeconds = v / 1000.0;
+            return YES;
+        case JESSI_LOG_EVENT_LAG:
+            self.lagSpikeCount++;
+            self.lastLagMs = v;
+            self.totalLagMs += v;
+            if (v > self.worstLagMs) self.worstLagMs = v;
+            return YES;
+        case JESSI_LOG_EVENT_JOIN:
+            if (!subject.length || [self.players containsObject:subject]) return NO;
+            [self.players addObject:subject];
+            return YES;
+        case JESSI_LOG_EVENT_LEAVE:
+            if (!subject.length || ![self.players containsObject:subject]) return NO;
+            [self.players removeObject:subject];
+            return YES;
+        case JESSI_LOG_EVENT_SAVE_STARTED:
+            self.saving = YES;
+            return YES;
+        case JESSI_LOG_EVENT_SAVED:
+            self.saving = NO;
+            self.saveCount++;
+            self.lastSaveDate = [NSDate date];
+            return YES;
+        case JESSI_LOG_EVENT_STOPPING:
+            self.stopping = YES;
+            self.ready = NO;
+            [self.players removeAllObjects];
+            return YES;
+        case JESSI_LOG_EVENT_EXCEPTION:
+            self.exceptionCount++;
+            self.lastException = subject;
+            return YES;
+        case JESSI_LOG_EVENT_NONE:
+        case JESSI_LOG_EVENT_STACK_FRAME:
+            return NO;
+    }
+    return NO;
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, id> *d = [NSMutableDictionary dictionary];
+    d[@"onlinePlayers"] = self.onlinePlayers;
+    d[@"ready"] = @(self.ready);
+    d[@"stopping"] = @(self.stopping);
+    d[@"startupSeconds"] = @(self.startupSeconds);
+    d[@"lagSpikeCount"] = @(self.lagSpikeCount);
+    d[@"lastLagMs"] = @(self.lastLagMs);
+    d[@"worstLagMs"] = @(self.worstLagMs);
+    d[@"totalLagMs"] = @(self.totalLagMs);
+    d[@"saveCount"] = @(self.saveCount);
+    d[@"saving"] = @(self.saving);
+    d[@"exceptionCount"] = @(self.exceptionCount);
+    if (self.lastSaveDate) d[@"lastSaveDate"] = self.lastSaveDate;
+    if (self.lastException) d[@"lastException"] = self.lastException;
+    return d;
+}
+
+@end
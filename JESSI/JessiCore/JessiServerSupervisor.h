@@ -0,0 +1,34 @@
+#import <Foundation/Foundation.h>
+#import "JessiServerService.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Owns one JessiServerService per server folder. Each instance keeps its own tailer, console,
+// RCON session and telemetry, so several servers can run side by side when the JVM is spawned
+// as a separate process (macOS, TrollStore). The in-process JVM still allows only one.
+@interface JessiServerSupervisor : NSObject
+
++ (instancetype)shared;
+
+@property (nonatomic, readonly) BOOL supportsConcurrentServers;
+
+- (JessiServerService *)instanceForServerNamed:(NSString *)serverName;
+- (nullable JessiServerService *)existingInstanceForServerNamed:(NSString *)serverName;
+- (NSArray<NSString *> *)runningServerNames;
+- (void)stopAllServers;
+
+// Per-server limits applied at the next start; 0 means "use the global setting".
+- (NSInteger)maxHeapMBForServerNamed:(NSString *)serverName;
+- (NSInteger)cpuCoresForServerNamed:(NSString *)serverName;
+- (void)setMaxHeapMB:(NSInteger)heapMB cpuCores:(NSInteger)cpuCores forServerNamed:(NSString *)serverName;
+
+// Keeps the preferred ports when they are free, otherwise picks the next free ones above
+// 25565/25575. Ports stay reserved for the server until released.
+- (void)reserveGamePort:(int *)gamePort rconPort:(int *)rconPort forServerNamed:(NSString *)serverName;
+- (void)releasePortsForServerNamed:(NSString *)serverName;
+// @[game, rcon] while reserved, otherwise empty.
+- (NSArray<NSNumber *> *)reservedPortsForServerNamed:(NSString *)serverName;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,176 @@
+#import "JessiServerSupervisor.h"
+
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <unistd.h>
+
+static NSString *const JessiServerLimitsKey = @"jessi.server.limits";
+static const int JessiDefaultGamePort = 25565;
+static const int JessiDefaultRconPort = 25575;
+
+// Java's ServerSocket sets SO_REUSEADDR, so a port in TIME_WAIT still counts as free.
+static BOOL jessi_port_is_bindable(int port) {
+    if (port <= 0 || port > 65535) return NO;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return YES;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    BOOL ok = bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    close(fd);
+    return ok;
+}
+
+@interface JessiServerSupervisor ()
+@property (nonatomic, strong) NSMutableDictionary<NSString *, JessiServerService *> *instances;
+// server name -> @[game port, rcon port]
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSArray<NSNumber *> *> *reservedPorts;
+@end
+
+@implementation JessiServerSupervisor
+
++ (instancetype)shared {
+    static JessiServerSupervisor *shared;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        shared = [JessiServerSupervisor new];
+    });
+    return shared;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _instances = [NSMutableDictionary dictionary];
+        _reservedPorts = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (BOOL)supportsConcurrentServers {
+    return [JessiServerService usesSeparateJVMProcess];
+}
+
+- (JessiServerService *)instanceForServerNamed:(NSString *)serverName {
+    @synchronized(self) {
+        JessiServerService *service = self.instances[serverName];
+        if (!service) {
+            service = [[JessiServerService alloc] initWithServerName:serverName];
+            service.maxHeapMB = [self maxHeapMBForServerNamed:serverName];
+            service.cpuCores = [self cpuCoresForServerNamed:serverName];
+            self.instances[serverName] = service;
+        }
+        return service;
+    }
+}
+
+- (JessiServerService *)existingInstanceForServerNamed:(NSString *)serverName {
+    @synchronized(self) {
+        return self.instances[serverName];
+    }
+}
+
+- (NSArray<NSString *> *)runningServerNames {
+    NSMutableArray<NSString *> *names = [NSMutableArray array];
+    @synchronized(self) {
+        [self.instances enumerateKeysAndObjectsUsingBlock:^(NSString *name, JessiServerService *service, BOOL *stop) {
+            if (service.isRunning) [names addObject:name];
+        }];
+    }
+    [names sortUsingSelector:@selector(localizedCaseInsensitiveCompare:)];
+    return names;
+}
+
+- (void)stopAllServers {
+    NSArray<JessiServerService *> *services;
+    @synchronized(self) {
+        services = self.instances.allValues;
+    }
+    for (JessiServerService *service in services) {
+        if (service.isRunning) [service stopServer];
+    }
+}
+
+- (NSDictionary *)limitsForServerNamed:(NSString *)serverName {
+    NSDictionary *all = [[NSUserDefaults standardUserDefaults] dictionaryForKey:JessiServerLimitsKey];
+    NSDictionary *limits = all[serverName];
+    return [limits isKindOfClass:[NSDictionary class]] ? limits : @{};
+}
+
+- (NSInteger)maxHeapMBForServerNamed:(NSString *)serverName {
+    return MAX([[self limitsForServerNamed:serverName][@"maxHeapMB"] integerValue], 0);
+}
+
+- (NSInteger)cpuCoresForServerNamed:(NSString *)serverName {
+    return MAX([[self limitsForServerNamed:serverName][@"cpuCores"] integerValue], 0);
+}
+
+- (void)setMaxHeapMB:(NSInteger)heapMB cpuCores:(NSInteger)cpuCores forServerNamed:(NSString *)serverName {
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    NSMutableDictionary *all = [[defaults dictionaryForKey:JessiServerLimitsKey] mutableCopy] ?: [NSMutableDictionary dictionary];
+    if (heapMB <= 0 && cpuCores <= 0) {
+        [all removeObjectForKey:serverName];
+    } else {
+        all[serverName] = @{ @"maxHeapMB": @(MAX(heapMB, 0)), @"cpuCores": @(MAX(cpuCores, 0)) };
+    }
+    [defaults setObject:all forKey:JessiServerLimitsKey];
+
+    JessiServerService *service = [self existingInstanceForServerNamed:serverName];
+    service.maxHeapMB = MAX(heapMB, 0);
+    service.cpuCores = MAX(cpuCores, 0);
+}
+
+- (BOOL)port:(int)port isTakenExcluding:(NSString *)serverName {
+    __block BOOL taken = NO;
+    [self.reservedPorts enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSArray<NSNumber *> *ports, BOOL *stop) {
+        if ([name isEqualToString:serverName]) return;
+        for (NSNumber *p in ports) {
+            if (p.intValue == port) {
+                taken = YES;
+                *stop = YES;
+                return;
+            }
+        }
+    }];
+    return taken;
+}
+
+- (int)freePortPreferring:(int)preferred base:(int)base avoiding:(int)other forServerNamed:(NSString *)serverName {
+    if (preferred > 0 && preferred != other && ![self port:preferred isTakenExcluding:serverName] && jessi_port_is_bindable(preferred)) {
+        return preferred;
+    }
+    for (int port = base; port < base + 200 && port <= 65535; port++) {
+        if (port == other || port == preferred) continue;
+        if ([self port:port isTakenExcluding:serverName]) continue;
+        if (jessi_port_is_bindable(port)) return port;
+    }
+    return preferred > 0 ? preferred : base;
+}
+
+- (void)reserveGamePort:(int *)gamePort rconPort:(int *)rconPort forServerNamed:(NSString *)serverName {
+    @synchronized(self) {
+        int game = [self freePortPreferring:(gamePort ? *gamePort : 0) base:JessiDefaultGamePort avoiding:0 forServerNamed:serverName];
+        int rcon = [self freePortPreferring:(rconPort ? *rconPort : 0) base:JessiDefaultRconPort avoiding:game forServerNamed:serverName];
+        self.reservedPorts[serverName] = @[@(game), @(rcon)];
+        if (gamePort) *gamePort = game;
+        if (rconPort) *rconPort = rcon;
+    }
+}
+
+- (void)releasePortsForServerNamed:(NSString *)serverName {
+    @synchronized(self) {
+        [self.reservedPorts removeObjectForKey:serverName];
+    }
+}
+
+- (NSArray<NSNumber *> *)reservedPortsForServerNamed:(NSString *)serverName {
+    @synchronized(self) {
+        return self.reservedPorts[serverName] ?: @[];
+    }
+}
+
+@end
@@ -2,6 +2,36 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Immutable copy of every setting plus the installed Java versions. One is built per change
+// (save, an NSUserDefaults change, a runtime install or delete) and shared until the next one,
+// so reads take no lock and never touch the filesystem.
+@interface JessiSettingsSnapshot : NSObject
+
+@property (nonatomic, readonly) uint64_t generation;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *availableJavaVersions;
+
+@property (nonatomic, copy, readonly) NSString *javaVersion;
+@property (nonatomic, readonly) NSInteger maxHeapMB;
+@property (nonatomic, readonly) BOOL txmSupport;
+@property (nonatomic, readonly) BOOL flagNettyNoNative;
+@property (nonatomic, readonly) BOOL flagJnaNoSys;
+@property (nonatomic, readonly) BOOL runInBackground;
+@property (nonatomic, readonly) BOOL disableSeparateJVMProcessOnTrollStore;
+@property (nonatomic, readonly) NSInteger consoleMaxLines;
+@property (nonatomic, readonly) NSInteger consoleMaxKB;
+@property (nonatomic, readonly) NSInteger shutdownSaveTimeout;
+@property (nonatomic, readonly) NSInteger shutdownStopTimeout;
+@property (nonatomic, readonly) NSInteger shutdownTermTimeout;
+@property (nonatomic, readonly) BOOL appCDSEnabled;
+@property (nonatomic, readonly) NSInteger appCDSMaxMB;
+@property (nonatomic, readonly) BOOL runtimePrewarm;
+@property (nonatomic, copy, readonly) NSString *launchArguments;
+@property (nonatomic, copy, readonly) NSString *cfapikey;
+
+@end
+
+// Editable settings for the settings screen: change properties, then save. Everything else
+// should read +current.
 @interface JessiSettings : NSObject
 
 @property (nonatomic, copy) NSString *javaVersion;
@@ -14,8 +44,26 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic) BOOL runInBackground;
 @property (nonatomic) BOOL disableSeparateJVMProcessOnTrollStore;
 
+@property (nonatomic) NSInteger consoleMaxLines;
+@property (nonatomic) NSInteger consoleMaxKB;
+
+// Seconds allowed for each shutdown stage: save-all flush, stop, then SIGTERM before SIGKILL.
+@property (nonatomic) NSInteger shutdownSaveTimeout;
+@property (nonatomic) NSInteger shutdownStopTimeout;
+@property (nonatomic) NSInteger shutdownTermTimeout;
+
+// Dynamic AppCDS archive per server (Java 17+); archives larger than the cap are discarded.
+@property (nonatomic) BOOL appCDSEnabled;
+@property (nonatomic) NSInteger appCDSMaxMB;
+
+// Page the selected runtime and server jar into the file cache in the background after launch.
+@property (nonatomic) BOOL runtimePrewarm;
+
 + (instancetype)shared;
++ (JessiSettingsSnapshot *)current;
 + (NSArray<NSString *> *)availableJavaVersions;
+// Called by JessiRuntimeRegistry when a runtime is installed or deleted.
++ (void)runtimesDidChange;
 - (void)load;
 - (void)save;
 
@@ -1,4 +1,8 @@
 #import "JessiSettings.h"
+#import "JessiRuntimeRegistry.h"
+
+#import <os/lock.h>
+#include <stdatomic.h>
 
 static NSString *const kJessiJavaVersion = @"jessi.javaVersion";
 static NSString *const kJessiMaxHeapMB = @"jessi.maxHeapMB";
@@ -9,100 +13,50 @@ static NSString *const kJessiTXMSupport = @"jessi.txmSupport";
 static NSString *const kJessicfapikey = @"jessi.mods.curseforgeApiKey";
 static NSString *const kJessiRunInBackground = @"jessi.runInBackground";
 static NSString *const kJessiDisableSeparateJVMProcessOnTrollStore = @"jessi.jvm.disableSeparateProcessOnTrollStore";
+static NSString *const kJessiConsoleMaxLines = @"jessi.console.maxLines";
+static NSString *const kJessiConsoleMaxKB = @"jessi.console.maxKB";
+static NSString *const kJessiShutdownSaveTimeout = @"jessi.shutdown.saveTimeout";
+static NSString *const kJessiShutdownStopTimeout = @"jessi.shutdown.stopTimeout";
+static NSString *const kJessiShutdownTermTimeout = @"jessi.shutdown.termTimeout";
+static NSString *const kJessiAppCDSEnabled = @"jessi.jvm.appCDSEnabled";
+static NSString *const kJessiAppCDSMaxMB = @"jessi.jvm.appCDSMaxMB";
+static NSString *const kJessiRuntimePrewarm = @"jessi.jvm.runtimePrewarm";
 
-@implementation JessiSettings
+// Readers load gSnapshot and compare the two generations; everything else happens under
+// gSnapshotLock. Published snapshots are never released (gPublished keeps them), which is what
+// lets readers use the raw pointer without retaining it under a lock. A new one is only
+// published when a value actually changed, so the list stays tiny.
+static os_unfair_lock gSnapshotLock = OS_UNFAIR_LOCK_INIT;
+static _Atomic(void *) gSnapshot;
+static _Atomic uint64_t gWantedGeneration = 1;
+static _Atomic uint64_t gBuiltGeneration;
+static NSMutableArray<JessiSettingsSnapshot *> *gPublished;
+static NSArray<NSString *> *gJavaVersions;
+// Bumped by runtimesDidChange; gJavaVersions was fetched at gJavaVersionsGeneration.
+static uint64_t gRuntimesGeneration = 1;
+static uint64_t gJavaVersionsGeneration;
 
-+ (instancetype)shared {
-    static JessiSettings *s;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        s = [[JessiSettings alloc] init];
-    });
-    [s load];
-    return s;
+static void jessi_settings_invalidate(void) {
+    atomic_fetch_add_explicit(&gWantedGeneration, 1, memory_order_release);
 }
 
-+ (NSArray<NSString *> *)availableJavaVersions {
-    NSMutableArray<NSString *> *available = [NSMutableArray array];
-    NSBundle *b = [NSBundle mainBundle];
-    NSString *bundleRoot = b.bundlePath;
-    NSString *resourceRoot = b.resourcePath;
-    NSFileManager *fm = [NSFileManager defaultManager];
-
-    BOOL isIOS26OrLater = NO;
-    NSOperatingSystemVersion v = [NSProcessInfo processInfo].operatingSystemVersion;
-    if (v.majorVersion >= 26) isIOS26OrLater = YES;
-
-    NSMutableArray<NSString *> *roots = [NSMutableArray array];
-    if (bundleRoot.length) [roots addObject:bundleRoot];
-    if (resourceRoot.length && ![resourceRoot isEqualToString:bundleRoot]) [roots addObject:resourceRoot];
-    if (bundleRoot.length) {
-        NSString *resourcesUnderBundle = [bundleRoot stringByAppendingPathComponent:@"Resources"];
-        if (![roots containsObject:resourcesUnderBundle]) [roots addObject:resourcesUnderBundle];
-    }
-
-    for (NSString *ver in @[@"8", @"17", @"21"]) {
-        if (isIOS26OrLater && [ver isEqualToString:@"8"]) {
-            continue;
-        }
-        for (NSString *root in roots) {
-            NSString *path = [root stringByAppendingPathComponent:[NSString stringWithFormat:@"java%@", ver]];
-            if ([fm fileExistsAtPath:path]) {
-                [available addObject:ver];
-                break;
-            }
-        }
-    }
-
-    if (!isIOS26OrLater && ![available containsObject:@"8"] && ![available containsObject:@"17"] && ![available containsObject:@"21"]) {
-        NSString *genericPath = nil;
-        for (NSString *root in roots) {
-            NSString *candidate = [root stringByAppendingPathComponent:@"java"];
-            if ([fm fileExistsAtPath:candidate]) {
-                genericPath = candidate;
-                break;
-            }
-        }
-
-        if (genericPath.length) {
-            NSString *releasePath = [genericPath stringByAppendingPathComponent:@"release"];
-            NSString *releaseContent = [NSString stringWithContentsOfFile:releasePath encoding:NSUTF8StringEncoding error:nil];
-
-            if ([releaseContent containsString:@"1.8.0"] || [releaseContent containsString:@"\"1.8"]) {
-                [available addObject:@"8"];
-            } else if ([releaseContent containsString:@"\"17."]) {
-                [available addObject:@"17"];
-            } else if ([releaseContent containsString:@"\"21."]) {
-                [available addObject:@"21"];
-            }
-        }
-    }
+@interface JessiSettingsSnapshot ()
+- (instancetype)initWithDefaults:(NSUserDefaults *)d
+           availableJavaVersions:(NSArray<NSString *> *)available
+                      generation:(uint64_t)generation;
+- (BOOL)hasSameValuesAs:(JessiSettingsSnapshot *)other;
+@end
 
-    NSURL *appSupport = [[fm URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
-    NSString *runtimesRoot = [[appSupport URLByAppendingPathComponent:@"Runtimes" isDirectory:YES] path];
-    if (runtimesRoot.length) {
-        for (NSString *ver in @[@"8", @"17", @"21"]) {
-            if (isIOS26OrLater && [ver isEqualToString:@"8"]) {
-                continue;
-            }
-            NSString *dir = [runtimesRoot stringByAppendingPathComponent:[NSString stringWithFormat:@"jre%@", ver]];
-            if ([fm fileExistsAtPath:dir] && ![available containsObject:ver]) {
-                [available addObject:ver];
-            }
-        }
-    }
+@implementation JessiSettingsSnapshot
 
-    return [available sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
-        return [a integerValue] - [b integerValue] > 0 ? NSOrderedDescending : NSOrderedAscending;
-    }];
-}
+- (instancetype)initWithDefaults:(NSUserDefaults *)d
+           availableJavaVersions:(NSArray<NSString *> *)available
+                      generation:(uint64_t)generation {
+    if (!(self = [super init])) return nil;
+    _generation = generation;
+    _availableJavaVersions = [available copy];
 
-- (void)load {
-    NSUserDefaults *d = [NSUserDefaults standardUserDefaults];
     NSString *savedVersion = [d stringForKey:kJessiJavaVersion];
-
-    NSArray<NSString *> *available = [JessiSettings availableJavaVersions];
-
     NSString *(^pickBestAvailable)(void) = ^NSString *{
         if ([available containsObject:@"21"]) return @"21";
         if ([available containsObject:@"17"]) return @"17";
@@ -112,52 +66,205 @@ static NSString *const kJessiDisableSeparateJVMProcessOnTrollStore = @"jessi.jvm
 
     if (available.count > 0) {
         if (savedVersion.length && [available containsObject:savedVersion]) {
-            self.javaVersion = savedVersion;
+            _javaVersion = [savedVersion copy];
         } else {
-            self.javaVersion = pickBestAvailable() ?: @"21";
+            _javaVersion = pickBestAvailable() ?: @"21";
         }
     } else {
-        self.javaVersion = savedVersion.length ? savedVersion : @"21";
+        _javaVersion = savedVersion.length ? [savedVersion copy] : @"21";
     }
-    
+
     NSInteger mb = [d integerForKey:kJessiMaxHeapMB];
-    self.maxHeapMB = (mb > 0) ? mb : 768;
+    _maxHeapMB = (mb > 0) ? mb : 768;
 
     if ([d objectForKey:kJessiTXMSupport] == nil) {
-        self.txmSupport = YES;
+        _txmSupport = YES;
     } else {
-        self.txmSupport = [d boolForKey:kJessiTXMSupport];
+        _txmSupport = [d boolForKey:kJessiTXMSupport];
     }
 
     if ([d objectForKey:kJessiFlagNettyNoNative] == nil) {
-        self.flagNettyNoNative = YES;
+        _flagNettyNoNative = YES;
     } else {
-        self.flagNettyNoNative = [d boolForKey:kJessiFlagNettyNoNative];
+        _flagNettyNoNative = [d boolForKey:kJessiFlagNettyNoNative];
     }
 
     if ([d objectForKey:kJessiFlagJnaNoSys] == nil) {
-        self.flagJnaNoSys = NO;
+        _flagJnaNoSys = NO;
     } else {
-        self.flagJnaNoSys = [d boolForKey:kJessiFlagJnaNoSys];
+        _flagJnaNoSys = [d boolForKey:kJessiFlagJnaNoSys];
     }
 
     if ([d objectForKey:kJessiRunInBackground] == nil) {
-        self.runInBackground = NO;
+        _runInBackground = NO;
     } else {
-        self.runInBackground = [d boolForKey:kJessiRunInBackground];
+        _runInBackground = [d boolForKey:kJessiRunInBackground];
     }
 
     if ([d objectForKey:kJessiDisableSeparateJVMProcessOnTrollStore] == nil) {
-        self.disableSeparateJVMProcessOnTrollStore = NO;
+        _disableSeparateJVMProcessOnTrollStore = NO;
     } else {
-        self.disableSeparateJVMProcessOnTrollStore = [d boolForKey:kJessiDisableSeparateJVMProcessOnTrollStore];
+        _disableSeparateJVMProcessOnTrollStore = [d boolForKey:kJessiDisableSeparateJVMProcessOnTrollStore];
     }
 
-    NSString *args = [d stringForKey:kJessiLaunchArgs];
-    if (args) self.launchArguments = args; else self.launchArguments = @"";
+    NSInteger lines = [d integerForKey:kJessiConsoleMaxLines];
+    _consoleMaxLines = (lines > 0) ? lines : 5000;
+    NSInteger kb = [d integerForKey:kJessiConsoleMaxKB];
+    _consoleMaxKB = (kb > 0) ? kb : 1024;
+
+    NSInteger saveTimeout = [d integerForKey:kJessiShutdownSaveTimeout];
+    _shutdownSaveTimeout = (saveTimeout > 0) ? saveTimeout : 120;
+    NSInteger stopTimeout = [d integerForKey:kJessiShutdownStopTimeout];
+    _shutdownStopTimeout = (stopTimeout > 0) ? stopTimeout : 60;
+    NSInteger termTimeout = [d integerForKey:kJessiShutdownTermTimeout];
+    _shutdownTermTimeout = (termTimeout > 0) ? termTimeout : 10;
+
+    if ([d objectForKey:kJessiAppCDSEnabled] == nil) {
+        _appCDSEnabled = YES;
+    } else {
+        _appCDSEnabled = [d boolForKey:kJessiAppCDSEnabled];
+    }
+    NSInteger cdsMB = [d integerForKey:kJessiAppCDSMaxMB];
+    _appCDSMaxMB = (cdsMB > 0) ? cdsMB : 256;
+
+    if ([d objectForKey:kJessiRuntimePrewarm] == nil) {
+        _runtimePrewarm = YES;
+    } else {
+        _runtimePrewarm = [d boolForKey:kJessiRuntimePrewarm];
+    }
+
+    _launchArguments = [[d stringForKey:kJessiLaunchArgs] copy] ?: @"";
+    _cfapikey = [[d stringForKey:kJessicfapikey] copy] ?: @"";
+    return self;
+}
 
-    NSString *key = [d stringForKey:kJessicfapikey];
-    if (key) self.cfapikey = key; else self.cfapikey = @"";
+- (BOOL)hasSameValuesAs:(JessiSettingsSnapshot *)o {
+    return [_availableJavaVersions isEqualToArray:o.availableJavaVersions] &&
+           [_javaVersion isEqualToString:o.javaVersion] &&
+           _maxHeapMB == o.maxHeapMB &&
+           _txmSupport == o.txmSupport &&
+           _flagNettyNoNative == o.flagNettyNoNative &&
+           _flagJnaNoSys == o.flagJnaNoSys &&
+           _runInBackground == o.runInBackground &&
+           _disableSeparateJVMProcessOnTrollStore == o.disableSeparateJVMProcessOnTrollStore &&
+           _consoleMaxLines == o.consoleMaxLines &&
+           _consoleMaxKB == o.consoleMaxKB &&
+           _shutdownSaveTimeout == o.shutdownSaveTimeout &&
+           _shutdownStopTimeout == o.shutdownStopTimeout &&
+           _shutdownTermTimeout == o.shutdownTermTimeout &&
+           _appCDSEnabled == o.appCDSEnabled &&
+           _appCDSMaxMB == o.appCDSMaxMB &&
+           _runtimePrewarm == o.runtimePrewarm &&
+           [_launchArguments isEqualToString:o.launchArguments] &&
+           [_cfapikey isEqualToString:o.cfapikey];
+}
+
+@end
+
+@implementation JessiSettings {
+    uint64_t _loadedGeneration;
+}
+
++ (instancetype)shared {
+    static JessiSettings *s;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s = [[JessiSettings alloc] init];
+    });
+    JessiSettingsSnapshot *snap = [self current];
+    @synchronized (s) {
+        if (s->_loadedGeneration != snap.generation) [s applySnapshot:snap];
+    }
+    return s;
+}
+
++ (JessiSettingsSnapshot *)current {
+    uint64_t wanted = atomic_load_explicit(&gWantedGeneration, memory_order_acquire);
+    void *ptr = atomic_load_explicit(&gSnapshot, memory_order_acquire);
+    if (ptr && atomic_load_explicit(&gBuiltGeneration, memory_order_acquire) == wanted) {
+        return (__bridge JessiSettingsSnapshot *)ptr;
+    }
+
+    static dispatch_once_t observeOnce;
+    dispatch_once(&observeOnce, ^{
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSUserDefaultsDidChangeNotification
+                                                          object:nil
+                                                           queue:nil
+                                                      usingBlock:^(__unused NSNotification *note) {
+            jessi_settings_invalidate();
+        }];
+    });
+
+    // The registry may touch the disk, so it is asked outside gSnapshotLock.
+    os_unfair_lock_lock(&gSnapshotLock);
+    uint64_t runtimesGeneration = gRuntimesGeneration;
+    BOOL needVersions = gJavaVersionsGeneration != runtimesGeneration;
+    os_unfair_lock_unlock(&gSnapshotLock);
+    NSArray<NSString *> *fetched = needVersions ? [[JessiRuntimeRegistry shared] availableVersions] : nil;
+
+    os_unfair_lock_lock(&gSnapshotLock);
+    wanted = atomic_load_explicit(&gWantedGeneration, memory_order_acquire);
+    JessiSettingsSnapshot *cur = (__bridge JessiSettingsSnapshot *)atomic_load_explicit(&gSnapshot, memory_order_relaxed);
+    if (!cur || atomic_load_explicit(&gBuiltGeneration, memory_order_relaxed) != wanted) {
+        if (fetched && runtimesGeneration > gJavaVersionsGeneration) {
+            gJavaVersions = fetched;
+            gJavaVersionsGeneration = runtimesGeneration;
+        }
+        if (!gPublished) gPublished = [NSMutableArray array];
+        JessiSettingsSnapshot *next = [[JessiSettingsSnapshot alloc] initWithDefaults:[NSUserDefaults standardUserDefaults]
+                                                                availableJavaVersions:gJavaVersions ?: @[]
+                                                                           generation:gPublished.count + 1];
+        if (!cur || ![next hasSameValuesAs:cur]) {
+            [gPublished addObject:next];
+            cur = next;
+            atomic_store_explicit(&gSnapshot, (__bridge void *)cur, memory_order_release);
+        }
+        // Runtimes changed while we were asking: leave the generation stale so the next call refetches.
+        if (gJavaVersionsGeneration == gRuntimesGeneration) {
+            atomic_store_explicit(&gBuiltGeneration, wanted, memory_order_release);
+        }
+    }
+    os_unfair_lock_unlock(&gSnapshotLock);
+    return cur;
+}
+
++ (void)runtimesDidChange {
+    os_unfair_lock_lock(&gSnapshotLock);
+    gRuntimesGeneration++;
+    os_unfair_lock_unlock(&gSnapshotLock);
+    jessi_settings_invalidate();
+}
+
++ (NSArray<NSString *> *)availableJavaVersions {
+    return [self current].availableJavaVersions;
+}
+
+- (void)applySnapshot:(JessiSettingsSnapshot *)snap {
+    _loadedGeneration = snap.generation;
+    self.javaVersion = snap.javaVersion;
+    self.maxHeapMB = snap.maxHeapMB;
+    self.txmSupport = snap.txmSupport;
+    self.flagNettyNoNative = snap.flagNettyNoNative;
+    self.flagJnaNoSys = snap.flagJnaNoSys;
+    self.runInBackground = snap.runInBackground;
+    self.disableSeparateJVMProcessOnTrollStore = snap.disableSeparateJVMProcessOnTrollStore;
+    self.consoleMaxLines = snap.consoleMaxLines;
+    self.consoleMaxKB = snap.consoleMaxKB;
+    self.shutdownSaveTimeout = snap.shutdownSaveTimeout;
+    self.shutdownStopTimeout = snap.shutdownStopTimeout;
+    self.shutdownTermTimeout = snap.shutdownTermTimeout;
+    self.appCDSEnabled = snap.appCDSEnabled;
+    self.appCDSMaxMB = snap.appCDSMaxMB;
+    self.runtimePrewarm = snap.runtimePrewarm;
+    self.launchArguments = snap.launchArguments;
+    self.cfapikey = snap.cfapikey;
+}
+
+- (void)load {
+    JessiSettingsSnapshot *snap = [JessiSettings current];
+    @synchronized (self) {
+        [self applySnapshot:snap];
+    }
 }
 
 - (void)save {
@@ -169,9 +276,18 @@ static NSString *const kJessiDisableSeparateJVMProcessOnTrollStore = @"jessi.jvm
     [d setBool:self.flagJnaNoSys forKey:kJessiFlagJnaNoSys];
     [d setBool:self.runInBackground forKey:kJessiRunInBackground];
     [d setBool:self.disableSeparateJVMProcessOnTrollStore forKey:kJessiDisableSeparateJVMProcessOnTrollStore];
+    [d setInteger:self.consoleMaxLines forKey:kJessiConsoleMaxLines];
+    [d setInteger:self.consoleMaxKB forKey:kJessiConsoleMaxKB];
+    [d setInteger:self.shutdownSaveTimeout forKey:kJessiShutdownSaveTimeout];
+    [d setInteger:self.shutdownStopTimeout forKey:kJessiShutdownStopTimeout];
+    [d setInteger:self.shutdownTermTimeout forKey:kJessiShutdownTermTimeout];
+    [d setBool:self.appCDSEnabled forKey:kJessiAppCDSEnabled];
+    [d setInteger:self.appCDSMaxMB forKey:kJessiAppCDSMaxMB];
+    [d setBool:self.runtimePrewarm forKey:kJessiRuntimePrewarm];
     [d setObject:self.launchArguments ?: @"" forKey:kJessiLaunchArgs];
     [d setBool:self.txmSupport forKey:kJessiTXMSupport];
     [d setObject:self.cfapikey ?: @"" forKey:kJessicfapikey];
+    jessi_settings_invalidate();
 }
 
 @end
@@ -0,0 +1,223 @@
+#include "JessiSigScan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#define JESSI_SIG_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JESSI_SIG_SSE2 1
+#endif
+
+#define JESSI_SIG_CACHE_MAX_LINES 8
+#define JESSI_MH_MAGIC_64 0xfeedfacfu
+#define JESSI_LC_UUID 0x1bu
+
+static int jessi_sig_match_at(const uint8_t *base, size_t len, size_t off, const jessi_sig_pattern *pattern) {
+    return off + pattern->len <= len && memcmp(base + off, pattern->bytes, pattern->len) == 0;
+}
+
+// Checks one aligned candidate against every pattern still missing; returns how many it resolved.
+static size_t jessi_sig_check(const uint8_t *base, size_t len, size_t off, const jessi_sig_pattern *patterns,
+                              size_t count, size_t *offsets) {
+    size_t found = 0;
+    for (size_t p = 0; p < count; p++) {
+        if (offsets[p] != JESSI_SIG_NOT_FOUND) continue;
+        if (base[off] != patterns[p].bytes[0]) continue;
+        if (jessi_sig_match_at(base, len, off, &patterns[p])) {
+            offsets[p] = off;
+            found++;
+        }
+    }
+    return found;
+}
+
+size_t jessi_sig_scan(const uint8_t *base, size_t len, const jessi_sig_pattern *patterns, size_t count,
+                      size_t *offsets) {
+    if (!offsets) return 0;
+    for (size_t p = 0; p < count; p++) offsets[p] = JESSI_SIG_NOT_FOUND;
+    if (!base || !patterns || count == 0 || count > JESSI_SIG_MAX_PATTERNS) return 0;
+    for (size_t p = 0; p < count; p++) {
+        if (!patterns[p].bytes || patterns[p].len == 0) return 0;
+    }
+
+    size_t remaining = count;
+    size_t off = 0;
+
+#if defined(JESSI_SIG_NEON)
+    static const uint8_t lane_mask_bytes[16] = {0xff, 0, 0, 0, 0xff, 0, 0, 0, 0xff, 0, 0, 0, 0xff, 0, 0, 0};
+    uint8x16_t lane_mask = vld1q_u8(lane_mask_bytes);
+    uint8x16_t firsts[JESSI_SIG_MAX_PATTERNS];
+    for (size_t p = 0; p < count; p++) firsts[p] = vdupq_n_u8(patterns[p].bytes[0]);
+    for (; remaining > 0 && off + 16 <= len; off += 16) {
+        uint8x16_t block = vld1q_u8(base + off);
+        uint8x16_t hits = vceqq_u8(block, firsts[0]);
+        for (size_t p = 1; p < count; p++) hits = vorrq_u8(hits, vceqq_u8(block, firsts[p]));
+        hits = vandq_u8(hits, lane_mask);
+        if (vmaxvq_u8(hits) == 0) continue;
+        for (size_t lane = 0; lane < 16 && remaining > 0; lane += 4) {
+            remaining -= jessi_sig_check(base, len, off + lane, patterns, count, offsets);
+        }
+    }
+#elif defined(JESSI_SIG_SSE2)
+    __m128i firsts[JESSI_SIG_MAX_PATTERNS];
+    for (size_t p = 0; p < count; p++) firsts[p] = _mm_set1_epi8((char)patterns[p].bytes[0]);
+    for (; remaining > 0 && off + 16 <= len; off += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(base + off));
+        __m128i hits = _mm_cmpeq_epi8(block, firsts[0]);
+        for (size_t p = 1; p < count; p++) hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, firsts[p]));
+        int mask = _mm_movemask_epi8(hits) & 0x1111;
+        while (mask && remaining > 0) {
+            int lane = __builtin_ctz((unsigned)mask);
+            mask &= mask - 1;
+            remaining -= jessi_sig_check(base, len, off + (size_t)lane, patterns, count, offsets);
+        }
+    }
+#endif
+
+    for (; remaining > 0 && off < len; off += 4) {
+        remaining -= jessi_sig_check(base, len, off, patterns, count, offsets);
+    }
+    return count - remaining;
+}
+
+int jessi_sig_verify(const uint8_t *base, size_t len, const jessi_sig_pattern *patterns, size_t count,
+                     const size_t *offsets) {
+    if (!base || !patterns || !offsets) return 0;
+    for (size_t p = 0; p < count; p++) {
+        if (offsets[p] == JESSI_SIG_NOT_FOUND) continue;
+        if ((offsets[p] & 3) != 0 || !jessi_sig_match_at(base, len, offsets[p], &patterns[p])) return 0;
+    }
+    return 1;
+}
+
+int jessi_macho_image_uuid(const void *header, uint8_t uuid[16]) {
+    if (!header || !uuid) return -1;
+    const uint8_t *h = header;
+    uint32_t magic, ncmds, sizeofcmds;
+    memcpy(&magic, h, 4);
+    if (magic != JESSI_MH_MAGIC_64) return -1;
+    memcpy(&ncmds, h + 16, 4);
+    memcpy(&sizeofcmds, h + 20, 4);
+
+    const uint8_t *cmd = h + 32;
+    const uint8_t *end = cmd + sizeofcmds;
+    for (uint32_t i = 0; i < ncmds && cmd + 8 <= end; i++) {
+        uint32_t type, size;
+        memcpy(&type, cmd, 4);
+        memcpy(&size, cmd + 4, 4);
+        if (size < 8 || cmd + size > end) break;
+        if (type == JESSI_LC_UUID && size >= 24) {
+            memcpy(uuid, cmd + 8, 16);
+            return 0;
+        }
+        cmd += size;
+    }
+    return -1;
+}
+
+// FNV-1a over the pattern set, so a changed signature never reuses offsets found for the old one.
+static uint64_t jessi_sig_patterns_hash(const jessi_sig_pattern *patterns, size_t count) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t p = 0; p < count; p++) {
+        for (size_t i = 0; i < patterns[p].len; i++) {
+            h ^= patterns[p].bytes[i];
+            h *= 1099511628211ULL;
+        }
+        h ^= 0xff;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void jessi_sig_cache_key(char *out, size_t cap, const uint8_t uuid[16], const jessi_sig_pattern *patterns,
+                                size_t count) {
+    size_t n = 0;
+    for (int i = 0; i < 16 && n + 2 < cap; i++) n += (size_t)snprintf(out + n, cap - n, "%02x", uuid[i]);
+    snprintf(out + n, cap - n, " %016llx", (unsigned long long)jessi_sig_patterns_hash(patterns, count));
+}
+
+int jessi_sig_cache_load(const char *path, const uint8_t uuid[16], const jessi_sig_pattern *patterns,
+                         size_t count, size_t *offsets) {
+    if (!path || !uuid || !offsets || count == 0 || count > JESSI_SIG_MAX_PATTERNS) return -1;
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    char key[64];
+    jessi_sig_cache_key(key, sizeof(key), uuid, patterns, count);
+    size_t key_len = strlen(key);
+    char line[512];
+    int rc = -1;
+    while (rc != 0 && fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, key_len) != 0 || line[key_len] != ' ') continue;
+        char *cursor = line + key_len;
+        size_t p = 0;
+        for (; p < count; p++) {
+            char *next = NULL;
+            while (*cursor == ' ') cursor++;
+            if (*cursor == '-') {
+                offsets[p] = JESSI_SIG_NOT_FOUND;
+                cursor++;
+                continue;
+            }
+            unsigned long long v = strtoull(cursor, &next, 16);
+            if (next == cursor) break;
+            offsets[p] = (size_t)v;
+            cursor = next;
+        }
+        if (p == count) rc = 0;
+    }
+    fclose(f);
+    return rc;
+}
+
+int jessi_sig_cache_store(const char *path, const uint8_t uuid[16], const jessi_sig_pattern *patterns,
+                          size_t count, const size_t *offsets) {
+    if (!path || !uuid || !offsets || count == 0 || count > JESSI_SIG_MAX_PATTERNS) return -1;
+
+    char key[64];
+    jessi_sig_cache_key(key, sizeof(key), uuid, patterns, count);
+    size_t key_len = strlen(key);
+
+    // Keep entries for other dyld builds (OS updates, other patterns) up to a small bound.
+    char kept[JESSI_SIG_CACHE_MAX_LINES - 1][512];
+    size_t kept_count = 0;
+    FILE *in = fopen(path, "r");
+    if (in) {
+        char line[512];
+        while (fgets(line, sizeof(line), in)) {
+            if (strncmp(line, key, key_len) == 0 || line[0] == '\n') continue;
+            if (kept_count == JESSI_SIG_CACHE_MAX_LINES - 1) {
+                memmove(kept[0], kept[1], sizeof(kept[0]) * (JESSI_SIG_CACHE_MAX_LINES - 2));
+                kept_count--;
+            }
+            snprintf(kept[kept_count++], sizeof(kept[0]), "%s", line);
+        }
+        fclose(in);
+    }
+
+    size_t tmp_len = strlen(path) + 8;
+    char *tmp = malloc(tmp_len);
+    if (!tmp) return -1;
+    snprintf(tmp, tmp_len, "%s.tmp", path);
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        free(tmp);
+        return -1;
+    }
+    for (size_t i = 0; i < kept_count; i++) fputs(kept[i], out);
+    fputs(key, out);
+    for (size_t p = 0; p < count; p++) {
+        if (offsets[p] == JESSI_SIG_NOT_FOUND) fputs(" -", out);
+        else fprintf(out, " %llx", (unsigned long long)offsets[p]);
+    }
+    fputc('\n', out);
+    int rc = (fclose(out) == 0 && rename(tmp, path) == 0) ? 0 : -1;
+    if (rc != 0) unlink(tmp);
+    free(tmp);
+    return rc;
+}
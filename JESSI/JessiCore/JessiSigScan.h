@@ -0,0 +1,42 @@
+#ifndef JessiSigScan_h
+#define JessiSigScan_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JESSI_SIG_NOT_FOUND ((size_t)-1)
+#define JESSI_SIG_MAX_PATTERNS 8
+
+typedef struct {
+    const uint8_t *bytes;
+    size_t len;
+} jessi_sig_pattern;
+
+// Finds the first 4-byte-aligned occurrence of every pattern in a single pass over
+// [base, base + len). offsets[i] is the match offset or JESSI_SIG_NOT_FOUND.
+// Returns how many patterns were found. Uses a NEON/SSE2 first-byte filter when available.
+size_t jessi_sig_scan(const uint8_t *base, size_t len, const jessi_sig_pattern *patterns, size_t count,
+                      size_t *offsets);
+
+// 1 if every found offset still holds its pattern.
+int jessi_sig_verify(const uint8_t *base, size_t len, const jessi_sig_pattern *patterns, size_t count,
+                     const size_t *offsets);
+
+// Copies the LC_UUID of an in-memory 64-bit Mach-O image. Returns 0 on success.
+int jessi_macho_image_uuid(const void *header, uint8_t uuid[16]);
+
+// Offset cache: one line per (image UUID, pattern set). Returns 0 when an entry was found.
+int jessi_sig_cache_load(const char *path, const uint8_t uuid[16], const jessi_sig_pattern *patterns,
+                         size_t count, size_t *offsets);
+int jessi_sig_cache_store(const char *path, const uint8_t uuid[16], const jessi_sig_pattern *patterns,
+                          size_t count, const size_t *offsets);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
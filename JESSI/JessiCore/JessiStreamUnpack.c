@@ -0,0 +1,1055 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "JessiStreamUnpack.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <compression.h>
+#else
+#include <lzma.h>
+#include <zlib.h>
+#endif
+
+#define JESSI_UNPACK_DEFAULT_QUEUE (8u * 1024u * 1024u)
+#define JESSI_UNPACK_CODEC_BUF (64 * 1024)
+#define JESSI_UNPACK_WRITE_CHUNK (256 * 1024)
+// GNU long names and pax headers are buffered whole; anything bigger isn't a runtime.
+#define JESSI_UNPACK_META_MAX (64 * 1024)
+#define JESSI_UNPACK_OP_COST 256
+
+// MARK: - Decoders (xz, raw deflate)
+
+typedef enum {
+    JESSI_CODEC_XZ,
+    JESSI_CODEC_DEFLATE,
+} jessi_codec_kind;
+
+typedef struct {
+    int active;
+    jessi_codec_kind kind;
+#if defined(__APPLE__)
+    compression_stream s;
+#else
+    lzma_stream xz;
+    z_stream z;
+#endif
+} jessi_codec;
+
+static int jessi_codec_init(jessi_codec *c, jessi_codec_kind kind) {
+    memset(c, 0, sizeof(*c));
+    c->kind = kind;
+#if defined(__APPLE__)
+    // COMPRESSION_LZMA decodes the .xz container; COMPRESSION_ZLIB is raw deflate, as in zip.
+    compression_algorithm algo = kind == JESSI_CODEC_XZ ? COMPRESSION_LZMA : COMPRESSION_ZLIB;
+    if (compression_stream_init(&c->s, COMPRESSION_STREAM_DECODE, algo) != COMPRESSION_STATUS_OK) return -1;
+#else
+    if (kind == JESSI_CODEC_XZ) {
+        lzma_stream init = LZMA_STREAM_INIT;
+        c->xz = init;
+        if (lzma_stream_decoder(&c->xz, UINT64_MAX, 0) != LZMA_OK) return -1;
+    } else if (inflateInit2(&c->z, -MAX_WBITS) != Z_OK) {
+        return -1;
+    }
+#endif
+    c->active = 1;
+    return 0;
+}
+
+// 1 at the end of the stream, 0 when it needs more input or more room, -1 on bad data.
+static int jessi_codec_run(jessi_codec *c, const uint8_t *in, size_t in_len, size_t *consumed,
+                           uint8_t *out, size_t out_cap, size_t *produced) {
+    if (in_len > (size_t)INT_MAX) in_len = (size_t)INT_MAX;
+#if defined(__APPLE__)
+    c->s.src_ptr = in;
+    c->s.src_size = in_len;
+    c->s.dst_ptr = out;
+    c->s.dst_size = out_cap;
+    compression_status st = compression_stream_process(&c->s, 0);
+    *consumed = in_len - c->s.src_size;
+    *produced = out_cap - c->s.dst_size;
+    if (st == COMPRESSION_STATUS_END) return 1;
+    return st == COMPRESSION_STATUS_OK ? 0 : -1;
+#else
+    if (c->kind == JESSI_CODEC_XZ) {
+        c->xz.next_in = in;
+        c->xz.avail_in = in_len;
+        c->xz.next_out = out;
+        c->xz.avail_out = out_cap;
+        lzma_ret r = lzma_code(&c->xz, LZMA_RUN);
+        *consumed = in_len - c->xz.avail_in;
+        *produced = out_cap - c->xz.avail_out;
+        if (r == LZMA_STREAM_END) return 1;
+        return (r == LZMA_OK || r == LZMA_BUF_ERROR) ? 0 : -1;
+    }
+    c->z.next_in = (Bytef *)in;
+    c->z.avail_in = (uInt)in_len;
+    c->z.next_out = out;
+    c->z.avail_out = (uInt)out_cap;
+    int r = inflate(&c->z, Z_NO_FLUSH);
+    *consumed = in_len - c->z.avail_in;
+    *produced = out_cap - c->z.avail_out;
+    if (r == Z_STREAM_END) return 1;
+    return (r == Z_OK || r == Z_BUF_ERROR) ? 0 : -1;
+#endif
+}
+
+static void jessi_codec_end(jessi_codec *c) {
+    if (!c->active) return;
+#if defined(__APPLE__)
+    compression_stream_destroy(&c->s);
+#else
+    if (c->kind == JESSI_CODEC_XZ) lzma_end(&c->xz);
+    else inflateEnd(&c->z);
+#endif
+    c->active = 0;
+}
+
+// MARK: - Writer queue
+
+typedef enum {
+    JESSI_OP_MKDIR,
+    JESSI_OP_OPEN,
+    JESSI_OP_WRITE,
+    JESSI_OP_CLOSE,
+    JESSI_OP_SYMLINK,
+    JESSI_OP_LINK,
+} jessi_unpack_op_kind;
+
+typedef struct jessi_unpack_op {
+    struct jessi_unpack_op *next;
+    jessi_unpack_op_kind kind;
+    mode_t mode;
+    char *path;    // absolute
+    char *target;  // symlink text, or absolute hard link source
+    uint8_t *data;
+    size_t len;
+} jessi_unpack_op;
+
+typedef enum {
+    JESSI_SNIFF,
+    JESSI_ZIP_HEADER,
+    JESSI_ZIP_NAME,
+    JESSI_ZIP_DATA,
+    JESSI_ZIP_DESCRIPTOR,
+    JESSI_ZIP_DONE,
+    JESSI_XZ,
+} jessi_container_state;
+
+typedef enum {
+    JESSI_TAR_HEADER,
+    JESSI_TAR_FILE,
+    JESSI_TAR_META,
+    JESSI_TAR_SKIP,
+    JESSI_TAR_PAD,
+    JESSI_TAR_END,
+} jessi_tar_state;
+
+typedef enum {
+    JESSI_META_LONGNAME,
+    JESSI_META_LONGLINK,
+    JESSI_META_PAX,
+} jessi_meta_kind;
+
+struct jessi_unpack {
+    char *dest;
+    jessi_unpack_status status;
+    char error[256];
+
+    // Container.
+    jessi_container_state cstate;
+    uint8_t head[64 * 1024 + 30];
+    size_t head_len;
+    size_t head_need;
+    uint16_t zip_flags;
+    uint16_t zip_method;
+    int zip_is64;
+    uint64_t zip_remaining;  // stored entries: bytes left
+    int zip_target;          // this entry is the .tar.xz
+    int zip_target_done;
+    jessi_codec inflater;
+    uint8_t inflate_out[JESSI_UNPACK_CODEC_BUF];
+
+    jessi_codec xz;
+    int xz_started;
+    int xz_done;
+    uint8_t xz_out[JESSI_UNPACK_CODEC_BUF];
+
+    // Tar.
+    jessi_tar_state tstate;
+    uint8_t block[512];
+    size_t block_len;
+    uint64_t remaining;
+    size_t pad;
+    int zero_blocks;
+    jessi_meta_kind meta_kind;
+    char *meta;
+    size_t meta_len;
+    char *long_name;
+    char *long_link;
+    char *pax_path;
+    char *pax_link;
+    char *file_path;
+    mode_t file_mode;
+    char **symlinks;  // dest-relative paths of symlinks extracted so far
+    size_t symlink_count;
+    size_t symlink_cap;
+    uint8_t *chunk;
+    size_t chunk_len;
+
+    // Writer thread.
+    pthread_t writer;
+    int writer_started;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    jessi_unpack_op *q_head;
+    jessi_unpack_op *q_tail;
+    size_t queued;
+    size_t max_queued;
+    int closing;
+    int writer_failed;
+    char writer_error[256];
+    char last_parent[PATH_MAX];
+
+    jessi_unpack_stats stats;
+};
+
+static jessi_unpack_status jessi_unpack_fail(jessi_unpack *u, jessi_unpack_status st, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static jessi_unpack_status jessi_unpack_fail(jessi_unpack *u, jessi_unpack_status st, const char *fmt, ...) {
+    if (u->status != JESSI_UNPACK_OK) return u->status;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(u->error, sizeof(u->error), fmt, ap);
+    va_end(ap);
+    u->status = st;
+    return st;
+}
+
+static void jessi_unpack_free_op(jessi_unpack_op *op) {
+    free(op->path);
+    free(op->target);
+    free(op->data);
+    free(op);
+}
+
+static size_t jessi_unpack_op_cost(const jessi_unpack_op *op) {
+    return op->len + JESSI_UNPACK_OP_COST;
+}
+
+static int jessi_unpack_mkdirs(char *path, mode_t mode) {
+    size_t len = strlen(path);
+    for (size_t i = 1; i <= len; i++) {
+        if (path[i] != '/' && path[i] != '\0') continue;
+        char saved = path[i];
+        path[i] = '\0';
+        int rc = mkdir(path, mode);
+        int err = errno;
+        path[i] = saved;
+        if (rc != 0 && err != EEXIST) return -1;
+    }
+    return 0;
+}
+
+// Parents are created once per directory rather than once per file.
+static int jessi_unpack_ensure_parent(jessi_unpack *u, const char *path) {
+    const char *slash = strrchr(path, '/');
+    if (!slash || slash == path) return 0;
+    size_t n = (size_t)(slash - path);
+    if (n >= sizeof(u->last_parent)) return -1;
+    if (strncmp(u->last_parent, path, n) == 0 && u->last_parent[n] == '\0') return 0;
+    char buf[PATH_MAX];
+    memcpy(buf, path, n);
+    buf[n] = '\0';
+    if (jessi_unpack_mkdirs(buf, 0755) != 0) return -1;
+    memcpy(u->last_parent, buf, n + 1);
+    return 0;
+}
+
+static int jessi_unpack_apply(jessi_unpack *u, jessi_unpack_op *op, int *fd) {
+    switch (op->kind) {
+        case JESSI_OP_MKDIR:
+            return jessi_unpack_mkdirs(op->path, 0755);
+        case JESSI_OP_OPEN:
+            if (jessi_unpack_ensure_parent(u, op->path) != 0) return -1;
+            unlink(op->path);
+            *fd = open(op->path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW, 0600);
+            return *fd >= 0 ? 0 : -1;
+        case JESSI_OP_WRITE: {
+            size_t off = 0;
+            while (off < op->len) {
+                ssize_t n = write(*fd, op->data + off, op->len - off);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return -1;
+                off += (size_t)n;
+            }
+            __atomic_fetch_add(&u->stats.file_bytes, op->len, __ATOMIC_RELAXED);
+            return 0;
+        }
+        case JESSI_OP_CLOSE: {
+            int rc = fchmod(*fd, op->mode);
+            if (close(*fd) != 0) rc = -1;
+            *fd = -1;
+            return rc;
+        }
+        case JESSI_OP_SYMLINK:
+            if (jessi_unpack_ensure_parent(u, op->path) != 0) return -1;
+            unlink(op->path);
+            return symlink(op->target, op->path);
+        case JESSI_OP_LINK:
+            if (jessi_unpack_ensure_parent(u, op->path) != 0) return -1;
+            unlink(op->path);
+            return link(op->target, op->path);
+    }
+    return -1;
+}
+
+static void *jessi_unpack_writer_main(void *arg) {
+    jessi_unpack *u = arg;
+    int fd = -1;
+    for (;;) {
+        pthread_mutex_lock(&u->lock);
+        while (!u->q_head && !u->closing) pthread_cond_wait(&u->cond, &u->lock);
+        jessi_unpack_op *op = u->q_head;
+        if (!op) {
+            pthread_mutex_unlock(&u->lock);
+            break;
+        }
+        u->q_head = op->next;
+        if (!u->q_head) u->q_tail = NULL;
+        pthread_mutex_unlock(&u->lock);
+
+        int failed = 0;
+        if (!u->writer_failed && jessi_unpack_apply(u, op, &fd) != 0) {
+            failed = errno ? errno : EIO;
+        }
+
+        pthread_mutex_lock(&u->lock);
+        u->queued -= jessi_unpack_op_cost(op);
+        if (failed && !u->writer_failed) {
+            u->writer_failed = 1;
+            snprintf(u->writer_error, sizeof(u->writer_error), "%s: %s", op->path, strerror(failed));
+        }
+        pthread_cond_broadcast(&u->cond);
+        pthread_mutex_unlock(&u->lock);
+        jessi_unpack_free_op(op);
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+static jessi_unpack_status jessi_unpack_writer_status(jessi_unpack *u) {
+    pthread_mutex_lock(&u->lock);
+    int failed = u->writer_failed;
+    char msg[256];
+    if (failed) memcpy(msg, u->writer_error, sizeof(msg));
+    pthread_mutex_unlock(&u->lock);
+    return failed ? jessi_unpack_fail(u, JESSI_UNPACK_IO, "write failed: %s", msg) : JESSI_UNPACK_OK;
+}
+
+// Takes ownership of op. Blocks while the writer has max_queued bytes outstanding.
+static jessi_unpack_status jessi_unpack_enqueue(jessi_unpack *u, jessi_unpack_op *op) {
+    size_t cost = jessi_unpack_op_cost(op);
+    pthread_mutex_lock(&u->lock);
+    if (u->queued > 0 && u->queued + cost > u->max_queued && !u->writer_failed) {
+        u->stats.writer_stalls++;
+        while (u->queued > 0 && u->queued + cost > u->max_queued && !u->writer_failed) {
+            pthread_cond_wait(&u->cond, &u->lock);
+        }
+    }
+    if (u->writer_failed) {
+        pthread_mutex_unlock(&u->lock);
+        jessi_unpack_free_op(op);
+        return jessi_unpack_writer_status(u);
+    }
+    op->next = NULL;
+    if (u->q_tail) u->q_tail->next = op;
+    else u->q_head = op;
+    u->q_tail = op;
+    u->queued += cost;
+    if (u->queued > u->stats.peak_queued) u->stats.peak_queued = u->queued;
+    pthread_cond_broadcast(&u->cond);
+    pthread_mutex_unlock(&u->lock);
+    return JESSI_UNPACK_OK;
+}
+
+static jessi_unpack_status jessi_unpack_push_op(jessi_unpack *u, jessi_unpack_op_kind kind, const char *path,
+                                                const char *target, mode_t mode) {
+    jessi_unpack_op *op = calloc(1, sizeof(*op));
+    if (!op) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+    op->kind = kind;
+    op->mode = mode;
+    op->path = path ? strdup(path) : NULL;
+    op->target = target ? strdup(target) : NULL;
+    if ((path && !op->path) || (target && !op->target)) {
+        jessi_unpack_free_op(op);
+        return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+    }
+    return jessi_unpack_enqueue(u, op);
+}
+
+static jessi_unpack_status jessi_unpack_flush_chunk(jessi_unpack *u) {
+    if (u->chunk_len == 0) return JESSI_UNPACK_OK;
+    jessi_unpack_op *op = calloc(1, sizeof(*op));
+    if (!op) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+    op->kind = JESSI_OP_WRITE;
+    op->data = u->chunk;
+    op->len = u->chunk_len;
+    u->chunk = NULL;
+    u->chunk_len = 0;
+    return jessi_unpack_enqueue(u, op);
+}
+
+// MARK: - Tar
+
+static uint64_t jessi_tar_number(const uint8_t *field, size_t len) {
+    // GNU base-256 for values that don't fit in octal.
+    if (field[0] & 0x80) {
+        uint64_t v = field[0] & 0x3f;
+        for (size_t i = 1; i < len; i++) v = (v << 8) | field[i];
+        return v;
+    }
+    uint64_t v = 0;
+    size_t i = 0;
+    while (i < len && (field[i] == ' ' || field[i] == '\0')) i++;
+    for (; i < len && field[i] >= '0' && field[i] <= '7'; i++) v = (v << 3) | (uint64_t)(field[i] - '0');
+    return v;
+}
+
+static char *jessi_tar_string(const uint8_t *field, size_t len) {
+    size_t n = 0;
+    while (n < len && field[n]) n++;
+    char *s = malloc(n + 1);
+    if (!s) return NULL;
+    memcpy(s, field, n);
+    s[n] = '\0';
+    return s;
+}
+
+static int jessi_tar_checksum_ok(const uint8_t *b) {
+    uint64_t want = jessi_tar_number(b + 148, 8);
+    uint64_t sum = 0;
+    for (int i = 0; i < 512; i++) sum += (i >= 148 && i < 156) ? ' ' : b[i];
+    return sum == want;
+}
+
+// Archive paths are relative to dest; "..", absolute paths and empty names are refused.
+static char *jessi_unpack_join(jessi_unpack *u, const char *name, int *skip) {
+    *skip = 0;
+    while (name[0] == '/' || (name[0] == '.' && name[1] == '/')) name += (name[0] == '/') ? 1 : 2;
+    size_t n = strlen(name);
+    while (n > 0 && name[n - 1] == '/') n--;
+    if (n == 0 || (n == 1 && name[0] == '.')) {
+        *skip = 1;
+        return NULL;
+    }
+    for (const char *p = name; p < name + n;) {
+        const char *slash = memchr(p, '/', (size_t)(name + n - p));
+        size_t part = slash ? (size_t)(slash - p) : (size_t)(name + n - p);
+        if (part == 2 && p[0] == '.' && p[1] == '.') return NULL;
+        p += part + 1;
+    }
+    size_t dlen = strlen(u->dest);
+    if (dlen + 1 + n >= PATH_MAX) return NULL;
+    char *out = malloc(dlen + 1 + n + 1);
+    if (!out) return NULL;
+    memcpy(out, u->dest, dlen);
+    out[dlen] = '/';
+    memcpy(out + dlen + 1, name, n);
+    out[dlen + 1 + n] = '\0';
+    return out;
+}
+
+// Nothing is written through an extracted symlink, whatever it points at.
+static int jessi_unpack_under_symlink(const jessi_unpack *u, const char *rel) {
+    for (size_t i = 0; i < u->symlink_count; i++) {
+        size_t n = strlen(u->symlinks[i]);
+        if (strncmp(rel, u->symlinks[i], n) == 0 && rel[n] == '/') return 1;
+    }
+    return 0;
+}
+
+// Symlink targets must stay inside dest: not absolute, and ".." only as leading components that
+// climb no higher than the link's own directory depth. Leading-only keeps the climb within real
+// directories, since nothing is ever extracted under a symlink.
+static int jessi_unpack_symlink_target_ok(const char *rel, const char *target) {
+    if (target[0] == '/') return 0;
+    int depth = 0;
+    for (const char *p = rel; *p; p++) depth += *p == '/';
+    int descended = 0;
+    for (const char *p = target; *p;) {
+        const char *slash = strchr(p, '/');
+        size_t part = slash ? (size_t)(slash - p) : strlen(p);
+        if (part == 2 && p[0] == '.' && p[1] == '.') {
+            if (descended || --depth < 0) return 0;
+        } else if (part > 0 && !(part == 1 && p[0] == '.')) {
+            descended = 1;
+        }
+        p += part + (slash ? 1 : 0);
+    }
+    return 1;
+}
+
+static jessi_unpack_status jessi_unpack_note_symlink(jessi_unpack *u, const char *rel) {
+    if (u->symlink_count == u->symlink_cap) {
+        size_t cap = u->symlink_cap ? u->symlink_cap * 2 : 16;
+        char **grown = realloc(u->symlinks, cap * sizeof(*grown));
+        if (!grown) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+        u->symlinks = grown;
+        u->symlink_cap = cap;
+    }
+    char *copy = strdup(rel);
+    if (!copy) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+    u->symlinks[u->symlink_count++] = copy;
+    return JESSI_UNPACK_OK;
+}
+
+static void jessi_tar_take(char **dst, char **src) {
+    free(*dst);
+    *dst = *src;
+    *src = NULL;
+}
+
+static void jessi_tar_apply_pax(jessi_unpack *u) {
+    // Records are "<len> <key>=<value>\n".
+    size_t off = 0;
+    while (off < u->meta_len) {
+        char *end = NULL;
+        unsigned long rec = strtoul(u->meta + off, &end, 10);
+        if (!end || *end != ' ' || rec == 0 || off + rec > u->meta_len) break;
+        char *kv = end + 1;
+        char *rec_end = u->meta + off + rec - 1;  // the '\n'
+        char *eq = memchr(kv, '=', (size_t)(rec_end - kv));
+        if (eq) {
+            size_t klen = (size_t)(eq - kv);
+            size_t vlen = (size_t)(rec_end - eq - 1);
+            char **slot = NULL;
+            if (klen == 4 && memcmp(kv, "path", 4) == 0) slot = &u->pax_path;
+            else if (klen == 8 && memcmp(kv, "linkpath", 8) == 0) slot = &u->pax_link;
+            if (slot) {
+                free(*slot);
+                *slot = malloc(vlen + 1);
+                if (*slot) {
+                    memcpy(*slot, eq + 1, vlen);
+                    (*slot)[vlen] = '\0';
+                }
+            }
+        }
+        off += rec;
+    }
+}
+
+static jessi_unpack_status jessi_tar_header(jessi_unpack *u) {
+    const uint8_t *b = u->block;
+    int zero = 1;
+    for (int i = 0; i < 512 && zero; i++) zero = b[i] == 0;
+    if (zero) {
+        if (++u->zero_blocks >= 2) u->tstate = JESSI_TAR_END;
+        return JESSI_UNPACK_OK;
+    }
+    u->zero_blocks = 0;
+    if (!jessi_tar_checksum_ok(b)) return jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "tar header checksum mismatch");
+
+    uint64_t size = jessi_tar_number(b + 124, 12);
+    mode_t mode = (mode_t)(jessi_tar_number(b + 100, 8) & 07777);
+    char type = (char)b[156];
+    u->remaining = size;
+    u->pad = (size_t)((512 - (size % 512)) % 512);
+
+    if (type == 'L' || type == 'K' || type == 'x') {
+        if (size > JESSI_UNPACK_META_MAX) return jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "tar metadata entry too large");
+        free(u->meta);
+        u->meta = malloc((size_t)size + 1);
+        if (!u->meta) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+        u->meta_len = 0;
+        u->meta_kind = type == 'L' ? JESSI_META_LONGNAME : type == 'K' ? JESSI_META_LONGLINK : JESSI_META_PAX;
+        u->tstate = size ? JESSI_TAR_META : JESSI_TAR_PAD;
+        if (!size) u->meta[0] = '\0';
+        return JESSI_UNPACK_OK;
+    }
+
+    char *name = NULL;
+    if (u->pax_path) jessi_tar_take(&name, &u->pax_path);
+    else if (u->long_name) jessi_tar_take(&name, &u->long_name);
+    else {
+        char *base = jessi_tar_string(b, 100);
+        char *prefix = memcmp(b + 257, "ustar", 5) == 0 ? jessi_tar_string(b + 345, 155) : NULL;
+        if (base && prefix && prefix[0]) {
+            size_t n = strlen(prefix) + 1 + strlen(base) + 1;
+            name = malloc(n);
+            if (name) snprintf(name, n, "%s/%s", prefix, base);
+            free(base);
+        } else {
+            name = base;
+        }
+        free(prefix);
+    }
+    char *linkname = NULL;
+    if (u->pax_link) jessi_tar_take(&linkname, &u->pax_link);
+    else if (u->long_link) jessi_tar_take(&linkname, &u->long_link);
+    else linkname = jessi_tar_string(b + 157, 100);
+    free(u->long_name);
+    u->long_name = NULL;
+    free(u->long_link);
+    u->long_link = NULL;
+    if (!name || !linkname) {
+        free(name);
+        free(linkname);
+        return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+    }
+
+    int skip = 0;
+    char *path = jessi_unpack_join(u, name, &skip);
+    jessi_unpack_status st = JESSI_UNPACK_OK;
+    const char *rel = path ? path + strlen(u->dest) + 1 : NULL;
+    if (!path && !skip) {
+        st = jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "unsafe path in archive: %s", name);
+    } else if (rel && jessi_unpack_under_symlink(u, rel)) {
+        st = jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "archive entry under a symlink: %s", name);
+    } else if (skip) {
+        u->tstate = size ? JESSI_TAR_SKIP : JESSI_TAR_PAD;
+    } else if (type == '0' || type == '\0' || type == '7') {
+        st = jessi_unpack_push_op(u, JESSI_OP_OPEN, path, NULL, mode);
+        u->stats.entries++;
+        u->tstate = JESSI_TAR_FILE;
+    } else if (type == '5') {
+        st = jessi_unpack_push_op(u, JESSI_OP_MKDIR, path, NULL, mode);
+        u->stats.entries++;
+        u->tstate = size ? JESSI_TAR_SKIP : JESSI_TAR_PAD;
+    } else if (type == '2') {
+        if (linkname[0] && !jessi_unpack_symlink_target_ok(rel, linkname)) {
+            st = jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "unsafe symlink in archive: %s -> %s", name, linkname);
+        } else if (linkname[0]) {
+            st = jessi_unpack_note_symlink(u, rel);
+            if (st == JESSI_UNPACK_OK) st = jessi_unpack_push_op(u, JESSI_OP_SYMLINK, path, linkname, 0);
+            u->stats.entries++;
+        }
+        u->tstate = size ? JESSI_TAR_SKIP : JESSI_TAR_PAD;
+    } else if (type == '1') {
+        int link_skip = 0;
+        char *source = jessi_unpack_join(u, linkname, &link_skip);
+        if (source && jessi_unpack_under_symlink(u, source + strlen(u->dest) + 1)) {
+            st = jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "hard link through a symlink in archive: %s", linkname);
+        } else if (source) {
+            st = jessi_unpack_push_op(u, JESSI_OP_LINK, path, source, 0);
+            u->stats.entries++;
+        } else if (!link_skip) {
+            st = jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "unsafe hard link in archive: %s", linkname);
+        }
+        free(source);
+        u->tstate = size ? JESSI_TAR_SKIP : JESSI_TAR_PAD;
+    } else {
+        u->tstate = size ? JESSI_TAR_SKIP : JESSI_TAR_PAD;
+    }
+    // Close the file right away when it's empty.
+    if (st == JESSI_UNPACK_OK && u->tstate == JESSI_TAR_FILE && size == 0) {
+        st = jessi_unpack_push_op(u, JESSI_OP_CLOSE, path, NULL, mode);
+        u->tstate = JESSI_TAR_PAD;
+    } else if (u->tstate == JESSI_TAR_FILE) {
+        free(u->file_path);
+        u->file_path = path;
+        u->file_mode = mode;
+        path = NULL;
+    }
+    free(path);
+    free(name);
+    free(linkname);
+    return st;
+}
+
+static jessi_unpack_status jessi_tar_push(jessi_unpack *u, const uint8_t *p, size_t len) {
+    while (len > 0 && u->status == JESSI_UNPACK_OK) {
+        switch (u->tstate) {
+            case JESSI_TAR_HEADER: {
+                size_t n = 512 - u->block_len;
+                if (n > len) n = len;
+                memcpy(u->block + u->block_len, p, n);
+                u->block_len += n;
+                p += n;
+                len -= n;
+                if (u->block_len == 512) {
+                    u->block_len = 0;
+                    jessi_tar_header(u);
+                }
+                break;
+            }
+            case JESSI_TAR_FILE: {
+                size_t n = u->remaining < len ? (size_t)u->remaining : len;
+                while (n > 0) {
+                    if (!u->chunk) {
+                        u->chunk = malloc(JESSI_UNPACK_WRITE_CHUNK);
+                        if (!u->chunk) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "out of memory");
+                    }
+                    size_t take = JESSI_UNPACK_WRITE_CHUNK - u->chunk_len;
+                    if (take > n) take = n;
+                    memcpy(u->chunk + u->chunk_len, p, take);
+                    u->chunk_len += take;
+                    p += take;
+                    len -= take;
+                    n -= take;
+                    u->remaining -= take;
+                    if (u->chunk_len == JESSI_UNPACK_WRITE_CHUNK && jessi_unpack_flush_chunk(u) != JESSI_UNPACK_OK) {
+                        return u->status;
+                    }
+                }
+                if (u->remaining == 0) {
+                    if (jessi_unpack_flush_chunk(u) != JESSI_UNPACK_OK) return u->status;
+                    jessi_unpack_push_op(u, JESSI_OP_CLOSE, u->file_path, NULL, u->file_mode);
+                    free(u->file_path);
+                    u->file_path = NULL;
+                    u->tstate = JESSI_TAR_PAD;
+                }
+                break;
+            }
+            case JESSI_TAR_META: {
+                size_t n = u->remaining < len ? (size_t)u->remaining : len;
+                memcpy(u->meta + u->meta_len, p, n);
+                u->meta_len += n;
+                u->remaining -= n;
+                p += n;
+                len -= n;
+                if (u->remaining == 0) {
+                    u->meta[u->meta_len] = '\0';
+                    if (u->meta_kind == JESSI_META_PAX) {
+                        jessi_tar_apply_pax(u);
+                        free(u->meta);
+                    } else {
+                        jessi_tar_take(u->meta_kind == JESSI_META_LONGNAME ? &u->long_name : &u->long_link, &u->meta);
+                    }
+                    u->meta = NULL;
+                    u->meta_len = 0;
+                    u->tstate = JESSI_TAR_PAD;
+                }
+                break;
+            }
+            case JESSI_TAR_SKIP: {
+                size_t n = u->remaining < len ? (size_t)u->remaining : len;
+                u->remaining -= n;
+                p += n;
+                len -= n;
+                if (u->remaining == 0) u->tstate = JESSI_TAR_PAD;
+                break;
+            }
+            case JESSI_TAR_PAD: {
+                size_t n = u->pad < len ? u->pad : len;
+                u->pad -= n;
+                p += n;
+                len -= n;
+                if (u->pad == 0) u->tstate = JESSI_TAR_HEADER;
+                break;
+            }
+            case JESSI_TAR_END:
+                // Trailing zero blocks past the end marker.
+                return JESSI_UNPACK_OK;
+        }
+        // A header can leave PAD with nothing to skip.
+        if (u->tstate == JESSI_TAR_PAD && u->pad == 0) u->tstate = JESSI_TAR_HEADER;
+    }
+    return u->status;
+}
+
+// MARK: - Containers
+
+static jessi_unpack_status jessi_xz_push(jessi_unpack *u, const uint8_t *in, size_t len) {
+    if (!u->xz_started) {
+        if (jessi_codec_init(&u->xz, JESSI_CODEC_XZ) != 0) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "xz decoder unavailable");
+        u->xz_started = 1;
+    }
+    while (!u->xz_done && u->status == JESSI_UNPACK_OK) {
+        size_t used = 0, made = 0;
+        int r = jessi_codec_run(&u->xz, in, len, &used, u->xz_out, sizeof(u->xz_out), &made);
+        in += used;
+        len -= used;
+        if (made) {
+            u->stats.tar_bytes += made;
+            if (jessi_tar_push(u, u->xz_out, made) != JESSI_UNPACK_OK) break;
+        }
+        if (r < 0) return jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "xz stream is corrupt or uses an unsupported filter");
+        if (r == 1) {
+            u->xz_done = 1;
+            break;
+        }
+        if (made == sizeof(u->xz_out)) continue;
+        if (len == 0) break;
+        if (used == 0) return jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "xz decoder made no progress");
+    }
+    return u->status;
+}
+
+static uint16_t jessi_le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t jessi_le32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint64_t jessi_le64(const uint8_t *p) { return (uint64_t)jessi_le32(p) | ((uint64_t)jessi_le32(p + 4) << 32); }
+
+static int jessi_ends_with(const char *s, size_t len, const char *suffix) {
+    size_t n = strlen(suffix);
+    return len >= n && memcmp(s + len - n, suffix, n) == 0;
+}
+
+static jessi_unpack_status jessi_zip_begin_entry(jessi_unpack *u) {
+    const uint8_t *h = u->head;
+    u->zip_flags = jessi_le16(h + 6);
+    u->zip_method = jessi_le16(h + 8);
+    uint64_t csize = jessi_le32(h + 18);
+    uint16_t name_len = jessi_le16(h + 26);
+    uint16_t extra_len = jessi_le16(h + 28);
+    const char *name = (const char *)h + 30;
+    const uint8_t *extra = h + 30 + name_len;
+
+    u->zip_is64 = 0;
+    if (csize == 0xffffffffu) {
+        // Zip64: the extra field carries the real sizes (uncompressed first).
+        for (size_t off = 0; off + 4 <= extra_len;) {
+            uint16_t id = jessi_le16(extra + off);
+            uint16_t sz = jessi_le16(extra + off + 2);
+            if (id == 0x0001 && sz >= 16) {
+                csize = jessi_le64(extra + off + 4 + 8);
+                u->zip_is64 = 1;
+                break;
+            }
+            off += 4u + sz;
+        }
+    }
+
+    u->zip_target = !u->zip_target_done && jessi_ends_with(name, name_len, ".tar.xz");
+    if (u->zip_flags & 0x1) return jessi_unpack_fail(u, JESSI_UNPACK_UNSUPPORTED, "encrypted zip entry");
+    if (u->zip_method != 0 && u->zip_method != 8) {
+        return jessi_unpack_fail(u, JESSI_UNPACK_UNSUPPORTED, "zip compression method %u", u->zip_method);
+    }
+    if (u->zip_method == 0 && (u->zip_flags & 0x8)) {
+        return jessi_unpack_fail(u, JESSI_UNPACK_UNSUPPORTED, "stored zip entry without a size");
+    }
+    if (u->zip_method == 8) {
+        jessi_codec_end(&u->inflater);
+        if (jessi_codec_init(&u->inflater, JESSI_CODEC_DEFLATE) != 0) return jessi_unpack_fail(u, JESSI_UNPACK_IO, "inflate unavailable");
+    }
+    u->zip_remaining = csize;
+    u->cstate = JESSI_ZIP_DATA;
+    return JESSI_UNPACK_OK;
+}
+
+static void jessi_zip_end_entry(jessi_unpack *u) {
+    if (u->zip_target) {
+        u->zip_target_done = 1;
+        // Everything after the runtime archive (other entries, central directory) is ignored.
+        u->cstate = JESSI_ZIP_DONE;
+        return;
+    }
+    u->head_len = 0;
+    if (u->zip_flags & 0x8) {
+        u->head_need = 4;
+        u->cstate = JESSI_ZIP_DESCRIPTOR;
+    } else {
+        u->head_need = 30;
+        u->cstate = JESSI_ZIP_HEADER;
+    }
+}
+
+// Consumes entry data; returns how much of p belonged to this entry.
+static size_t jessi_zip_data(jessi_unpack *u, const uint8_t *p, size_t len) {
+    if (u->zip_method == 0) {
+        size_t n = u->zip_remaining < len ? (size_t)u->zip_remaining : len;
+        if (u->zip_target) jessi_xz_push(u, p, n);
+        u->zip_remaining -= n;
+        if (u->zip_remaining == 0) jessi_zip_end_entry(u);
+        return n;
+    }
+    size_t total = 0;
+    while (u->status == JESSI_UNPACK_OK) {
+        size_t used = 0, made = 0;
+        int r = jessi_codec_run(&u->inflater, p, len, &used, u->inflate_out, sizeof(u->inflate_out), &made);
+        p += used;
+        len -= used;
+        total += used;
+        if (made && u->zip_target) jessi_xz_push(u, u->inflate_out, made);
+        if (r < 0) {
+            jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "zip entry is corrupt");
+            break;
+        }
+        if (r == 1) {
+            jessi_codec_end(&u->inflater);
+            jessi_zip_end_entry(u);
+            break;
+        }
+        if (made == sizeof(u->inflate_out)) continue;
+        if (len == 0) break;
+        if (used == 0) {
+            jessi_unpack_fail(u, JESSI_UNPACK_CORRUPT, "inflate made no progress");
+            break;
+        }
+    }
+    return total;
+}
+
+static jessi_unpack_status jessi_container_push(jessi_unpack *u, const uint8_t *p, size_t len) {
+    while (len > 0 && u->status == JESSI_UNPACK_OK) {
+        switch (u->cstate) {
+            case JESSI_SNIFF:
+            case JESSI_ZIP_HEADER:
+            case JESSI_ZIP_NAME:
+            case JESSI_ZIP_DESCRIPTOR: {
+                size_t n = u->head_need - u->head_len;
+                if (n > len) n = len;
+                memcpy(u->head + u->head_len, p, n);
+                u->head_len += n;
+                p += n;
+                len -= n;
+                if (u->head_len < u->head_need) break;
+
+                if (u->cstate == JESSI_SNIFF) {
+                    static const uint8_t xz_magic[6] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+                    if (memcmp(u->head, xz_magic, 6) == 0) {
+                        u->cstate = JESSI_XZ;
+                        jessi_xz_push(u, u->head, u->head_len);
+                    } else if (jessi_le32(u->head) == 0x04034b50) {
+                        u->cstate = JESSI_ZIP_HEADER;
+                        u->head_need = 30;
+                    } else {
+                        return jessi_unpack_fail(u, JESSI_UNPACK_UNSUPPORTED, "not a .tar.xz or .zip download");
+                    }
+                } else if (u->cstate == JESSI_ZIP_HEADER) {
+                    uint32_t sig = jessi_le32(u->head);
+                    if (sig != 0x04034b50) {
+                        // Central directory before any .tar.xz entry, or something we can't follow.
+                        return jessi_unpack_fail(u, sig == 0x02014b50 ? JESSI_UNPACK_CORRUPT : JESSI_UNPACK_UNSUPPORTED,
+                                                 sig == 0x02014b50 ? "runtime archive did not contain a .tar.xz"
+                                                                   : "unexpected zip record");
+                    }
+                    u->head_need = 30 + (size_t)jessi_le16(u->head + 26) + jessi_le16(u->head + 28);
+                    u->cstate = JESSI_ZIP_NAME;
+                } else if (u->cstate == JESSI_ZIP_NAME) {
+                    jessi_zip_begin_entry(u);
+                } else {
+                    // Data descriptor: optional signature, crc32, then both sizes (8 bytes each for zip64).
+                    if (u->head_len == 4) {
+                        size_t rest = u->zip_is64 ? 20 : 12;
+                        u->head_need = jessi_le32(u->head) == 0x08074b50 ? 4 + rest : rest;
+                    } else {
+                        u->head_len = 0;
+                        u->head_need = 30;
+                        u->cstate = JESSI_ZIP_HEADER;
+                    }
+                }
+                break;
+            }
+            case JESSI_ZIP_DATA: {
+                size_t used = jessi_zip_data(u, p, len);
+                p += used;
+                len -= used;
+                break;
+            }
+            case JESSI_ZIP_DONE:
+                return u->status;
+            case JESSI_XZ:
+                jessi_xz_push(u, p, len);
+                return u->status;
+        }
+    }
+    return u->status;
+}
+
+// MARK: - API
+
+jessi_unpack *jessi_unpack_create(const char *dest_dir, size_t max_queued) {
+    if (!dest_dir || !dest_dir[0]) return NULL;
+    jessi_unpack *u = calloc(1, sizeof(*u));
+    if (!u) return NULL;
+    u->dest = strdup(dest_dir);
+    size_t dlen = u->dest ? strlen(u->dest) : 0;
+    while (dlen > 1 && u->dest[dlen - 1] == '/') u->dest[--dlen] = '\0';
+    u->max_queued = max_queued ? max_queued : JESSI_UNPACK_DEFAULT_QUEUE;
+    if (u->max_queued < JESSI_UNPACK_WRITE_CHUNK + JESSI_UNPACK_OP_COST) u->max_queued = JESSI_UNPACK_WRITE_CHUNK + JESSI_UNPACK_OP_COST;
+    u->head_need = 6;
+    u->cstate = JESSI_SNIFF;
+    u->tstate = JESSI_TAR_HEADER;
+    pthread_mutex_init(&u->lock, NULL);
+    pthread_cond_init(&u->cond, NULL);
+    if (!u->dest || pthread_create(&u->writer, NULL, jessi_unpack_writer_main, u) != 0) {
+        jessi_unpack_destroy(u);
+        return NULL;
+    }
+    u->writer_started = 1;
+    return u;
+}
+
+jessi_unpack_status jessi_unpack_feed(jessi_unpack *u, const void *bytes, size_t len) {
+    if (!u) return JESSI_UNPACK_IO;
+    if (u->status != JESSI_UNPACK_OK) return u->status;
+    u->stats.bytes_in += len;
+    if (jessi_container_push(u, bytes, len) != JESSI_UNPACK_OK) return u->status;
+    return jessi_unpack_writer_status(u);
+}
+
+jessi_unpack_status jessi_unpack_finish(jessi_unpack *u) {
+    if (!u) return JESSI_UNPACK_IO;
+    if (u->status == JESSI_UNPACK_OK) {
+        if (u->cstate == JESSI_SNIFF || !u->xz_done) {
+            jessi_unpack_fail(u, JESSI_UNPACK_TRUNCATED, "download ended before the archive did");
+        } else if (u->tstate != JESSI_TAR_END && !(u->tstate == JESSI_TAR_HEADER && u->block_len == 0)) {
+            jessi_unpack_fail(u, JESSI_UNPACK_TRUNCATED, "tar stream ended mid-entry");
+        }
+    }
+    // queued drops only after an op is applied, so this also covers the one in flight.
+    pthread_mutex_lock(&u->lock);
+    while (u->queued > 0 && !u->writer_failed) pthread_cond_wait(&u->cond, &u->lock);
+    pthread_mutex_unlock(&u->lock);
+    if (u->status != JESSI_UNPACK_OK) return u->status;
+    return jessi_unpack_writer_status(u);
+}
+
+const char *jessi_unpack_error(const jessi_unpack *u) {
+    return u && u->error[0] ? u->error : "";
+}
+
+void jessi_unpack_get_stats(const jessi_unpack *u, jessi_unpack_stats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!u) return;
+    *out = u->stats;
+    out->file_bytes = __atomic_load_n(&u->stats.file_bytes, __ATOMIC_RELAXED);
+}
+
+void jessi_unpack_destroy(jessi_unpack *u) {
+    if (!u) return;
+    if (u->writer_started) {
+        pthread_mutex_lock(&u->lock);
+        // Unfinished work isn't wanted once the caller gives up.
+        jessi_unpack_op *op = u->q_head;
+        u->q_head = u->q_tail = NULL;
+        u->closing = 1;
+        pthread_cond_broadcast(&u->cond);
+        pthread_mutex_unlock(&u->lock);
+        while (op) {
+            jessi_unpack_op *next = op->next;
+            jessi_unpack_free_op(op);
+            op = next;
+        }
+        pthread_join(u->writer, NULL);
+    }
+    jessi_codec_end(&u->inflater);
+    jessi_codec_end(&u->xz);
+    pthread_mutex_destroy(&u->lock);
+    pthread_cond_destroy(&u->cond);
+    free(u->chunk);
+    free(u->meta);
+    free(u->file_path);
+    for (size_t i = 0; i < u->symlink_count; i++) free(u->symlinks[i]);
+    free(u->symlinks);
+    free(u->long_name);
+    free(u->long_link);
+    free(u->pax_path);
+    free(u->pax_link);
+    free(u->dest);
+    free(u);
+}
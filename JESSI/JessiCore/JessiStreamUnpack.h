@@ -0,0 +1,55 @@
+#ifndef JessiStreamUnpack_h
+#define JessiStreamUnpack_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Unpacks a runtime download while it arrives: .tar.xz, or a .zip holding one (stored or
+// deflated). Bytes go zip -> xz -> tar in fixed-size buffers, and file writes are queued to a
+// writer thread, so memory stays bounded by max_queued no matter how large the runtime is.
+// feed() blocks while the writer is behind, which in turn slows the network reader.
+
+typedef enum {
+    JESSI_UNPACK_OK = 0,
+    // Valid archive that can't be streamed (encrypted zip, stored entry of unknown size,
+    // another compression method...). Nothing is wrong with the bytes; use a buffered path.
+    JESSI_UNPACK_UNSUPPORTED = 1,
+    JESSI_UNPACK_CORRUPT = 2,
+    JESSI_UNPACK_IO = 3,
+    // finish() before the archive ended.
+    JESSI_UNPACK_TRUNCATED = 4,
+} jessi_unpack_status;
+
+typedef struct {
+    uint64_t bytes_in;       // archive bytes fed
+    uint64_t tar_bytes;      // decompressed tar stream
+    uint64_t file_bytes;     // written to files
+    uint64_t entries;        // files, directories and links created
+    uint64_t writer_stalls;  // times feed() waited for the writer
+    uint64_t peak_queued;    // high-water mark of bytes waiting for the writer
+} jessi_unpack_stats;
+
+typedef struct jessi_unpack jessi_unpack;
+
+// dest_dir must exist. max_queued 0 picks the default (8 MB).
+jessi_unpack *jessi_unpack_create(const char *dest_dir, size_t max_queued);
+
+// Errors are sticky: once a call fails, later calls return the same status.
+jessi_unpack_status jessi_unpack_feed(jessi_unpack *u, const void *bytes, size_t len);
+// Checks the archive ended cleanly and waits for every queued write to land.
+jessi_unpack_status jessi_unpack_finish(jessi_unpack *u);
+
+const char *jessi_unpack_error(const jessi_unpack *u);
+void jessi_unpack_get_stats(const jessi_unpack *u, jessi_unpack_stats *out);
+// Stops the writer (dropping queued work if finish wasn't called) and frees everything.
+void jessi_unpack_destroy(jessi_unpack *u);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
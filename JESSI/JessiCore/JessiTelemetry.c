@@ -0,0 +1,307 @@
+#include "JessiTelemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <sys/resource.h>
+#if __has_include(<libproc.h>)
+#include <libproc.h>
+#define JESSI_TELEMETRY_HAS_LIBPROC 1
+#else
+// Not in the iOS SDK headers, but exported by libsystem.
+extern int proc_pid_rusage(int pid, int flavor, rusage_info_t *buffer);
+#endif
+#elif defined(__linux__)
+#include <fcntl.h>
+#endif
+
+static uint64_t jessi_telemetry_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static double jessi_telemetry_wall_time(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+}
+
+#if defined(__APPLE__)
+
+// rusage_info times are mach absolute units on arm64, not nanoseconds.
+static uint64_t jessi_mach_to_ns(uint64_t t) {
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+    if (tb.numer == tb.denom) return t;
+    return t / tb.denom * tb.numer + (t % tb.denom) * tb.numer / tb.denom;
+}
+
+static int jessi_telemetry_read_rusage(pid_t pid, jessi_telemetry_sample *out, int want_memory, int want_cpu) {
+    struct rusage_info_v2 ri;
+    if (proc_pid_rusage(pid, RUSAGE_INFO_V2, (rusage_info_t *)&ri) != 0) return -1;
+    out->disk_read_bytes = ri.ri_diskio_bytesread;
+    out->disk_write_bytes = ri.ri_diskio_byteswritten;
+    if (want_memory) {
+        out->resident_bytes = ri.ri_resident_size;
+        out->footprint_bytes = ri.ri_phys_footprint;
+    }
+    if (want_cpu) {
+        out->cpu_user_ns = jessi_mach_to_ns(ri.ri_user_time);
+        out->cpu_system_ns = jessi_mach_to_ns(ri.ri_system_time);
+    }
+    return 0;
+}
+
+static int jessi_telemetry_read_self(jessi_telemetry_sample *out) {
+    task_t task = mach_task_self();
+
+    task_vm_info_data_t vm;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(task, TASK_VM_INFO, (task_info_t)&vm, &count) != KERN_SUCCESS) return -1;
+    out->resident_bytes = vm.resident_size;
+    out->footprint_bytes = vm.phys_footprint;
+
+    // Terminated threads are accounted in basic info, live ones in thread times.
+    mach_task_basic_info_data_t basic;
+    count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(task, MACH_TASK_BASIC_INFO, (task_info_t)&basic, &count) == KERN_SUCCESS) {
+        out->cpu_user_ns = (uint64_t)basic.user_time.seconds * 1000000000ull + (uint64_t)basic.user_time.microseconds * 1000ull;
+        out->cpu_system_ns = (uint64_t)basic.system_time.seconds * 1000000000ull + (uint64_t)basic.system_time.microseconds * 1000ull;
+    }
+    task_thread_times_info_data_t times;
+    count = TASK_THREAD_TIMES_INFO_COUNT;
+    if (task_info(task, TASK_THREAD_TIMES_INFO, (task_info_t)&times, &count) == KERN_SUCCESS) {
+        out->cpu_user_ns += (uint64_t)times.user_time.seconds * 1000000000ull + (uint64_t)times.user_time.microseconds * 1000ull;
+        out->cpu_system_ns += (uint64_t)times.system_time.seconds * 1000000000ull + (uint64_t)times.system_time.microseconds * 1000ull;
+    }
+
+    thread_act_array_t threads = NULL;
+    mach_msg_type_number_t thread_count = 0;
+    out->threads = -1;
+    if (task_threads(task, &threads, &thread_count) == KERN_SUCCESS) {
+        out->threads = (int32_t)thread_count;
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            mach_port_deallocate(task, threads[i]);
+        }
+        vm_deallocate(task, (vm_address_t)threads, sizeof(thread_act_t) * thread_count);
+    }
+
+    jessi_telemetry_read_rusage(getpid(), out, 0, 0);
+    return 0;
+}
+
+static int jessi_telemetry_read_pid(pid_t pid, jessi_telemetry_sample *out) {
+    if (jessi_telemetry_read_rusage(pid, out, 1, 1) != 0) return -1;
+    out->threads = -1;
+#if JESSI_TELEMETRY_HAS_LIBPROC
+    struct proc_taskinfo ti;
+    if (proc_pidinfo(pid, PROC_PIDTASKINFO, 0, &ti, sizeof(ti)) == (int)sizeof(ti)) {
+        out->threads = ti.pti_threadnum;
+    }
+#endif
+    return 0;
+}
+
+#elif defined(__linux__)
+
+static int jessi_telemetry_read_file(const char *path, char *buf, size_t cap) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, cap - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = 0;
+    return 0;
+}
+
+static int jessi_telemetry_read_proc(pid_t pid, jessi_telemetry_sample *out) {
+    char path[64];
+    char buf[4096];
+    if (pid > 0) snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    else snprintf(path, sizeof(path), "/proc/self/stat");
+    if (jessi_telemetry_read_file(path, buf, sizeof(buf)) != 0) return -1;
+
+    // The command name may contain spaces; fields resume after the last ')'.
+    char *p = strrchr(buf, ')');
+    if (!p) return -1;
+    p += 2;
+    unsigned long long utime = 0, stime = 0;
+    long threads = -1, rss = 0;
+    int field = 3;
+    char *save = NULL;
+    for (char *tok = strtok_r(p, " ", &save); tok; tok = strtok_r(NULL, " ", &save), field++) {
+        if (field == 14) utime = strtoull(tok, NULL, 10);
+        else if (field == 15) stime = strtoull(tok, NULL, 10);
+        else if (field == 20) threads = strtol(tok, NULL, 10);
+        else if (field == 24) { rss = strtol(tok, NULL, 10); break; }
+    }
+    long hz = sysconf(_SC_CLK_TCK);
+    if (hz <= 0) hz = 100;
+    out->cpu_user_ns = utime * (1000000000ull / (unsigned long long)hz);
+    out->cpu_system_ns = stime * (1000000000ull / (unsigned long long)hz);
+    out->threads = (int32_t)threads;
+    out->resident_bytes = (uint64_t)rss * (uint64_t)sysconf(_SC_PAGESIZE);
+    out->footprint_bytes = out->resident_bytes;
+
+    if (pid > 0) snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+    else snprintf(path, sizeof(path), "/proc/self/io");
+    if (jessi_telemetry_read_file(path, buf, sizeof(buf)) == 0) {
+        char *r = strstr(buf, "\nread_bytes: ");
+        char *w = strstr(buf, "\nwrite_bytes: ");
+        if (r) out->disk_read_bytes = strtoull(r + 13, NULL, 10);
+        if (w) out->disk_write_bytes = strtoull(w + 14, NULL, 10);
+    }
+    return 0;
+}
+
+#endif
+
+int jessi_telemetry_read(pid_t pid, jessi_telemetry_sample *out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    out->timestamp_ns = jessi_telemetry_now_ns();
+    out->wall_time = jessi_telemetry_wall_time();
+#if defined(__APPLE__)
+    if (pid == 0 || pid == getpid()) return jessi_telemetry_read_self(out);
+    return jessi_telemetry_read_pid(pid, out);
+#elif defined(__linux__)
+    return jessi_telemetry_read_proc(pid, out);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+struct jessi_telemetry_ring {
+    jessi_telemetry_sample *samples;
+    size_t capacity;
+    size_t head;
+    size_t count;
+};
+
+jessi_telemetry_ring *jessi_telemetry_ring_create(size_t capacity) {
+    if (capacity == 0) return NULL;
+    jessi_telemetry_ring *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    r->samples = calloc(capacity, sizeof(jessi_telemetry_sample));
+    if (!r->samples) {
+        free(r);
+        return NULL;
+    }
+    r->capacity = capacity;
+    return r;
+}
+
+static const jessi_telemetry_sample *jessi_telemetry_ring_at(const jessi_telemetry_ring *r, size_t idx) {
+    return &r->samples[(r->head + r->capacity - r->count + idx) % r->capacity];
+}
+
+void jessi_telemetry_ring_push(jessi_telemetry_ring *r, jessi_telemetry_sample *s) {
+    if (!r || !s) return;
+    s->cpu_percent = 0;
+    s->disk_read_bps = 0;
+    s->disk_write_bps = 0;
+    if (r->count) {
+        const jessi_telemetry_sample *prev = jessi_telemetry_ring_at(r, r->count - 1);
+        if (s->timestamp_ns > prev->timestamp_ns) {
+            double dt = (double)(s->timestamp_ns - prev->timestamp_ns) / 1e9;
+            uint64_t cpu = s->cpu_user_ns + s->cpu_system_ns;
+            uint64_t prev_cpu = prev->cpu_user_ns + prev->cpu_system_ns;
+            if (cpu >= prev_cpu) s->cpu_percent = (double)(cpu - prev_cpu) / 1e9 / dt * 100.0;
+            if (s->disk_read_bytes >= prev->disk_read_bytes) s->disk_read_bps = (double)(s->disk_read_bytes - prev->disk_read_bytes) / dt;
+            if (s->disk_write_bytes >= prev->disk_write_bytes) s->disk_write_bps = (double)(s->disk_write_bytes - prev->disk_write_bytes) / dt;
+        }
+    }
+    r->samples[r->head] = *s;
+    r->head = (r->head + 1) % r->capacity;
+    if (r->count < r->capacity) r->count++;
+}
+
+size_t jessi_telemetry_ring_count(const jessi_telemetry_ring *r) {
+    return r ? r->count : 0;
+}
+
+int jessi_telemetry_ring_get(const jessi_telemetry_ring *r, size_t idx, jessi_telemetry_sample *out) {
+    if (!r || idx >= r->count || !out) return -1;
+    *out = *jessi_telemetry_ring_at(r, idx);
+    return 0;
+}
+
+void jessi_telemetry_ring_clear(jessi_telemetry_ring *r) {
+    if (!r) return;
+    r->head = 0;
+    r->count = 0;
+}
+
+void jessi_telemetry_ring_destroy(jessi_telemetry_ring *r) {
+    if (!r) return;
+    free(r->samples);
+    free(r);
+}
+
+static void jessi_stat_add(jessi_telemetry_stat *st, double v, size_t n) {
+    if (n == 0 || v < st->min) st->min = v;
+    if (n == 0 || v > st->max) st->max = v;
+    st->avg += v;
+}
+
+size_t jessi_telemetry_ring_rollup(const jessi_telemetry_ring *r, double window_seconds, jessi_telemetry_rollup *out) {
+    if (!out) return 0;
+    memset(out, 0, sizeof(*out));
+    if (!r || r->count == 0) return 0;
+
+    const jessi_telemetry_sample *last = jessi_telemetry_ring_at(r, r->count - 1);
+    uint64_t window_ns = window_seconds > 0 ? (uint64_t)(window_seconds * 1e9) : UINT64_MAX;
+    size_t n = 0;
+    uint64_t first_ts = last->timestamp_ns;
+    for (size_t i = r->count; i-- > 0;) {
+        const jessi_telemetry_sample *s = jessi_telemetry_ring_at(r, i);
+        if (last->timestamp_ns - s->timestamp_ns > window_ns) break;
+        const double mb = 1024.0 * 1024.0;
+        jessi_stat_add(&out->resident_mb, (double)s->resident_bytes / mb, n);
+        jessi_stat_add(&out->footprint_mb, (double)s->footprint_bytes / mb, n);
+        jessi_stat_add(&out->cpu_percent, s->cpu_percent, n);
+        jessi_stat_add(&out->threads, (double)s->threads, n);
+        jessi_stat_add(&out->disk_read_kbps, s->disk_read_bps / 1024.0, n);
+        jessi_stat_add(&out->disk_write_kbps, s->disk_write_bps / 1024.0, n);
+        first_ts = s->timestamp_ns;
+        n++;
+    }
+
+    jessi_telemetry_stat *stats[] = { &out->resident_mb, &out->footprint_mb, &out->cpu_percent,
+                                      &out->threads, &out->disk_read_kbps, &out->disk_write_kbps };
+    for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) stats[i]->avg /= (double)n;
+    out->count = n;
+    out->seconds = (double)(last->timestamp_ns - first_ts) / 1e9;
+    return n;
+}
+
+const char *jessi_telemetry_csv_header(void) {
+    return "time,resident_mb,footprint_mb,cpu_percent,threads,disk_read_kbps,disk_write_kbps,cpu_user_s,cpu_system_s,disk_read_bytes,disk_write_bytes\n";
+}
+
+size_t jessi_telemetry_format_csv_row(const jessi_telemetry_sample *s, char *buf, size_t cap) {
+    if (!s) return 0;
+    const double mb = 1024.0 * 1024.0;
+    int n = snprintf(buf, cap, "%.3f,%.1f,%.1f,%.1f,%d,%.1f,%.1f,%.3f,%.3f,%llu,%llu\n",
+                     s->wall_time,
+                     (double)s->resident_bytes / mb,
+                     (double)s->footprint_bytes / mb,
+                     s->cpu_percent,
+                     (int)s->threads,
+                     s->disk_read_bps / 1024.0,
+                     s->disk_write_bps / 1024.0,
+                     (double)s->cpu_user_ns / 1e9,
+                     (double)s->cpu_system_ns / 1e9,
+                     (unsigned long long)s->disk_read_bytes,
+                     (unsigned long long)s->disk_write_bytes);
+    return n > 0 ? (size_t)n : 0;
+}
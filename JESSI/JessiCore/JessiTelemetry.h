@@ -0,0 +1,72 @@
+#ifndef JessiTelemetry_h
+#define JessiTelemetry_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t timestamp_ns;      // monotonic
+    double wall_time;           // seconds since 1970
+    uint64_t resident_bytes;
+    uint64_t footprint_bytes;   // phys_footprint on Apple, RSS elsewhere
+    uint64_t cpu_user_ns;
+    uint64_t cpu_system_ns;
+    int32_t threads;            // -1 when the backend cannot tell
+    uint64_t disk_read_bytes;
+    uint64_t disk_write_bytes;
+
+    // Filled in by jessi_telemetry_ring_push from the previous sample.
+    double cpu_percent;         // 100 = one core busy
+    double disk_read_bps;
+    double disk_write_bps;
+} jessi_telemetry_sample;
+
+// pid 0 samples the calling process (task_info on Apple); other pids use proc_pid_rusage
+// on Apple and /proc on Linux. Returns 0 on success.
+int jessi_telemetry_read(pid_t pid, jessi_telemetry_sample *out);
+
+typedef struct jessi_telemetry_ring jessi_telemetry_ring;
+
+jessi_telemetry_ring *jessi_telemetry_ring_create(size_t capacity);
+void jessi_telemetry_ring_push(jessi_telemetry_ring *r, jessi_telemetry_sample *sample);
+size_t jessi_telemetry_ring_count(const jessi_telemetry_ring *r);
+// idx 0 is the oldest retained sample.
+int jessi_telemetry_ring_get(const jessi_telemetry_ring *r, size_t idx, jessi_telemetry_sample *out);
+void jessi_telemetry_ring_clear(jessi_telemetry_ring *r);
+void jessi_telemetry_ring_destroy(jessi_telemetry_ring *r);
+
+typedef struct {
+    double min;
+    double avg;
+    double max;
+} jessi_telemetry_stat;
+
+typedef struct {
+    size_t count;
+    double seconds;
+    jessi_telemetry_stat resident_mb;
+    jessi_telemetry_stat footprint_mb;
+    jessi_telemetry_stat cpu_percent;
+    jessi_telemetry_stat threads;
+    jessi_telemetry_stat disk_read_kbps;
+    jessi_telemetry_stat disk_write_kbps;
+} jessi_telemetry_rollup;
+
+// Rolls up the samples from the last `window_seconds` (0 = everything retained).
+// Returns the number of samples used.
+size_t jessi_telemetry_ring_rollup(const jessi_telemetry_ring *r, double window_seconds, jessi_telemetry_rollup *out);
+
+const char *jessi_telemetry_csv_header(void);
+// Writes one CSV row including the trailing newline; returns the length it needed.
+size_t jessi_telemetry_format_csv_row(const jessi_telemetry_sample *s, char *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
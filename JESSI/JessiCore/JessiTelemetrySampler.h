@@ -0,0 +1,32 @@
+#import <Foundation/Foundation.h>
+#import <sys/types.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Samples memory, CPU, threads and disk I/O of the server on a timer into a fixed-size ring.
+// Sample dictionaries use the CSV column names (resident_mb, cpu_percent, threads, ...).
+@interface JessiTelemetrySampler : NSObject
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSTimeInterval interval;
+@property (atomic, readonly) pid_t pid;
+@property (atomic, readonly, getter=isSampling) BOOL sampling;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity interval:(NSTimeInterval)interval NS_DESIGNATED_INITIALIZER;
+- (instancetype)init;
+
+// pid 0 samples this process (in-process JVM). Clears previous samples.
+- (void)startWithPid:(pid_t)pid;
+- (void)stop;
+
+- (nullable NSDictionary<NSString *, NSNumber *> *)latestSample;
+- (NSArray<NSDictionary<NSString *, NSNumber *> *> *)samples;
+// Keys are metric names, each mapping to @{min, avg, max}; plus "count" and "seconds".
+- (NSDictionary<NSString *, id> *)rollupForLastSeconds:(NSTimeInterval)seconds;
+
+- (NSString *)csvString;
+- (BOOL)writeCSVToPath:(NSString *)path error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,150 @@
+#import "JessiTelemetrySampler.h"
+#import "JessiTelemetry.h"
+
+static NSDictionary<NSString *, NSNumber *> *jessi_telemetry_sample_dict(const jessi_telemetry_sample *s) {
+    const double mb = 1024.0 * 1024.0;
+    return @{
+        @"time": @(s->wall_time),
+        @"resident_mb": @((double)s->resident_bytes / mb),
+        @"footprint_mb": @((double)s->footprint_bytes / mb),
+        @"cpu_percent": @(s->cpu_percent),
+        @"threads": @(s->threads),
+        @"disk_read_kbps": @(s->disk_read_bps / 1024.0),
+        @"disk_write_kbps": @(s->disk_write_bps / 1024.0),
+        @"cpu_user_s": @((double)s->cpu_user_ns / 1e9),
+        @"cpu_system_s": @((double)s->cpu_system_ns / 1e9),
+        @"disk_read_bytes": @(s->disk_read_bytes),
+        @"disk_write_bytes": @(s->disk_write_bytes),
+    };
+}
+
+static NSDictionary<NSString *, NSNumber *> *jessi_telemetry_stat_dict(jessi_telemetry_stat st) {
+    return @{ @"min": @(st.min), @"avg": @(st.avg), @"max": @(st.max) };
+}
+
+@interface JessiTelemetrySampler ()
+@property (atomic, readwrite) pid_t pid;
+@property (atomic, readwrite, getter=isSampling) BOOL sampling;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable) dispatch_source_t timer;
+@property (nonatomic, assign) jessi_telemetry_ring *ring;
+@end
+
+@implementation JessiTelemetrySampler
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity interval:(NSTimeInterval)interval {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, (NSUInteger)2);
+        _interval = interval > 0.05 ? interval : 1.0;
+        _queue = dispatch_queue_create("com.baconmania.jessi.telemetry", DISPATCH_QUEUE_SERIAL);
+        _ring = jessi_telemetry_ring_create(_capacity);
+    }
+    return self;
+}
+
+- (instancetype)init {
+    // One hour at one sample per second.
+    return [self initWithCapacity:3600 interval:1.0];
+}
+
+- (void)dealloc {
+    if (_timer) dispatch_source_cancel(_timer);
+    jessi_telemetry_ring_destroy(_ring);
+}
+
+- (void)startWithPid:(pid_t)pid {
+    dispatch_sync(self.queue, ^{
+        if (self.timer) dispatch_source_cancel(self.timer);
+        jessi_telemetry_ring_clear(self.ring);
+        self.pid = pid;
+        self.sampling = YES;
+
+        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+        uint64_t interval = (uint64_t)(self.interval * NSEC_PER_SEC);
+        dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, 0), interval, interval / 10);
+        __weak JessiTelemetrySampler *weakSelf = self;
+        dispatch_source_set_event_handler(timer, ^{
+            [weakSelf takeSample];
+        });
+        self.timer = timer;
+        dispatch_resume(timer);
+    });
+}
+
+- (void)stop {
+    dispatch_sync(self.queue, ^{
+        if (!self.timer) return;
+        // One last sample so the export covers the whole run.
+        [self takeSample];
+        dispatch_source_cancel(self.timer);
+        self.timer = nil;
+        self.sampling = NO;
+    });
+}
+
+- (void)takeSample {
+    jessi_telemetry_sample s;
+    if (jessi_telemetry_read(self.pid, &s) != 0) return;
+    jessi_telemetry_ring_push(self.ring, &s);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)latestSample {
+    __block NSDictionary<NSString *, NSNumber *> *out = nil;
+    dispatch_sync(self.queue, ^{
+        size_t count = jessi_telemetry_ring_count(self.ring);
+        jessi_telemetry_sample s;
+        if (count && jessi_telemetry_ring_get(self.ring, count - 1, &s) == 0) out = jessi_telemetry_sample_dict(&s);
+    });
+    return out;
+}
+
+- (NSArray<NSDictionary<NSString *, NSNumber *> *> *)samples {
+    NSMutableArray<NSDictionary<NSString *, NSNumber *> *> *out = [NSMutableArray array];
+    dispatch_sync(self.queue, ^{
+        size_t count = jessi_telemetry_ring_count(self.ring);
+        for (size_t i = 0; i < count; i++) {
+            jessi_telemetry_sample s;
+            if (jessi_telemetry_ring_get(self.ring, i, &s) == 0) [out addObject:jessi_telemetry_sample_dict(&s)];
+        }
+    });
+    return out;
+}
+
+- (NSDictionary<NSString *, id> *)rollupForLastSeconds:(NSTimeInterval)seconds {
+    __block jessi_telemetry_rollup r;
+    dispatch_sync(self.queue, ^{
+        jessi_telemetry_ring_rollup(self.ring, seconds, &r);
+    });
+    return @{
+        @"count": @(r.count),
+        @"seconds": @(r.seconds),
+        @"resident_mb": jessi_telemetry_stat_dict(r.resident_mb),
+        @"footprint_mb": jessi_telemetry_stat_dict(r.footprint_mb),
+        @"cpu_percent": jessi_telemetry_stat_dict(r.cpu_percent),
+        @"threads": jessi_telemetry_stat_dict(r.threads),
+        @"disk_read_kbps": jessi_telemetry_stat_dict(r.disk_read_kbps),
+        @"disk_write_kbps": jessi_telemetry_stat_dict(r.disk_write_kbps),
+    };
+}
+
+- (NSString *)csvString {
+    NSMutableString *out = [NSMutableString stringWithUTF8String:jessi_telemetry_csv_header()];
+    dispatch_sync(self.queue, ^{
+        size_t count = jessi_telemetry_ring_count(self.ring);
+        char row[256];
+        for (size_t i = 0; i < count; i++) {
+            jessi_telemetry_sample s;
+            if (jessi_telemetry_ring_get(self.ring, i, &s) != 0) continue;
+            if (jessi_telemetry_format_csv_row(&s, row, sizeof(row)) >= sizeof(row)) continue;
+            [out appendString:[NSString stringWithUTF8String:row] ?: @""];
+        }
+    });
+    return out;
+}
+
+- (BOOL)writeCSVToPath:(NSString *)path error:(NSError **)error {
+    return [[self csvString] writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:error];
+}
+
+@end
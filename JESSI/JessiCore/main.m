@@ -7,6 +7,7 @@
 #import <stdlib.h>
 
 #import "JessiAppDelegate.h"
+#import "JessiChildChannel.h"
 
 int jessi_server_main(int argc, char *argv[]);
 int jessi_tool_main(int argc, char *argv[]);
@@ -62,7 +63,9 @@ __attribute__((visibility("default"))) int main(int argc, char *argv[]) {
     BOOL isMainThread = pthread_main_np() != 0;
 
     if (argc > 1 && argv[1] && streq(argv[1], "--server")) {
-        return jessi_server_main(argc - 1, argv + 1);
+        int code = jessi_server_main(argc - 1, argv + 1);
+        jessi_child_status_send("exit", "code=%d", code);
+        return code;
     }
 
     if (argc > 1 && argv[1] && streq(argv[1], "--tool")) {
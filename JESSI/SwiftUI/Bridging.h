@@ -1,6 +1,14 @@
 #import "../JessiCore/JessiPaths.h"
 #import "../JessiCore/JessiSettings.h"
 #import "../JessiCore/JessiServerService.h"
+#import "../JessiCore/JessiServerSupervisor.h"
+#import "../JessiCore/JessiRuntimePrewarm.h"
+#import "../JessiCore/JessiLoaderCache.h"
+#import "../JessiCore/JessiRuntimeRegistry.h"
+#import "../JessiCore/JessiStreamUnpack.h"
+#import "../JessiCore/JessiDownloader.h"
+#import "../JessiCore/JessiArtifactStore.h"
+#import "../JessiCore/JessiDownloadQueue.h"
 
 #ifdef __cplusplus
 extern "C" {
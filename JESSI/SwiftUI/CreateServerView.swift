@@ -49,7 +49,6 @@ struct CreateServerView: View {
     @State private var isCreating: Bool = false
     @State private var createStatus: String = ""
     @State private var createProgress: Double? = nil
-    @State private var createProgressObservation: NSKeyValueObservation? = nil
     @State private var createError: String? = nil
     @State private var showCreateError: Bool = false
 
@@ -1206,7 +1205,6 @@ struct CreateServerView: View {
         isCreating = true
         createStatus = "Preparing..."
         createProgress = nil
-        createProgressObservation = nil
 
         let serverDirURL = URL(fileURLWithPath: dir, isDirectory: true)
         let selectedVersion = mcVersion
@@ -1234,7 +1232,6 @@ struct CreateServerView: View {
         isCreating = false
         createStatus = ""
         createProgress = nil
-        createProgressObservation = nil
         if success {
             NotificationCenter.default.post(name: Notification.Name("JessiServersChanged"), object: nil)
             presentation.wrappedValue.dismiss()
@@ -1309,10 +1306,12 @@ struct CreateServerView: View {
                 }
 
                 var downloadName: String? = nil
+                var downloadSHA256: String? = nil
                 if let downloads = chosen["downloads"] as? [String: Any],
                    let app = downloads["application"] as? [String: Any],
                    let name = app["name"] as? String {
                     downloadName = name
+                    downloadSHA256 = app["sha256"] as? String
                 }
 
                 let name = downloadName ?? "paper-\(mcVersion)-\(buildNumber).jar"
@@ -1324,7 +1323,7 @@ struct CreateServerView: View {
                 }
 
                 let dest = serverDir.appendingPathComponent("server.jar")
-                self.downloadFile(jarURL, to: dest, completion: completion)
+                self.downloadFile(jarURL, to: dest, sha256: downloadSHA256, completion: completion)
             }
         }
     }
@@ -1335,41 +1334,33 @@ struct CreateServerView: View {
         }
     }
 
-    private func downloadFile(_ url: URL, to dest: URL, completion: @escaping (Result<Void, Error>) -> Void) {
-        let task = URLSession.shared.downloadTask(with: url) { tmpURL, _, error in
+    // Segmented and resumable; sha1/sha256 are checked before the file lands at dest, and the
+    // file is shared with other servers through the artifact store.
+    private func downloadFile(_ url: URL, to dest: URL, sha1: String? = nil, sha256: String? = nil, completion: @escaping (Result<Void, Error>) -> Void) {
+        let request = JessiDownloadRequest(url: url, destination: dest.path)
+        request.sha1 = sha1
+        request.sha256 = sha256
+        request.storeArtifact = true
+
+        DispatchQueue.main.async {
+            self.createProgress = 0
+        }
+        JessiDownloader.download(request, progress: { received, total in
+            guard total > 0 else { return }
+            let fraction = min(max(Double(received) / Double(total), 0), 1)
+            DispatchQueue.main.async {
+                self.createProgress = fraction
+            }
+        }, completion: { error in
             DispatchQueue.main.async {
                 self.createProgress = nil
-                self.createProgressObservation = nil
             }
-
-            if let error = error {
+            if let error {
                 completion(.failure(error))
-                return
-            }
-            guard let tmpURL = tmpURL else {
-                completion(.failure(InstallerError.message("Download failed (no temp file).")))
-                return
-            }
-            do {
-                let fm = FileManager.default
-                try? fm.removeItem(at: dest)
-                try fm.createDirectory(at: dest.deletingLastPathComponent(), withIntermediateDirectories: true)
-                try fm.moveItem(at: tmpURL, to: dest)
+            } else {
                 completion(.success(()))
-            } catch {
-                completion(.failure(error))
             }
-        }
-
-        DispatchQueue.main.async {
-            self.createProgress = 0
-            self.createProgressObservation = task.progress.observe(\.fractionCompleted, options: [.new]) { p, _ in
-                DispatchQueue.main.async {
-                    self.createProgress = p.fractionCompleted
-                }
-            }
-        }
-        task.resume()
+        })
     }
 
     private func fetchJSON(_ url: URL, completion: @escaping (Result<Any, Error>) -> Void) {
@@ -1451,7 +1442,7 @@ struct CreateServerView: View {
                         }
 
                         let dest = serverDir.appendingPathComponent("server.jar")
-                        self.downloadFile(serverURL, to: dest, completion: completion)
+                        self.downloadFile(serverURL, to: dest, sha1: server["sha1"] as? String, completion: completion)
                     }
                 }
             }
@@ -1607,12 +1598,17 @@ struct CreateServerView: View {
                     return
                 }
 
+                if self.useCachedLoader("forge", version: artifactVersion, serverDir: serverDir, completion: completion) {
+                    return
+                }
+
                 let installerDest = serverDir.appendingPathComponent("forge-installer.jar")
                 self.downloadFile(installerURL, to: installerDest) { dlRes in
                     switch dlRes {
                     case .failure(let err): completion(.failure(err))
                     case .success:
-                        self.runInstallerJar(installerJar: installerDest, serverDir: serverDir, completion: completion)
+                        self.runInstallerJar(installerJar: installerDest, serverDir: serverDir, loader: "forge", version: artifactVersion,
+                                             unixArgsHint: "libraries/net/minecraftforge/forge/\(artifactVersion)/unix_args.txt", completion: completion)
                     }
                 }
             }
@@ -1645,12 +1641,17 @@ struct CreateServerView: View {
                 return
             }
 
+            if self.useCachedLoader("neoforge", version: chosen, serverDir: serverDir, completion: completion) {
+                return
+            }
+
             let installerDest = serverDir.appendingPathComponent("neoforge-installer.jar")
             self.downloadFile(installerURL, to: installerDest) { dlRes in
                 switch dlRes {
                 case .failure(let err): completion(.failure(err))
                 case .success:
-                    self.runInstallerJar(installerJar: installerDest, serverDir: serverDir, completion: completion)
+                    self.runInstallerJar(installerJar: installerDest, serverDir: serverDir, loader: "neoforge", version: chosen,
+                                         unixArgsHint: "libraries/net/neoforged/neoforge/\(chosen)/unix_args.txt", completion: completion)
                 }
             }
         }.resume()
@@ -1677,13 +1678,36 @@ struct CreateServerView: View {
         return out
     }
 
-    private func runInstallerJar(installerJar: URL, serverDir: URL, completion: @escaping (Result<Void, Error>) -> Void) {
+    // A loader version another server already installed is cloned from the shared store instead
+    // of downloading and running its installer again.
+    private func useCachedLoader(_ loader: String, version: String, serverDir: URL, completion: @escaping (Result<Void, Error>) -> Void) -> Bool {
+        guard let unixArgsRel = JessiLoaderCache.shared().materializeLoader(loader, version: version, intoServerDir: serverDir.path) else {
+            return false
+        }
+        do {
+            try writeLaunchArgs(unixArgsRel: unixArgsRel, serverDir: serverDir)
+            DispatchQueue.main.async { completion(.success(())) }
+        } catch {
+            DispatchQueue.main.async { completion(.failure(error)) }
+        }
+        return true
+    }
+
+    private func writeLaunchArgs(unixArgsRel: String, serverDir: URL) throws {
+        let launchArgs = "@\(unixArgsRel)\nnogui\n"
+        try launchArgs.write(to: serverDir.appendingPathComponent("jessi-launch-args.txt"), atomically: true, encoding: .utf8)
+    }
+
+    private func runInstallerJar(installerJar: URL, serverDir: URL, loader: String, version: String, unixArgsHint: String,
+                                 completion: @escaping (Result<Void, Error>) -> Void) {
         func completeOnMain(_ result: Result<Void, Error>) {
             DispatchQueue.main.async {
                 completion(result)
             }
         }
 
+        let preexisting = Set((try? FileManager.default.contentsOfDirectory(atPath: serverDir.path)) ?? [])
+
         let argsPath = serverDir.appendingPathComponent("jessi-installer-args.txt")
         do {
             try "--installServer\n".write(to: argsPath, atomically: true, encoding: .utf8)
@@ -1692,10 +1716,10 @@ struct CreateServerView: View {
             return
         }
 
-        let javaVersion = JessiSettings.shared().javaVersion
+        let javaVersion = JessiSettings.current().javaVersion
         
         var bgTask: UIBackgroundTaskIdentifier = .invalid
-        if JessiSettings.shared().runInBackground {
+        if JessiSettings.current().runInBackground {
             bgTask = UIApplication.shared.beginBackgroundTask {
                 UIApplication.shared.endBackgroundTask(bgTask)
                 bgTask = .invalid
@@ -1715,24 +1739,27 @@ struct CreateServerView: View {
                 return
             }
 
-            guard let unixArgsRel = self.findUnixArgsRelativePath(serverDir: serverDir) else {
+            let hinted = FileManager.default.fileExists(atPath: serverDir.appendingPathComponent(unixArgsHint).path)
+            guard let unixArgsRel = hinted ? unixArgsHint : self.findUnixArgsRelativePath(serverDir: serverDir) else {
                 completeOnMain(.failure(InstallerError.message("Installed, but couldn't find unix_args.txt (Forge/NeoForge launcher args).")))
                 return
             }
 
-            let launchArgs = "@\(unixArgsRel)\nnogui\n"
             do {
-                try launchArgs.write(to: serverDir.appendingPathComponent("jessi-launch-args.txt"), atomically: true, encoding: .utf8)
-                completeOnMain(.success(()))
+                try self.writeLaunchArgs(unixArgsRel: unixArgsRel, serverDir: serverDir)
             } catch {
                 completeOnMain(.failure(error))
+                return
             }
+            _ = JessiLoaderCache.shared().storeLoader(loader, version: version, fromServerDir: serverDir.path,
+                                                     unixArgsPath: unixArgsRel, preexisting: preexisting)
+            completeOnMain(.success(()))
         }
     }
 
     private func findUnixArgsRelativePath(serverDir: URL) -> String? {
         let fm = FileManager.default
-        guard let e = fm.enumerator(at: serverDir, includingPropertiesForKeys: [.isRegularFileKey], options: [.skipsHiddenFiles]) else {
+        guard let e = fm.enumerator(at: serverDir.appendingPathComponent("libraries"), includingPropertiesForKeys: [.isRegularFileKey], options: [.skipsHiddenFiles]) else {
             return nil
         }
         for case let url as URL in e {
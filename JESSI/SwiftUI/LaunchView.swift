@@ -68,33 +68,73 @@ private struct ImagePicker: UIViewControllerRepresentable {
 
 final class LaunchModel: NSObject, ObservableObject {
     @Published var servers: [String] = []
-    @Published var selectedServer: String = ""
+    @Published var selectedServer: String = "" {
+        didSet {
+            if selectedServer != oldValue { attachSelectedInstance() }
+        }
+    }
     @Published var isRunning: Bool = false
-    @Published var consoleText: String = ""
+    @Published var runningServers: [String] = []
+    @Published var isStopping: Bool = false
+    @Published var consoleIsEmpty: Bool = true
     @Published var commandText: String = ""
     @Published var activeAlert: LaunchAlert? = nil
     @Published var propertiesManager: ServerPropertiesManager?
-
-    private let service: JessiServerService
+    // Per-server limits as typed; empty means the global setting.
+    @Published var heapLimitText: String = ""
+    @Published var cpuLimitText: String = ""
+
+    private let supervisor = JessiServerSupervisor.shared()
+    // Folder listing only; each server's own instance comes from the supervisor.
+    private let folders = JessiServerService()
+    private var service: JessiServerService
     private var cancellables = Set<AnyCancellable>()
+    let consoleDeltas = PassthroughSubject<JessiConsoleDelta, Never>()
+
+    var supportsConcurrentServers: Bool {
+        supervisor.supportsConcurrentServers
+    }
 
     override init() {
-        self.service = JessiServerService()
+        self.service = folders
         super.init()
-        self.service.delegate = self
         NotificationCenter.default.publisher(for: Notification.Name("JessiServersChanged"))
             .receive(on: DispatchQueue.main)
             .sink { [weak self] _ in
                 self?.reloadServers()
             }
             .store(in: &cancellables)
+        NotificationCenter.default.publisher(for: Notification.Name(JessiServerRunningChanged))
+            .receive(on: DispatchQueue.main)
+            .sink { [weak self] _ in
+                self?.refreshRunningState()
+            }
+            .store(in: &cancellables)
         reloadServers()
-        self.isRunning = service.isRunning
-        updatePropertiesManager()
+        attachSelectedInstance()
+    }
+
+    private func attachSelectedInstance() {
+        let next = selectedServer.isEmpty ? folders : supervisor.instance(forServerNamed: selectedServer)
+        if next !== service {
+            service.delegate = nil
+            service = next
+        }
+        service.delegate = self
+        consoleIsEmpty = service.consoleSnapshot().isEmpty
+        loadLimits()
+        refreshRunningState()
+        JessiRuntimePrewarm.shared().prewarmServerNamed(selectedServer.isEmpty ? nil : selectedServer, afterDelay: 2)
+    }
+
+    private func refreshRunningState() {
+        runningServers = supervisor.runningServerNames()
+        isRunning = service.isRunning
+        isStopping = service.shutdownStage != .idle
     }
 
     func reloadServers() {
-        let folders = service.availableServerFolders()
+        let folders = self.folders.availableServerFolders()
         self.servers = folders
         if folders.isEmpty {
             selectedServer = ""
@@ -106,7 +146,7 @@ final class LaunchModel: NSObject, ObservableObject {
     
     private func updatePropertiesManager() {
         if !selectedServer.isEmpty {
-            let root = service.serversRoot()
+            let root = folders.serversRoot()
             let path = (root as NSString).appendingPathComponent(selectedServer)
             self.propertiesManager = ServerPropertiesManager(serverPath: path)
         } else {
@@ -114,6 +154,25 @@ final class LaunchModel: NSObject, ObservableObject {
         }
     }
 
+    private func loadLimits() {
+        guard !selectedServer.isEmpty else {
+            heapLimitText = ""
+            cpuLimitText = ""
+            return
+        }
+        let heap = supervisor.maxHeapMB(forServerNamed: selectedServer)
+        let cores = supervisor.cpuCores(forServerNamed: selectedServer)
+        heapLimitText = heap > 0 ? String(heap) : ""
+        cpuLimitText = cores > 0 ? String(cores) : ""
+    }
+
+    func saveLimits() {
+        guard !selectedServer.isEmpty else { return }
+        let heap = max(Int(heapLimitText.trimmingCharacters(in: .whitespaces)) ?? 0, 0)
+        let cores = min(max(Int(cpuLimitText.trimmingCharacters(in: .whitespaces)) ?? 0, 0), ProcessInfo.processInfo.activeProcessorCount)
+        supervisor.setMaxHeapMB(heap, cpuCores: cores, forServerNamed: selectedServer)
+    }
+
     func startServer() {
         guard !selectedServer.isEmpty else { return }
         UIApplication.shared.isIdleTimerDisabled = true
@@ -126,7 +185,7 @@ final class LaunchModel: NSObject, ObservableObject {
 
     func start() {
 
-        let heapMB = JessiSettings.shared().maxHeapMB
+        let heapMB = JessiSettings.current().maxHeapMB
         if heapMB == 51925 {
             activeAlert = .mspj("oh fuck! please dont bypass MSPJ!!!")
         }
@@ -139,7 +198,7 @@ final class LaunchModel: NSObject, ObservableObject {
             return
         }
 
-        let selectedJava = JessiSettings.shared().javaVersion
+        let selectedJava = JessiSettings.current().javaVersion
         if !available.contains(selectedJava) {
             activeAlert = .runtime("Your selected Java version (Java \(selectedJava)) is not installed. Please install it or pick a different version in settings.")
             return
@@ -154,7 +213,9 @@ final class LaunchModel: NSObject, ObservableObject {
     }
 
     func stop() {
-        UIApplication.shared.isIdleTimerDisabled = false
+        if runningServers.count <= 1 {
+            UIApplication.shared.isIdleTimerDisabled = false
+        }
         service.stopServer()
     }
 
@@ -165,7 +226,7 @@ final class LaunchModel: NSObject, ObservableObject {
     }
 
     func copyConsole() {
-        UIPasteboard.general.string = consoleText
+        UIPasteboard.general.string = service.consoleSnapshot()
         let generator = UIImpactFeedbackGenerator(style: .medium)
         generator.impactOccurred()
     }
@@ -176,23 +237,31 @@ final class LaunchModel: NSObject, ObservableObject {
         _ = service.sendRcon(cmd)
         commandText = ""
     }
+
+    func consoleSnapshot() -> String {
+        service.consoleSnapshot()
+    }
 }
 
 extension LaunchModel: JessiServerServiceDelegate {
-    func serverServiceDidUpdateConsole(_ consoleText: String) {
-        DispatchQueue.main.async {
-            self.consoleText = consoleText
-            let serversRoot = self.service.serversRoot()
-            let serverPath = (serversRoot as NSString).appendingPathComponent(self.selectedServer)
-            let consoleLogPath = (serverPath as NSString).appendingPathComponent("console.log")
-            try? consoleText.write(toFile: consoleLogPath, atomically: true, encoding: .utf8)
+    // Delivered on the main queue, in order with the service's buffer, so the
+    // text view can seed itself from consoleSnapshot() and then apply deltas.
+    func serverServiceDidAppendConsole(_ delta: JessiConsoleDelta) {
+        let isEmpty = delta.isReset && delta.appendedText.isEmpty
+        if consoleIsEmpty != isEmpty {
+            consoleIsEmpty = isEmpty
         }
+        consoleDeltas.send(delta)
+    }
+
+    func serverServiceDidChangeShutdownStage(_ stage: JessiShutdownStage) {
+        isStopping = stage != .idle
     }
 
     func serverServiceDidChangeRunning(_ isRunning: Bool) {
         DispatchQueue.main.async {
-            self.isRunning = isRunning
-            if !isRunning {
+            self.refreshRunningState()
+            if self.runningServers.isEmpty {
                 UIApplication.shared.isIdleTimerDisabled = false
             }
         }
@@ -409,6 +478,47 @@ struct QuickSettingsView: View {
     }
 }
 
+struct ServerLimitsView: View {
+    @ObservedObject var model: LaunchModel
+
+    var body: some View {
+        VStack(alignment: .leading, spacing: 16) {
+            Text("Resources")
+                .font(.headline)
+
+            VStack(spacing: 0) {
+                SettingRow(title: "Max Heap (MB)") {
+                    TextField(String(JessiSettings.current().maxHeapMB), text: Binding(
+                        get: { model.heapLimitText },
+                        set: { model.heapLimitText = $0; model.saveLimits() }
+                    ))
+                    .keyboardType(.numberPad)
+                    .multilineTextAlignment(.trailing)
+                }
+
+                Divider()
+
+                SettingRow(title: "CPU Cores") {
+                    TextField("All", text: Binding(
+                        get: { model.cpuLimitText },
+                        set: { model.cpuLimitText = $0; model.saveLimits() }
+                    ))
+                    .keyboardType(.numberPad)
+                    .multilineTextAlignment(.trailing)
+                }
+            }
+            .background(Color(UIColor.tertiarySystemBackground))
+            .cornerRadius(12)
+
+            Text("Leave blank to use the global setting. Changes apply the next time this server starts.")
+                .font(.footnote)
+                .foregroundColor(.secondary)
+        }
+        .padding(.horizontal, 16)
+        .padding(.bottom, 8)
+    }
+}
+
 struct SettingRow<Content: View>: View {
     let title: String
     let content: Content
@@ -490,14 +600,14 @@ struct LaunchView: View {
                         if model.servers.isEmpty {
                              Text("None").foregroundColor(.secondary)
                         } else {
-                             if model.isRunning {
+                             if model.isRunning && !model.supportsConcurrentServers {
                                  Text(model.selectedServer)
                                      .foregroundColor(.green)
                              } else {
                                  Menu {
                                      Picker("Server", selection: $model.selectedServer) {
                                          ForEach(model.servers, id: \.self) { s in
-                                             Text(s).tag(s)
+                                             Text(model.runningServers.contains(s) ? "\(s) (running)" : s).tag(s)
                                          }
                                      }
                                  } label: {
@@ -533,14 +643,14 @@ struct LaunchView: View {
 
                         Button(action: {
                             let isMacBuild = ProcessInfo.processInfo.isMacCatalystApp
-                            let shouldUseSeparateProcess = jessi_is_trollstore_installed() && !JessiSettings.shared().disableSeparateJVMProcessOnTrollStore
+                            let shouldUseSeparateProcess = jessi_is_trollstore_installed() && !JessiSettings.current().disableSeparateJVMProcessOnTrollStore
                             if isMacBuild || shouldUseSeparateProcess {
                                 model.stop()
                             } else {
                                 model.activeAlert = .stopConfirm
                             }
                         }) {
-                            Text("Stop")
+                            Text(model.isStopping ? "Force Stop" : "Stop")
                                 .font(.system(size: 17, weight: .semibold))
                                 .frame(maxWidth: .infinity)
                                 .padding(.vertical, 12)
@@ -576,7 +686,7 @@ struct LaunchView: View {
                 }
                 .padding(.horizontal, 16)
 
-                ConsolePanel(text: $model.consoleText)
+                ConsolePanel(model: model)
                     .frame(height: 250)
                     .padding(.horizontal, 16)
 
@@ -614,7 +724,9 @@ struct LaunchView: View {
 
                 if let manager = model.propertiesManager {
                     QuickSettingsView(manager: manager)
-                    
+
+                    ServerLimitsView(model: model)
+
                     Button(action: { showAdvancedSettings = true }) {
                         Text("Advanced Settings")
                             .font(.headline)
@@ -746,12 +858,13 @@ struct LaunchView: View {
 }
 
 private struct ConsolePanel: View {
-    @Binding var text: String
+    @ObservedObject var model: LaunchModel
 
     var body: some View {
         ZStack(alignment: .topLeading) {
-            ConsoleTextView(text: $text)
-            if text.isEmpty {
+            ConsoleTextView(deltas: model.consoleDeltas, snapshot: model.consoleSnapshot)
+                .id(model.selectedServer)
+            if model.consoleIsEmpty {
                 Text("Console output will appear here.")
                     .font(.system(size: 12, design: .monospaced))
                     .foregroundColor(.secondary)
@@ -768,7 +881,16 @@ private struct ConsolePanel: View {
 }
 
 private struct ConsoleTextView: UIViewRepresentable {
-    @Binding var text: String
+    let deltas: PassthroughSubject<JessiConsoleDelta, Never>
+    let snapshot: () -> String
+
+    final class Coordinator {
+        var cancellable: AnyCancellable?
+    }
+
+    func makeCoordinator() -> Coordinator {
+        Coordinator()
+    }
 
     func makeUIView(context: Context) -> UITextView {
         let tv = UITextView(frame: .zero)
@@ -781,23 +903,48 @@ private struct ConsoleTextView: UIViewRepresentable {
         tv.font = UIFont.monospacedSystemFont(ofSize: 12, weight: .regular)
         tv.textContainerInset = UIEdgeInsets(top: 12, left: 8, bottom: 12, right: 8)
         tv.textContainer.lineBreakMode = .byCharWrapping
+        tv.layoutManager.allowsNonContiguousLayout = true
         tv.setContentCompressionResistancePriority(.defaultLow, for: .horizontal)
+        tv.text = snapshot()
+        context.coordinator.cancellable = deltas.sink { [weak tv] delta in
+            guard let tv = tv else { return }
+            ConsoleTextView.apply(delta, to: tv)
+        }
         return tv
     }
 
-    func updateUIView(_ uiView: UITextView, context: Context) {
-        guard uiView.text != text else { return }
+    func updateUIView(_ uiView: UITextView, context: Context) {}
+
+    static func dismantleUIView(_ uiView: UITextView, coordinator: Coordinator) {
+        coordinator.cancellable = nil
+    }
 
+    private static func apply(_ delta: JessiConsoleDelta, to uiView: UITextView) {
         let bottomThreshold: CGFloat = 24
         let visibleBottom = uiView.contentOffset.y + uiView.bounds.size.height
         let wasAtBottom = visibleBottom >= (uiView.contentSize.height - bottomThreshold)
         let oldOffset = uiView.contentOffset
 
-        uiView.text = text
-        uiView.layoutIfNeeded()
+        let attributes: [NSAttributedString.Key: Any] = [
+            .font: uiView.font ?? UIFont.monospacedSystemFont(ofSize: 12, weight: .regular),
+            .foregroundColor: UIColor.label
+        ]
+        let appended = NSAttributedString(string: delta.appendedText, attributes: attributes)
+        let storage = uiView.textStorage
+        storage.beginEditing()
+        if delta.isReset {
+            storage.setAttributedString(appended)
+        } else {
+            let trim = min(Int(delta.trimmedLength), storage.length)
+            if trim > 0 {
+                storage.deleteCharacters(in: NSRange(location: 0, length: trim))
+            }
+            storage.append(appended)
+        }
+        storage.endEditing()
 
         if wasAtBottom {
-            let end = NSRange(location: max(0, (uiView.text as NSString).length - 1), length: 1)
+            let end = NSRange(location: max(0, storage.length - 1), length: 1)
             uiView.scrollRangeToVisible(end)
         } else {
             let maxOffsetY = max(0, uiView.contentSize.height - uiView.bounds.size.height)
@@ -159,6 +159,7 @@ struct ModrinthFile: Decodable {
     let url: String
     let filename: String
     let primary: Bool
+    let hashes: [String: String]?
 }
 
 struct CurseForgeSearchResponse: Decodable {
@@ -261,6 +262,8 @@ private struct MrpackIndex: Decodable {
 private struct MrpackFile: Decodable {
     let path: String
     let downloads: [String]
+    let hashes: [String: String]?
+    let fileSize: Int64?
 }
 
 private struct CurseForgeModpackManifest: Decodable {
@@ -283,6 +286,7 @@ final class ModsVM: ObservableObject {
     @Published var installedmods: [String: InstalledModRecord] = [:]
     @Published var installingmods: Set<String> = []
     @Published var failedmods: Set<String> = []
+    @Published var installprogress: [String: Double] = [:]
     @Published var provider: ModProvider = .modrinth
     @Published var contentType: ContentType = .mod
     
@@ -351,7 +355,7 @@ final class ModsVM: ObservableObject {
     }
 
     var cfapikey: String? {
-        let saved = JessiSettings.shared().cfapikey.trimmingCharacters(in: .whitespacesAndNewlines)
+        let saved = JessiSettings.current().cfapikey.trimmingCharacters(in: .whitespacesAndNewlines)
         if !saved.isEmpty {
             return saved
         }
@@ -697,6 +701,7 @@ final class ModsVM: ObservableObject {
             deleteInstalledRecord(modid: modid, serverdir: serverdir, excluding: [])
         }
         saveinstalledmods()
+        JessiArtifactStore.shared().collectGarbage()
     }
 
     func cleanupExistingInstall(for mod: ModSearchItem, keeping newRecord: InstalledModRecord) {
@@ -710,6 +715,7 @@ final class ModsVM: ObservableObject {
         protectedPaths.insert("\(newRecord.contentType.dirname)/\(newRecord.filename)")
 
         deleteInstalledRecord(modid: existingKey, serverdir: serverdir, excluding: protectedPaths)
+        JessiArtifactStore.shared().collectGarbage()
     }
 
     private func serverRootURL() -> URL? {
@@ -822,6 +828,12 @@ private struct Mod: View {
                     Spacer()
                     
                     if model.installingmods.contains(mod.id) {
+                        if let progress = model.installprogress[mod.id] {
+                            Text("\(Int(progress * 100))%")
+                                .font(.system(size: 12))
+                                .foregroundColor(.secondary)
+                        }
+
                         ProgressView()
                             .progressViewStyle(CircularProgressViewStyle())
                             .frame(width: 15, height: 15)
@@ -934,6 +946,7 @@ private struct Mod: View {
                     model.installedmods[mod.id] = installedRecord
                     model.saveinstalledmods()
                     model.installingmods.remove(mod.id)
+                    model.installprogress.removeValue(forKey: mod.id)
                     model.failedmods.remove(mod.id)
                 }
 
@@ -942,6 +955,7 @@ private struct Mod: View {
                 modlogger.flushdivider()
                 _ = await MainActor.run {
                     model.installingmods.remove(mod.id)
+                    model.installprogress.removeValue(forKey: mod.id)
                     model.markInstallFailed(mod.id)
                 }
             }
@@ -976,14 +990,97 @@ private struct Mod: View {
             throw NSError(domain: "invalid file URL", code: 0)
         }
 
-        let (moddata, _) = try await URLSession.shared.data(from: fileurl)
-        if mod.contentType == .modpack, file.filename.lowercased().hasSuffix(".mrpack") {
+        let isModpack = mod.contentType == .modpack && file.filename.lowercased().hasSuffix(".mrpack")
+        let isDatapack = mod.contentType == .datapack && file.filename.lowercased().hasSuffix(".zip")
+        if !isModpack && !isDatapack {
+            let modpath = try modFileURL(filename: file.filename)
+            try await downloadVerified(fileurl, to: modpath, sha1: file.hashes?["sha1"], sha512: file.hashes?["sha512"], share: true)
+            modlogger.enclosedlog("installed \(mod.title) to \(modpath.path)")
+            modlogger.flushdivider()
+            return InstalledModRecord(filename: file.filename, contentType: mod.contentType, managedPaths: nil)
+        }
+
+        let temp = FileManager.default.temporaryDirectory.appendingPathComponent("jessi-modrinth-\(UUID().uuidString)-\(file.filename)")
+        defer { try? FileManager.default.removeItem(at: temp) }
+        try await downloadVerified(fileurl, to: temp, sha1: file.hashes?["sha1"], sha512: file.hashes?["sha512"], share: false)
+        let moddata = try Data(contentsOf: temp, options: .mappedIfSafe)
+        if isModpack {
             return try await installModpackFromMrpack(data: moddata, filename: file.filename)
         }
-        if mod.contentType == .datapack, file.filename.lowercased().hasSuffix(".zip") {
-            return try installdatapackzip(data: moddata, filename: file.filename)
+        return try installdatapackzip(data: moddata, filename: file.filename)
+    }
+
+    private func downloadVerified(_ url: URL, to dest: URL, sha1: String?, sha512: String?, share: Bool) async throws {
+        try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+            let request = JessiDownloadRequest(url: url, destination: dest.path)
+            request.sha1 = sha1
+            request.sha512 = sha512
+            request.storeArtifact = share
+            JessiDownloader.download(request, progress: nil) { error in
+                if let error {
+                    continuation.resume(throwing: error)
+                } else {
+                    continuation.resume()
+                }
+            }
+        }
+    }
+
+    // Pack files go through one JessiDownloadQueue so a 200-mod pack downloads in parallel,
+    // straight to disk; progress shows as a percentage on the row.
+    private func runPackDownloads(_ queue: JessiDownloadQueue) async throws {
+        let modID = mod.id
+        try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+                queue.run(progress: { received, total, done, count in
+                    let fraction: Double
+                    if total > 0 {
+                        fraction = Double(received) / Double(total)
+                    } else {
+                        fraction = count > 0 ? Double(done) / Double(count) : 0
+                    }
+                    DispatchQueue.main.async {
+                        if model.installingmods.contains(modID) {
+                            model.installprogress[modID] = fraction
+                        }
+                    }
+                }) { error in
+                    if let error {
+                        continuation.resume(throwing: error)
+                    } else {
+                        continuation.resume()
+                    }
+                }
+            }
+        } onCancel: {
+            queue.cancel()
+        }
+    }
+
+    // Resolves CurseForge manifest entries a few at a time instead of one request after another.
+    private func resolveManifestFiles<T: Sendable>(
+        _ files: [CurseForgeModpackManifestFile],
+        resolve: @escaping (CurseForgeModpackManifestFile) async throws -> T?
+    ) async throws -> [T?] {
+        let limit = 8
+        var results = [T?](repeating: nil, count: files.count)
+        try await withThrowingTaskGroup(of: (Int, T?).self) { group in
+            var next = 0
+            while next < min(limit, files.count) {
+                let index = next
+                group.addTask { (index, try await resolve(files[index])) }
+                next += 1
+            }
+            while case let (index, value)? = try await group.next() {
+                results[index] = value
+                if next < files.count {
+                    let index = next
+                    group.addTask { (index, try await resolve(files[index])) }
+                    next += 1
+                }
+            }
         }
-        return try writeModFile(data: moddata, filename: file.filename)
+        return results
     }
 
     private func curseforgeinstall() async throws -> InstalledModRecord {
@@ -1036,17 +1133,23 @@ private struct Mod: View {
             throw NSError(domain: "invalid CurseForge file URL", code: 0)
         }
 
-        let (moddata, _) = try await URLSession.shared.data(from: selected.url)
-        if mod.contentType == .modpack, selected.file.fileName.lowercased().hasSuffix(".mrpack") {
-            return try await installModpackFromMrpack(data: moddata, filename: selected.file.fileName)
+        let filename = selected.file.fileName
+        if mod.contentType == .modpack, filename.lowercased().hasSuffix(".mrpack") {
+            return try await withTemporaryDownload(selected.url, filename: filename) { moddata in
+                try await installModpackFromMrpack(data: moddata, filename: filename)
+            }
         }
-        if mod.contentType == .modpack, selected.file.fileName.lowercased().hasSuffix(".zip") {
-            return try await installcurseforgemodpackzip(data: moddata, filename: selected.file.fileName, key: key)
+        if mod.contentType == .modpack, filename.lowercased().hasSuffix(".zip") {
+            return try await withTemporaryDownload(selected.url, filename: filename) { moddata in
+                try await installcurseforgemodpackzip(data: moddata, filename: filename, key: key)
+            }
         }
-        if mod.contentType == .datapack, selected.file.fileName.lowercased().hasSuffix(".zip") {
-            return try installdatapackzip(data: moddata, filename: selected.file.fileName)
+        if mod.contentType == .datapack, filename.lowercased().hasSuffix(".zip") {
+            return try await withTemporaryDownload(selected.url, filename: filename) { moddata in
+                try installdatapackzip(data: moddata, filename: filename)
+            }
         }
-        return try writeModFile(data: moddata, filename: selected.file.fileName)
+        return try await installModFile(from: selected.url, filename: filename)
     }
 
     private func curseforgeinstallkeyless() async throws -> InstalledModRecord {
@@ -1069,20 +1172,44 @@ private struct Mod: View {
             throw NSError(domain: "invalid CurseForge file URL", code: 0)
         }
 
-        let (moddata, response) = try await URLSession.shared.data(from: url)
-        let responseName = response.suggestedFilename ?? url.lastPathComponent
-        let filename = responseName.isEmpty ? selected.filename : responseName
+        // The CDN link ends in the file's real name; the listing's name is the fallback.
+        let urlName = url.lastPathComponent
+        let filename = urlName.contains(".") ? urlName : selected.filename
 
         if mod.contentType == .modpack, filename.lowercased().hasSuffix(".mrpack") {
-            return try await installModpackFromMrpack(data: moddata, filename: filename)
+            return try await withTemporaryDownload(url, filename: filename) { moddata in
+                try await installModpackFromMrpack(data: moddata, filename: filename)
+            }
         }
         if mod.contentType == .modpack, filename.lowercased().hasSuffix(".zip") {
-            return try await installcurseforgemodpackzipkeyless(data: moddata, filename: filename)
+            return try await withTemporaryDownload(url, filename: filename) { moddata in
+                try await installcurseforgemodpackzipkeyless(data: moddata, filename: filename)
+            }
         }
         if mod.contentType == .datapack, filename.lowercased().hasSuffix(".zip") {
-            return try installdatapackzip(data: moddata, filename: filename)
+            return try await withTemporaryDownload(url, filename: filename) { moddata in
+                try installdatapackzip(data: moddata, filename: filename)
+            }
         }
-        return try writeModFile(data: moddata, filename: filename)
+        return try await installModFile(from: url, filename: filename)
+    }
+
+    // Packs are unpacked from a temporary file, mapped rather than read into memory, as on Modrinth.
+    private func withTemporaryDownload<T>(_ url: URL, filename: String, _ body: (Data) async throws -> T) async throws -> T {
+        let temp = FileManager.default.temporaryDirectory.appendingPathComponent("jessi-curseforge-\(UUID().uuidString)-\(filename)")
+        defer { try? FileManager.default.removeItem(at: temp) }
+        try await downloadVerified(url, to: temp, sha1: nil, sha512: nil, share: false)
+        let moddata = try Data(contentsOf: temp, options: .mappedIfSafe)
+        return try await body(moddata)
+    }
+
+    // CurseForge publishes no hashes here, so the file is shared by the hash the store computes.
+    private func installModFile(from url: URL, filename: String) async throws -> InstalledModRecord {
+        let modpath = try modFileURL(filename: filename)
+        try await downloadVerified(url, to: modpath, sha1: nil, sha512: nil, share: true)
+        modlogger.enclosedlog("installed \(mod.title) to \(modpath.path)")
+        modlogger.flushdivider()
+        return InstalledModRecord(filename: filename, contentType: mod.contentType, managedPaths: nil)
     }
 
     private func isPreferredCurseForgeFile(_ file: CurseForgeFile) -> Bool {
@@ -1243,19 +1370,24 @@ private struct Mod: View {
             managed.insert(normalized)
         }
 
+        let queue = JessiDownloadQueue()
         for file in index.files {
             let normalized = try normalizedRelativePath(file.path)
-            guard let downloadString = file.downloads.first,
-                  let url = URL(string: downloadString) else {
+            let mirrors = file.downloads.compactMap { URL(string: $0) }
+            guard !mirrors.isEmpty else {
                 throw NSError(domain: "invalid mrpack file download URL", code: 0)
             }
 
-            let (fileData, _) = try await URLSession.shared.data(from: url)
             let destination = serverRoot.appendingPathComponent(normalized)
             try fm.createDirectory(at: destination.deletingLastPathComponent(), withIntermediateDirectories: true)
-            try fileData.write(to: destination, options: [.atomic])
+            let request = JessiDownloadRequest(mirrors: mirrors, destination: destination.path)
+            request.sha1 = file.hashes?["sha1"]
+            request.sha512 = file.hashes?["sha512"]
+            request.storeArtifact = true
+            queue.add(request, expectedSize: file.fileSize ?? 0)
             managed.insert(normalized)
         }
+        try await runPackDownloads(queue)
 
         let modpacksDir = serverRoot.appendingPathComponent(ContentType.modpack.dirname)
         try fm.createDirectory(at: modpacksDir, withIntermediateDirectories: true)
@@ -1316,18 +1448,24 @@ private struct Mod: View {
         let modsdir = serverroot.appendingPathComponent(ContentType.mod.dirname)
         try fm.createDirectory(at: modsdir, withIntermediateDirectories: true)
 
+        let fileurls = try await resolveManifestFiles(manifest.files) { file in
+            try await resolveCurseForgeManifestFileURL(projectID: file.projectID, fileID: file.fileID, key: key)
+        }
+
         var unresolvedFiles: [String] = []
-        for file in manifest.files {
-            guard let fileurl = try await resolveCurseForgeManifestFileURL(projectID: file.projectID, fileID: file.fileID, key: key) else {
+        let queue = JessiDownloadQueue()
+        for (file, fileurl) in zip(manifest.files, fileurls) {
+            guard let fileurl else {
                 unresolvedFiles.append("\(file.projectID):\(file.fileID)")
                 continue
             }
-            let (filedata, _) = try await URLSession.shared.data(from: fileurl)
             let filename = fileurl.lastPathComponent.isEmpty ? "\(file.fileID).jar" : fileurl.lastPathComponent
-            let destination = modsdir.appendingPathComponent(filename)
-            try filedata.write(to: destination, options: [.atomic])
+            let request = JessiDownloadRequest(url: fileurl, destination: modsdir.appendingPathComponent(filename).path)
+            request.storeArtifact = true
+            queue.add(request, expectedSize: 0)
             managed.insert("mods/\(filename)")
         }
+        try await runPackDownloads(queue)
 
         if !manifest.files.isEmpty, unresolvedFiles.count == manifest.files.count {
             for relativePath in managed {
@@ -1406,15 +1544,40 @@ private struct Mod: View {
         let modsdir = serverroot.appendingPathComponent(ContentType.mod.dirname)
         try fm.createDirectory(at: modsdir, withIntermediateDirectories: true)
 
+        let resolved = try await resolveManifestFiles(manifest.files) { file in
+            try? await resolveCurseForgeFileKeyless(projectID: file.projectID, fileID: file.fileID)
+        }
+
         var unresolvedFiles: [String] = []
-        for file in manifest.files {
-            do {
-                let (filedata, filename) = try await downloadCurseForgeFileKeyless(projectID: file.projectID, fileID: file.fileID)
-                let destination = modsdir.appendingPathComponent(filename)
-                try filedata.write(to: destination, options: [.atomic])
-                managed.insert("mods/\(filename)")
-            } catch {
-                unresolvedFiles.append("\(file.projectID):\(file.fileID)")
+        var queued: [String: (relative: String, label: String)] = [:]
+        let queue = JessiDownloadQueue()
+        queue.stopOnFirstError = false
+        for (file, target) in zip(manifest.files, resolved) {
+            let label = "\(file.projectID):\(file.fileID)"
+            guard let target else {
+                unresolvedFiles.append(label)
+                continue
+            }
+            let (fileurl, filename) = target
+            let destination = modsdir.appendingPathComponent(filename).path
+            let request = JessiDownloadRequest(url: fileurl, destination: destination)
+            request.storeArtifact = true
+            queue.add(request, expectedSize: 0)
+            queued[destination] = ("mods/\(filename)", label)
+        }
+        do {
+            try await runPackDownloads(queue)
+        } catch let error as NSError where error.domain == JessiDownloadErrorDomain && error.code == JessiDownloadErrorCode.cancelled.rawValue {
+            throw error
+        } catch {
+            // Failed files are collected below and skipped like unresolved ones.
+        }
+        let failed = Set(queue.failedRequests.compactMap { $0.destinationPath })
+        for (destination, entry) in queued {
+            if failed.contains(destination) {
+                unresolvedFiles.append(entry.label)
+            } else {
+                managed.insert(entry.relative)
             }
         }
 
@@ -1449,16 +1612,28 @@ private struct Mod: View {
         return InstalledModRecord(filename: markername, contentType: .modpack, managedPaths: managedpaths)
     }
 
-    private func downloadCurseForgeFileKeyless(projectID: Int, fileID: Int) async throws -> (Data, String) {
-        guard let downloadurl = URL(string: "https://www.curseforge.com/api/v1/mods/\\(projectID)/files/\\(fileID)/download") else {
+    // Follows the keyless download redirect with a HEAD request so the file itself can be
+    // queued under its real name.
+    private func resolveCurseForgeFileKeyless(projectID: Int, fileID: Int) async throws -> (URL, String) {
+        guard let downloadurl = URL(string: "https://www.curseforge.com/api/v1/mods/\(projectID)/files/\(fileID)/download") else {
             throw NSError(domain: "invalid CurseForge download URL", code: 0)
         }
-        let (data, response) = try await URLSession.shared.data(from: downloadurl)
+        var request = URLRequest(url: downloadurl)
+        request.httpMethod = "HEAD"
+        let (_, response) = try await URLSession.shared.data(for: request)
+        if let http = response as? HTTPURLResponse {
+            if http.statusCode == 405 {
+                return (downloadurl, "\(fileID).jar")
+            }
+            guard (200..<300).contains(http.statusCode) else {
+                throw NSError(domain: "CurseForge download returned \(http.statusCode)", code: http.statusCode)
+            }
+        }
         let filename = response.suggestedFilename
             ?? response.url?.lastPathComponent
             ?? "\(fileID).jar"
 
-        return (data, filename.isEmpty ? "\(fileID).jar" : filename)
+        return (response.url ?? downloadurl, filename.isEmpty ? "\(fileID).jar" : filename)
     }
 
     private func resolveCurseForgeManifestFileURL(projectID: Int, fileID: Int, key: String) async throws -> URL? {
@@ -1598,7 +1773,7 @@ private struct Mod: View {
         return cleaned.joined(separator: "/")
     }
 
-    private func writeModFile(data: Data, filename: String) throws -> InstalledModRecord {
+    private func modFileURL(filename: String) throws -> URL {
         let fm = FileManager.default
         guard let docs = fm.urls(for: .documentDirectory, in: .userDomainMask).first else {
             throw NSError(domain: "documents directory not found", code: 0)
@@ -1612,13 +1787,7 @@ private struct Mod: View {
         if !fm.fileExists(atPath: extensionsDir.path) {
             try fm.createDirectory(at: extensionsDir, withIntermediateDirectories: true)
         }
-
-        let modpath = extensionsDir.appendingPathComponent(filename)
-        try data.write(to: modpath)
-
-        modlogger.enclosedlog("installed \(mod.title) to \(modpath.path)")
-        modlogger.flushdivider()
-        return InstalledModRecord(filename: filename, contentType: mod.contentType, managedPaths: nil)
+        return extensionsDir.appendingPathComponent(filename)
     }
 }
 
@@ -313,8 +313,7 @@ final class SettingsModel: ObservableObject {
     @Published var cleanupInProgress: Bool = false
     @Published var cleanupStatus: String = ""
 
-    private var activeJVMSession: URLSession? = nil
-    private var activeJVMDelegate: JVMDownloadProgressDelegate? = nil
+    private var activeJVMDownload: JessiDownloader? = nil
     private var isInstallPipelineRunning: Bool = false
 
     let allJVMVersions: [String] = ["8", "17", "21"]
@@ -536,14 +535,7 @@ final class SettingsModel: ObservableObject {
     }
 
     func refreshInstalledJVMVersions() {
-        var installed: Set<String> = []
-        for ver in allJVMVersions {
-            let dir = runtimeDir(for: ver)
-            if FileManager.default.fileExists(atPath: dir.path) {
-                installed.insert(ver)
-            }
-        }
-        installedJVMVersions = installed
+        installedJVMVersions = Set(JessiRuntimeRegistry.shared().installedVersions())
     }
 
     func deleteInstalledJVMVersions(at offsets: IndexSet) {
@@ -554,6 +546,7 @@ final class SettingsModel: ObservableObject {
 
             let dir = runtimeDir(for: ver)
             try? FileManager.default.removeItem(at: dir)
+            JessiRuntimeRegistry.shared().removeInstalledVersion(ver)
         }
 
         refreshInstalledJVMVersions()
@@ -564,6 +557,7 @@ final class SettingsModel: ObservableObject {
         guard installedJVMVersions.contains(ver) else { return }
         let dir = runtimeDir(for: ver)
         try? FileManager.default.removeItem(at: dir)
+        JessiRuntimeRegistry.shared().removeInstalledVersion(ver)
         refreshInstalledJVMVersions()
         refreshAvailableJavaVersions()
     }
@@ -629,59 +623,6 @@ final class SettingsModel: ObservableObject {
         if fm.fileExists(atPath: helper2.path) { _ = chmod(helper2.path, 0o755) }
     }
 
-    private func readU32LE(_ data: Data, _ offset: Int) -> UInt32? {
-        guard offset >= 0, offset + 4 <= data.count else { return nil }
-        return data.withUnsafeBytes { raw in
-            let p = raw.baseAddress!.advanced(by: offset).assumingMemoryBound(to: UInt32.self)
-            return UInt32(littleEndian: p.pointee)
-        }
-    }
-
-    private func machoPlatform(ofBinaryAt url: URL) -> UInt32? {
-        guard let data = try? Data(contentsOf: url, options: .mappedIfSafe) else { return nil }
-        guard let magic = readU32LE(data, 0) else { return nil }
-
-        guard magic == MH_MAGIC_64 else { return nil }
-        guard let ncmdsU32 = readU32LE(data, 16) else { return nil }
-        let ncmds = Int(ncmdsU32)
-        var cmdOffset = 32
-
-        for _ in 0..<ncmds {
-            guard let cmd = readU32LE(data, cmdOffset), let cmdsizeU32 = readU32LE(data, cmdOffset + 4) else { break }
-            let cmdsize = Int(cmdsizeU32)
-            if cmdsize < 8 || cmdOffset + cmdsize > data.count { break }
-
-            if cmd == UInt32(LC_BUILD_VERSION), let platform = readU32LE(data, cmdOffset + 8) {
-                return platform
-            }
-
-            cmdOffset += cmdsize
-        }
-
-        return nil
-    }
-
-    private func validateRuntimeForCurrentPlatform(_ runtimeRoot: URL) throws {
-        guard isMacCatalyst else { return }
-
-        let fm = FileManager.default
-        let libjliA = runtimeRoot.appendingPathComponent("lib/libjli.dylib")
-        let libjliB = runtimeRoot.appendingPathComponent("lib/jli/libjli.dylib")
-        let libjli = fm.fileExists(atPath: libjliA.path) ? libjliA : libjliB
-
-        guard fm.fileExists(atPath: libjli.path) else {
-            throw NSError(domain: "JESSI", code: 106, userInfo: [NSLocalizedDescriptionKey: "Downloaded runtime is missing libjli.dylib"])
-        }
-
-        guard let platform = machoPlatform(ofBinaryAt: libjli) else {
-            throw NSError(domain: "JESSI", code: 107, userInfo: [NSLocalizedDescriptionKey: "Could not verify runtime platform for \(libjli.lastPathComponent)"])
-        }
-
-        if platform != UInt32(PLATFORM_MACCATALYST) {
-            throw NSError(domain: "JESSI", code: 108, userInfo: [NSLocalizedDescriptionKey: "Downloaded JVM is not Mac Catalyst compatible (platform \(platform))."])
-        }
-    }
-
     private func extractTar(_ tarPath: URL, to destDir: URL) throws {
         let fm = FileManager.default
         try fm.createDirectory(at: destDir, withIntermediateDirectories: true)
@@ -756,13 +697,159 @@ final class SettingsModel: ObservableObject {
             self.jvmDownloadProgress = 0
         }
 
+        var lastError: Error?
+
+        // The downloader fails over between mirrors on its own; another pass only helps when a
+        // mirror served a broken archive.
+        func attemptDownload(at index: Int) {
+            guard index < candidateURLs.count else {
+                completion(.failure(lastError ?? NSError(domain: "JESSI", code: 2, userInfo: [NSLocalizedDescriptionKey: "Download failed"])))
+                return
+            }
+
+            let mirrors = Array(candidateURLs[index...]) + Array(candidateURLs[..<index])
+            streamRuntime(version: version, mirrors: mirrors) { result in
+                switch result {
+                case .installed:
+                    completion(.success(()))
+                case .unsupported(let reason):
+                    NSLog("[JESSI] Can't stream \(mirrors[0].lastPathComponent) (\(reason)), downloading it whole")
+                    self.downloadRuntimeBuffered(version: version, mirrors: mirrors) { buffered in
+                        switch buffered {
+                        case .success:
+                            completion(.success(()))
+                        case .failure(let error):
+                            completion(.failure(error))
+                        }
+                    }
+                case .failed(let error):
+                    let nsError = error as NSError
+                    if nsError.domain == JessiDownloadErrorDomain || nsError.domain == NSURLErrorDomain {
+                        completion(.failure(error))
+                        return
+                    }
+                    lastError = error
+                    attemptDownload(at: index + 1)
+                }
+            }
+        }
+
+        attemptDownload(at: 0)
+    }
+
+    private enum RuntimeStreamResult {
+        case installed
+        case unsupported(String)
+        case failed(Error)
+    }
+
+    // Network -> zip -> xz -> tar -> files in one pass: the download is never written out, and
+    // the unpacker's writer thread overlaps disk writes with the next chunks arriving. Drops are
+    // resumed by range on the same or the next mirror, so the unpacker just keeps going.
+    private func streamRuntime(version: String, mirrors: [URL], completion: @escaping (RuntimeStreamResult) -> Void) {
+        let fm = FileManager.default
+        let staging = runtimesDir.appendingPathComponent("jre\(version).staging-\(UUID().uuidString)", isDirectory: true)
+        do {
+            try fm.createDirectory(at: staging, withIntermediateDirectories: true)
+        } catch {
+            completion(.failed(error))
+            return
+        }
+        guard let unpacker = jessi_unpack_create(staging.path, 0) else {
+            try? fm.removeItem(at: staging)
+            completion(.unsupported("unpacker unavailable"))
+            return
+        }
+
+        var status = JESSI_UNPACK_OK
+        let request = JessiDownloadRequest(mirrors: mirrors, destination: nil)
+        // Called on the download's serial queue; a blocked feed holds back the next chunk.
+        let download = JessiDownloader.stream(request, onData: { data in
+            for region in data.regions {
+                status = region.withUnsafeBytes { raw in
+                    jessi_unpack_feed(unpacker, raw.baseAddress, raw.count)
+                }
+                if status != JESSI_UNPACK_OK { return false }
+            }
+            return true
+        }, progress: { [weak self] received, total in
+            guard total > 0 else { return }
+            let fraction = min(max(Double(received) / Double(total), 0), 1)
+            DispatchQueue.main.async {
+                self?.jvmDownloadProgress = fraction
+            }
+        }, completion: { error in
+            if status == JESSI_UNPACK_OK && error == nil {
+                status = jessi_unpack_finish(unpacker)
+            }
+
+            var stats = jessi_unpack_stats()
+            jessi_unpack_get_stats(unpacker, &stats)
+            let reason = String(cString: jessi_unpack_error(unpacker))
+            // Stops the writer before the staging directory is cleaned up.
+            jessi_unpack_destroy(unpacker)
+            self.activeJVMDownload = nil
+
+            if status == JESSI_UNPACK_UNSUPPORTED {
+                try? fm.removeItem(at: staging)
+                completion(.unsupported(reason))
+                return
+            }
+            guard status == JESSI_UNPACK_OK else {
+                try? fm.removeItem(at: staging)
+                completion(.failed(NSError(domain: "JESSI", code: 3, userInfo: [NSLocalizedDescriptionKey: reason.isEmpty ? "Runtime archive is invalid" : reason])))
+                return
+            }
+            if let error {
+                try? fm.removeItem(at: staging)
+                completion(.failed(error))
+                return
+            }
+
+            NSLog("[JESSI] Java \(version): streamed \(stats.bytes_in) bytes, \(stats.entries) entries, \(stats.file_bytes) bytes written, \(stats.writer_stalls) writer stalls, peak queue \(stats.peak_queued)")
+            do {
+                try self.installStagedRuntime(staging, version: version)
+                completion(.installed)
+            } catch {
+                try? fm.removeItem(at: staging)
+                completion(.failed(error))
+            }
+        })
+        activeJVMDownload = download
+    }
+
+    private func installStagedRuntime(_ staging: URL, version: String) throws {
+        let fm = FileManager.default
+        let finalDir = runtimeDir(for: version)
+
+        postInstallFixPermissions(runtimeRoot: staging)
+        try JessiRuntimeRegistry.shared().validateRuntime(atPath: staging.path)
+
+        if fm.fileExists(atPath: finalDir.path) {
+            let backup = runtimesDir.appendingPathComponent("jre\(version).backup-\(UUID().uuidString)", isDirectory: true)
+            try? fm.removeItem(at: backup)
+            try fm.moveItem(at: finalDir, to: backup)
+            try? fm.removeItem(at: backup)
+        }
+        try fm.moveItem(at: staging, to: finalDir)
+        JessiRuntimeRegistry.shared().registerInstalledVersion(version)
+
+        DispatchQueue.main.async {
+            self.jvmDownloadProgress = 1
+        }
+    }
+
+    // Download to disk, then unzip / unxz / untar. Only used for archives the streaming path
+    // can't follow; the download itself is segmented and resumable.
+    private func downloadRuntimeBuffered(version: String, mirrors: [URL], completion: @escaping (Result<Void, Error>) -> Void) {
         let outerFM = FileManager.default
         let tmpRoot = outerFM.temporaryDirectory.appendingPathComponent("jessi-jvm-install", isDirectory: true)
         let workDir = tmpRoot.appendingPathComponent(UUID().uuidString, isDirectory: true)
-        let zipPath = workDir.appendingPathComponent("jre\(version).zip")
         let unzipDir = workDir.appendingPathComponent("unzipped", isDirectory: true)
         let tarXZPath = workDir.appendingPathComponent("runtime.tar.xz")
         let tarPath = workDir.appendingPathComponent("runtime.tar")
+        let downloadedName = mirrors[0].lastPathComponent.isEmpty ? "runtime-download" : mirrors[0].lastPathComponent
+        let downloadedPath = workDir.appendingPathComponent(downloadedName)
 
         do {
             try outerFM.createDirectory(at: unzipDir, withIntermediateDirectories: true)
@@ -771,141 +858,74 @@ final class SettingsModel: ObservableObject {
             return
         }
 
-        var lastError: Error?
+        let request = JessiDownloadRequest(mirrors: mirrors, destination: downloadedPath.path)
+        let download = JessiDownloader.download(request, progress: { [weak self] received, total in
+            guard total > 0 else { return }
+            let fraction = min(max(Double(received) / Double(total), 0), 1)
+            DispatchQueue.main.async {
+                self?.jvmDownloadProgress = fraction
+            }
+        }, completion: { error in
+            let fm = FileManager.default
+            self.activeJVMDownload = nil
+            defer { try? fm.removeItem(at: workDir) }
 
-        func attemptDownload(at index: Int) {
-            guard index < candidateURLs.count else {
-                completion(.failure(lastError ?? NSError(domain: "JESSI", code: 2, userInfo: [NSLocalizedDescriptionKey: "Download failed"])))
+            if let error {
+                completion(.failure(error))
                 return
             }
 
-            let url = candidateURLs[index]
-            let progressDelegate = JVMDownloadProgressDelegate { [weak self] fraction in
-                DispatchQueue.main.async {
-                    self?.jvmDownloadProgress = fraction
-                }
-            }
-            let session = URLSession(configuration: .default, delegate: progressDelegate, delegateQueue: nil)
-            self.activeJVMDelegate = progressDelegate
-            self.activeJVMSession = session
-            var progressTimer: DispatchSourceTimer?
-
-            let task = session.downloadTask(with: url) { tempURL, _, error in
-                let fm = FileManager.default
-                defer {
-                    progressTimer?.cancel()
-                    progressTimer = nil
-                    if self.activeJVMSession === session {
-                        self.activeJVMSession = nil
-                        self.activeJVMDelegate = nil
-                    }
-                    session.finishTasksAndInvalidate()
-                }
-
-                if let error {
-                    lastError = error
-                    attemptDownload(at: index + 1)
-                    return
-                }
-                guard let tempURL else {
-                    lastError = NSError(domain: "JESSI", code: 2, userInfo: [NSLocalizedDescriptionKey: "Download failed"])
-                    attemptDownload(at: index + 1)
-                    return
-                }
-
-                do {
-                    try fm.createDirectory(at: workDir, withIntermediateDirectories: true)
-                    defer { try? fm.removeItem(at: workDir) }
-                    if fm.fileExists(atPath: tarXZPath.path) { try? fm.removeItem(at: tarXZPath) }
-
-                    let downloadedName = url.lastPathComponent.isEmpty ? "runtime-download" : url.lastPathComponent
-                    let downloadedPath = workDir.appendingPathComponent(downloadedName)
-                    if fm.fileExists(atPath: downloadedPath.path) { try? fm.removeItem(at: downloadedPath) }
-                    try fm.moveItem(at: tempURL, to: downloadedPath)
-
-                    if downloadedPath.lastPathComponent.hasSuffix(".tar.xz") {
-                        try fm.copyItem(at: downloadedPath, to: tarXZPath)
-                    } else {
-                        if fm.fileExists(atPath: zipPath.path) { try? fm.removeItem(at: zipPath) }
-                        try fm.copyItem(at: downloadedPath, to: zipPath)
-
-                        let archive = try Archive(url: zipPath, accessMode: .read)
-                        for entry in archive {
-                            let outURL = unzipDir.appendingPathComponent(entry.path)
-                            let parent = outURL.deletingLastPathComponent()
-                            try? fm.createDirectory(at: parent, withIntermediateDirectories: true)
-                            if fm.fileExists(atPath: outURL.path) {
-                                try? fm.removeItem(at: outURL)
-                            }
-                            _ = try archive.extract(entry, to: outURL)
+            do {
+                if downloadedPath.lastPathComponent.hasSuffix(".tar.xz") {
+                    try fm.moveItem(at: downloadedPath, to: tarXZPath)
+                } else {
+                    let archive = try Archive(url: downloadedPath, accessMode: .read)
+                    for entry in archive {
+                        let outURL = unzipDir.appendingPathComponent(entry.path)
+                        let parent = outURL.deletingLastPathComponent()
+                        try? fm.createDirectory(at: parent, withIntermediateDirectories: true)
+                        if fm.fileExists(atPath: outURL.path) {
+                            try? fm.removeItem(at: outURL)
                         }
+                        _ = try archive.extract(entry, to: outURL)
+                    }
 
-                        let enumerator = fm.enumerator(at: unzipDir, includingPropertiesForKeys: nil)
-                        var foundTarXZ: URL? = nil
-                        while let u = enumerator?.nextObject() as? URL {
-                            if u.pathExtension == "xz" && u.lastPathComponent.hasSuffix(".tar.xz") {
-                                foundTarXZ = u
-                                break
-                            }
+                    let enumerator = fm.enumerator(at: unzipDir, includingPropertiesForKeys: nil)
+                    var foundTarXZ: URL? = nil
+                    while let u = enumerator?.nextObject() as? URL {
+                        if u.pathExtension == "xz" && u.lastPathComponent.hasSuffix(".tar.xz") {
+                            foundTarXZ = u
+                            break
                         }
-                        guard let foundTarXZ else {
-                            throw NSError(domain: "JESSI", code: 3, userInfo: [NSLocalizedDescriptionKey: "Runtime archive did not contain a .tar.xz"])
-                        }
-                        try fm.copyItem(at: foundTarXZ, to: tarXZPath)
                     }
-
-                    try autoreleasepool {
-                        let xzData = try Data(contentsOf: tarXZPath, options: .mappedIfSafe)
-                        let tarData = try XZArchive.unarchive(archive: xzData)
-                        try tarData.write(to: tarPath, options: [.atomic])
+                    guard let foundTarXZ else {
+                        throw NSError(domain: "JESSI", code: 3, userInfo: [NSLocalizedDescriptionKey: "Runtime archive did not contain a .tar.xz"])
                     }
+                    try fm.moveItem(at: foundTarXZ, to: tarXZPath)
+                }
 
-                    let finalDir = self.runtimeDir(for: version)
-                    let staging = self.runtimesDir.appendingPathComponent("jre\(version).staging-\(UUID().uuidString)", isDirectory: true)
-                    if fm.fileExists(atPath: staging.path) { try? fm.removeItem(at: staging) }
-
-                    try self.extractTar(tarPath, to: staging)
-                    self.postInstallFixPermissions(runtimeRoot: staging)
-                    try self.validateRuntimeForCurrentPlatform(staging)
-
-                    if fm.fileExists(atPath: finalDir.path) {
-                        let backup = self.runtimesDir.appendingPathComponent("jre\(version).backup-\(UUID().uuidString)", isDirectory: true)
-                        try? fm.removeItem(at: backup)
-                        try fm.moveItem(at: finalDir, to: backup)
-                        try? fm.removeItem(at: backup)
-                    }
-                    try fm.moveItem(at: staging, to: finalDir)
+                try autoreleasepool {
+                    let xzData = try Data(contentsOf: tarXZPath, options: .mappedIfSafe)
+                    let tarData = try XZArchive.unarchive(archive: xzData)
+                    try tarData.write(to: tarPath, options: [.atomic])
+                }
 
-                    DispatchQueue.main.async {
-                        self.jvmDownloadProgress = 1
-                    }
+                let staging = self.runtimesDir.appendingPathComponent("jre\(version).staging-\(UUID().uuidString)", isDirectory: true)
+                if fm.fileExists(atPath: staging.path) { try? fm.removeItem(at: staging) }
 
-                    completion(.success(()))
+                do {
+                    try self.extractTar(tarPath, to: staging)
+                    try self.installStagedRuntime(staging, version: version)
                 } catch {
-                    lastError = error
-                    attemptDownload(at: index + 1)
-                }
-            }
-
-            let timer = DispatchSource.makeTimerSource(queue: DispatchQueue.global(qos: .utility))
-            timer.schedule(deadline: .now(), repeating: .milliseconds(120))
-            timer.setEventHandler { [weak task] in
-                guard let task = task else { return }
-                let expected = task.countOfBytesExpectedToReceive
-                let received = task.countOfBytesReceived
-                guard expected > 0, received >= 0 else { return }
-                let fraction = min(max(Double(received) / Double(expected), 0), 1)
-                DispatchQueue.main.async {
-                    self.jvmDownloadProgress = fraction
+                    try? fm.removeItem(at: staging)
+                    throw error
                 }
+                completion(.success(()))
+            } catch {
+                completion(.failure(error))
             }
-            progressTimer = timer
-            timer.resume()
-
-            task.resume()
-        }
-
-        attemptDownload(at: 0)
+        })
+        activeJVMDownload = download
     }
 
     func installRuntimes(versions: [String],
@@ -2570,23 +2590,6 @@ extension URL: Identifiable {
     public var id: String { absoluteString }
 }
 
-private class JVMDownloadProgressDelegate: NSObject, URLSessionDownloadDelegate {
-    let onProgress: (Double) -> Void
-
-    init(onProgress: @escaping (Double) -> Void) {
-        self.onProgress = onProgress
-    }
-
-    func urlSession(_ session: URLSession, downloadTask: URLSessionDownloadTask, didWriteData bytesWritten: Int64, totalBytesWritten: Int64, totalBytesExpectedToWrite: Int64) {
-        guard totalBytesExpectedToWrite > 0 else { return }
-        let fraction = Double(totalBytesWritten) / Double(totalBytesExpectedToWrite)
-        onProgress(min(max(fraction, 0), 1))
-    }
-
-    func urlSession(_ session: URLSession, downloadTask: URLSessionDownloadTask, didFinishDownloadingTo location: URL) {
-    }
-}
-
 // MARK: - Keyless CurseForge (shared)
 
 struct KeylessCurseClientPaths {
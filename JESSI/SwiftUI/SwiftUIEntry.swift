@@ -195,6 +195,7 @@ struct ServerManagerView: View {
 
         do {
             try fm.moveItem(atPath: oldPath, toPath: newPath)
+            JessiArtifactStore.shared().moveReferences(fromPath: oldPath, toPath: newPath)
             NotificationCenter.default.post(name: Notification.Name("JessiServersChanged"), object: nil)
             model.reload()
         } catch {
@@ -208,6 +209,7 @@ struct ServerManagerView: View {
         let path = (root as NSString).appendingPathComponent(name)
         do {
             try fm.removeItem(atPath: path)
+            JessiArtifactStore.shared().collectGarbage()
             NotificationCenter.default.post(name: Notification.Name("JessiServersChanged"), object: nil)
             model.reload()
         } catch {
@@ -0,0 +1,300 @@
+// Spawns this binary as a stub child ("--child <mode>") through JessiChildChannel and checks
+// stdout/stderr delivery and the log copy, status-line framing in both directions, exit and
+// signal reaping, heartbeats and stall reports, and the drain cut-off when a grandchild keeps
+// the pipes open. Built with short drain/stall intervals so it runs in about two seconds.
+
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "JessiChildChannel.h"
+#include "jessi_test.h"
+
+extern char **environ;
+
+#define STDOUT_LINES 4000
+
+static void sleep_ms(unsigned ms) {
+    struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+// Child side -------------------------------------------------------------------------------
+
+static void put(int fd, const char *text) {
+    (void)write(fd, text, strlen(text));
+}
+
+static int child_main(const char *mode) {
+    int fd = jessi_child_status_fd();
+    if (fd < 0) return 90;
+
+    if (strcmp(mode, "echo") == 0) {
+        const char *env = getenv(JESSI_CHILD_STATUS_FD_ENV);
+        jessi_child_status_send("env", "%s", env ? env : "-");
+        jessi_child_status_send("phase", "boot");
+        jessi_child_status_send("pid", "%d", (int)getpid());
+        for (int i = 0; i < STDOUT_LINES; i++) printf("stdout line %04d\n", i);
+        fflush(stdout);
+        fputs("stderr says hi\n", stderr);
+
+        // A status line written in pieces, then one with CRLF and trailing spaces, then a bare key.
+        put(fd, "pha");
+        sleep_ms(20);
+        put(fd, "se loaded\n");
+        put(fd, "note spaced value  \r\n");
+        put(fd, "ready\n\n");
+
+        // Control line from the parent; echo it back.
+        char line[128];
+        size_t n = 0;
+        while (n + 1 < sizeof(line)) {
+            ssize_t r = read(fd, line + n, 1);
+            if (r <= 0 || line[n] == '\n') break;
+            n++;
+        }
+        line[n] = '\0';
+        jessi_child_status_send("ack", "%s", line);
+        // Unterminated last line: delivered when the socket closes.
+        put(fd, "exit normal");
+        return 7;
+    }
+    if (strcmp(mode, "heartbeat") == 0) {
+        if (jessi_child_status_start_heartbeat(40) != 0) return 91;
+        sleep_ms(300);
+        return 0;
+    }
+    if (strcmp(mode, "stall") == 0) {
+        jessi_child_status_send("hb", "1");
+        sleep_ms(700);
+        jessi_child_status_send("hb", "2");
+        sleep_ms(100);
+        return 0;
+    }
+    if (strcmp(mode, "grandchild") == 0) {
+        // The grandchild inherits stdout/stderr but not the status socket (CLOEXEC).
+        char *argv[] = {"sleep", "5", NULL};
+        pid_t pid;
+        if (posix_spawnp(&pid, "sleep", NULL, NULL, argv, environ) != 0) return 92;
+        jessi_child_status_send("grandchild", "%d", (int)pid);
+        puts("child leaving");
+        fflush(stdout);
+        return 0;
+    }
+    if (strcmp(mode, "kill") == 0) {
+        puts("about to die");
+        fflush(stdout);
+        raise(SIGKILL);
+    }
+    return 93;
+}
+
+// Parent side ------------------------------------------------------------------------------
+
+typedef struct {
+    jessi_child_channel *ch;
+    char out[STDOUT_LINES * 20];
+    size_t out_len;
+    char err[256];
+    size_t err_len;
+    char status[64][128];
+    size_t status_count;
+    int stalls;
+} recorder;
+
+static void on_output(void *ctx, jessi_child_stream stream, const uint8_t *bytes, size_t len) {
+    recorder *r = ctx;
+    char *buf = stream == JESSI_CHILD_STDOUT ? r->out : r->err;
+    size_t cap = stream == JESSI_CHILD_STDOUT ? sizeof(r->out) : sizeof(r->err);
+    size_t *used = stream == JESSI_CHILD_STDOUT ? &r->out_len : &r->err_len;
+    size_t n = len < cap - 1 - *used ? len : cap - 1 - *used;
+    memcpy(buf + *used, bytes, n);
+    *used += n;
+    buf[*used] = '\0';
+}
+
+static void on_status(void *ctx, const jessi_child_status *msg) {
+    recorder *r = ctx;
+    if (strcmp(msg->key, "stall") == 0) r->stalls++;
+    if (r->status_count < 64) {
+        snprintf(r->status[r->status_count++], sizeof(r->status[0]), "%s|%s", msg->key, msg->value);
+    }
+    if (strcmp(msg->key, "ready") == 0) {
+        JESSI_CHECK(jessi_child_channel_send(r->ch, "stop now") == 0, "send from the status callback failed");
+    }
+}
+
+static const jessi_child_callbacks kCallbacks = {on_output, on_status};
+
+static jessi_child_channel *spawn_child(const char *self, const char *mode, const char *log_path, recorder *r) {
+    char *argv[] = {(char *)self, "--child", (char *)mode, NULL};
+    // A stale value in the parent's environment must be replaced, not duplicated.
+    size_t n = 0;
+    while (environ[n]) n++;
+    char **env = calloc(n + 2, sizeof(char *));
+    memcpy(env, environ, n * sizeof(char *));
+    env[n] = JESSI_CHILD_STATUS_FD_ENV "=99";
+    int err = 0;
+    jessi_child_channel *ch = jessi_child_channel_spawn(self, argv, env, log_path, &kCallbacks, r, &err);
+    free(env);
+    JESSI_CHECK(ch != NULL, "%s: spawn failed: %s", mode, strerror(err));
+    r->ch = ch;
+    return ch;
+}
+
+static int has_status(const recorder *r, const char *entry) {
+    for (size_t i = 0; i < r->status_count; i++) {
+        if (strcmp(r->status[i], entry) == 0) return 1;
+    }
+    return 0;
+}
+
+static void test_echo(const char *self) {
+    char log_path[256];
+    const char *tmp = getenv("TMPDIR");
+    snprintf(log_path, sizeof(log_path), "%s/jessi-child-%d.log", tmp && tmp[0] ? tmp : "/tmp", (int)getpid());
+    unlink(log_path);
+
+    static recorder r;
+    jessi_child_channel *ch = spawn_child(self, "echo", log_path, &r);
+    if (!ch) return;
+    int status = 0;
+    JESSI_CHECK(jessi_child_channel_wait(ch, &status) == 0, "wait failed");
+    JESSI_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 7, "exit status %d", status);
+
+    size_t want_len = (size_t)STDOUT_LINES * strlen("stdout line 0000\n");
+    JESSI_CHECK(r.out_len == want_len, "stdout: %zu bytes, want %zu", r.out_len, want_len);
+    int in_order = 1;
+    for (int i = 0; i < STDOUT_LINES && in_order; i++) {
+        char want[32];
+        snprintf(want, sizeof(want), "stdout line %04d\n", i);
+        in_order = r.out_len >= (size_t)(i + 1) * 17 && memcmp(r.out + (size_t)i * 17, want, 17) == 0;
+    }
+    JESSI_CHECK(in_order, "stdout bytes reordered or lost");
+    JESSI_CHECK(strcmp(r.err, "stderr says hi\n") == 0, "stderr: %s", r.err);
+
+    static const char *const want[] = {
+        "env|3", "phase|boot", "phase|loaded", "note|spaced value", "ready|", "ack|stop now", "exit|normal",
+    };
+    size_t want_count = sizeof(want) / sizeof(want[0]);
+    JESSI_CHECK(r.status_count == want_count + 1, "%zu status messages", r.status_count);
+    // "pid" is the third message; its value is only known now.
+    char pid_entry[32];
+    snprintf(pid_entry, sizeof(pid_entry), "pid|%d", (int)jessi_child_channel_pid(ch));
+    JESSI_CHECK(r.status_count > 2 && strcmp(r.status[2], pid_entry) == 0, "status[2] %s, want %s", r.status[2], pid_entry);
+    for (size_t i = 0, j = 0; i < r.status_count && j < want_count; i++) {
+        if (i == 2) continue;
+        JESSI_CHECK(strcmp(r.status[i], want[j]) == 0, "status[%zu] %s, want %s", i, r.status[i], want[j]);
+        j++;
+    }
+
+    jessi_child_stats stats;
+    jessi_child_channel_get_stats(ch, &stats);
+    JESSI_CHECK(stats.stdout_bytes == want_len && stats.stderr_bytes == 15, "stats %llu/%llu",
+                (unsigned long long)stats.stdout_bytes, (unsigned long long)stats.stderr_bytes);
+    JESSI_CHECK(stats.status_messages == want_count + 1 && stats.heartbeats == 0, "stats: %llu status, %llu hb",
+                (unsigned long long)stats.status_messages, (unsigned long long)stats.heartbeats);
+    JESSI_CHECK(stats.logged_bytes == want_len + 15, "logged %llu", (unsigned long long)stats.logged_bytes);
+
+    // wait() flushes the log; it holds both streams.
+    size_t log_len = 0;
+    char *log = jessi_test_read_file(log_path, &log_len);
+    JESSI_CHECK(log && log_len == want_len + 15 && strstr(log, "stderr says hi\n") && strstr(log, "stdout line 3999\n"),
+                "log has %zu bytes", log_len);
+    free(log);
+    unlink(log_path);
+    JESSI_CHECK(jessi_child_channel_send(ch, "late") != 0, "send after exit succeeded");
+    jessi_child_channel_destroy(ch);
+}
+
+static void test_heartbeat(const char *self) {
+    static recorder r;
+    jessi_child_channel *ch = spawn_child(self, "heartbeat", NULL, &r);
+    if (!ch) return;
+    int status = 0;
+    jessi_child_channel_wait(ch, &status);
+    JESSI_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "heartbeat child status %d", status);
+    jessi_child_stats stats;
+    jessi_child_channel_get_stats(ch, &stats);
+    JESSI_CHECK(stats.heartbeats >= 4 && stats.last_heartbeat_ns != 0, "%llu heartbeats", (unsigned long long)stats.heartbeats);
+    JESSI_CHECK(has_status(&r, "hb|1") && has_status(&r, "hb|2") && has_status(&r, "hb|3"), "heartbeat sequence");
+    JESSI_CHECK(r.stalls == 0, "stall reported while heartbeats flowed");
+    jessi_child_channel_destroy(ch);
+}
+
+static void test_stall(const char *self) {
+    static recorder r;
+    jessi_child_channel *ch = spawn_child(self, "stall", NULL, &r);
+    if (!ch) return;
+    jessi_child_channel_wait(ch, NULL);
+    // hb 1, a 700 ms gap (> JESSI_CHILD_STALL_MS), one stall report, then hb 2 clears it.
+    JESSI_CHECK(r.stalls == 1, "%d stall reports", r.stalls);
+    size_t stall_at = 0, hb2_at = 0;
+    for (size_t i = 0; i < r.status_count; i++) {
+        if (strncmp(r.status[i], "stall|", 6) == 0) {
+            stall_at = i;
+            long ms = strtol(r.status[i] + 6, NULL, 10);
+            JESSI_CHECK(ms >= JESSI_CHILD_STALL_MS && ms < 700, "stall after %ld ms", ms);
+        }
+        if (strcmp(r.status[i], "hb|2") == 0) hb2_at = i;
+    }
+    JESSI_CHECK(stall_at > 0 && hb2_at > stall_at, "stall at %zu, hb 2 at %zu", stall_at, hb2_at);
+    jessi_child_channel_destroy(ch);
+}
+
+static void test_grandchild(const char *self) {
+    static recorder r;
+    jessi_child_channel *ch = spawn_child(self, "grandchild", NULL, &r);
+    if (!ch) return;
+    double start = jessi_test_now();
+    int status = 0;
+    jessi_child_channel_wait(ch, &status);
+    double elapsed = jessi_test_now() - start;
+    JESSI_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "grandchild parent status %d", status);
+    JESSI_CHECK(elapsed < 2.0, "wait held by the grandchild for %.2fs", elapsed);
+    JESSI_CHECK(strstr(r.out, "child leaving\n") != NULL, "output before exit lost");
+    for (size_t i = 0; i < r.status_count; i++) {
+        if (strncmp(r.status[i], "grandchild|", 11) == 0) kill((pid_t)atoi(r.status[i] + 11), SIGKILL);
+    }
+    jessi_child_channel_destroy(ch);
+}
+
+static void test_killed(const char *self) {
+    static recorder r;
+    jessi_child_channel *ch = spawn_child(self, "kill", NULL, &r);
+    if (!ch) return;
+    int status = 0;
+    JESSI_CHECK(jessi_child_channel_wait(ch, &status) == 0, "wait failed");
+    JESSI_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL, "status %d", status);
+    JESSI_CHECK(strcmp(r.out, "about to die\n") == 0, "stdout: %s", r.out);
+    // Reaped: the pid is gone and a second wait returns the same status.
+    JESSI_CHECK(waitpid(jessi_child_channel_pid(ch), NULL, WNOHANG) < 0 && errno == ECHILD, "child not reaped");
+    int again = 0;
+    JESSI_CHECK(jessi_child_channel_wait(ch, &again) == 0 && again == status, "second wait");
+    jessi_child_channel_destroy(ch);
+}
+
+static void test_spawn_failure(void) {
+    char *argv[] = {"missing", NULL};
+    int err = 0;
+    jessi_child_channel *ch = jessi_child_channel_spawn("/nonexistent/jessi-child", argv, environ, NULL, &kCallbacks, NULL, &err);
+    JESSI_CHECK(ch == NULL && err == ENOENT, "spawn of a missing binary: %p, %s", (void *)ch, strerror(err));
+    JESSI_CHECK(jessi_child_channel_spawn(NULL, argv, environ, NULL, NULL, NULL, &err) == NULL && err == EINVAL, "NULL path");
+    // Not started through a channel: no status fd, and sends are dropped.
+    JESSI_CHECK(jessi_child_status_fd() == -1, "parent has a status fd");
+    jessi_child_status_send("phase", "ignored");
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "--child") == 0) return child_main(argv[2]);
+    unsetenv(JESSI_CHILD_STATUS_FD_ENV);
+    test_echo(argv[0]);
+    test_heartbeat(argv[0]);
+    test_stall(argv[0]);
+    test_grandchild(argv[0]);
+    test_killed(argv[0]);
+    test_spawn_failure();
+    return jessi_test_done("child_channel_test");
+}
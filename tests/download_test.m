@@ -0,0 +1,153 @@
+// Runs JessiDownloader against tests/standin/http_server.py: a body cut off mid-transfer resumes
+// with a range request, a dead mirror falls through to the next one, and corrupt bytes fail the
+// hash check (after one clean retry). Needs Foundation, so macOS only.
+
+#import <Foundation/Foundation.h>
+#import <spawn.h>
+#import <sys/wait.h>
+#import "JessiDownloader.h"
+#include "jessi_test.h"
+
+extern char **environ;
+
+typedef struct {
+    pid_t pid;
+    int stdinFd;
+    int port;
+    char sha256[65];
+} standin;
+
+// The stand-in prints its port and the body's digest, then serves until its stdin closes.
+static BOOL start_standin(standin *s) {
+    int in[2], out[2];
+    if (pipe(in) != 0) return NO;
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return NO;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, in[1]);
+    posix_spawn_file_actions_addclose(&actions, out[0]);
+    char *argv[] = {"python3", "standin/http_server.py", NULL};
+    int rc = posix_spawnp(&s->pid, "python3", &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(in[0]);
+    close(out[1]);
+    if (rc != 0) {
+        close(in[1]);
+        close(out[0]);
+        return NO;
+    }
+    s->stdinFd = in[1];
+    s->port = 0;
+    long size = 0;
+    FILE *f = fdopen(out[0], "r");
+    if (!f || fscanf(f, "port %d size %ld sha256 %64s", &s->port, &size, s->sha256) != 3) s->port = 0;
+    if (f) fclose(f);
+    else close(out[0]);
+    return s->port > 0;
+}
+
+static void stop_standin(standin *s) {
+    close(s->stdinFd);
+    int status = 0;
+    waitpid(s->pid, &status, 0);
+}
+
+static NSURL *url(const standin *s, NSString *path) {
+    return [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d%@", s->port, path]];
+}
+
+// "<path> <range>" lines for the requests since the last call.
+static NSArray<NSString *> *request_log(const standin *s) {
+    NSData *data = [NSData dataWithContentsOfURL:url(s, @"/log")];
+    NSString *text = data ? [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] : @"";
+    NSMutableArray *lines = [[text componentsSeparatedByString:@"\n"] mutableCopy];
+    [lines removeObject:@""];
+    return lines;
+}
+
+static NSError *download(const standin *s, NSArray<NSString *> *paths, NSString *dest) {
+    NSMutableArray<NSURL *> *mirrors = [NSMutableArray array];
+    for (NSString *path in paths) [mirrors addObject:url(s, path)];
+    JessiDownloadRequest *request = [JessiDownloadRequest requestWithMirrors:mirrors destination:dest];
+    request.sha256 = @(s->sha256);
+
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    __block NSError *error = nil;
+    [JessiDownloader downloadRequest:request progress:nil completion:^(NSError *e) {
+        error = e;
+        dispatch_semaphore_signal(done);
+    }];
+    if (dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(60 * NSEC_PER_SEC))) != 0) {
+        return [NSError errorWithDomain:@"JessiTest" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"no completion"}];
+    }
+    return error;
+}
+
+static BOOL is_error(NSError *error, JessiDownloadErrorCode code) {
+    return [error.domain isEqualToString:JessiDownloadErrorDomain] && error.code == code;
+}
+
+#define DESC(obj) ((obj) ? [(obj) description].UTF8String : "nil")
+
+int main(void) {
+    @autoreleasepool {
+        standin s;
+        if (!start_standin(&s)) {
+            fprintf(stderr, "can't start standin/http_server.py (python3 needed)\n");
+            return 1;
+        }
+        NSFileManager *fm = [NSFileManager defaultManager];
+        NSString *dir = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                         [NSString stringWithFormat:@"jessi-download-test-%d", getpid()]];
+        [fm createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+        NSError *error = nil;
+        NSArray<NSString *> *log = nil;
+
+        // Cut off a quarter of the way in: the retry asks for the rest, not the whole file.
+        NSString *resumed = [dir stringByAppendingPathComponent:@"resumed.bin"];
+        error = download(&s, @[@"/drop/resumed.bin"], resumed);
+        JESSI_CHECK(!error, "resume: %s", DESC(error));
+        JESSI_CHECK([[fm attributesOfItemAtPath:resumed error:nil] fileSize] == 1 << 20, "resume: wrong size");
+        log = request_log(&s);
+        JESSI_CHECK(log.count == 2, "resume: expected 2 requests, got %s", DESC(log));
+        if (log.count == 2) {
+            NSString *range = [log[1] componentsSeparatedByString:@" "].lastObject;
+            long long offset = [range hasPrefix:@"bytes="] ? [range substringFromIndex:6].longLongValue : 0;
+            JESSI_CHECK(offset > 0 && offset < 1 << 20, "resume: second request was %s", DESC(log[1]));
+        }
+
+        // The first mirror is down; the second one serves the file.
+        NSString *failover = [dir stringByAppendingPathComponent:@"failover.bin"];
+        error = download(&s, @[@"/down/failover.bin", @"/good/failover.bin"], failover);
+        JESSI_CHECK(!error, "failover: %s", DESC(error));
+        JESSI_CHECK([fm fileExistsAtPath:failover], "failover: no file");
+        log = request_log(&s);
+        JESSI_CHECK(log.count == 2 && [log[0] hasPrefix:@"/down/"] && [log[1] hasPrefix:@"/good/"],
+                    "failover: requests %s", DESC(log));
+
+        // Corrupt bytes from the only mirror: one clean retry, then a hash mismatch and no file.
+        NSString *corrupt = [dir stringByAppendingPathComponent:@"corrupt.bin"];
+        error = download(&s, @[@"/corrupt/corrupt.bin"], corrupt);
+        JESSI_CHECK(is_error(error, JessiDownloadErrorHashMismatch), "corrupt: %s", DESC(error));
+        JESSI_CHECK(![fm fileExistsAtPath:corrupt], "corrupt: unverified file moved into place");
+        log = request_log(&s);
+        JESSI_CHECK(log.count == 2, "corrupt: expected 2 requests, got %s", DESC(log));
+
+        // The retry after a mismatch moves on to the next mirror.
+        NSString *recovered = [dir stringByAppendingPathComponent:@"recovered.bin"];
+        error = download(&s, @[@"/corrupt/recovered.bin", @"/good/recovered.bin"], recovered);
+        JESSI_CHECK(!error, "recovered: %s", DESC(error));
+        log = request_log(&s);
+        JESSI_CHECK(log.count == 2 && [log[1] hasPrefix:@"/good/"], "recovered: requests %s", DESC(log));
+
+        [fm removeItemAtPath:dir error:nil];
+        stop_standin(&s);
+    }
+    return jessi_test_done("download_test");
+}
@@ -0,0 +1,60 @@
+#ifndef jessi_test_h
+#define jessi_test_h
+
+// Tiny harness for the portable C parts of JessiCore. Each test is its own program: checks
+// print file:line on failure and main returns jessi_test_done().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int jessi_test_failures;
+static int jessi_test_checks;
+
+#define JESSI_CHECK(cond, ...)                                           \
+    do {                                                                 \
+        jessi_test_checks++;                                             \
+        if (!(cond)) {                                                   \
+            jessi_test_failures++;                                       \
+            fprintf(stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                \
+            fputc('\n', stderr);                                         \
+        }                                                                \
+    } while (0)
+
+static inline int jessi_test_done(const char *name) {
+    if (jessi_test_failures) {
+        fprintf(stderr, "%s: %d of %d checks failed\n", name, jessi_test_failures, jessi_test_checks);
+        return 1;
+    }
+    printf("%s: %d checks passed\n", name, jessi_test_checks);
+    return 0;
+}
+
+static inline double jessi_test_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Whole file into a NUL-terminated heap buffer; NULL if it can't be read.
+static inline char *jessi_test_read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = n >= 0 ? malloc((size_t)n + 1) : NULL;
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    if (!buf) return NULL;
+    buf[n] = '\0';
+    if (len) *len = (size_t)n;
+    return buf;
+}
+
+#endif
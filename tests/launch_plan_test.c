@@ -0,0 +1,154 @@
+// Builds launch plans for fixed device/server inputs and compares the argument vector with
+// tests/golden/launch-plan/<case>.txt. JESSI_UPDATE_GOLDEN=1 rewrites the files instead.
+
+#include "JessiLaunchPlan.h"
+#include "jessi_test.h"
+
+#define SET_ARGS(list, count, ...)                                                 \
+    do {                                                                           \
+        static const char *const args_[] = {__VA_ARGS__};                          \
+        (list) = args_;                                                            \
+        (count) = sizeof(args_) / sizeof(args_[0]);                                \
+    } while (0)
+
+typedef struct {
+    const char *name;
+    jessi_launch_inputs in;
+} plan_case;
+
+static jessi_launch_inputs base_server(void) {
+    jessi_launch_inputs in = {0};
+    in.kind = JESSI_LAUNCH_SERVER;
+    in.java_major = 21;
+    in.ios_major = 18;
+    in.has_extended_va = 1;
+    in.device_ram_mb = 8192;
+    in.cpu_cores = 6;
+    in.software = "vanilla";
+    in.java_path = "/rt/java21/bin/java";
+    in.java_home = "/rt/java21";
+    in.working_dir = "/docs/servers/survival";
+    in.tmp_dir = "/tmp/jessi";
+    in.library_path = "/app/Frameworks";
+    in.jar_path = "/docs/servers/survival/server.jar";
+    return in;
+}
+
+static void check_case(const plan_case *c, const char *dir, int update) {
+    jessi_launch_plan *plan = jessi_launch_plan_build(&c->in);
+    JESSI_CHECK(plan != NULL, "%s: build failed", c->name);
+    if (!plan) return;
+
+    size_t need = jessi_launch_plan_format(plan, NULL, 0);
+    size_t hlen = strlen("# profile: ") + strlen(jessi_launch_plan_profile(plan)) + 1;
+    char *got = malloc(hlen + need + 1);
+    snprintf(got, hlen + 1, "# profile: %s\n", jessi_launch_plan_profile(plan));
+    jessi_launch_plan_format(plan, got + hlen, need + 1);
+
+    char *const *argv = jessi_launch_plan_argv(plan);
+    JESSI_CHECK(argv && argv[jessi_launch_plan_argc(plan)] == NULL, "%s: argv not NULL-terminated", c->name);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.txt", dir, c->name);
+    if (update) {
+        FILE *f = fopen(path, "w");
+        JESSI_CHECK(f != NULL, "%s: can't write %s", c->name, path);
+        if (f) {
+            fputs(got, f);
+            fclose(f);
+        }
+    } else {
+        char *want = jessi_test_read_file(path, NULL);
+        JESSI_CHECK(want != NULL, "%s: missing %s (run with JESSI_UPDATE_GOLDEN=1)", c->name, path);
+        if (want) {
+            JESSI_CHECK(strcmp(want, got) == 0, "%s: differs from %s\n--- got\n%s--- want\n%s", c->name, path, got, want);
+            free(want);
+        }
+    }
+    free(got);
+    jessi_launch_plan_destroy(plan);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "golden/launch-plan";
+    const char *env = getenv("JESSI_UPDATE_GOLDEN");
+    int update = env && env[0] == '1';
+
+    plan_case cases[16];
+    size_t n = 0;
+
+    // Defaults only: 768M heap, Serial, the iOS <= 18 code cache cap.
+    cases[n++] = (plan_case){"ios18-vanilla", base_server()};
+
+    // Collector choice from the user: -UseSerialGC and a flag that merely ends in GC must not
+    // displace +UseG1GC. The TXM and compressed-class-pointer flags stay.
+    {
+        jessi_launch_inputs in = base_server();
+        in.ios_major = 26;
+        in.txm_support = 1;
+        in.has_extended_va = 0;
+        in.software = "forge";
+        in.heap_mb = 2048;
+        SET_ARGS(in.user_args, in.user_arg_count, "-Xmx3G", "-XX:+UseG1GC", "-XX:-UseSerialGC",
+                 "-XX:+UseAdaptiveSizePolicyWithSystemGC", "-XX:+UseCompressedClassPointers",
+                 "-XX:-MirrorMappedCodeCache");
+        cases[n++] = (plan_case){"ios26-txm-forge-user-gc", in};
+    }
+
+    // Low-memory phone on Paper: the user's -Xms wins, the CDS archive is mapped.
+    {
+        jessi_launch_inputs in = base_server();
+        in.java_major = 17;
+        in.device_ram_mb = 3072;
+        in.software = "paper";
+        in.cds_archive = "/docs/servers/survival/jessi-cds.jsa";
+        SET_ARGS(in.user_args, in.user_arg_count, "-Xms64M", "-Dpaper.playerconnection.keepalive=60");
+        cases[n++] = (plan_case){"ios17-low-memory-paper", in};
+    }
+
+    // Java 8 on iOS 16: flags the in-process JVM can't honour are dropped.
+    {
+        jessi_launch_inputs in = base_server();
+        in.java_major = 8;
+        in.ios_major = 16;
+        in.java_path = "/rt/java8/bin/java";
+        in.java_home = "/rt/java8";
+        SET_ARGS(in.user_args, in.user_arg_count, "-Xverify:none", "-XX:-UseCompressedOops", "-Xmx1G");
+        cases[n++] = (plan_case){"ios16-java8-unsupported-flags", in};
+    }
+
+    // macOS, big heap: G1 with its tuning, then the user picks Parallel and the tuning goes.
+    {
+        jessi_launch_inputs in = base_server();
+        in.spawned = 1;
+        in.ios_major = 0;
+        in.cpu_cores = 8;
+        in.heap_mb = 4096;
+        in.active_cpus = 4;
+        cases[n++] = (plan_case){"macos-g1", in};
+        SET_ARGS(in.user_args, in.user_arg_count, "-XX:+UseParallelGC");
+        cases[n++] = (plan_case){"macos-user-parallel", in};
+    }
+
+    // Forge argfile: everything from @argfile on is the command; no -jar is added.
+    {
+        jessi_launch_inputs in = base_server();
+        in.software = "neoforge";
+        SET_ARGS(in.user_args, in.user_arg_count, "-Xmx2G", "@user_jvm_args.txt",
+                 "@libraries/net/neoforged/neoforge/21.1.72/unix_args.txt", "-Xmx9G", "nogui");
+        cases[n++] = (plan_case){"ios18-neoforge-argfile", in};
+    }
+
+    // Tool: fixed small heap, program arguments after the jar.
+    {
+        jessi_launch_inputs in = base_server();
+        in.kind = JESSI_LAUNCH_TOOL;
+        in.software = NULL;
+        in.jar_path = "/tmp/jessi/forge-installer.jar";
+        SET_ARGS(in.program_args, in.program_arg_count, "--installServer", "/docs/servers/modded");
+        cases[n++] = (plan_case){"tool-installer", in};
+    }
+
+    for (size_t i = 0; i < n; i++) check_case(&cases[i], dir, update);
+    return jessi_test_done("launch_plan_test");
+}
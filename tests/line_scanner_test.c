@@ -0,0 +1,275 @@
+// Checks JessiLineScanner: the vectorized newline search against memchr at every alignment,
+// UTF-8 prefix cuts, reassembly of a stream fed in every chunk size, overlong-line pieces and
+// the line filter. With --bench MB it times scanning + filtering a synthetic log against a
+// byte-at-a-time reference, which is what the scanner replaced.
+
+#include "JessiLineScanner.h"
+#include "jessi_test.h"
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    size_t lines;
+    size_t pieces;
+    size_t max_piece;
+    int bad_boundary;
+    const uint8_t *input;
+    size_t input_len;
+    size_t borrowed;
+} collector;
+
+static void collect_bytes(collector *c, const uint8_t *p, size_t n) {
+    if (c->len + n > c->cap) {
+        c->cap = (c->len + n) * 2 + 64;
+        c->buf = realloc(c->buf, c->cap);
+    }
+    memcpy(c->buf + c->len, p, n);
+    c->len += n;
+}
+
+// Rebuilds the stream: terminated lines get their '\n' back, pieces are appended as-is.
+static void collect_line(void *ctx, const uint8_t *line, size_t len, int terminated) {
+    collector *c = ctx;
+    collect_bytes(c, line, len);
+    if (terminated) {
+        collect_bytes(c, (const uint8_t *)"\n", 1);
+        c->lines++;
+    } else {
+        c->pieces++;
+        if (len > c->max_piece) c->max_piece = len;
+        if (jessi_utf8_complete_prefix(line, len) != len || (len && (line[0] & 0xC0) == 0x80)) c->bad_boundary = 1;
+    }
+    if (c->input && line >= c->input && line < c->input + c->input_len) c->borrowed++;
+}
+
+static void test_find_newline(void) {
+    uint8_t buf[96];
+    for (size_t start = 0; start < 16; start++) {
+        for (size_t len = 0; len + start <= 80; len++) {
+            for (size_t at = 0; at <= len; at++) {
+                memset(buf, 'x', sizeof(buf));
+                if (at < len) buf[start + at] = '\n';
+                buf[start + len] = '\n'; // just past the range; must never be reported
+                const uint8_t *want = len ? memchr(buf + start, '\n', len) : NULL;
+                const uint8_t *got = jessi_find_newline(buf + start, len);
+                if (got != want) {
+                    JESSI_CHECK(got == want, "start %zu len %zu nl %zu: got %td want %td", start, len, at,
+                                got ? got - buf : -1, want ? want - buf : -1);
+                    return;
+                }
+            }
+        }
+    }
+    JESSI_CHECK(1, "find_newline");
+}
+
+static void test_utf8_prefix(void) {
+    static const struct {
+        const char *bytes;
+        size_t want;
+    } cases[] = {
+        {"abc", 3},
+        {"a\xC3", 1},
+        {"a\xC3\xA9", 3},
+        {"\xE2\x82", 0},
+        {"x\xE2\x82\xAC", 4},
+        {"\xF0\x9F\x98", 0},
+        {"\xF0\x9F\x98\x80", 4},
+        {"\x80\x80", 2},   // stray continuation bytes: nothing to wait for
+        {"\xFF", 1},
+        {"", 0},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t len = strlen(cases[i].bytes);
+        size_t got = jessi_utf8_complete_prefix((const uint8_t *)cases[i].bytes, len);
+        JESSI_CHECK(got == cases[i].want, "case %zu: got %zu want %zu", i, got, cases[i].want);
+    }
+}
+
+static const char kStream[] =
+    "[12:00:00] [Server thread/INFO]: Starting minecraft server version 1.21.1\n"
+    "\n"
+    "[12:00:01] [Server thread/INFO]: Joueur \xC3\xA9t\xC3\xA9 connect\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\n"
+    "[12:00:02] [Server thread/WARN]: Can't keep up! Is the server overloaded? Running 2500ms or 50 ticks behind\n"
+    "x\n"
+    "[12:00:03] [Server thread/INFO]: partial tail without newline \xF0\x9F\x98\x80";
+
+static void test_chunked_feed(void) {
+    const uint8_t *in = (const uint8_t *)kStream;
+    size_t len = sizeof(kStream) - 1;
+    for (size_t chunk = 1; chunk <= len; chunk++) {
+        jessi_line_scanner *s = jessi_line_scanner_create(0);
+        collector c = {0};
+        for (size_t off = 0; off < len; off += chunk) {
+            size_t n = len - off < chunk ? len - off : chunk;
+            jessi_line_scanner_feed(s, in + off, n, collect_line, &c);
+        }
+        size_t pending = jessi_line_scanner_pending(s);
+        jessi_line_scanner_flush(s, collect_line, &c);
+        int ok = c.len == len && memcmp(c.buf, in, len) == 0 && c.lines == 5 && c.pieces == 1 && pending > 0;
+        if (!ok) {
+            JESSI_CHECK(ok, "chunk %zu: %zu bytes, %zu lines, %zu pieces, pending %zu", chunk, c.len, c.lines, c.pieces, pending);
+            free(c.buf);
+            jessi_line_scanner_destroy(s);
+            return;
+        }
+        JESSI_CHECK(jessi_line_scanner_pending(s) == 0, "chunk %zu: flush left bytes", chunk);
+        free(c.buf);
+        jessi_line_scanner_destroy(s);
+    }
+}
+
+static void test_zero_copy(void) {
+    const uint8_t *in = (const uint8_t *)kStream;
+    size_t len = sizeof(kStream) - 1;
+    jessi_line_scanner *s = jessi_line_scanner_create(0);
+    collector c = {.input = in, .input_len = len};
+    jessi_line_scanner_feed(s, in, len, collect_line, &c);
+    JESSI_CHECK(c.lines == 5 && c.borrowed == 5, "complete lines should come straight from the input: %zu of %zu", c.borrowed, c.lines);
+    JESSI_CHECK(jessi_line_scanner_pending(s) > 0, "tail should be carried");
+    jessi_line_scanner_reset(s);
+    JESSI_CHECK(jessi_line_scanner_pending(s) == 0, "reset kept bytes");
+    free(c.buf);
+    jessi_line_scanner_destroy(s);
+}
+
+static void test_overlong_lines(void) {
+    // 3- and 4-byte sequences that straddle every possible 16/17/64-byte cut.
+    uint8_t line[1000];
+    size_t len = 0;
+    while (len + 7 < sizeof(line)) {
+        memcpy(line + len, "\xE2\x82\xAC" "\xF0\x9F\x98\x80", 7);
+        len += 7;
+    }
+    line[len++] = '\n';
+    size_t maxes[] = {16, 17, 64};
+    for (size_t m = 0; m < 3; m++) {
+        for (size_t chunk = 1; chunk <= 33; chunk += 4) {
+            jessi_line_scanner *s = jessi_line_scanner_create(maxes[m]);
+            collector c = {0};
+            for (size_t off = 0; off < len; off += chunk) {
+                size_t n = len - off < chunk ? len - off : chunk;
+                jessi_line_scanner_feed(s, line + off, n, collect_line, &c);
+            }
+            JESSI_CHECK(c.len == len && memcmp(c.buf, line, len) == 0, "max %zu chunk %zu: bytes lost", maxes[m], chunk);
+            JESSI_CHECK(c.pieces > 0 && c.max_piece <= maxes[m], "max %zu chunk %zu: piece of %zu", maxes[m], chunk, c.max_piece);
+            JESSI_CHECK(!c.bad_boundary, "max %zu chunk %zu: piece split a UTF-8 sequence", maxes[m], chunk);
+            JESSI_CHECK(c.lines == 1, "max %zu chunk %zu: %zu terminated lines", maxes[m], chunk, c.lines);
+            free(c.buf);
+            jessi_line_scanner_destroy(s);
+        }
+    }
+}
+
+static int matches(const jessi_line_filter *f, const char *line) {
+    return jessi_line_filter_matches(f, (const uint8_t *)line, strlen(line));
+}
+
+static void test_filter(void) {
+    jessi_line_filter *f = jessi_line_filter_create();
+    JESSI_CHECK(jessi_line_filter_add(f, JESSI_LINE_RULE_SUBSTRING, "RCON") == 0, "substring rule");
+    JESSI_CHECK(jessi_line_filter_add(f, JESSI_LINE_RULE_PREFIX, "[Rcon") == 0, "prefix rule");
+    JESSI_CHECK(jessi_line_filter_add(f, JESSI_LINE_RULE_REGEX, "remote control( listener)?$") == 0, "regex rule");
+    JESSI_CHECK(jessi_line_filter_add(f, JESSI_LINE_RULE_REGEX, "([unclosed") == -1, "bad regex accepted");
+    JESSI_CHECK(jessi_line_filter_add(f, JESSI_LINE_RULE_SUBSTRING, "") == -1, "empty pattern accepted");
+    JESSI_CHECK(jessi_line_filter_count(f) == 3, "count %zu", jessi_line_filter_count(f));
+
+    JESSI_CHECK(matches(f, "[12:00:00] [RCON Listener #1/INFO]: Thread RCON Client started"), "substring");
+    JESSI_CHECK(matches(f, "[Rcon] closed"), "prefix");
+    JESSI_CHECK(!matches(f, "x [Rcon] closed"), "prefix matched mid-line");
+    JESSI_CHECK(matches(f, "[12:00:00] [Server thread/INFO]: Starting remote control listener"), "regex");
+    JESSI_CHECK(!matches(f, "[12:00:00] [Server thread/INFO]: remote control listener is off"), "regex anchor ignored");
+    JESSI_CHECK(!matches(f, "[12:00:00] [Server thread/INFO]: Done (3.2s)!"), "plain line filtered");
+    JESSI_CHECK(!matches(f, "RCO"), "short line matched");
+
+    // Lines are not NUL-terminated: nothing past `len` may take part in a match.
+    const char *buf = "[12:00:00] Done RCON remote control";
+    JESSI_CHECK(!jessi_line_filter_matches(f, (const uint8_t *)buf, 15), "matched past the line end");
+    JESSI_CHECK(jessi_line_filter_matches(f, (const uint8_t *)buf, 20), "substring at the line end");
+    jessi_line_filter_destroy(f);
+}
+
+// What the scanner replaced, in C terms: one byte at a time to the newline, then each pattern
+// searched from every position.
+static size_t reference_scan(const uint8_t *p, size_t len, const char *const *patterns, size_t npat) {
+    size_t kept = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != '\n') continue;
+        int hit = 0;
+        for (size_t k = 0; k < npat && !hit; k++) {
+            size_t n = strlen(patterns[k]);
+            for (size_t j = start; j + n <= i && !hit; j++) hit = memcmp(p + j, patterns[k], n) == 0;
+        }
+        kept += !hit;
+        start = i + 1;
+    }
+    return kept;
+}
+
+typedef struct {
+    const jessi_line_filter *filter;
+    size_t kept;
+} bench_ctx;
+
+static void bench_line(void *ctx, const uint8_t *line, size_t len, int terminated) {
+    bench_ctx *b = ctx;
+    if (terminated && !jessi_line_filter_matches(b->filter, line, len)) b->kept++;
+}
+
+static void bench(long megabytes) {
+    static const char *const lines[] = {
+        "[12:00:00] [Server thread/INFO]: Steve joined the game\n",
+        "[12:00:01] [Server thread/WARN]: Can't keep up! Is the server overloaded? Running 2034ms or 40 ticks behind\n",
+        "[12:00:02] [RCON Listener #1/INFO]: Thread RCON Client #3 started\n",
+        "[12:00:03] [Worker-Main-4/INFO]: Preparing spawn area: 84%\n",
+        "[12:00:04] [Server thread/INFO]: <Alex> is anyone on? \xC3\xA9\xE2\x82\xAC\n",
+    };
+    static const char *const patterns[] = {"RCON", "Rcon", "remote control"};
+    size_t len = (size_t)megabytes << 20;
+    uint8_t *text = malloc(len);
+    size_t off = 0;
+    for (size_t i = 0; off < len; i++) {
+        const char *l = lines[i % 5];
+        size_t n = strlen(l);
+        if (n > len - off) n = len - off;
+        memcpy(text + off, l, n);
+        off += n;
+    }
+
+    jessi_line_filter *f = jessi_line_filter_create();
+    for (size_t k = 0; k < 3; k++) jessi_line_filter_add(f, JESSI_LINE_RULE_SUBSTRING, patterns[k]);
+    jessi_line_scanner *s = jessi_line_scanner_create(0);
+    bench_ctx b = {f, 0};
+    double t0 = jessi_test_now();
+    for (size_t o = 0; o < len; o += 65536) {
+        jessi_line_scanner_feed(s, text + o, len - o < 65536 ? len - o : 65536, bench_line, &b);
+    }
+    double t1 = jessi_test_now();
+    size_t kept = reference_scan(text, len, patterns, 3);
+    double t2 = jessi_test_now();
+    JESSI_CHECK(kept == b.kept, "bench: scanner kept %zu lines, reference %zu", b.kept, kept);
+
+    double mb = (double)len / (1 << 20);
+    printf("line scanner: %.0f MB, scanner+filter %.0f MB/s, byte-at-a-time reference %.0f MB/s (%.1fx)\n", mb,
+           mb / (t1 - t0), mb / (t2 - t1), (t2 - t1) / (t1 - t0));
+    jessi_line_scanner_destroy(s);
+    jessi_line_filter_destroy(f);
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    long bench_mb = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) bench_mb = strtol(argv[++i], NULL, 10);
+    }
+    test_find_newline();
+    test_utf8_prefix();
+    test_chunked_feed();
+    test_zero_copy();
+    test_overlong_lines();
+    test_filter();
+    if (bench_mb > 0 && !jessi_test_failures) bench(bench_mb);
+    return jessi_test_done("line_scanner_test");
+}
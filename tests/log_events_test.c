@@ -0,0 +1,104 @@
+// Feeds tests/corpus/server-log.tsv through the log parser and checks every line's event.
+// With --bench N it then parses the corpus N times and reports lines per second.
+
+#include "JessiLogEvents.h"
+#include "jessi_test.h"
+
+static const char *kKinds[] = {
+    "NONE", "DONE", "LAG", "JOIN", "LEAVE", "SAVE_STARTED", "SAVED", "STOPPING", "EXCEPTION", "STACK_FRAME",
+};
+static const char *kLevels[] = {"-", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+typedef struct {
+    const char *kind;
+    const char *level;
+    const char *value;
+    const char *subject;
+    const char *line;
+    int lineno;
+} corpus_row;
+
+// Splits the corpus in place; the line is everything after the fourth tab.
+static size_t load_corpus(char *text, corpus_row *rows, size_t cap) {
+    size_t n = 0;
+    int lineno = 0;
+    for (char *p = text; *p && n < cap;) {
+        char *nl = strchr(p, '\n');
+        if (nl) *nl = '\0';
+        lineno++;
+        if (*p && *p != '#') {
+            char *fields[4];
+            char *q = p;
+            int ok = 1;
+            for (int i = 0; i < 4 && ok; i++) {
+                fields[i] = q;
+                char *tab = strchr(q, '\t');
+                if (!tab) ok = 0;
+                else {
+                    *tab = '\0';
+                    q = tab + 1;
+                }
+            }
+            JESSI_CHECK(ok, "corpus line %d is malformed", lineno);
+            if (ok) rows[n++] = (corpus_row){fields[0], fields[1], fields[2], fields[3], q, lineno};
+        }
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+    const char *path = "corpus/server-log.tsv";
+    long bench = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) bench = strtol(argv[++i], NULL, 10);
+        else path = argv[i];
+    }
+    char *text = jessi_test_read_file(path, NULL);
+    if (!text) {
+        fprintf(stderr, "can't read %s\n", path);
+        return 1;
+    }
+    static corpus_row rows[1024];
+    size_t count = load_corpus(text, rows, 1024);
+    JESSI_CHECK(count > 0, "empty corpus");
+
+    jessi_log_parser parser;
+    jessi_log_parser_init(&parser);
+    for (size_t i = 0; i < count; i++) {
+        const corpus_row *r = &rows[i];
+        const uint8_t *line = (const uint8_t *)r->line;
+        jessi_log_event ev;
+        jessi_log_parser_feed(&parser, line, strlen(r->line), &ev);
+        JESSI_CHECK(strcmp(kKinds[ev.kind], r->kind) == 0, "line %d: kind %s, want %s", r->lineno, kKinds[ev.kind], r->kind);
+        JESSI_CHECK(strcmp(kLevels[ev.level], r->level) == 0, "line %d: level %s, want %s", r->lineno, kLevels[ev.level], r->level);
+        if (strcmp(r->value, "-") != 0) {
+            JESSI_CHECK(ev.value == strtoll(r->value, NULL, 10), "line %d: value %lld, want %s", r->lineno, (long long)ev.value, r->value);
+        }
+        if (strcmp(r->subject, "-") != 0) {
+            size_t n = strlen(r->subject);
+            JESSI_CHECK(ev.subject.length == n && memcmp(line + ev.subject.offset, r->subject, n) == 0,
+                        "line %d: subject %.*s, want %s", r->lineno, (int)ev.subject.length, r->line + ev.subject.offset, r->subject);
+        }
+    }
+
+    if (bench > 0 && !jessi_test_failures) {
+        size_t lens[1024];
+        for (size_t i = 0; i < count; i++) lens[i] = strlen(rows[i].line);
+        volatile int sink = 0;
+        double start = jessi_test_now();
+        for (long n = 0; n < bench; n++) {
+            for (size_t i = 0; i < count; i++) {
+                jessi_log_event ev;
+                sink += jessi_log_parser_feed(&parser, (const uint8_t *)rows[i].line, lens[i], &ev);
+            }
+        }
+        double secs = jessi_test_now() - start;
+        double lines = (double)bench * (double)count;
+        printf("log events: %.0f lines in %.3fs, %.1f M lines/s, %.0f ns/line\n", lines, secs, lines / secs / 1e6, secs / lines * 1e9);
+        (void)sink;
+    }
+    free(text);
+    return jessi_test_done("log_events_test");
+}
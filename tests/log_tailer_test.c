@@ -0,0 +1,163 @@
+// Drives JessiLogTailer on real files in a temporary directory (inotify on Linux, kqueue on
+// macOS): stdio until latest.log appears, appends, log4j-style rotation, truncation, and the
+// stale latest.log from a previous run.
+
+#include "JessiLogTailer.h"
+#include "jessi_test.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+    char got[2][4096];
+    size_t len[2];
+    int overflow;
+} collector;
+
+static void collect(void *ctx, jessi_log_source source, const uint8_t *bytes, size_t len) {
+    collector *c = ctx;
+    pthread_mutex_lock(&c->lock);
+    if (c->len[source] + len < sizeof(c->got[source])) {
+        memcpy(c->got[source] + c->len[source], bytes, len);
+        c->len[source] += len;
+        c->got[source][c->len[source]] = '\0';
+    } else {
+        c->overflow = 1;
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+// Waits up to two seconds for everything `source` delivered so far to equal `want`.
+static int wait_for(collector *c, jessi_log_source source, const char *want) {
+    double deadline = jessi_test_now() + 2.0;
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        int same = strcmp(c->got[source], want) == 0;
+        pthread_mutex_unlock(&c->lock);
+        if (same) return 1;
+        if (jessi_test_now() > deadline) return 0;
+        usleep(2000);
+    }
+}
+
+static const char *got(collector *c, jessi_log_source source) {
+    static char copy[4096];
+    pthread_mutex_lock(&c->lock);
+    memcpy(copy, c->got[source], sizeof(copy));
+    pthread_mutex_unlock(&c->lock);
+    return copy;
+}
+
+static void put(const char *path, int flags, const char *text) {
+    int fd = open(path, O_WRONLY | O_CREAT | flags, 0644);
+    JESSI_CHECK(fd >= 0, "can't open %s", path);
+    if (fd < 0) return;
+    size_t len = strlen(text);
+    JESSI_CHECK(write(fd, text, len) == (ssize_t)len, "short write to %s", path);
+    close(fd);
+}
+
+static void path_in(char *out, size_t cap, const char *dir, const char *name) {
+    snprintf(out, cap, "%s/%s", dir, name);
+}
+
+int main(void) {
+    char dir[] = "/tmp/jessi-log-tailer-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char latest[256], stdio[256], rotated[256];
+    path_in(latest, sizeof(latest), dir, "latest.log");
+    path_in(stdio, sizeof(stdio), dir, "stdio.log");
+    path_in(rotated, sizeof(rotated), dir, "2026-10-17-1.log");
+
+    collector c = {.lock = PTHREAD_MUTEX_INITIALIZER};
+    jessi_log_tailer_stats stats;
+
+    // Before latest.log exists the tailer follows stdio.
+    put(stdio, O_TRUNC, "Starting server\n");
+    jessi_log_tailer *t = jessi_log_tailer_create(latest, stdio, collect, &c);
+    JESSI_CHECK(t != NULL, "create failed");
+    if (!t) return jessi_test_done("log_tailer_test");
+    JESSI_CHECK(jessi_log_tailer_start(t) == 0, "start failed");
+    JESSI_CHECK(jessi_log_tailer_start(t) != 0, "second start succeeded");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_STDIO, "Starting server\n"), "stdio: %s", got(&c, JESSI_LOG_SOURCE_STDIO));
+    put(stdio, O_APPEND, "Loading libraries\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_STDIO, "Starting server\nLoading libraries\n"),
+                "stdio append: %s", got(&c, JESSI_LOG_SOURCE_STDIO));
+
+    // latest.log appears: what stdio had left is drained, then only latest.log is followed.
+    put(stdio, O_APPEND, "last stdio line\n");
+    put(latest, O_TRUNC, "[Server thread/INFO]: Preparing level\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_LATEST, "[Server thread/INFO]: Preparing level\n"),
+                "latest: %s", got(&c, JESSI_LOG_SOURCE_LATEST));
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_STDIO, "Starting server\nLoading libraries\nlast stdio line\n"),
+                "stdio drain: %s", got(&c, JESSI_LOG_SOURCE_STDIO));
+    put(stdio, O_APPEND, "ignored\n");
+    put(latest, O_APPEND, "[Server thread/INFO]: Done (3.2s)!\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_LATEST, "[Server thread/INFO]: Preparing level\n[Server thread/INFO]: Done (3.2s)!\n"),
+                "latest append: %s", got(&c, JESSI_LOG_SOURCE_LATEST));
+    JESSI_CHECK(strstr(got(&c, JESSI_LOG_SOURCE_STDIO), "ignored") == NULL, "stdio still followed after latest.log");
+    jessi_log_tailer_get_stats(t, &stats);
+    JESSI_CHECK(stats.source_switches == 1, "%llu source switches", (unsigned long long)stats.source_switches);
+
+    // Rotation: a line written just before the rename still comes from the old file, then the
+    // new latest.log is read from the start.
+    pthread_mutex_lock(&c.lock);
+    c.len[JESSI_LOG_SOURCE_LATEST] = 0;
+    c.got[JESSI_LOG_SOURCE_LATEST][0] = '\0';
+    pthread_mutex_unlock(&c.lock);
+    jessi_log_tailer_get_stats(t, &stats);
+    uint64_t reopens = stats.reopens;
+    put(latest, O_APPEND, "before rotation\n");
+    JESSI_CHECK(rename(latest, rotated) == 0, "rename failed");
+    put(latest, O_TRUNC, "a fresh latest.log after rotation\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_LATEST, "before rotation\na fresh latest.log after rotation\n"),
+                "rotation: %s", got(&c, JESSI_LOG_SOURCE_LATEST));
+    put(rotated, O_APPEND, "written to the old file\n");
+    put(latest, O_APPEND, "after\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_LATEST, "before rotation\na fresh latest.log after rotation\nafter\n"),
+                "after rotation: %s", got(&c, JESSI_LOG_SOURCE_LATEST));
+    jessi_log_tailer_get_stats(t, &stats);
+    JESSI_CHECK(stats.reopens > reopens, "rotation not counted as a reopen");
+
+    // Truncation in place: the shorter file is read again from the start.
+    reopens = stats.reopens;
+    put(latest, O_TRUNC, "cut\n");
+    JESSI_CHECK(wait_for(&c, JESSI_LOG_SOURCE_LATEST, "before rotation\na fresh latest.log after rotation\nafter\ncut\n"),
+                "truncation: %s", got(&c, JESSI_LOG_SOURCE_LATEST));
+    jessi_log_tailer_get_stats(t, &stats);
+    JESSI_CHECK(stats.reopens > reopens, "truncation not counted as a reopen");
+    JESSI_CHECK(stats.wakeups > 0 && stats.read_calls > 0, "no wakeups or reads counted");
+
+    // Nothing is delivered after stop.
+    jessi_log_tailer_stop(t);
+    put(latest, O_APPEND, "after stop\n");
+    usleep(50000);
+    JESSI_CHECK(strstr(got(&c, JESSI_LOG_SOURCE_LATEST), "after stop") == NULL, "delivered after stop");
+    jessi_log_tailer_destroy(t);
+
+    // A latest.log left by the previous run is stale: only what is appended after create counts.
+    collector fresh = {.lock = PTHREAD_MUTEX_INITIALIZER};
+    put(latest, O_TRUNC, "previous run\n");
+    t = jessi_log_tailer_create(latest, stdio, collect, &fresh);
+    JESSI_CHECK(t != NULL && jessi_log_tailer_start(t) == 0, "second tailer failed");
+    if (t) {
+        usleep(50000);
+        put(latest, O_APPEND, "this run\n");
+        JESSI_CHECK(wait_for(&fresh, JESSI_LOG_SOURCE_LATEST, "this run\n"), "stale: %s", got(&fresh, JESSI_LOG_SOURCE_LATEST));
+        jessi_log_tailer_destroy(t);
+    }
+    JESSI_CHECK(!c.overflow && !fresh.overflow, "collector overflow");
+
+    unlink(latest);
+    unlink(stdio);
+    unlink(rotated);
+    rmdir(dir);
+    return jessi_test_done("log_tailer_test");
+}
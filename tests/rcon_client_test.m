@@ -0,0 +1,162 @@
+// Runs JessiRconClient against tests/standin/rcon_server.py, which frames packets the way the
+// vanilla listener does: sentinel-terminated multi-packet replies, command order on one session,
+// auth failure, timeouts and drops followed by a reconnect. Needs Foundation, so macOS only.
+
+#import <Foundation/Foundation.h>
+#import <spawn.h>
+#import <sys/wait.h>
+#import "JessiRconClient.h"
+#include "jessi_test.h"
+
+extern char **environ;
+
+typedef struct {
+    pid_t pid;
+    int stdinFd;
+    int port;
+} standin;
+
+// The stand-in prints its port, then serves until its stdin closes.
+static BOOL start_standin(standin *s, const char *password) {
+    int in[2], out[2];
+    if (pipe(in) != 0) return NO;
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return NO;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, in[1]);
+    posix_spawn_file_actions_addclose(&actions, out[0]);
+    char *argv[] = {"python3", "standin/rcon_server.py", (char *)password, NULL};
+    int rc = posix_spawnp(&s->pid, "python3", &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(in[0]);
+    close(out[1]);
+    if (rc != 0) {
+        close(in[1]);
+        close(out[0]);
+        return NO;
+    }
+    s->stdinFd = in[1];
+    s->port = 0;
+    FILE *f = fdopen(out[0], "r");
+    if (!f || fscanf(f, "port %d", &s->port) != 1) s->port = 0;
+    if (f) fclose(f);
+    else close(out[0]);
+    return s->port > 0;
+}
+
+static void stop_standin(standin *s) {
+    close(s->stdinFd);
+    int status = 0;
+    waitpid(s->pid, &status, 0);
+}
+
+static JessiRconClient *new_client(int port, NSString *password) {
+    JessiRconClient *client = [[JessiRconClient alloc] initWithPort:port password:password];
+    // main() blocks on the replies, so completions can't go to the main queue.
+    client.completionQueue = dispatch_queue_create("com.baconmania.jessi.tests.rcon", DISPATCH_QUEUE_SERIAL);
+    return client;
+}
+
+static NSString *run(JessiRconClient *client, NSString *command, NSTimeInterval timeout, NSError **outError) {
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    __block NSString *response = nil;
+    __block NSError *error = nil;
+    [client sendCommand:command timeout:timeout completion:^(NSString *r, NSError *e) {
+        response = r;
+        error = e;
+        dispatch_semaphore_signal(done);
+    }];
+    if (dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(15 * NSEC_PER_SEC))) != 0) {
+        error = [NSError errorWithDomain:@"JessiTest" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"no completion"}];
+    }
+    if (outError) *outError = error;
+    return response;
+}
+
+static BOOL is_error(NSError *error, JessiRconErrorCode code) {
+    return [error.domain isEqualToString:JessiRconErrorDomain] && error.code == code;
+}
+
+#define DESC(obj) ((obj) ? [(obj) description].UTF8String : "nil")
+
+int main(void) {
+    @autoreleasepool {
+        standin s;
+        if (!start_standin(&s, "hunter2")) {
+            fprintf(stderr, "can't start standin/rcon_server.py (python3 needed)\n");
+            return 1;
+        }
+        JessiRconClient *client = new_client(s.port, @"hunter2");
+        NSError *error = nil;
+        NSString *r = nil;
+
+        r = run(client, @"echo hello", 0, &error);
+        JESSI_CHECK(!error && [r isEqualToString:@"hello"], "echo: %s / %s", DESC(r), DESC(error));
+        JESSI_CHECK(client.isConnected, "session closed after a reply");
+
+        // Vanilla splits this into 4096 + 4096 + 1808; only the sentinel ends the reply.
+        r = run(client, @"big 10000", 0, &error);
+        JESSI_CHECK(!error && r.length == 10000, "big: %lu chars / %s", (unsigned long)r.length, DESC(error));
+        if (r.length == 10000) {
+            JESSI_CHECK([r characterAtIndex:4096] == 'a' + 4096 % 26 && [r characterAtIndex:9999] == 'a' + 9999 % 26,
+                        "big: packets joined out of order");
+        }
+
+        // Queued commands go out one at a time and come back in order, even when one is slow.
+        {
+            dispatch_semaphore_t done = dispatch_semaphore_create(0);
+            __block NSArray<NSString *> *responses = nil;
+            __block NSError *batchError = nil;
+            [client sendCommands:@[@"echo a", @"slow 0.3 b", @"echo c"] completion:^(NSArray<NSString *> *rs, NSError *e) {
+                responses = rs;
+                batchError = e;
+                dispatch_semaphore_signal(done);
+            }];
+            long waited = dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(15 * NSEC_PER_SEC)));
+            JESSI_CHECK(waited == 0 && !batchError && [responses isEqualToArray:(@[@"a", @"b", @"c"])],
+                        "batch: %s / %s", DESC(responses), DESC(batchError));
+        }
+
+        r = run(client, @"connections", 0, &error);
+        JESSI_CHECK([r isEqualToString:@"1"], "expected one long-lived session, got %s connections", DESC(r));
+
+        // A lost reply fails with a timeout; the next request reconnects.
+        double start = jessi_test_now();
+        r = run(client, @"hang", 0.5, &error);
+        double elapsed = jessi_test_now() - start;
+        JESSI_CHECK(is_error(error, JessiRconErrorTimeout), "hang: %s", DESC(error));
+        JESSI_CHECK(elapsed >= 0.4 && elapsed < 5, "hang: timed out after %.2fs", elapsed);
+        r = run(client, @"echo after-timeout", 0, &error);
+        JESSI_CHECK(!error && [r isEqualToString:@"after-timeout"], "after timeout: %s / %s", DESC(r), DESC(error));
+
+        // The server dropping the session mid-request is reported; the next request reconnects.
+        r = run(client, @"drop", 0, &error);
+        JESSI_CHECK(is_error(error, JessiRconErrorDisconnected), "drop: %s", DESC(error));
+        r = run(client, @"echo after-drop", 0, &error);
+        JESSI_CHECK(!error && [r isEqualToString:@"after-drop"], "after drop: %s / %s", DESC(r), DESC(error));
+        r = run(client, @"connections", 0, &error);
+        JESSI_CHECK([r isEqualToString:@"3"], "expected 3 connections after two reconnects, got %s", DESC(r));
+
+        // "stop" answers and then closes: the partial reply comes back with the disconnect.
+        r = run(client, @"stop", 0, &error);
+        JESSI_CHECK(is_error(error, JessiRconErrorDisconnected), "stop: %s", DESC(error));
+        JESSI_CHECK([r isEqualToString:@"Stopping the server"], "stop: reply %s", DESC(r));
+        JESSI_CHECK(!client.isConnected, "stop: still connected");
+
+        JessiRconClient *wrong = new_client(s.port, @"wrong");
+        r = run(wrong, @"echo hello", 0, &error);
+        JESSI_CHECK(is_error(error, JessiRconErrorAuth), "bad password: %s", DESC(error));
+
+        stop_standin(&s);
+        [client disconnect];
+        r = run(client, @"echo hello", 0, &error);
+        JESSI_CHECK(is_error(error, JessiRconErrorConnect), "no listener: %s", DESC(error));
+    }
+    return jessi_test_done("rcon_client_test");
+}
@@ -0,0 +1,243 @@
+// Checks JessiSigScan on a fake 512 KB dyld __TEXT built from fixed bytes: the dyld bypass
+// signatures planted at known offsets between decoys (first-byte hits, 7-of-8 prefixes,
+// misaligned copies, a match straddling the scan end), a sweep of every small length against
+// the scalar scan it replaced, LC_UUID parsing and the offset cache. With --bench N it times
+// N scans of the fixture and of an all-zero image against the old two-pass scalar search.
+
+#include <unistd.h>
+
+#include "JessiSigScan.h"
+#include "jessi_test.h"
+
+#define IMAGE_LEN 0x80000
+
+// Copied from JessiJavaRunner.m: svc #0x80 after mov x16, #SYS_mmap / #SYS_fcntl.
+static const uint8_t kMmapSig[] = {0xB0, 0x18, 0x80, 0xD2, 0x01, 0x10, 0x00, 0xD4};
+static const uint8_t kFcntlSig[] = {0x90, 0x0B, 0x80, 0xD2, 0x01, 0x10, 0x00, 0xD4};
+static const uint8_t kUuid[16] = {0x4c, 0x4c, 0x44, 0x9a, 0x55, 0x55, 0x3c, 0x1e, 0x8a, 0x2b, 0x10, 0x7e, 0x39, 0x0f, 0x61, 0x07};
+
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    memcpy(p, &v, 4);
+}
+
+// mach_header_64 with a dummy load command followed by LC_UUID, then pseudo-random words.
+static void build_image(uint8_t *img, uint32_t seed) {
+    rng_state = seed;
+    for (size_t i = 0; i < IMAGE_LEN; i += 4) put32(img + i, rng() | 0x01000000u);
+    memset(img, 0, 96);
+    put32(img, 0xfeedfacfu);
+    put32(img + 16, 2);       // ncmds
+    put32(img + 20, 16 + 24); // sizeofcmds
+    put32(img + 32, 0x2a);    // some other command
+    put32(img + 36, 16);
+    put32(img + 48, 0x1b);    // LC_UUID
+    put32(img + 52, 24);
+    memcpy(img + 56, kUuid, 16);
+}
+
+static void plant(uint8_t *img, size_t off, const uint8_t *sig, size_t n) {
+    memcpy(img + off, sig, n);
+}
+
+// The pre-SIMD search: one aligned pass per signature.
+static size_t scalar_find(const uint8_t *base, size_t len, const uint8_t *sig, size_t n) {
+    for (size_t off = 0; off + n <= len; off += 4) {
+        if (base[off] == sig[0] && memcmp(base + off, sig, n) == 0) return off;
+    }
+    return JESSI_SIG_NOT_FOUND;
+}
+
+static const jessi_sig_pattern kPatterns[2] = {{kMmapSig, sizeof(kMmapSig)}, {kFcntlSig, sizeof(kFcntlSig)}};
+
+static void scan_expect(const char *what, const uint8_t *img, size_t len, size_t want0, size_t want1) {
+    size_t offsets[2];
+    size_t found = jessi_sig_scan(img, len, kPatterns, 2, offsets);
+    size_t want_found = (want0 != JESSI_SIG_NOT_FOUND) + (want1 != JESSI_SIG_NOT_FOUND);
+    JESSI_CHECK(offsets[0] == want0 && offsets[1] == want1 && found == want_found,
+                "%s: got %zx %zx (%zu found), want %zx %zx", what, offsets[0], offsets[1], found, want0, want1);
+    JESSI_CHECK(jessi_sig_verify(img, len, kPatterns, 2, offsets), "%s: verify rejected the scan result", what);
+}
+
+static void test_fixture(uint8_t *img) {
+    build_image(img, 0x5eed);
+    const size_t mmap_at = 0x3f1c4, fcntl_at = IMAGE_LEN - 8;
+    for (size_t i = 0; i < 64; i++) img[0x1000 + i * 64] = kMmapSig[0];       // first-byte decoys
+    plant(img, 0x200, kMmapSig, 7);                                              // 7 of 8 bytes
+    plant(img, 0x2f0, kFcntlSig, 7);
+    plant(img, 0x100a2, kMmapSig, 8);                                            // misaligned copy first
+    plant(img, 0x20001, kFcntlSig, 8);
+    plant(img, mmap_at, kMmapSig, 8);
+    plant(img, fcntl_at, kFcntlSig, 8);                                          // last slot that fits
+    scan_expect("fixture", img, IMAGE_LEN, mmap_at, fcntl_at);
+
+    // Four bytes shorter, the fcntl site straddles the end and must not count.
+    scan_expect("fixture, short scan", img, IMAGE_LEN - 4, mmap_at, JESSI_SIG_NOT_FOUND);
+
+    // The first aligned occurrence wins.
+    plant(img, 0x12340, kMmapSig, 8);
+    plant(img, 0x60, kFcntlSig, 8);
+    scan_expect("fixture, earlier copies", img, IMAGE_LEN, 0x12340, 0x60);
+
+    // Patching one byte of a found site makes a cached offset stale.
+    size_t offsets[2] = {0x12340, 0x60};
+    img[0x12340 + 5] ^= 0xff;
+    JESSI_CHECK(!jessi_sig_verify(img, IMAGE_LEN, kPatterns, 2, offsets), "verify accepted a patched site");
+    img[0x12340 + 5] ^= 0xff;
+    offsets[0] = 0x100a2;
+    JESSI_CHECK(!jessi_sig_verify(img, IMAGE_LEN, kPatterns, 2, offsets), "verify accepted a misaligned offset");
+    offsets[0] = JESSI_SIG_NOT_FOUND;
+    JESSI_CHECK(jessi_sig_verify(img, IMAGE_LEN, kPatterns, 2, offsets), "verify rejected a missing pattern");
+
+    uint8_t uuid[16];
+    JESSI_CHECK(jessi_macho_image_uuid(img, uuid) == 0 && memcmp(uuid, kUuid, 16) == 0, "LC_UUID not read");
+    put32(img + 20, 16 + 8); // sizeofcmds cuts LC_UUID short
+    JESSI_CHECK(jessi_macho_image_uuid(img, uuid) != 0, "read LC_UUID past sizeofcmds");
+    put32(img, 0xfeedface);
+    JESSI_CHECK(jessi_macho_image_uuid(img, uuid) != 0, "accepted a 32-bit header");
+}
+
+// Every short length and aligned position, including the SIMD block tails.
+static void test_sweep(void) {
+    uint8_t buf[160];
+    for (size_t len = 0; len <= 128; len++) {
+        for (size_t at = 0; at + 8 <= len + 8 && at < 128; at += 4) {
+            memset(buf, kMmapSig[0], sizeof(buf));
+            plant(buf, at, kFcntlSig, 8);
+            plant(buf, (at + 36) % 120, kMmapSig, 8);
+            size_t offsets[2];
+            jessi_sig_scan(buf, len, kPatterns, 2, offsets);
+            size_t want0 = scalar_find(buf, len, kMmapSig, 8), want1 = scalar_find(buf, len, kFcntlSig, 8);
+            if (offsets[0] != want0 || offsets[1] != want1) {
+                JESSI_CHECK(0, "len %zu at %zu: got %zx %zx want %zx %zx", len, at, offsets[0], offsets[1], want0, want1);
+                return;
+            }
+        }
+    }
+    JESSI_CHECK(1, "sweep");
+}
+
+static void test_random(uint8_t *img) {
+    for (uint32_t trial = 1; trial <= 40; trial++) {
+        build_image(img, trial * 7919);
+        for (int k = 0; k < 200; k++) img[(rng() % (IMAGE_LEN / 4)) * 4] = k & 1 ? kMmapSig[0] : kFcntlSig[0];
+        if (trial % 3) plant(img, (rng() % (IMAGE_LEN / 4 - 2)) * 4, kMmapSig, 8);
+        if (trial % 5) plant(img, (rng() % (IMAGE_LEN / 4 - 2)) * 4, kFcntlSig, 8);
+        if (trial % 7 == 0) plant(img, (rng() % (IMAGE_LEN / 4 - 2)) * 4 + 2, kMmapSig, 8);
+        size_t offsets[2];
+        jessi_sig_scan(img, IMAGE_LEN, kPatterns, 2, offsets);
+        size_t want0 = scalar_find(img, IMAGE_LEN, kMmapSig, 8), want1 = scalar_find(img, IMAGE_LEN, kFcntlSig, 8);
+        if (offsets[0] != want0 || offsets[1] != want1) {
+            JESSI_CHECK(0, "trial %u: got %zx %zx want %zx %zx", trial, offsets[0], offsets[1], want0, want1);
+            return;
+        }
+    }
+    JESSI_CHECK(1, "random");
+}
+
+static void test_bad_input(void) {
+    uint8_t buf[64] = {0};
+    plant(buf, 8, kMmapSig, 8);
+    size_t offsets[JESSI_SIG_MAX_PATTERNS + 1];
+    JESSI_CHECK(jessi_sig_scan(buf, sizeof(buf), kPatterns, 0, offsets) == 0, "count 0");
+    jessi_sig_pattern many[JESSI_SIG_MAX_PATTERNS + 1];
+    for (size_t i = 0; i <= JESSI_SIG_MAX_PATTERNS; i++) many[i] = kPatterns[0];
+    JESSI_CHECK(jessi_sig_scan(buf, sizeof(buf), many, JESSI_SIG_MAX_PATTERNS + 1, offsets) == 0 &&
+                    offsets[0] == JESSI_SIG_NOT_FOUND,
+                "too many patterns scanned");
+    jessi_sig_pattern empty[2] = {kPatterns[0], {kFcntlSig, 0}};
+    JESSI_CHECK(jessi_sig_scan(buf, sizeof(buf), empty, 2, offsets) == 0 && offsets[0] == JESSI_SIG_NOT_FOUND,
+                "empty pattern scanned");
+    JESSI_CHECK(jessi_sig_scan(buf, sizeof(buf), many, JESSI_SIG_MAX_PATTERNS, offsets) == JESSI_SIG_MAX_PATTERNS &&
+                    offsets[JESSI_SIG_MAX_PATTERNS - 1] == 8,
+                "repeated patterns should all resolve to the same site");
+}
+
+static void test_cache(void) {
+    char path[256];
+    const char *tmp = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/jessi-sig-cache-%d.txt", tmp && tmp[0] ? tmp : "/tmp", (int)getpid());
+    unlink(path);
+
+    uint8_t uuid[16];
+    memcpy(uuid, kUuid, 16);
+    size_t stored[2] = {0x3f1c4, JESSI_SIG_NOT_FOUND}, loaded[2] = {0, 0};
+    JESSI_CHECK(jessi_sig_cache_load(path, uuid, kPatterns, 2, loaded) != 0, "hit on a missing file");
+    JESSI_CHECK(jessi_sig_cache_store(path, uuid, kPatterns, 2, stored) == 0, "store failed");
+    JESSI_CHECK(jessi_sig_cache_load(path, uuid, kPatterns, 2, loaded) == 0 && loaded[0] == stored[0] &&
+                    loaded[1] == JESSI_SIG_NOT_FOUND,
+                "round trip: %zx %zx", loaded[0], loaded[1]);
+
+    // Another pattern set under the same image is a different entry.
+    const jessi_sig_pattern swapped[2] = {kPatterns[1], kPatterns[0]};
+    JESSI_CHECK(jessi_sig_cache_load(path, uuid, swapped, 2, loaded) != 0, "hit for another pattern set");
+
+    // Other dyld builds are kept up to a bound; the oldest go first, the newest stays.
+    for (uint8_t i = 1; i <= 12; i++) {
+        uuid[0] = i;
+        stored[0] = 0x1000u * i;
+        jessi_sig_cache_store(path, uuid, kPatterns, 2, stored);
+    }
+    uuid[0] = 12;
+    JESSI_CHECK(jessi_sig_cache_load(path, uuid, kPatterns, 2, loaded) == 0 && loaded[0] == 0xc000, "newest entry lost");
+    uuid[0] = 1;
+    JESSI_CHECK(jessi_sig_cache_load(path, uuid, kPatterns, 2, loaded) != 0, "oldest entry kept past the bound");
+    size_t len = 0;
+    char *text = jessi_test_read_file(path, &len);
+    size_t lines = 0;
+    for (size_t i = 0; text && i < len; i++) lines += text[i] == '\n';
+    JESSI_CHECK(lines > 0 && lines <= 8, "cache holds %zu lines", lines);
+    free(text);
+    unlink(path);
+}
+
+static void bench(uint8_t *img, long iters) {
+    const char *names[2] = {"fixture", "no match"};
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 0) {
+            build_image(img, 0x5eed);
+            plant(img, 0x3f1c4, kMmapSig, 8);
+            plant(img, IMAGE_LEN - 8, kFcntlSig, 8);
+        } else {
+            memset(img, 0, IMAGE_LEN);
+        }
+        volatile size_t sink = 0;
+        double t0 = jessi_test_now();
+        for (long i = 0; i < iters; i++) {
+            sink += scalar_find(img, IMAGE_LEN, kMmapSig, 8);
+            sink += scalar_find(img, IMAGE_LEN, kFcntlSig, 8);
+        }
+        double t1 = jessi_test_now();
+        for (long i = 0; i < iters; i++) {
+            size_t offsets[2];
+            sink += jessi_sig_scan(img, IMAGE_LEN, kPatterns, 2, offsets) + offsets[0];
+        }
+        double t2 = jessi_test_now();
+        double scalar_us = (t1 - t0) / (double)iters * 1e6, simd_us = (t2 - t1) / (double)iters * 1e6;
+        printf("sig scan (%s, 512 KB): scalar two-pass %.1f us, single pass %.1f us (%.1fx)\n", names[pass], scalar_us,
+               simd_us, scalar_us / simd_us);
+        (void)sink;
+    }
+}
+
+int main(int argc, char **argv) {
+    long iters = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) iters = strtol(argv[++i], NULL, 10);
+    }
+    uint8_t *img = malloc(IMAGE_LEN);
+    test_fixture(img);
+    test_sweep();
+    test_random(img);
+    test_bad_input();
+    test_cache();
+    if (iters > 0 && !jessi_test_failures) bench(img, iters);
+    free(img);
+    return jessi_test_done("sig_scan_test");
+}
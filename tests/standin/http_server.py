@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Stand-in download mirror, for tests/download_test.m.
+
+Prints "port <n> size <bytes> sha256 <hex>" once listening on 127.0.0.1, then serves until stdin
+closes. The body is random per run, so partial copies from an earlier run never match.
+
+Paths (anything after the first component is ignored, so each case can use its own file name):
+  /good/...     the body, with ETag, Content-Length and single byte ranges (206/416)
+  /drop/...     like /good, but the first request for each path sends a quarter of what it
+                promised and closes the connection
+  /down/...     503
+  /corrupt/...  like /good with one byte flipped
+  /log          "<path> <Range or ->" per request since the last /log, then forgets them
+"""
+
+import hashlib
+import http.server
+import os
+import re
+import sys
+import threading
+
+SIZE = 1 << 20
+BODY = os.urandom(SIZE)
+CORRUPT = BODY[:SIZE // 2] + bytes([BODY[SIZE // 2] ^ 0xFF]) + BODY[SIZE // 2 + 1:]
+ETAG = '"%s"' % hashlib.sha256(BODY).hexdigest()[:16]
+
+lock = threading.Lock()
+requests = []
+dropped = set()
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, *args):
+        pass
+
+    def do_GET(self):
+        if self.path == "/log":
+            with lock:
+                text = "".join("%s %s\n" % r for r in requests)
+                requests.clear()
+            self.send_body(200, text.encode(), {"Content-Type": "text/plain"})
+            return
+        with lock:
+            requests.append((self.path, self.headers.get("Range") or "-"))
+        kind = self.path.split("/")[1]
+        if kind == "down":
+            self.send_body(503, b"mirror down\n", {})
+            return
+        if kind not in ("good", "drop", "corrupt"):
+            self.send_body(404, b"not found\n", {})
+            return
+        body = CORRUPT if kind == "corrupt" else BODY
+        start, end, status = 0, SIZE, 200
+        headers = {"ETag": ETAG, "Accept-Ranges": "bytes"}
+        m = re.fullmatch(r"bytes=(\d+)-(\d*)", self.headers.get("Range") or "")
+        if_range = self.headers.get("If-Range")
+        if m and (if_range is None or if_range == ETAG):
+            start = int(m.group(1))
+            end = min(int(m.group(2)) + 1, SIZE) if m.group(2) else SIZE
+            if start >= SIZE or start >= end:
+                self.send_body(416, b"", {"Content-Range": "bytes */%d" % SIZE})
+                return
+            status = 206
+            headers["Content-Range"] = "bytes %d-%d/%d" % (start, end - 1, SIZE)
+        data = body[start:end]
+
+        with lock:
+            drop = kind == "drop" and self.path not in dropped
+            dropped.add(self.path)
+        if drop:
+            self.send_response(status)
+            for k, v in headers.items():
+                self.send_header(k, v)
+            self.send_header("Content-Length", str(len(data)))
+            self.end_headers()
+            self.wfile.write(data[:len(data) // 4])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+        self.send_body(status, data, headers)
+
+    def send_body(self, status, data, headers):
+        self.send_response(status)
+        for k, v in headers.items():
+            self.send_header(k, v)
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+
+def main():
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), Handler)
+    server.daemon_threads = True
+    print("port %d size %d sha256 %s" % (server.server_port, SIZE, hashlib.sha256(BODY).hexdigest()), flush=True)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    sys.stdin.read()
+
+
+if __name__ == "__main__":
+    main()
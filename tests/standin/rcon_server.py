@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Stand-in for the vanilla RCON listener, for tests/rcon_client_test.m.
+
+Prints "port <n>" once listening on 127.0.0.1, then serves until stdin closes. Like vanilla
+it reads one packet per recv() and drops the connection when two arrive together, splits
+replies into 4096-byte packets, and answers unknown packet types with "Unknown request".
+
+Commands: "echo <text>", "big <bytes>", "slow <seconds> <text>", "hang", "drop",
+"stop" (replies, then closes), "connections" (accepted so far).
+"""
+
+import socket
+import struct
+import sys
+import threading
+import time
+
+PASSWORD = sys.argv[1] if len(sys.argv) > 1 else "hunter2"
+MAX_PAYLOAD = 4096
+connections = 0
+lock = threading.Lock()
+
+
+def packet(pid, ptype, payload):
+    body = struct.pack("<ii", pid, ptype) + payload + b"\0\0"
+    return struct.pack("<i", len(body)) + body
+
+
+def reply(conn, pid, text):
+    data = text.encode()
+    chunks = [data[i:i + MAX_PAYLOAD] for i in range(0, len(data), MAX_PAYLOAD)] or [b""]
+    conn.sendall(b"".join(packet(pid, 0, c) for c in chunks))
+
+
+def serve(conn):
+    authed = False
+    with conn:
+        while True:
+            data = conn.recv(1460 * 4)
+            if len(data) < 14:
+                return
+            (length,) = struct.unpack_from("<i", data)
+            if length + 4 != len(data):
+                return  # partial or coalesced packets: vanilla loses the framing here
+            pid, ptype = struct.unpack_from("<ii", data, 4)
+            payload = data[12:-2].decode()
+            if ptype == 3:
+                authed = payload == PASSWORD
+                conn.sendall(packet(pid if authed else -1, 2, b""))
+                continue
+            if ptype != 2:
+                reply(conn, pid, "Unknown request %x" % ptype)
+                continue
+            if not authed:
+                reply(conn, -1, "")
+                continue
+            cmd, _, arg = payload.partition(" ")
+            if cmd == "echo":
+                reply(conn, pid, arg)
+            elif cmd == "big":
+                reply(conn, pid, "".join(chr(ord("a") + i % 26) for i in range(int(arg))))
+            elif cmd == "slow":
+                secs, _, text = arg.partition(" ")
+                time.sleep(float(secs))
+                reply(conn, pid, text)
+            elif cmd == "hang":
+                while conn.recv(4096):
+                    pass
+                return
+            elif cmd == "drop":
+                return
+            elif cmd == "stop":
+                reply(conn, pid, "Stopping the server")
+                conn.shutdown(socket.SHUT_RDWR)
+                return
+            elif cmd == "connections":
+                with lock:
+                    reply(conn, pid, str(connections))
+            else:
+                reply(conn, pid, "Unknown command")
+
+
+def main():
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("127.0.0.1", 0))
+    listener.listen(8)
+    print("port %d" % listener.getsockname()[1], flush=True)
+
+    def accept_loop():
+        global connections
+        while True:
+            conn, _ = listener.accept()
+            with lock:
+                connections += 1
+            threading.Thread(target=serve, args=(conn,), daemon=True).start()
+
+    threading.Thread(target=accept_loop, daemon=True).start()
+    sys.stdin.read()
+
+
+if __name__ == "__main__":
+    main()